@@ -0,0 +1 @@
+/root/repo/src/libbiomeval/../include/be_dirent_windows.h
\ No newline at end of file
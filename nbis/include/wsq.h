@@ -126,6 +126,8 @@ typedef struct wavlet_tree {
    int inv_cl;
 } W_TREE;
 #define W_TREELEN 20
+/* Number of levels of the wavelet tree with a lowpass subband */
+#define WSQ_MAX_REDUCTION 4
 
 typedef struct quant_tree {
    short x;     /* UL corner of block */
@@ -184,6 +186,24 @@ typedef struct header_frm {
    unsigned short software;
 } FRM_HEADER_WSQ;
 
+/* State of the bit reader used when decoding huffman encoded data. */
+typedef struct bitstate_wsq {
+   unsigned char code;   /* next byte of data */
+   unsigned char code2;  /* stuffed byte of data */
+} BITSTATE_WSQ;
+
+/* All state used while decoding a single WSQ image, allowing */
+/* independent images to be decoded concurrently.             */
+typedef struct decode_ctx_wsq {
+   DTT_TABLE dtt_table;
+   DQT_TABLE dqt_table;
+   DHT_TABLE dht_table[MAX_DHT_TABLES];
+   FRM_HEADER_WSQ frm_header_wsq;
+   W_TREE w_tree[W_TREELEN];
+   Q_TREE q_tree[Q_TREELEN];
+   BITSTATE_WSQ bitstate;
+} DECODE_CTX_WSQ;
+
 /* External global variables. */
 extern int biomeval_nbis_debug;
 extern QUANT_VALS biomeval_nbis_quant_vals;
@@ -230,6 +250,22 @@ extern int biomeval_nbis_nextbits_wsq(unsigned short *, unsigned short *, FILE *
                  const int);
 extern int biomeval_nbis_getc_nextbits_wsq(unsigned short *, unsigned short *,
                  unsigned char **, unsigned char *, int *, const int);
+extern int biomeval_nbis_wsq_decode_mem_r(DECODE_CTX_WSQ *, unsigned char **,
+                 int *, int *, int *, int *, int *, unsigned char *, const int);
+extern int biomeval_nbis_wsq_decode_mem_reduced_r(DECODE_CTX_WSQ *,
+                 unsigned char **, int *, int *, int *, int *, int *,
+                 unsigned char *, const int, const int);
+extern int biomeval_nbis_wsq_decode_mem_reduced_buf_r(DECODE_CTX_WSQ *,
+                 unsigned char *, const int, int *, int *, int *, int *,
+                 int *, unsigned char *, const int, const int);
+extern int biomeval_nbis_huffman_decode_data_mem_r(DECODE_CTX_WSQ *, short *,
+                 unsigned char **, unsigned char *);
+extern int biomeval_nbis_decode_data_mem_r(int *, int *, int *, int *,
+                 unsigned char *, unsigned char **, unsigned char *, int *,
+                 unsigned short *, BITSTATE_WSQ *);
+extern int biomeval_nbis_getc_nextbits_wsq_r(unsigned short *, unsigned short *,
+                 unsigned char **, unsigned char *, int *, const int,
+                 BITSTATE_WSQ *);
 
 /* encoder.c */
 extern int biomeval_nbis_wsq_encode_mem(unsigned char **, int *, const float, unsigned char *,
@@ -327,6 +363,9 @@ extern void biomeval_nbis_get_lets(float *, float *, const int, const int, const
                  const int, float *, const int, float *, const int, const int);
 extern int biomeval_nbis_wsq_reconstruct(float *, const int, const int,
                  W_TREE biomeval_nbis_w_tree[], const int, const DTT_TABLE *);
+extern int biomeval_nbis_wsq_reconstruct_reduced(float *, const int,
+                 const int, W_TREE biomeval_nbis_w_tree[], const int,
+                 const DTT_TABLE *, const int, int *, int *);
 extern void  biomeval_nbis_join_lets(float *, float *, const int, const int,
                  const int, const int, float *, const int,
                  float *, const int, const int);
@@ -334,6 +373,8 @@ extern int biomeval_nbis_int_sign(const int);
 extern int biomeval_nbis_image_size(const int, short *, short *);
 extern void biomeval_nbis_init_wsq_decoder_resources(void);
 extern void biomeval_nbis_free_wsq_decoder_resources(void);
+extern void biomeval_nbis_init_wsq_decode_ctx(DECODE_CTX_WSQ *);
+extern void biomeval_nbis_free_wsq_decode_ctx(DECODE_CTX_WSQ *);
 
 extern int biomeval_nbis_delete_comments_wsq(unsigned char **, int *, unsigned char *, int);
 
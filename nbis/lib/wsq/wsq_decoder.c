@@ -58,28 +58,54 @@ of the software.
 #cat: biomeval_nbis_wsq_decode_mem - Decodes a datastream of WSQ compressed bytes
 #cat:                  from a memory buffer, returning a lossy
 #cat:                  reconstructed pixmap.
+#cat: biomeval_nbis_wsq_decode_mem_r - Reentrant version of biomeval_nbis_wsq_decode_mem,
+#cat:                  keeping all decoder state in a caller supplied
+#cat:                  context.
+#cat: biomeval_nbis_wsq_decode_mem_reduced_r - Reentrant decoding of a
+#cat:                  WSQ compressed memory buffer at a reduced
+#cat:                  resolution.
+#cat: biomeval_nbis_wsq_decode_mem_reduced_buf_r - Reentrant decoding of a
+#cat:                  WSQ compressed memory buffer at a reduced
+#cat:                  resolution into a caller supplied pixmap.
 #cat: biomeval_nbis_wsq_decode_file - Decodes a datastream of WSQ compressed bytes
 #cat:                  from an open file, returning a lossy
 #cat:                  reconstructed pixmap.
 #cat: biomeval_nbis_huffman_decode_data_mem - Decodes a block of huffman encoded
 #cat:                  data from a memory buffer.
+#cat: biomeval_nbis_huffman_decode_data_mem_r - Reentrant version of
+#cat:                  biomeval_nbis_huffman_decode_data_mem.
 #cat: biomeval_nbis_huffman_decode_data_file - Decodes a block of huffman encoded
 #cat:                  data from an open file.
 #cat: biomeval_nbis_decode_data_mem - Decodes huffman encoded data from a memory buffer.
 #cat:
+#cat: biomeval_nbis_decode_data_mem_r - Reentrant version of biomeval_nbis_decode_data_mem.
+#cat:
 #cat: biomeval_nbis_decode_data_file - Decodes huffman encoded data from an open file.
 #cat:
 #cat: biomeval_nbis_nextbits_wsq - Gets next sequence of bits for data decoding from
 #cat:                    an open file.
 #cat: biomeval_nbis_getc_nextbits_wsq - Gets next sequence of bits for data decoding
 #cat:                    from a memory buffer.
+#cat: biomeval_nbis_getc_nextbits_wsq_r - Reentrant version of
+#cat:                    biomeval_nbis_getc_nextbits_wsq.
 
 ***********************************************************************/
 
 #include <stdio.h>
+#include <string.h>
 #include <wsq.h>
 #include <dataio.h>
 
+static int biomeval_nbis_huffman_decode_data_mem_int(short *, DTT_TABLE *,
+                 DQT_TABLE *, DHT_TABLE *, const FRM_HEADER_WSQ *, Q_TREE *,
+                 unsigned char **, unsigned char *, BITSTATE_WSQ *);
+static int biomeval_nbis_wsq_decode_mem_reduced_int(DECODE_CTX_WSQ *,
+                 unsigned char **, unsigned char *, const int, int *, int *,
+                 int *, int *, int *, unsigned char *, const int, const int);
+
+/* Bit reader state shared by the non-reentrant memory decoding routines. */
+static BITSTATE_WSQ biomeval_nbis_bitstate_wsq;
+
 /************************************************************************/
 /*              This is an implementation based on the Crinimal         */
 /*              Justice Information Services (CJIS) document            */
@@ -92,61 +118,131 @@ of the software.
 int biomeval_nbis_wsq_decode_mem(unsigned char **odata, int *ow, int *oh, int *od, int *oppi,
                    int *lossyflag, unsigned char *idata, const int ilen)
 {
-   int ret, i;
+   int ret;
+   DECODE_CTX_WSQ ctx;
+
+   ret = biomeval_nbis_wsq_decode_mem_r(&ctx, odata, ow, oh, od, oppi,
+                                        lossyflag, idata, ilen);
+
+   /* Publish the decoder state as the non-reentrant decoder always has. */
+   biomeval_nbis_free_wsq_decoder_resources();
+   biomeval_nbis_dqt_table = ctx.dqt_table;
+   memcpy(biomeval_nbis_dht_table, ctx.dht_table, sizeof(ctx.dht_table));
+   biomeval_nbis_frm_header_wsq = ctx.frm_header_wsq;
+   memcpy(biomeval_nbis_w_tree, ctx.w_tree, sizeof(ctx.w_tree));
+   memcpy(biomeval_nbis_q_tree, ctx.q_tree, sizeof(ctx.q_tree));
+
+   return(ret);
+}
+
+/***************************************************************************/
+/* Reentrant WSQ decoder routine.  Decodes a WSQ compressed memory buffer  */
+/* as biomeval_nbis_wsq_decode_mem does, but keeps all tables, trees, and  */
+/* bit reader state in the supplied context instead of in global storage,  */
+/* so that different images may be decoded concurrently as long as each    */
+/* uses its own context.                                                   */
+/***************************************************************************/
+int biomeval_nbis_wsq_decode_mem_r(DECODE_CTX_WSQ *ctx, unsigned char **odata,
+                   int *ow, int *oh, int *od, int *oppi, int *lossyflag,
+                   unsigned char *idata, const int ilen)
+{
+   return(biomeval_nbis_wsq_decode_mem_reduced_r(ctx, odata, ow, oh, od,
+                   oppi, lossyflag, idata, ilen, 0));
+}
+
+/***************************************************************************/
+/* Reentrant WSQ decoder routine returning the pixmap at 1/(2^level) of    */
+/* its resolution (level in [0, WSQ_MAX_REDUCTION]).  Entropy decoding is  */
+/* unchanged, but only the coarsest levels of the wavelet tree are         */
+/* reconstructed, from the lowpass subband of the requested level.         */
+/***************************************************************************/
+int biomeval_nbis_wsq_decode_mem_reduced_r(DECODE_CTX_WSQ *ctx,
+                   unsigned char **odata, int *ow, int *oh, int *od,
+                   int *oppi, int *lossyflag, unsigned char *idata,
+                   const int ilen, const int level)
+{
+   return(biomeval_nbis_wsq_decode_mem_reduced_int(ctx, odata,
+                   (unsigned char *)NULL, 0, ow, oh, od, oppi, lossyflag,
+                   idata, ilen, level));
+}
+
+/***************************************************************************/
+/* Reentrant WSQ decoder routine as biomeval_nbis_wsq_decode_mem_reduced_r, */
+/* except the reconstructed pixmap is written to the caller supplied       */
+/* buffer obuf of olen bytes instead of to allocated memory.  Returns -22  */
+/* if obuf is smaller than the reduced pixmap.                             */
+/***************************************************************************/
+int biomeval_nbis_wsq_decode_mem_reduced_buf_r(DECODE_CTX_WSQ *ctx,
+                   unsigned char *obuf, const int olen, int *ow, int *oh,
+                   int *od, int *oppi, int *lossyflag, unsigned char *idata,
+                   const int ilen, const int level)
+{
+   return(biomeval_nbis_wsq_decode_mem_reduced_int(ctx,
+                   (unsigned char **)NULL, obuf, olen, ow, oh, od, oppi,
+                   lossyflag, idata, ilen, level));
+}
+
+/***************************************************************************/
+/* Decodes into obuf when it is not NULL, otherwise into memory allocated  */
+/* and returned in odata.                                                  */
+/***************************************************************************/
+static int biomeval_nbis_wsq_decode_mem_reduced_int(DECODE_CTX_WSQ *ctx,
+                   unsigned char **odata, unsigned char *obuf,
+                   const int olen, int *ow, int *oh, int *od,
+                   int *oppi, int *lossyflag, unsigned char *idata,
+                   const int ilen, const int level)
+{
+   int ret;
    unsigned short marker;         /* WSQ marker */
    int num_pix;                   /* image size and counter */
    int width, height, ppi;        /* image parameters */
+   int rwidth, rheight;           /* reduced image parameters */
    unsigned char *cdata;          /* image pointer */
    float *fdata;                  /* image pointers */
    short *qdata;                  /* image pointers */
    unsigned char *cbufptr;        /* points to current byte in buffer */
    unsigned char *ebufptr;        /* points to end of buffer */
 
-   /* Added by MDG on 02-24-05 */
-   biomeval_nbis_init_wsq_decoder_resources();
+   biomeval_nbis_init_wsq_decode_ctx(ctx);
 
    /* Set memory buffer pointers. */
    cbufptr = idata;
    ebufptr = idata + ilen;
 
-   /* Init DHT Tables to 0. */
-   for(i = 0; i < MAX_DHT_TABLES; i++)
-      (biomeval_nbis_dht_table + i)->tabdef = 0;
-
    /* Read the SOI marker. */
    if((ret = biomeval_nbis_getc_marker_wsq(&marker, SOI_WSQ, &cbufptr, ebufptr))){
-      biomeval_nbis_free_wsq_decoder_resources();
+      biomeval_nbis_free_wsq_decode_ctx(ctx);
       return(ret);
    }
 
    /* Read in supporting tables up to the SOF marker. */
    if((ret = biomeval_nbis_getc_marker_wsq(&marker, TBLS_N_SOF, &cbufptr, ebufptr))){
-      biomeval_nbis_free_wsq_decoder_resources();
+      biomeval_nbis_free_wsq_decode_ctx(ctx);
       return(ret);
    }
    while(marker != SOF_WSQ) {
-      if((ret = biomeval_nbis_getc_table_wsq(marker, &biomeval_nbis_dtt_table, &biomeval_nbis_dqt_table, biomeval_nbis_dht_table,
+      if((ret = biomeval_nbis_getc_table_wsq(marker, &ctx->dtt_table, &ctx->dqt_table, ctx->dht_table,
                           &cbufptr, ebufptr))){
-         biomeval_nbis_free_wsq_decoder_resources();
+         biomeval_nbis_free_wsq_decode_ctx(ctx);
          return(ret);
       }
       if((ret = biomeval_nbis_getc_marker_wsq(&marker, TBLS_N_SOF, &cbufptr, ebufptr))){
-         biomeval_nbis_free_wsq_decoder_resources();
+         biomeval_nbis_free_wsq_decode_ctx(ctx);
          return(ret);
       }
    }
 
    /* Read in the Frame Header. */
-   if((ret = biomeval_nbis_getc_frame_header_wsq(&biomeval_nbis_frm_header_wsq, &cbufptr, ebufptr))){
-      biomeval_nbis_free_wsq_decoder_resources();
+   if((ret = biomeval_nbis_getc_frame_header_wsq(&ctx->frm_header_wsq, &cbufptr, ebufptr))){
+      biomeval_nbis_free_wsq_decode_ctx(ctx);
       return(ret);
    }
-   width = biomeval_nbis_frm_header_wsq.width;
-   height = biomeval_nbis_frm_header_wsq.height;
+   width = ctx->frm_header_wsq.width;
+   height = ctx->frm_header_wsq.height;
    num_pix = width * height;
 
    if((ret = biomeval_nbis_getc_ppi_wsq(&ppi, idata, ilen))){
-      biomeval_nbis_free_wsq_decoder_resources();
+      biomeval_nbis_free_wsq_decode_ctx(ctx);
       return(ret);
    }
 
@@ -154,7 +250,8 @@ int biomeval_nbis_wsq_decode_mem(unsigned char **odata, int *ow, int *oh, int *o
       fprintf(stderr, "SOI, tables, and frame header read\n\n");
 
    /* Build WSQ decomposition trees. */
-   biomeval_nbis_build_wsq_trees(biomeval_nbis_w_tree, W_TREELEN, biomeval_nbis_q_tree, Q_TREELEN, width, height);
+   biomeval_nbis_build_wsq_trees(ctx->w_tree, W_TREELEN, ctx->q_tree, Q_TREELEN,
+                  width, height);
 
    if(biomeval_nbis_debug > 0)
       fprintf(stderr, "Tables for wavelet decomposition finished\n\n");
@@ -162,15 +259,15 @@ int biomeval_nbis_wsq_decode_mem(unsigned char **odata, int *ow, int *oh, int *o
    /* Allocate working memory. */
    qdata = (short *) malloc(num_pix * sizeof(short));
    if(qdata == (short *)NULL) {
-      fprintf(stderr,"ERROR: biomeval_nbis_wsq_decode_mem : malloc : qdata1\n");
-      biomeval_nbis_free_wsq_decoder_resources();
+      fprintf(stderr,"ERROR: biomeval_nbis_wsq_decode_mem_reduced_r : malloc : qdata1\n");
+      biomeval_nbis_free_wsq_decode_ctx(ctx);
       return(-20);
    }
    /* Decode the Huffman encoded data blocks. */
-   if((ret = biomeval_nbis_huffman_decode_data_mem(qdata, &biomeval_nbis_dtt_table, &biomeval_nbis_dqt_table, biomeval_nbis_dht_table,
-                                    &cbufptr, ebufptr))){
+   if((ret = biomeval_nbis_huffman_decode_data_mem_r(ctx, qdata, &cbufptr,
+                                                     ebufptr))){
       free(qdata);
-      biomeval_nbis_free_wsq_decoder_resources();
+      biomeval_nbis_free_wsq_decode_ctx(ctx);
       return(ret);
    }
 
@@ -179,10 +276,10 @@ int biomeval_nbis_wsq_decode_mem(unsigned char **odata, int *ow, int *oh, int *o
          "Quantized WSQ subband data blocks read and Huffman decoded\n\n");
 
    /* Decode the quantize wavelet subband data. */
-   if((ret = biomeval_nbis_unquantize(&fdata, &biomeval_nbis_dqt_table, biomeval_nbis_q_tree, Q_TREELEN,
+   if((ret = biomeval_nbis_unquantize(&fdata, &ctx->dqt_table, ctx->q_tree, Q_TREELEN,
                          qdata, width, height))){
       free(qdata);
-      biomeval_nbis_free_wsq_decoder_resources();
+      biomeval_nbis_free_wsq_decode_ctx(ctx);
       return(ret);
    }
 
@@ -192,41 +289,54 @@ int biomeval_nbis_wsq_decode_mem(unsigned char **odata, int *ow, int *oh, int *o
    /* Done with quantized wavelet subband data. */
    free(qdata);
 
-   if((ret = biomeval_nbis_wsq_reconstruct(fdata, width, height, biomeval_nbis_w_tree, W_TREELEN,
-                              &biomeval_nbis_dtt_table))){
+   if((ret = biomeval_nbis_wsq_reconstruct_reduced(fdata, width, height,
+                              ctx->w_tree, W_TREELEN, &ctx->dtt_table, level,
+                              &rwidth, &rheight))){
       free(fdata);
-      biomeval_nbis_free_wsq_decoder_resources();
+      biomeval_nbis_free_wsq_decode_ctx(ctx);
       return(ret);
    }
 
    if(biomeval_nbis_debug > 0)
       fprintf(stderr, "WSQ reconstruction of image finished\n\n");
 
-   cdata = (unsigned char *)malloc(num_pix * sizeof(unsigned char));
-   if(cdata == (unsigned char *)NULL) {
-      free(fdata);
-      biomeval_nbis_free_wsq_decoder_resources();
-      fprintf(stderr,"ERROR: biomeval_nbis_wsq_decode_mem : malloc : cdata\n");
-      return(-21);
+   if(obuf != (unsigned char *)NULL) {
+      if(olen < rwidth * rheight) {
+         free(fdata);
+         biomeval_nbis_free_wsq_decode_ctx(ctx);
+         fprintf(stderr,"ERROR: biomeval_nbis_wsq_decode_mem_reduced_buf_r : "
+                 "buffer of %d bytes < %d\n", olen, rwidth * rheight);
+         return(-22);
+      }
+      cdata = obuf;
+   }
+   else {
+      cdata = (unsigned char *)malloc(rwidth * rheight * sizeof(unsigned char));
+      if(cdata == (unsigned char *)NULL) {
+         free(fdata);
+         biomeval_nbis_free_wsq_decode_ctx(ctx);
+         fprintf(stderr,"ERROR: biomeval_nbis_wsq_decode_mem_reduced_r : malloc : cdata\n");
+         return(-21);
+      }
    }
 
    /* Convert floating point pixels to unsigned char pixels. */
-   biomeval_nbis_conv_img_2_uchar(cdata, fdata, width, height,
-                      biomeval_nbis_frm_header_wsq.m_shift, biomeval_nbis_frm_header_wsq.r_scale);
+   biomeval_nbis_conv_img_2_uchar(cdata, fdata, rwidth, rheight,
+                      ctx->frm_header_wsq.m_shift, ctx->frm_header_wsq.r_scale);
 
    /* Done with floating point pixels. */
    free(fdata);
 
-   /* Added by MDG on 02-24-05 */
-   biomeval_nbis_free_wsq_decoder_resources();
+   biomeval_nbis_free_wsq_decode_ctx(ctx);
 
    if(biomeval_nbis_debug > 0)
       fprintf(stderr, "Doubleing point pixels converted to unsigned char\n\n");
 
    /* Assign reconstructed pixmap and attributes to output pointers. */
-   *odata = cdata;
-   *ow = width;
-   *oh = height;
+   if(odata != (unsigned char **)NULL)
+      *odata = cdata;
+   *ow = rwidth;
+   *oh = rheight;
    *od = 8;
    *oppi = ppi;
    *lossyflag = 1;
@@ -386,6 +496,38 @@ int biomeval_nbis_huffman_decode_data_mem(
    DHT_TABLE *dht_table,    /* huffman table */
    unsigned char **cbufptr, /* points to current byte in input buffer */
    unsigned char *ebufptr)  /* points to end of input buffer */
+{
+   return(biomeval_nbis_huffman_decode_data_mem_int(ip, dtt_table, dqt_table,
+                 dht_table, &biomeval_nbis_frm_header_wsq, biomeval_nbis_q_tree,
+                 cbufptr, ebufptr, &biomeval_nbis_bitstate_wsq));
+}
+
+/***************************************************************************/
+/* Reentrant routine to decode an entire "block" of encoded data from      */
+/* memory buffer, using the tables, trees, and bit reader state held in    */
+/* the decoder context.                                                    */
+/***************************************************************************/
+int biomeval_nbis_huffman_decode_data_mem_r(
+   DECODE_CTX_WSQ *ctx,     /* decoder context */
+   short *ip,               /* image pointer */
+   unsigned char **cbufptr, /* points to current byte in input buffer */
+   unsigned char *ebufptr)  /* points to end of input buffer */
+{
+   return(biomeval_nbis_huffman_decode_data_mem_int(ip, &ctx->dtt_table,
+                 &ctx->dqt_table, ctx->dht_table, &ctx->frm_header_wsq,
+                 ctx->q_tree, cbufptr, ebufptr, &ctx->bitstate));
+}
+
+static int biomeval_nbis_huffman_decode_data_mem_int(
+   short *ip,               /* image pointer */
+   DTT_TABLE *dtt_table,    /*transform table pointer */
+   DQT_TABLE *dqt_table,    /* quantization table */
+   DHT_TABLE *dht_table,    /* huffman table */
+   const FRM_HEADER_WSQ *frm_header_wsq, /* frame header */
+   Q_TREE *q_tree,          /* quantization tree */
+   unsigned char **cbufptr, /* points to current byte in input buffer */
+   unsigned char *ebufptr,  /* points to end of input buffer */
+   BITSTATE_WSQ *bitstate)  /* bit reader state */
 {
    int ret;
    int blk = 0;           /* block number */
@@ -409,7 +551,7 @@ int biomeval_nbis_huffman_decode_data_mem(
    bit_count = 0;
    ipc = 0;
    ipc_q = 0;
-   ipc_mx = biomeval_nbis_frm_header_wsq.width * biomeval_nbis_frm_header_wsq.height;
+   ipc_mx = frm_header_wsq->width * frm_header_wsq->height;
 
    while(marker != EOI_WSQ) {
 
@@ -425,7 +567,7 @@ int biomeval_nbis_huffman_decode_data_mem(
          if(dqt_table->dqt_def && !ipc_q) {
             for(n = 0; n < 64; n++)
                if(dqt_table->q_bin[n] == 0.0)
-                  ipc_mx -= biomeval_nbis_q_tree[n].lenx*biomeval_nbis_q_tree[n].leny;
+                  ipc_mx -= q_tree[n].lenx*q_tree[n].leny;
 
             ipc_q = 1;
          }
@@ -459,9 +601,9 @@ int biomeval_nbis_huffman_decode_data_mem(
       }
 
       /* get next huffman category code from compressed input data stream */
-      if((ret = biomeval_nbis_decode_data_mem(&nodeptr, mincode, maxcode, valptr,
+      if((ret = biomeval_nbis_decode_data_mem_r(&nodeptr, mincode, maxcode, valptr,
                             (dht_table+hufftable_id)->huffvalues,
-                            cbufptr, ebufptr, &bit_count, &marker)))
+                            cbufptr, ebufptr, &bit_count, &marker, bitstate)))
          return(ret);
 
       if(nodeptr == -1) {
@@ -500,36 +642,36 @@ int biomeval_nbis_huffman_decode_data_mem(
          ipc++;
       }
       else if(nodeptr == 101){
-         if((ret = biomeval_nbis_getc_nextbits_wsq(&tbits, &marker, cbufptr, ebufptr,
-                                &bit_count, 8)))
+         if((ret = biomeval_nbis_getc_nextbits_wsq_r(&tbits, &marker, cbufptr, ebufptr,
+                                &bit_count, 8, bitstate)))
             return(ret);
          *ip++ = tbits;
          ipc++;
       }
       else if(nodeptr == 102){
-         if((ret = biomeval_nbis_getc_nextbits_wsq(&tbits, &marker, cbufptr, ebufptr,
-                                &bit_count, 8)))
+         if((ret = biomeval_nbis_getc_nextbits_wsq_r(&tbits, &marker, cbufptr, ebufptr,
+                                &bit_count, 8, bitstate)))
             return(ret);
          *ip++ = -tbits;
          ipc++;
       }
       else if(nodeptr == 103){
-         if((ret = biomeval_nbis_getc_nextbits_wsq(&tbits, &marker, cbufptr, ebufptr,
-                                &bit_count, 16)))
+         if((ret = biomeval_nbis_getc_nextbits_wsq_r(&tbits, &marker, cbufptr, ebufptr,
+                                &bit_count, 16, bitstate)))
             return(ret);
          *ip++ = tbits;
          ipc++;
       }
       else if(nodeptr == 104){
-         if((ret = biomeval_nbis_getc_nextbits_wsq(&tbits, &marker, cbufptr, ebufptr,
-                                &bit_count, 16)))
+         if((ret = biomeval_nbis_getc_nextbits_wsq_r(&tbits, &marker, cbufptr, ebufptr,
+                                &bit_count, 16, bitstate)))
             return(ret);
          *ip++ = -tbits;
          ipc++;
       }
       else if(nodeptr == 105) {
-         if((ret = biomeval_nbis_getc_nextbits_wsq(&tbits, &marker, cbufptr, ebufptr,
-                                &bit_count, 8)))
+         if((ret = biomeval_nbis_getc_nextbits_wsq_r(&tbits, &marker, cbufptr, ebufptr,
+                                &bit_count, 8, bitstate)))
             return(ret);
          ipc += tbits;
          if(ipc > ipc_mx) {
@@ -544,8 +686,8 @@ int biomeval_nbis_huffman_decode_data_mem(
             *ip++ = 0;
       }
       else if(nodeptr == 106) {
-         if((ret = biomeval_nbis_getc_nextbits_wsq(&tbits, &marker, cbufptr, ebufptr,
-                                &bit_count, 16)))
+         if((ret = biomeval_nbis_getc_nextbits_wsq_r(&tbits, &marker, cbufptr, ebufptr,
+                                &bit_count, 16, bitstate)))
             return(ret);
          ipc += tbits;
          if(ipc > ipc_mx) {
@@ -723,13 +865,37 @@ int biomeval_nbis_decode_data_mem(
    unsigned char *ebufptr,      /* points to end of input buffer          */
    int *bit_count,      /* marks the bit to receive from the input byte */
    unsigned short *marker)
+{
+   return(biomeval_nbis_decode_data_mem_r(onodeptr, mincode, maxcode, valptr,
+                 huffvalues, cbufptr, ebufptr, bit_count, marker,
+                 &biomeval_nbis_bitstate_wsq));
+}
+
+/*********************************************************************/
+/* Reentrant routine to decode the encoded data from memory buffer.  */
+/*********************************************************************/
+int biomeval_nbis_decode_data_mem_r(
+   int *onodeptr,       /* returned huffman code category        */
+   int *mincode,        /* points to minimum code value for      */
+                        /*    a given code length                */
+   int *maxcode,        /* points to maximum code value for      */
+                        /*    a given code length                */
+   int *valptr,         /* points to first code in the huffman   */
+                        /*    code table for a given code length */
+   unsigned char *huffvalues,   /* defines order of huffman code          */
+                                /*    lengths in relation to code sizes   */
+   unsigned char **cbufptr,     /* points to current byte in input buffer */
+   unsigned char *ebufptr,      /* points to end of input buffer          */
+   int *bit_count,      /* marks the bit to receive from the input byte */
+   unsigned short *marker,
+   BITSTATE_WSQ *bitstate)      /* bit reader state */
 {
    int ret;
    int inx, inx2;       /*increment variables*/
    unsigned short code, tbits;  /* becomes a huffman code word
                                    (one bit at a time)*/
 
-   if((ret = biomeval_nbis_getc_nextbits_wsq(&code, marker, cbufptr, ebufptr, bit_count, 1)))
+   if((ret = biomeval_nbis_getc_nextbits_wsq_r(&code, marker, cbufptr, ebufptr, bit_count, 1, bitstate)))
       return(ret);
 
    if(*marker != 0){
@@ -738,7 +904,7 @@ int biomeval_nbis_decode_data_mem(
    }
 
    for(inx = 1; (int)code > maxcode[inx]; inx++) {
-      if((ret = biomeval_nbis_getc_nextbits_wsq(&tbits, marker, cbufptr, ebufptr, bit_count, 1)))
+      if((ret = biomeval_nbis_getc_nextbits_wsq_r(&tbits, marker, cbufptr, ebufptr, bit_count, 1, bitstate)))
          return(ret);
 
       code = (code << 1) + tbits;
@@ -866,48 +1032,63 @@ int biomeval_nbis_getc_nextbits_wsq(
    unsigned char *ebufptr,      /* points to end of input buffer */
    int *bit_count,      /* marks the bit to receive from the input byte */
    const int bits_req)  /* number of bits requested */
+{
+   return(biomeval_nbis_getc_nextbits_wsq_r(obits, marker, cbufptr, ebufptr,
+                 bit_count, bits_req, &biomeval_nbis_bitstate_wsq));
+}
+
+/***************************************************************************/
+/* Reentrant routine to get nextbit(s) of data stream from memory buffer.  */
+/* The partially consumed byte is kept in the caller's bit reader state.   */
+/***************************************************************************/
+int biomeval_nbis_getc_nextbits_wsq_r(
+   unsigned short *obits,       /* returned bits */
+   unsigned short *marker,      /* returned marker */
+   unsigned char **cbufptr,     /* points to current byte in input buffer */
+   unsigned char *ebufptr,      /* points to end of input buffer */
+   int *bit_count,      /* marks the bit to receive from the input byte */
+   const int bits_req,  /* number of bits requested */
+   BITSTATE_WSQ *bitstate)      /* bit reader state */
 {
    int ret;
-   static unsigned char code;   /*next byte of data*/
-   static unsigned char code2;  /*stuffed byte of data*/
    unsigned short bits, tbits;  /*bits of current data byte requested*/
    int bits_needed;     /*additional bits required to finish request*/
 
                               /*used to "mask out" n number of
                                 bits from data stream*/
-   static unsigned char bit_mask[9] = {0x00,0x01,0x03,0x07,0x0f,
+   static const unsigned char bit_mask[9] = {0x00,0x01,0x03,0x07,0x0f,
                                        0x1f,0x3f,0x7f,0xff};
    if(*bit_count == 0) {
-      if((ret = biomeval_nbis_getc_byte(&code, cbufptr, ebufptr))){
+      if((ret = biomeval_nbis_getc_byte(&bitstate->code, cbufptr, ebufptr))){
          return(ret);
       }
       *bit_count = 8;
-      if(code == 0xFF) {
-         if((ret = biomeval_nbis_getc_byte(&code2, cbufptr, ebufptr))){
+      if(bitstate->code == 0xFF) {
+         if((ret = biomeval_nbis_getc_byte(&bitstate->code2, cbufptr, ebufptr))){
             return(ret);
          }
-         if(code2 != 0x00 && bits_req == 1) {
-            *marker = (code << 8) | code2;
+         if(bitstate->code2 != 0x00 && bits_req == 1) {
+            *marker = (bitstate->code << 8) | bitstate->code2;
             *obits = 1;
             return(0);
          }
-         if(code2 != 0x00) {
-            fprintf(stderr, "ERROR: biomeval_nbis_getc_nextbits_wsq : No stuffed zeros\n");
+         if(bitstate->code2 != 0x00) {
+            fprintf(stderr, "ERROR: biomeval_nbis_getc_nextbits_wsq_r : No stuffed zeros\n");
             return(-41);
          }
       }
    }
    if(bits_req <= *bit_count) {
-      bits = (code >>(*bit_count - bits_req)) & (bit_mask[bits_req]);
+      bits = (bitstate->code >>(*bit_count - bits_req)) & (bit_mask[bits_req]);
       *bit_count -= bits_req;
-      code &= bit_mask[*bit_count];
+      bitstate->code &= bit_mask[*bit_count];
    }
    else {
       bits_needed = bits_req - *bit_count;
-      bits = code << bits_needed;
+      bits = bitstate->code << bits_needed;
       *bit_count = 0;
-      if((ret = biomeval_nbis_getc_nextbits_wsq(&tbits, (unsigned short *)NULL, cbufptr,
-                             ebufptr, bit_count, bits_needed)))
+      if((ret = biomeval_nbis_getc_nextbits_wsq_r(&tbits, (unsigned short *)NULL, cbufptr,
+                             ebufptr, bit_count, bits_needed, bitstate)))
          return(ret);
       bits |= tbits;
    }
@@ -76,6 +76,9 @@ of the software.
 #cat:
 #cat: biomeval_nbis_wsq_reconstruct - Reconstructs a lossy floating point pixmap from
 #cat:                  a WSQ compressed datastream.
+#cat: biomeval_nbis_wsq_reconstruct_reduced - Reconstructs a lossy floating point
+#cat:                  pixmap at a reduced resolution from a WSQ
+#cat:                  compressed datastream.
 #cat: biomeval_nbis_join_lets - Reconstruct the image from the wavelet subbands.
 #cat:
 #cat: biomeval_nbis_int_sign - Get the sign of the sythesis filter coefficients.
@@ -86,6 +89,10 @@ of the software.
 #cat:                      WSQ decoder
 #cat: biomeval_nbis_free_wsq_decoder_resources - Deallocates memory resources used by the
 #cat:                      WSQ decoder
+#cat: biomeval_nbis_init_wsq_decode_ctx - Initializes a reentrant WSQ decoder
+#cat:                      context
+#cat: biomeval_nbis_free_wsq_decode_ctx - Deallocates memory resources held by a
+#cat:                      reentrant WSQ decoder context
 
 ***********************************************************************/
 
@@ -930,6 +937,102 @@ int biomeval_nbis_wsq_reconstruct(float *fdata, const int width, const int heigh
    return(0);
 }
 
+/************************************************************************/
+/* WSQ reconstructs the image at 1/(2^level) of its resolution, using   */
+/* the lowpass subband of the wavelet tree at that level and skipping   */
+/* the finer levels.  The reduced pixmap is returned at the start of    */
+/* "fdata" with a row length of "owidth" pixels.  NOTE: this            */
+/* routine modifies and returns the results in "fdata".                 */
+/************************************************************************/
+int biomeval_nbis_wsq_reconstruct_reduced(float *fdata, const int width,
+                  const int height, W_TREE w_tree[], const int w_treelen,
+                  const DTT_TABLE *dtt_table, const int level, int *owidth,
+                  int *oheight)
+{
+   /* w_tree node holding the lowpass subband of each level */
+   static const int ll_node[WSQ_MAX_REDUCTION + 1] = {0, 1, 14, 15, 19};
+   int ret, num_pix, node, target, lenx, leny, r, c, i;
+   float *fdata1, *fdata_bse, *fptr, gain, scale;
+
+   if((level < 0) || (level > WSQ_MAX_REDUCTION)) {
+      fprintf(stderr,
+      "ERROR: biomeval_nbis_wsq_reconstruct_reduced : level %d not in [0,%d]\n",
+      level, WSQ_MAX_REDUCTION);
+      return(-98);
+   }
+   if(level == 0) {
+      if((ret = biomeval_nbis_wsq_reconstruct(fdata, width, height, w_tree,
+                                 w_treelen, dtt_table)))
+         return(ret);
+      *owidth = width;
+      *oheight = height;
+      return(0);
+   }
+
+   if(dtt_table->lodef != 1) {
+      fprintf(stderr,
+      "ERROR: biomeval_nbis_wsq_reconstruct_reduced : Lopass filter coefficients not defined\n");
+      return(-95);
+   }
+   if(dtt_table->hidef != 1) {
+      fprintf(stderr,
+      "ERROR: biomeval_nbis_wsq_reconstruct_reduced : Hipass filter coefficients not defined\n");
+      return(-96);
+   }
+
+   target = ll_node[level];
+   lenx = w_tree[target].lenx;
+   leny = w_tree[target].leny;
+
+   /* Subbands are filtered with a row length of "width" pixels. */
+   num_pix = width * leny;
+   /* Allocate temporary floating point pixmap. */
+   if((fdata1 = (float *) malloc(num_pix*sizeof(float))) == NULL) {
+      fprintf(stderr,
+         "ERROR : biomeval_nbis_wsq_reconstruct_reduced : malloc : fdata1\n");
+      return(-97);
+   }
+
+   /* Reconstruct only the subbands within the lowpass subband. */
+   for (node = w_treelen - 1; node >= target; node--) {
+      if((w_tree[node].x + w_tree[node].lenx > lenx) ||
+         (w_tree[node].y + w_tree[node].leny > leny))
+         continue;
+      fdata_bse = fdata + (w_tree[node].y * width) + w_tree[node].x;
+      biomeval_nbis_join_lets(fdata1, fdata_bse, w_tree[node].lenx, w_tree[node].leny,
+                  1, width,
+                  dtt_table->hifilt, dtt_table->hisz,
+                  dtt_table->lofilt, dtt_table->losz,
+                  w_tree[node].inv_cl);
+      biomeval_nbis_join_lets(fdata_bse, fdata1, w_tree[node].leny, w_tree[node].lenx,
+                  width, 1,
+                  dtt_table->hifilt, dtt_table->hisz,
+                  dtt_table->lofilt, dtt_table->losz,
+                  w_tree[node].inv_rw);
+   }
+   free(fdata1);
+
+   /* Undo the DC gain of the lowpass filter, applied twice per level. */
+   gain = 0.0;
+   for(i = 0; i < dtt_table->losz; i++)
+      gain += dtt_table->lofilt[i];
+   scale = 1.0;
+   for(i = 0; i < level; i++)
+      scale /= (gain * gain);
+
+   /* Pack the lowpass subband rows at the start of the pixmap. */
+   fptr = fdata;
+   for(r = 0; r < leny; r++) {
+      fdata_bse = fdata + (r * width);
+      for(c = 0; c < lenx; c++)
+         *fptr++ = fdata_bse[c] * scale;
+   }
+
+   *owidth = lenx;
+   *oheight = leny;
+   return(0);
+}
+
 /****************************************************************/
 void  biomeval_nbis_join_lets(
    float *new,    /* image pointers for creating subband splits */
@@ -1361,6 +1464,33 @@ void biomeval_nbis_free_wsq_decoder_resources()
    }
 }
 
+/*************************************************************/
+/* Initializes a decoder context so that it holds no memory  */
+/* and no Huffman tables are defined.                        */
+/*************************************************************/
+void biomeval_nbis_init_wsq_decode_ctx(DECODE_CTX_WSQ *ctx)
+{
+   memset(ctx, 0, sizeof(DECODE_CTX_WSQ));
+   ctx->dtt_table.lofilt = (float *)NULL;
+   ctx->dtt_table.hifilt = (float *)NULL;
+}
+
+/*************************************************************/
+/* Deallocates memory held by a decoder context.             */
+/*************************************************************/
+void biomeval_nbis_free_wsq_decode_ctx(DECODE_CTX_WSQ *ctx)
+{
+   if(ctx->dtt_table.lofilt != (float *)NULL){
+      free(ctx->dtt_table.lofilt);
+      ctx->dtt_table.lofilt = (float *)NULL;
+   }
+
+   if(ctx->dtt_table.hifilt != (float *)NULL){
+      free(ctx->dtt_table.hifilt);
+      ctx->dtt_table.hifilt = (float *)NULL;
+   }
+}
+
 /************************************************************************
              
 #cat: biomeval_nbis_delete_comments_wsq - Deletes all comments in a WSQ compressed file.
@@ -0,0 +1,334 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IMAGE_BATCHDECODER_H__
+#define __BE_IMAGE_BATCHDECODER_H__
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <be_image.h>
+#include <be_image_image.h>
+#include <be_io_recordstore.h>
+#include <be_memory_autoarray.h>
+
+namespace BiometricEvaluation
+{
+	namespace Image
+	{
+		/**
+		 * @brief
+		 * Decode many images on a pool of threads.
+		 *
+		 * @details
+		 * Encoded images are submitted from one or more threads,
+		 * either as buffers or as keys of a RecordStore.  Worker
+		 * threads open each image with Image::openImage(), decode
+		 * its pixels, and deliver a Result, either through a
+		 * callback or to be retrieved with next().
+		 *
+		 * Workers live as long as the BatchDecoder, so state kept
+		 * per thread by codecs (such as libjpeg decompression
+		 * objects) is reused from image to image.  Records are read
+		 * through a RecordStore::Cursor per worker when the
+		 * RecordStore supports them.
+		 *
+		 * The number of images submitted but not yet delivered is
+		 * bounded: submit() blocks until the oldest Results are
+		 * retrieved.
+		 */
+		class BatchDecoder
+		{
+		public:
+			/** Order in which Results are delivered */
+			enum class Order
+			{
+				/** The order images were submitted */
+				Submission,
+				/** The order images finished decoding */
+				Completion
+			};
+
+			/** Configuration of a BatchDecoder */
+			struct Options
+			{
+				/**
+				 * Number of worker threads.  0 uses the
+				 * number of hardware threads.
+				 */
+				uint32_t threads{0};
+				/** Order in which Results are delivered */
+				Order order{Order::Submission};
+				/**
+				 * Maximum images submitted but not yet
+				 * delivered.  0 is twice the number of
+				 * threads.
+				 */
+				uint32_t queueDepth{0};
+				/**
+				 * Depth passed to
+				 * Image::getRawGrayscaleData(), or 0 to
+				 * decode with Image::getRawData().
+				 */
+				uint8_t grayscaleDepth{0};
+			};
+
+			/** One decoded image */
+			struct Result
+			{
+				/** Order of submission, starting from 0 */
+				uint64_t sequence{0};
+				/** Identifier or RecordStore key submitted */
+				std::string identifier{};
+				/** Opened image, or nullptr on error */
+				std::shared_ptr<Image> image{};
+				/** Decoded pixels */
+				Memory::uint8Array rawData{};
+				/** Exception raised opening or decoding */
+				std::exception_ptr error{};
+			};
+
+			/** Counters for images of one compression algorithm */
+			struct FormatStatistics
+			{
+				/** Images decoded */
+				uint64_t images{0};
+				/** Images that raised an exception */
+				uint64_t failures{0};
+				/** Size of encoded data of decoded images */
+				uint64_t encodedBytes{0};
+				/** Size of pixels of decoded images */
+				uint64_t decodedBytes{0};
+				/** Time spent opening and decoding images */
+				uint64_t microseconds{0};
+			};
+
+			/**
+			 * Counters by compression algorithm.  Data that
+			 * could not be identified is counted as
+			 * CompressionAlgorithm::None.
+			 */
+			using Statistics = std::map<CompressionAlgorithm,
+			    FormatStatistics>;
+
+			/** Function receiving Results */
+			using Callback = std::function<void(Result &result)>;
+
+			/**
+			 * @brief
+			 * Constructor, delivering Results to next().
+			 *
+			 * @param options
+			 * Configuration.
+			 *
+			 * @throw Error::ParameterError
+			 * Invalid options.
+			 */
+			explicit BatchDecoder(
+			    const Options &options);
+
+			/**
+			 * @brief
+			 * Constructor, delivering Results to next(), with
+			 * default Options.
+			 */
+			BatchDecoder();
+
+			/**
+			 * @brief
+			 * Constructor, delivering Results to a callback.
+			 *
+			 * @param callback
+			 * Function receiving each Result.  Calls are
+			 * serialized, but are made from worker threads.
+			 * @param options
+			 * Configuration.
+			 *
+			 * @throw Error::ParameterError
+			 * Invalid options or empty callback.
+			 *
+			 * @note
+			 * Exceptions thrown by callback are discarded.
+			 * callback must not call submit(), which may wait
+			 * for the callback to return.
+			 */
+			BatchDecoder(
+			    const Callback &callback,
+			    const Options &options);
+
+			/**
+			 * @brief
+			 * Constructor, delivering Results to a callback,
+			 * with default Options.
+			 *
+			 * @param callback
+			 * Function receiving each Result.
+			 *
+			 * @throw Error::ParameterError
+			 * Empty callback.
+			 */
+			explicit BatchDecoder(
+			    const Callback &callback);
+
+			/**
+			 * @brief
+			 * Decode an encoded image.
+			 *
+			 * @param data
+			 * Encoded image.
+			 * @param identifier
+			 * Identifier of the image.
+			 *
+			 * @return
+			 * Sequence number of the image's Result.
+			 *
+			 * @throw Error::ObjectExists
+			 * finish() was called.
+			 *
+			 * @note
+			 * Blocks while the queue is full.
+			 */
+			uint64_t
+			submit(
+			    const std::shared_ptr<const Memory::uint8Array>
+			    &data,
+			    const std::string &identifier = "");
+
+			/**
+			 * @brief
+			 * Decode a copy of an encoded image.
+			 *
+			 * @param data
+			 * Encoded image.
+			 * @param identifier
+			 * Identifier of the image.
+			 *
+			 * @return
+			 * Sequence number of the image's Result.
+			 *
+			 * @throw Error::ObjectExists
+			 * finish() was called.
+			 *
+			 * @note
+			 * Blocks while the queue is full.
+			 */
+			uint64_t
+			submit(
+			    const Memory::uint8Array &data,
+			    const std::string &identifier = "");
+
+			/**
+			 * @brief
+			 * Read and decode a record.
+			 *
+			 * @param recordStore
+			 * RecordStore containing key.  It must not be
+			 * modified until the Result is delivered, and is
+			 * retained until the BatchDecoder is destroyed.
+			 * @param key
+			 * Key of an encoded image, which becomes the
+			 * Result's identifier.
+			 *
+			 * @return
+			 * Sequence number of the image's Result.
+			 *
+			 * @throw Error::ObjectExists
+			 * finish() was called.
+			 *
+			 * @note
+			 * Blocks while the queue is full.  Errors reading
+			 * the record are reported in the Result.
+			 */
+			uint64_t
+			submit(
+			    const std::shared_ptr<IO::RecordStore>
+			    &recordStore,
+			    const std::string &key);
+
+			/**
+			 * @brief
+			 * Indicate that no more images will be submitted.
+			 */
+			void
+			finish();
+
+			/**
+			 * @brief
+			 * Obtain the next Result.
+			 *
+			 * @param[out] result
+			 * Next Result.
+			 *
+			 * @return
+			 * true if result was set, false if finish() was
+			 * called and all Results have been delivered.
+			 *
+			 * @throw Error::StrategyError
+			 * Results are delivered to a callback.
+			 *
+			 * @note
+			 * Blocks until a Result is available.
+			 */
+			bool
+			next(
+			    Result &result);
+
+			/**
+			 * @brief
+			 * Wait for all submitted images to be delivered.
+			 *
+			 * @note
+			 * When Results are delivered to next(), another
+			 * thread must be retrieving them.
+			 */
+			void
+			wait();
+
+			/**
+			 * @return
+			 * Number of worker threads.
+			 */
+			uint32_t
+			getThreadCount()
+			    const;
+
+			/**
+			 * @return
+			 * Counters of images decoded so far.
+			 */
+			Statistics
+			getStatistics()
+			    const;
+
+			/**
+			 * @brief
+			 * Destructor.
+			 *
+			 * @details
+			 * Images not yet decoded are discarded, and workers
+			 * are joined.
+			 */
+			~BatchDecoder();
+
+			BatchDecoder(const BatchDecoder&) = delete;
+			BatchDecoder& operator=(const BatchDecoder&) = delete;
+
+		private:
+			class Impl;
+			std::unique_ptr<BatchDecoder::Impl> pimpl;
+		};
+	}
+}
+
+#endif /* __BE_IMAGE_BATCHDECODER_H__ */
@@ -57,11 +57,14 @@ namespace BiometricEvaluation
 			    const statusCallback_t &statusCallback =
 			        Image::defaultStatusCallback);
 
-			~BMP() = default;
+			BMP(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
 
-			Memory::AutoArray<uint8_t>
-			getRawData()
-			    const;
+			~BMP() = default;
 
 			Memory::AutoArray<uint8_t>
 			getRawGrayscaleData(
@@ -84,7 +87,37 @@ namespace BiometricEvaluation
 			isBMP(
 			    const uint8_t *data,
 			    uint64_t size);
+
+			/**
+			 * @brief
+			 * Obtain the attributes of a BMP image from its
+			 * headers.
+			 *
+			 * @param[in] data
+			 *	The buffer to probe.
+			 * @param[in] size
+			 *	The size of data.
+			 *
+			 * @return
+			 *	Attributes of the image, as they would be
+			 *	reported by a BMP constructed from data.
+			 *
+			 * @throw Error::DataError
+			 *	The color table is truncated.
+			 * @throw Error::StrategyError
+			 *	Not a BMP, or the image is not supported by
+			 *	BMP.
+			 *
+			 * @see Image::probe()
+			 */
+			static Attributes
+			probe(
+			    const uint8_t *data,
+			    const uint64_t size);
 		protected:
+			Memory::uint8Array
+			decodeRawData()
+			    const override;
 
 		private:
 			/** Bitmap File Header */
@@ -189,8 +222,10 @@ namespace BiometricEvaluation
 			 *	ColorTable read from the data and mapped into
 			 *	RGBA values.
 			 *
+			 * @throw Error::DataError
+			 *	The color table is truncated.
 			 */
-			void
+			static void
 			getColorTable(
 			    const uint8_t *buf,
 			    uint64_t bufsz,
@@ -224,6 +259,34 @@ namespace BiometricEvaluation
 			    BMPHeader *bmpHeader,
 			    BITMAPINFOHEADER *dibHeader) const;
 
+			/**
+			 * @brief
+			 * Parse the BMP and DIB headers and the color table.
+			 * @details
+			 * Shared by the constructor and probe().
+			 *
+			 * @param[in] data
+			 *	BMP data.
+			 * @param[in] size
+			 *	Size of data.
+			 * @param[out] colorTable
+			 *	The color table, empty when bits-per-pixel
+			 *	is more than 8.
+			 *
+			 * @return
+			 *	Attributes described by the headers.
+			 *
+			 * @throw Error::StrategyError
+			 *	Not a supported BMP.
+			 * @throw Error::DataError
+			 *	The color table is truncated.
+			 */
+			static Attributes
+			parseHeaders(
+			    const uint8_t *data,
+			    const uint64_t size,
+			    ColorTable &colorTable);
+
 			ColorTable _colorTable{};
 		};
 
@@ -0,0 +1,231 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IMAGE_DECODECACHE_H__
+#define __BE_IMAGE_DECODECACHE_H__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <be_memory_autoarray.h>
+
+namespace BiometricEvaluation
+{
+	namespace Image
+	{
+		/* Forward declaration */
+		class Image;
+
+		/**
+		 * @brief
+		 * Process-wide, memory-bounded cache of decoded pixels.
+		 *
+		 * @details
+		 * When the capacity is non-zero, the decoded pixels returned
+		 * from Image::getRawData() and
+		 * Image::getRawGrayscaleData() are kept in a least recently
+		 * used cache, so that other Image objects encapsulating the
+		 * same data need not decode it again.  Entries are keyed by
+		 * either the encoded data or by the Image's identifier, and
+		 * by the representation of the pixels (native, alpha channel
+		 * removed, or grayscale depth).  Entries keyed by encoded
+		 * data share it with the Image (or copy it, if borrowed),
+		 * and its size counts toward the capacity.
+		 *
+		 * The cache is disabled (capacity 0) by default.  All
+		 * methods are safe to call from multiple threads.
+		 *
+		 * @see Image::setRetainDecodedData()
+		 */
+		class DecodeCache
+		{
+		public:
+			/** What identifies the pixels of an Image */
+			enum class KeyType
+			{
+				/** Hash and size of the encoded data */
+				Content,
+				/**
+				 * Image::getIdentifier(), or Content for
+				 * Images without an identifier.
+				 */
+				Identifier
+			};
+
+			/** Counters describing use of the cache */
+			struct Statistics
+			{
+				/** Decodes avoided by the cache */
+				uint64_t hits{0};
+				/** Decodes avoided by an Image's own pixels */
+				uint64_t retainedHits{0};
+				/** Decodes performed while caching */
+				uint64_t misses{0};
+				/** Entries discarded to stay within capacity */
+				uint64_t evictions{0};
+				/** Entries in the cache */
+				uint64_t entries{0};
+				/** Bytes of pixels, and data keying them, in the cache */
+				uint64_t bytes{0};
+				/** Maximum bytes of decoded pixels */
+				uint64_t capacity{0};
+			};
+
+			/**
+			 * @brief
+			 * Set the maximum size of decoded pixels held.
+			 *
+			 * @param bytes
+			 * Maximum size, in bytes, of all cached pixels.
+			 * 0 disables the cache.
+			 *
+			 * @note
+			 * Least recently used entries are evicted when the
+			 * capacity is reduced.
+			 */
+			static void
+			setCapacity(
+			    uint64_t bytes);
+
+			/**
+			 * @return
+			 * Maximum size, in bytes, of all cached pixels.
+			 */
+			static uint64_t
+			getCapacity();
+
+			/**
+			 * @brief
+			 * Set what identifies the pixels of an Image.
+			 *
+			 * @param keyType
+			 * What identifies the pixels of an Image.
+			 *
+			 * @note
+			 * Identifier keys avoid hashing, comparing, and
+			 * holding the encoded data, but must uniquely
+			 * identify the data.  The cache is cleared when the
+			 * key type changes.
+			 */
+			static void
+			setKeyType(
+			    KeyType keyType);
+
+			/**
+			 * @return
+			 * What identifies the pixels of an Image.
+			 */
+			static KeyType
+			getKeyType();
+
+			/**
+			 * @return
+			 * Current counters.
+			 */
+			static Statistics
+			getStatistics();
+
+			/**
+			 * @brief
+			 * Zero the hit, miss, and eviction counters.
+			 */
+			static void
+			resetStatistics();
+
+			/**
+			 * @brief
+			 * Discard all cached pixels.
+			 */
+			static void
+			clear();
+
+		private:
+			friend class Image;
+
+			/** Form of cached pixels */
+			enum class Representation : uint8_t
+			{
+				Raw,
+				RawWithoutAlpha,
+				Grayscale1,
+				Grayscale8,
+				Grayscale16
+			};
+
+			/** Identity of cached pixels */
+			struct Key
+			{
+				/** Image identifier, when KeyType::Identifier */
+				std::string identifier{};
+				/** Hash of encoded data, when not identifier */
+				uint64_t hash{0};
+				/**
+				 * Encoded data, when not identifier, compared
+				 * so that a hash collision is not a match.
+				 */
+				std::shared_ptr<const uint8_t> data{};
+				/** Size of encoded data */
+				uint64_t size{0};
+				/** Form of pixels */
+				Representation representation{
+				    Representation::Raw};
+
+				bool
+				operator==(
+				    const Key &rhs)
+				    const;
+			};
+
+			/** Decoded pixels, shared with Images retaining them */
+			using Pixels = std::shared_ptr<const Memory::uint8Array>;
+
+			/**
+			 * @brief
+			 * Obtain cached pixels.
+			 *
+			 * @param key
+			 * Identity of the pixels.
+			 *
+			 * @return
+			 * Cached pixels, or nullptr if not cached.
+			 */
+			static Pixels
+			find(
+			    const Key &key);
+
+			/**
+			 * @brief
+			 * Cache decoded pixels.
+			 *
+			 * @param key
+			 * Identity of the pixels.
+			 * @param pixels
+			 * Decoded pixels.
+			 */
+			static void
+			insert(
+			    const Key &key,
+			    const Pixels &pixels);
+
+			/** Count a decode avoided by an Image's own pixels */
+			static void
+			countRetainedHit();
+
+			/** Count a decode performed while caching */
+			static void
+			countMiss();
+
+			class Impl;
+		};
+	}
+}
+
+#endif /* __BE_IMAGE_DECODECACHE_H__ */
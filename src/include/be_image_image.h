@@ -19,6 +19,7 @@
 #include <be_framework_status.h>
 #include <be_io.h>
 #include <be_image.h>
+#include <be_image_decodecache.h>
 #include <be_memory_autoarray.h>
 
 namespace BiometricEvaluation
@@ -125,6 +126,99 @@ namespace BiometricEvaluation
 			    const statusCallback_t &statusCallback =
 			        Image::defaultStatusCallback);
 
+			/**
+		 	 * @brief
+			 * Parent constructor for all Image classes, over
+			 * shared or borrowed image data.
+			 *
+			 * @param[in] data
+			 *	The image data, from shareData() or
+			 *	borrowData().  It is not copied.
+			 * @param[in] size
+			 *	The size of the image data, in bytes.
+			 * @param[in] dimensions
+			 *	The width and height of the image in pixels.
+			 * @param[in] colorDepth
+			 *	The image color depth, in bits-per-pixel.
+			 * @param[in] bitDepth
+			 *	The number of bits per color component.
+			 * @param[in] resolution
+			 *	The resolution of the image
+			 * @param[in] compression
+			 *	The CompressionAlgorithm of data.
+			 * @param[in] hasAlphaChannel
+			 *	Presence of an alpha channel.
+			 * @param identifier
+			 * Identifier for the encapsulated data.
+			 * @param statusCallback
+			 * Function to handle statuses sent when processing
+			 * images.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error while creating Image.
+			 */
+			Image(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const Size dimensions,
+			    const uint32_t colorDepth,
+			    const uint16_t bitDepth,
+			    const Resolution resolution,
+			    const CompressionAlgorithm compression,
+			    const bool hasAlphaChannel,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
+
+			/**
+		 	 * @brief
+			 * Parent constructor for all Image classes, over
+			 * shared or borrowed image data.
+			 *
+			 * @param[in] data
+			 *	The image data, from shareData() or
+			 *	borrowData().  It is not copied.
+			 * @param[in] size
+			 *	The size of the image data, in bytes.
+			 * @param[in] compression
+			 *	The CompressionAlgorithm of data.
+			 * @param identifier
+			 * Identifier for the encapsulated data.
+			 * @param statusCallback
+			 * Function to handle statuses sent when processing
+			 * images.
+			 *
+			 * @throw Error::DataError
+			 *	Error manipulating data.
+			 * @throw Error::StrategyError
+			 *	Error while creating Image.
+			 */
+			Image(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const CompressionAlgorithm compression,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
+
+			/** Attributes of an image described by its headers */
+			struct Attributes
+			{
+				/** Compression algorithm of the data */
+				CompressionAlgorithm compressionAlgorithm{
+				    CompressionAlgorithm::None};
+				/** Width and height in pixels */
+				Size dimensions{};
+				/** Number of bits per pixel */
+				uint32_t colorDepth{0};
+				/** Number of bits per color component */
+				uint16_t bitDepth{0};
+				/** Resolution */
+				Resolution resolution{};
+				/** Presence of an alpha channel */
+				bool hasAlphaChannel{false};
+			};
+
 			/**
 			 * @brief
 			 * Accessor for the CompressionAlgorithm of the image.
@@ -176,10 +270,15 @@ namespace BiometricEvaluation
 			 *
 			 * @throw Error::DataError
 			 *	Error decompressing image data.
+			 *
+			 * @note
+			 * Data is decoded with decodeRawData(), unless it
+			 * was retained by this object or is held in the
+			 * DecodeCache.
 			 */
 			virtual Memory::uint8Array
 			getRawData()
-			    const = 0;
+			    const;
 
 			/**
 		 	 * @brief
@@ -212,6 +311,97 @@ namespace BiometricEvaluation
 			    const bool removeAlphaChannelIfPresent)
 			    const;
 
+			/**
+			 * @brief
+			 * Accessor for the raw image data, reusing a
+			 * buffer.
+			 *
+			 * @param[in,out] rawData
+			 * Buffer to hold the data returned from getRawData().
+			 * It is resized to fit, and its memory is reused
+			 * when large enough, so that one buffer may be
+			 * recycled across many images.
+			 *
+			 * @throw Error::DataError
+			 * Error decompressing image data.
+			 *
+			 * @note
+			 * Codecs able to do so decode straight into
+			 * rawData.  Otherwise, or when decoded data was
+			 * retained or is held in the DecodeCache, it is
+			 * copied into rawData.
+			 */
+			virtual void
+			getRawData(
+			    Memory::uint8Array &rawData)
+			    const;
+
+			/**
+			 * @brief
+			 * Accessor for raw image data of a region, at reduced
+			 * resolution.
+			 *
+			 * @param[in] reduction
+			 * Number of times to halve the resolution of the
+			 * image.  0 is full resolution, 1 is 1/2 scale,
+			 * 2 is 1/4 scale, and so on.
+			 * @param[in] roi
+			 * Region of the full-resolution image to decode.
+			 * An ROI with no size is the entire image.  The path
+			 * of the ROI is ignored.
+			 *
+			 * @return
+			 * AutoArray holding raw image data of
+			 * getReducedDimensions(reduction, roi) pixels, in the
+			 * format returned from getRawData().
+			 *
+			 * @throw Error::DataError
+			 * Error decompressing image data.
+			 * @throw Error::ParameterError
+			 * roi is not within the image, or reduction is too
+			 * large.
+			 *
+			 * @note
+			 * A reduced pixel covers a square of 2^reduction
+			 * full-resolution pixels.  Codecs that can decode
+			 * at reduced resolution or decode a region do so;
+			 * others decode the entire image and average each
+			 * square (or sample it, for components of more than
+			 * 8 bits).  Reduced pixels therefore differ slightly
+			 * between codecs.
+			 */
+			virtual Memory::uint8Array
+			getRawData(
+			    const uint8_t reduction,
+			    const ROI &roi)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain the dimensions of raw image data of a region
+			 * at reduced resolution.
+			 *
+			 * @param[in] reduction
+			 * Number of times to halve the resolution of the
+			 * image.
+			 * @param[in] roi
+			 * Region of the full-resolution image.  An ROI with
+			 * no size is the entire image.
+			 *
+			 * @return
+			 * Dimensions of the data returned from
+			 * getRawData(reduction, roi).
+			 *
+			 * @throw Error::ParameterError
+			 * roi is not within the image, or reduction is too
+			 * large.
+			 */
+			Size
+			getReducedDimensions(
+			    const uint8_t reduction,
+			    const ROI &roi)
+			    const;
+
 			/**
 			 * @brief
 			 * Accessor for decompressed data in grayscale.
@@ -231,9 +421,9 @@ namespace BiometricEvaluation
 			 *	Invalid value for depth.
 			 *
 			 * @note
-			 *	This method does not save a cached copy of the
-			 *	decompressed image because the bit depth of the
-			 *	image can be changed between calls.
+			 * Data is converted with decodeRawGrayscaleData(),
+			 * unless the conversion to depth was retained by this
+			 * object or is held in the DecodeCache.
 			 *
 			 * @note
 			 * When depth is 1, this method returns an image that
@@ -249,7 +439,208 @@ namespace BiometricEvaluation
 			virtual Memory::uint8Array
 			getRawGrayscaleData(
 			    uint8_t depth)
-			    const = 0;
+			    const;
+
+			/**
+			 * @brief
+			 * Sequential decoder of bands of rows of an image.
+			 * @details
+			 * Each call to read() decodes the next band of rows
+			 * of a region, from top to bottom, into a buffer
+			 * supplied by the caller, in the format returned
+			 * from getRawData().  Codecs that can decode part
+			 * of an image at a time (such as TIFF strips and
+			 * tiles, and non-interlaced PNG rows) hold only a
+			 * band, so that the memory used does not grow with
+			 * the size of the image.  Other codecs decode the
+			 * region when the BandReader is created.
+			 *
+			 * A BandReader must not outlive the Image that
+			 * created it.
+			 */
+			class BandReader
+			{
+			public:
+				/**
+				 * @brief
+				 * Decode the next band of rows.
+				 *
+				 * @param[in,out] band
+				 * Buffer receiving the rows, one after the
+				 * other, getRowSize() bytes apart.  It is
+				 * resized to getBandSize() when smaller, so
+				 * one buffer may be reused for every band.
+				 *
+				 * @return
+				 * Number of rows decoded, at most
+				 * getMaximumBandRows(), or 0 once every row
+				 * of the region has been read.
+				 *
+				 * @throw Error::DataError
+				 * Error decompressing image data.
+				 */
+				uint32_t
+				read(
+				    Memory::uint8Array &band);
+
+				/**
+				 * @brief
+				 * Decode the next band of rows, converted
+				 * to grayscale.
+				 *
+				 * @param[in,out] band
+				 * Buffer receiving the rows, as they would
+				 * appear in getRawGrayscaleData(depth).  It
+				 * is resized when smaller than needed.
+				 * @param[in] depth
+				 * Bit depth of the grayscale rows: 16, 8,
+				 * or 1.
+				 *
+				 * @return
+				 * Number of rows decoded, or 0 once every
+				 * row of the region has been read.
+				 *
+				 * @throw Error::DataError
+				 * Error decompressing image data.
+				 * @throw Error::NotImplemented
+				 * Unsupported conversion based on source
+				 * color depth.
+				 * @throw Error::ParameterError
+				 * Invalid value for depth.
+				 */
+				uint32_t
+				readGrayscale(
+				    Memory::uint8Array &band,
+				    uint8_t depth);
+
+				/**
+				 * @return
+				 * Region of the image decoded.
+				 */
+				ROI
+				getRegion()
+				    const;
+
+				/**
+				 * @return
+				 * Row of the image that begins the next
+				 * band.
+				 */
+				uint32_t
+				getNextRow()
+				    const;
+
+				/**
+				 * @return
+				 * Size of one row of the region, in bytes.
+				 */
+				uint64_t
+				getRowSize()
+				    const;
+
+				/**
+				 * @return
+				 * Largest number of rows in one band.
+				 */
+				uint32_t
+				getMaximumBandRows()
+				    const;
+
+				/**
+				 * @return
+				 * Size of the largest band, in bytes.
+				 */
+				uint64_t
+				getBandSize()
+				    const;
+
+				virtual ~BandReader() = default;
+
+			protected:
+				/**
+				 * @brief
+				 * Constructor.
+				 *
+				 * @param[in] image
+				 * Image decoded.
+				 * @param[in] region
+				 * Region of image to decode, which must be
+				 * within image.
+				 * @param[in] maximumBandRows
+				 * Largest number of rows decodeBand()
+				 * decodes at once.
+				 */
+				BandReader(
+				    const Image &image,
+				    const ROI &region,
+				    const uint32_t maximumBandRows);
+
+				/**
+				 * @brief
+				 * Decode a band of rows.
+				 *
+				 * @param[out] band
+				 * Buffer of getBandSize() bytes receiving
+				 * the rows.
+				 * @param[in] row
+				 * Row of the image beginning the band,
+				 * which is the row following the previous
+				 * band.
+				 *
+				 * @return
+				 * Number of rows decoded, from 1 to
+				 * getMaximumBandRows(), and not past the
+				 * bottom of the region.
+				 *
+				 * @throw Error::DataError
+				 * Error decompressing image data.
+				 */
+				virtual uint32_t
+				decodeBand(
+				    uint8_t *band,
+				    const uint32_t row) = 0;
+
+			private:
+				/** Region decoded */
+				ROI _region;
+				/** Largest number of rows in one band */
+				uint32_t _maximumBandRows;
+				/** Size of one row of the region */
+				uint64_t _rowSize;
+				/** Color depth of the image */
+				uint32_t _colorDepth;
+				/** Row of the image beginning the next band */
+				uint32_t _nextRow;
+				/** Band read before grayscale conversion */
+				Memory::uint8Array _colorBand{};
+			};
+
+			/**
+			 * @brief
+			 * Obtain a new BandReader over a region of the image.
+			 *
+			 * @param[in] roi
+			 * Region of the image to decode.  An ROI with no size
+			 * is the entire image.  The path of the ROI is
+			 * ignored.
+			 *
+			 * @return
+			 * A BandReader positioned at the top of roi, which
+			 * must not outlive this object.
+			 *
+			 * @throw Error::DataError
+			 * Error decompressing image data.
+			 * @throw Error::ParameterError
+			 * roi is not within the image.
+			 *
+			 * @note
+			 * The default implementation decodes roi with
+			 * getRawData(0, roi) and copies bands out of it.
+			 */
+			virtual std::unique_ptr<BandReader>
+			makeBandReader(
+			    const ROI &roi = ROI())
+			    const;
 
 			/**
 		 	 * @brief
@@ -321,6 +712,39 @@ namespace BiometricEvaluation
 			getIdentifier()
 			    const;
 
+			/**
+			 * @brief
+			 * Keep decoded data with this object.
+			 *
+			 * @param retain
+			 * Whether the data returned from getRawData() and
+			 * getRawGrayscaleData() is decoded only once and
+			 * kept until this object is destroyed or
+			 * releaseDecodedData() is called.
+			 *
+			 * @note
+			 * Copies of this object share retained data.
+			 */
+			void
+			setRetainDecodedData(
+			    bool retain);
+
+			/**
+			 * @return
+			 * Whether decoded data is kept with this object.
+			 */
+			bool
+			getRetainDecodedData()
+			    const;
+
+			/**
+			 * @brief
+			 * Discard decoded data kept with this object.
+			 */
+			void
+			releaseDecodedData()
+			    const;
+
 			virtual ~Image();
 
 			/*
@@ -411,6 +835,68 @@ namespace BiometricEvaluation
 			    const statusCallback_t &statusCallback =
 			        Image::defaultStatusCallback);
 
+			/**
+			 * @brief
+			 * Determine the image type of a buffer of shared or
+			 * borrowed image data and create an Image object.
+			 *
+ 			 * @param[in] data
+			 *	The image data, from shareData() or
+			 *	borrowData().  It is not copied.
+			 * @param[in] size
+			 *	The size of the image data, in bytes.
+			 * @param identifier
+			 * Identifier for the encapsulated data.
+			 * @param statusCallback
+			 * Function to handle statuses sent when processing
+			 * images.
+			 *
+			 * @return
+			 *	Image representation of the input data buffer.
+			 *
+			 * @throw Error::DataError
+			 *	Error manipulating data.
+			 * @throw Error::StrategyError
+			 *	Error while creating Image.
+			 */
+			static std::shared_ptr<Image>
+			openImage(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
+
+			/**
+			 * @brief
+			 * Determine the image type of a buffer of shared
+			 * image data and create an Image object.
+			 *
+ 			 * @param[in] data
+			 *	The image data, which must not be modified
+			 *	while shared.  It is not copied.
+			 * @param identifier
+			 * Identifier for the encapsulated data.
+			 * @param statusCallback
+			 * Function to handle statuses sent when processing
+			 * images.
+			 *
+			 * @return
+			 *	Image representation of the input data buffer.
+			 *
+			 * @throw Error::DataError
+			 *	Error manipulating data.
+			 * @throw Error::StrategyError
+			 *	Error while creating Image.
+			 */
+			static std::shared_ptr<Image>
+			openImage(
+			    const std::shared_ptr<const Memory::uint8Array>
+			    &data,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
+
 			/**
 			 * @brief
 			 * Determine the image type of an image file and create
@@ -506,6 +992,99 @@ namespace BiometricEvaluation
 			getCompressionAlgorithm(
 			    const std::string &path);
 
+			/**
+			 * @brief
+			 * Obtain the attributes of image data from its
+			 * headers.
+			 *
+  			 * @param[in] data
+			 *	The image data.
+			 * @param[in] size
+			 *	The size of the image data, in bytes.
+			 *
+			 * @return
+			 *	Attributes of the image, as they would be
+			 *	reported by the Image returned from
+			 *	openImage().
+			 *
+			 * @throw Error::DataError
+			 *	Headers are malformed or truncated.
+			 * @throw Error::NotImplemented
+			 *	The image would not be supported by
+			 *	openImage().
+			 * @throw Error::StrategyError
+			 *	Could not determine compression algorithm.
+			 *
+			 * @note
+			 * Only the headers are parsed.  The data is neither
+			 * copied nor decoded.
+			 */
+			static Attributes
+			probe(
+			    const uint8_t *data,
+			    const uint64_t size);
+
+			/**
+			 * @brief
+			 * Obtain the attributes of image data from its
+			 * headers.
+			 *
+  			 * @param[in] data
+			 *	The image data.
+			 *
+			 * @return
+			 *	Attributes of the image, as they would be
+			 *	reported by the Image returned from
+			 *	openImage().
+			 *
+			 * @throw Error::DataError
+			 *	Headers are malformed or truncated.
+			 * @throw Error::NotImplemented
+			 *	The image would not be supported by
+			 *	openImage().
+			 * @throw Error::StrategyError
+			 *	Could not determine compression algorithm.
+			 */
+			static Attributes
+			probe(
+			    const Memory::uint8Array &data);
+
+			/**
+			 * @brief
+			 * Share ownership of image data with Images.
+			 *
+			 * @param[in] data
+			 *	Image data, which must not be modified while
+			 *	shared.
+			 *
+			 * @return
+			 *	Pointer to the contents of data, keeping data
+			 *	alive, for constructing Images without
+			 *	copying data.
+			 */
+			static std::shared_ptr<const uint8_t>
+			shareData(
+			    const std::shared_ptr<const Memory::uint8Array>
+			    &data);
+
+			/**
+			 * @brief
+			 * Lend image data to Images.
+			 *
+			 * @param[in] data
+			 *	Image data, which must remain valid and
+			 *	unmodified for as long as any Image
+			 *	constructed from the return value (or a copy
+			 *	of one) exists.
+			 *
+			 * @return
+			 *	Non-owning pointer to data, for constructing
+			 *	Images without copying data.
+			 */
+			static std::shared_ptr<const uint8_t>
+			borrowData(
+			    const uint8_t *data);
+
 			/**
 			 * @brief
 			 * Obtain Image::Raw version of an Image::Image.
@@ -546,6 +1125,144 @@ namespace BiometricEvaluation
 			    const Framework::Status &status);
 
 		protected:
+			/**
+			 * @brief
+			 * Decode the image data.
+			 *
+			 * @return
+			 * Raw image data, as described by getRawData().
+			 *
+			 * @throw Error::DataError
+			 * Error decompressing image data.
+			 * @throw Error::NotImplemented
+			 * Decoding is not implemented by this class.
+			 *
+			 * @note
+			 * Called from getRawData() when the data is not
+			 * already decoded.
+			 */
+			virtual Memory::uint8Array
+			decodeRawData()
+			    const;
+
+			/**
+			 * @brief
+			 * Decode the image data into a buffer.
+			 *
+			 * @param[out] rawData
+			 * Buffer to hold raw image data, as described by
+			 * getRawData().  Its memory may be reused.
+			 *
+			 * @throw Error::DataError
+			 * Error decompressing image data.
+			 * @throw Error::NotImplemented
+			 * Decoding is not implemented by this class.
+			 *
+			 * @note
+			 * Called from getRawData(rawData) when the data is
+			 * not already decoded.  The default implementation
+			 * moves the data returned from decodeRawData().
+			 */
+			virtual void
+			decodeRawDataInto(
+			    Memory::uint8Array &rawData)
+			    const;
+
+			/**
+			 * @brief
+			 * Resize a buffer, discarding its contents.
+			 *
+			 * @param[in,out] buffer
+			 * Buffer to resize.  Its memory is kept if at least
+			 * size bytes were allocated.
+			 * @param[in] size
+			 * New size of buffer.
+			 */
+			static void
+			resizeBuffer(
+			    Memory::uint8Array &buffer,
+			    const uint64_t size);
+
+			/**
+			 * @brief
+			 * Decode the image data in grayscale.
+			 *
+			 * @param depth
+			 * The desired bit depth of the resulting raw image,
+			 * already validated by getRawGrayscaleData().
+			 *
+			 * @return
+			 * Raw grayscale image data, as described by
+			 * getRawGrayscaleData().
+			 *
+			 * @throw Error::DataError
+			 * Error decompressing image data.
+			 * @throw Error::NotImplemented
+			 * Unsupported conversion based on source color depth.
+			 * @throw Error::ParameterError
+			 * depth is not supported by this class.
+			 *
+			 * @note
+			 * The default implementation converts the data
+			 * returned from getRawData().
+			 */
+			virtual Memory::uint8Array
+			decodeRawGrayscaleData(
+			    uint8_t depth)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain a region in reduced-resolution coordinates.
+			 *
+			 * @param[in] reduction
+			 * Number of times to halve the resolution of the
+			 * image.
+			 * @param[in] roi
+			 * Region of the full-resolution image.  An ROI with
+			 * no size is the entire image.
+			 *
+			 * @return
+			 * The smallest region of the reduced-resolution image
+			 * covering roi.
+			 *
+			 * @throw Error::ParameterError
+			 * roi is not within the image, or reduction is too
+			 * large.
+			 */
+			ROI
+			getReducedROI(
+			    const uint8_t reduction,
+			    const ROI &roi)
+			    const;
+
+			/**
+			 * @brief
+			 * Crop raw data of the entire image at reduced
+			 * resolution to a region.
+			 *
+			 * @param[in] rawData
+			 * Raw data of getReducedDimensions(reduction, ROI())
+			 * pixels.
+			 * @param[in] reduction
+			 * Number of times the resolution was halved.
+			 * @param[in] roi
+			 * Region of the full-resolution image.
+			 *
+			 * @return
+			 * rawData cropped to getReducedROI(reduction, roi).
+			 *
+			 * @throw Error::ParameterError
+			 * roi is not within the image, or reduction is too
+			 * large.
+			 */
+			Memory::uint8Array
+			cropReducedRawData(
+			    const Memory::uint8Array &rawData,
+			    const uint8_t reduction,
+			    const ROI &roi)
+			    const;
+
 			/**
 		 	 * @brief
 			 * Mutator for the resolution of the image .
@@ -591,6 +1308,23 @@ namespace BiometricEvaluation
 			setBitDepth(
 			    const uint16_t bitDepth);
 
+			/**
+			 * @brief
+			 * Copy image data.
+			 *
+			 * @param[in] data
+			 *	The image data.
+			 * @param[in] size
+			 *	The size of the image data, in bytes.
+			 *
+			 * @return
+			 *	Pointer to a copy of data.
+			 */
+			static std::shared_ptr<const uint8_t>
+			copyData(
+			    const uint8_t *data,
+			    const uint64_t size);
+
 			/** @return Const pointer to buffer underlying _data. */
 			const uint8_t *
 			getDataPointer()
@@ -615,6 +1349,20 @@ namespace BiometricEvaluation
 				this->_hasAlphaChannel = hasAlphaChannel;
 			}
 
+			/**
+			 * @brief
+			 * Mutator for all attributes described by headers.
+			 *
+			 * @param[in] attributes
+			 * Attributes obtained from probe().
+			 *
+			 * @note
+			 * The compression algorithm is not changed.
+			 */
+			void
+			setAttributes(
+			    const Attributes &attributes);
+
 		private:
 			/** Image dimensions (width and height) in pixels */
 			Size _dimensions;
@@ -631,8 +1379,11 @@ namespace BiometricEvaluation
 			/** Resolution */
 			Resolution _resolution;
 
-			/** Encoded image data */
-			Memory::AutoArray<uint8_t> _data;
+			/** Encoded image data, owned, shared, or borrowed */
+			std::shared_ptr<const uint8_t> _data;
+
+			/** Size of _data, in bytes */
+			uint64_t _dataSize;
 
 			/** Compression algorithm of _data */
 			CompressionAlgorithm _compressionAlgorithm;
@@ -643,6 +1394,29 @@ namespace BiometricEvaluation
 			/** Status callback */
 			statusCallback_t _statusCallback{
 			    Image::defaultStatusCallback};
+
+			/** Decoded data kept with this object */
+			struct DecodedData;
+			std::shared_ptr<DecodedData> _decodedData;
+
+			/**
+			 * @brief
+			 * Obtain decoded data, decoding only if it was not
+			 * retained or cached.
+			 *
+			 * @param representation
+			 * Form of the decoded data.
+			 * @param decode
+			 * Function that decodes the data.
+			 *
+			 * @return
+			 * Decoded data.
+			 */
+			Memory::uint8Array
+			getDecodedData(
+			    DecodeCache::Representation representation,
+			    const std::function<Memory::uint8Array()> &decode)
+			    const;
 		};
 	}
 }
@@ -48,6 +48,9 @@ namespace BiometricEvaluation
 {
 	namespace Image
 	{
+		/* Forward declaration */
+		class Raw;
+
 		/**
 		 * @brief
 		 * A JPEG-encoded image.
@@ -68,15 +71,26 @@ namespace BiometricEvaluation
 			    const statusCallback_t &statusCallback =
 			        Image::defaultStatusCallback);
 
+			JPEG(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
+
 			~JPEG() = default;
 
-			Memory::uint8Array
-			getRawGrayscaleData(
-			    uint8_t depth) const;
+			/*
+			 * We need the remaining base class variants as well,
+			 * otherwise they are hidden by the declaration below.
+			 */
+			using Image::getRawData;
 
 			Memory::uint8Array
-			getRawData()
-			    const;
+			getRawData(
+			    const uint8_t reduction,
+			    const ROI &roi)
+			    const override;
 
 			/**
 			 * Whether or not data is a Lossy JPEG image.
@@ -95,6 +109,58 @@ namespace BiometricEvaluation
 			    const uint8_t *data,
 			    uint64_t size);
 
+			/**
+			 * @brief
+			 * Obtain the attributes of a JPEG image from its
+			 * headers.
+			 *
+			 * @param[in] data
+			 *	The buffer to probe.
+			 * @param[in] size
+			 *	The size of data.
+			 *
+			 * @return
+			 *	Attributes of the image, as they would be
+			 *	reported by a JPEG constructed from data.
+			 *
+			 * @throw Error::DataError
+			 *	Headers are malformed or truncated.
+			 * @throw Error::NotImplemented
+			 *	The image is not supported by JPEG.
+			 *
+			 * @see Image::probe()
+			 */
+			static Attributes
+			probe(
+			    const uint8_t *data,
+			    const uint64_t size);
+
+			/**
+			 * @brief
+			 * Encode an image as baseline JPEG.
+			 *
+			 * @param[in] raw
+			 *	Image to encode: 8-bit grayscale or 24-bit
+			 *	RGB.
+			 * @param[in] quality
+			 *	libjpeg quality, from 1 (smallest) to 100
+			 *	(best).
+			 *
+			 * @return
+			 *	JFIF-encoded image.
+			 *
+			 * @throw Error::ParameterError
+			 *	quality is out of range, or raw is empty.
+			 * @throw Error::NotImplemented
+			 *	Unsupported depth or alpha channel.
+			 * @throw Error::StrategyError
+			 *	Error while encoding.
+			 */
+			static Memory::uint8Array
+			encode(
+			    const Raw &raw,
+			    const uint8_t quality = 75);
+
 			static int
 			getc_skip_marker_segment(
 			    const unsigned short marker,
@@ -102,6 +168,19 @@ namespace BiometricEvaluation
 			    unsigned char *ebufptr);
 
 		protected:
+			Memory::uint8Array
+			decodeRawData()
+			    const override;
+
+			void
+			decodeRawDataInto(
+			    Memory::uint8Array &rawData)
+			    const override;
+
+			Memory::uint8Array
+			decodeRawGrayscaleData(
+			    uint8_t depth)
+			    const override;
 
 		private:
 			/**
@@ -17,6 +17,9 @@ namespace BiometricEvaluation
 {
 	namespace Image
 	{
+		/* Forward declaration */
+		class Raw;
+
 		/**
 		 * @brief
 		 * A JPEG-2000-encoded image.
@@ -57,11 +60,27 @@ namespace BiometricEvaluation
 			    const statusCallback_t &statusCallback =
 			        Image::defaultStatusCallback);
 
+			JPEG2000(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback,
+			    const int8_t codecFormat = 2);
+
 			~JPEG2000() = default;
 
+			/*
+			 * We need the remaining base class variants as well,
+			 * otherwise they are hidden by the declaration below.
+			 */
+			using Image::getRawData;
+
 			Memory::uint8Array
-			getRawData()
-			    const;
+			getRawData(
+			    const uint8_t reduction,
+			    const ROI &roi)
+			    const override;
 
 			Memory::uint8Array
 			getRawGrayscaleData(
@@ -84,14 +103,206 @@ namespace BiometricEvaluation
 			    const uint8_t *data,
 			    uint64_t size);
 
+			/**
+			 * @brief
+			 * Obtain the attributes of a JPEG-2000 image from its
+			 * headers.
+			 *
+			 * @param[in] data
+			 *	The buffer to probe.
+			 * @param[in] size
+			 *	The size of data.
+			 *
+			 * @return
+			 *	Attributes of the image, as they would be
+			 *	reported by a JPEG2000 constructed from data.
+			 *
+			 * @throw Error::DataError
+			 *	Headers are malformed or truncated.
+			 * @throw Error::NotImplemented
+			 *	The image is not supported by JPEG2000.
+			 *
+			 * @see Image::probe()
+			 */
+			static Attributes
+			probe(
+			    const uint8_t *data,
+			    const uint64_t size);
+
+			/**
+			 * @brief
+			 * Encode an image in the JP2 file format.
+			 *
+			 * @param[in] raw
+			 *	Image to encode: 1 to 4 components of 8 or 16
+			 *	bits.  The last component of 2- and
+			 *	4-component images is opacity when
+			 *	raw.hasAlphaChannel().
+			 * @param[in] compressionRatio
+			 *	Target ratio of raw to encoded size for
+			 *	irreversible (lossy) compression, or 0 for
+			 *	reversible (lossless) compression.
+			 *
+			 * @return
+			 *	JP2-encoded image, with a capture resolution
+			 *	box when raw's resolution has units.
+			 *
+			 * @throw Error::ParameterError
+			 *	compressionRatio is negative, or raw is empty.
+			 * @throw Error::NotImplemented
+			 *	Unsupported depth.
+			 * @throw Error::StrategyError
+			 *	Error while encoding.
+			 */
+			static Memory::uint8Array
+			encode(
+			    const Raw &raw,
+			    const float compressionRatio = 0);
+
+			/**
+			 * @brief
+			 * Set the number of threads used to decode each
+			 * image.
+			 *
+			 * @param[in] threads
+			 *	Number of threads libopenjp2 may use to decode
+			 *	code blocks of one image.  1 decodes on the
+			 *	calling thread, and 0 uses all processors.
+			 *
+			 * @note
+			 * Affects only objects constructed afterwards.
+			 * Images decoded in parallel (e.g., by a
+			 * BatchDecoder) are best decoded with 1 thread.
+			 *
+			 * @see setDecodeThreadCount()
+			 */
+			static void
+			setDefaultDecodeThreadCount(
+			    const uint32_t threads);
+
+			/**
+			 * @return
+			 * Number of threads used to decode images
+			 * constructed from now on.  Defaults to 1.
+			 */
+			static uint32_t
+			getDefaultDecodeThreadCount();
+
+			/**
+			 * @brief
+			 * Set whether images hold the header parsed when
+			 * constructed until their first decode.
+			 *
+			 * @param[in] retain
+			 *	true to keep libopenjp2's codec, stream, and
+			 *	parsed header from construction, so the first
+			 *	decode need not parse the header again.  false
+			 *	releases them when construction completes.
+			 *
+			 * @note
+			 * Affects only objects constructed afterwards.
+			 * Holding is worthwhile only for images decoded
+			 * soon after construction (e.g., by a BatchDecoder),
+			 * since the held state is kept until the first
+			 * decode or destruction.
+			 */
+			static void
+			setDefaultRetainHeader(
+			    const bool retain);
+
+			/**
+			 * @return
+			 * Whether images constructed from now on hold their
+			 * parsed header until their first decode.  Defaults
+			 * to false.
+			 */
+			static bool
+			getDefaultRetainHeader();
+
+			/**
+			 * @return
+			 * Whether libopenjp2 can decode with more than one
+			 * thread.  If not, decode thread counts are
+			 * recorded but ignored.
+			 */
+			static bool
+			isMultithreadedDecodingSupported();
+
+			/**
+			 * @brief
+			 * Set the number of threads used to decode this
+			 * image.
+			 *
+			 * @param[in] threads
+			 *	Number of threads libopenjp2 may use.  1
+			 *	decodes on the calling thread, and 0 uses all
+			 *	processors.
+			 */
+			void
+			setDecodeThreadCount(
+			    const uint32_t threads);
+
+			/**
+			 * @return
+			 * Number of threads used to decode this image.
+			 */
+			uint32_t
+			getDecodeThreadCount()
+			    const;
+
+		protected:
+			Memory::uint8Array
+			decodeRawData()
+			    const override;
+
 		private:
 			/** JPEG2000 codec to use (from libopenjpeg) */
 			const int8_t _codecFormat;
+			/** Threads libopenjp2 may use to decode */
+			uint32_t _decodeThreadCount;
+
+			/**
+			 * Codec whose header was read by the constructor,
+			 * held for the first decode when
+			 * getDefaultRetainHeader() was true, else nullptr.
+			 */
+			struct Decompression;
+			std::shared_ptr<Decompression> _decompression;
+
+			/**
+			 * @brief
+			 * Decode a region at reduced resolution.
+			 *
+			 * @param[in] reduction
+			 * Number of resolution levels to discard.
+			 * @param[in] roi
+			 * Region of the full-resolution image.  An ROI with
+			 * no size is the entire image.
+			 *
+			 * @return
+			 * Raw image data of getReducedROI(reduction, roi).
+			 *
+			 * @throw Error::NotImplemented
+			 * The codestream has fewer resolution levels than
+			 * reduction, or an unsupported layout.
+			 * @throw Error::StrategyError
+			 * Error decoding.
+			 */
+			Memory::uint8Array
+			decodeRegion(
+			    const uint8_t reduction,
+			    const ROI &roi)
+			    const;
 
 			/**
 			 * @brief
 			 * Parse CDEF box to check for an opacity component.
 			 *
+			 * @param[in] data
+			 * JP2 data, or the boxes preceding the codestream.
+			 * @param[in] size
+			 * Size of data.
+			 *
 			 * @return
 			 * true if there is a separate opacity component. false
 			 * otherwise.
@@ -99,8 +310,33 @@ namespace BiometricEvaluation
 			 * @throw Error::ObjectDoesNotExist
 			 * No CDEF box.
 			 */
-			bool
-			checkForAlphaInCDEF();
+			static bool
+			checkForAlphaInCDEF(
+			    const uint8_t *data,
+			    const uint64_t size);
+
+			/**
+			 * @brief
+			 * Obtain the size of the boxes preceding the
+			 * codestream.
+			 *
+			 * @param[in] data
+			 * JP2 data.
+			 * @param[in] size
+			 * Size of data.
+			 *
+			 * @return
+			 * Offset of the Contiguous Codestream box, or size
+			 * if there is no such box.
+			 *
+			 * @note
+			 * Header boxes, such as resc and cdef, must
+			 * precede the codestream.
+			 */
+			static uint64_t
+			getHeaderSize(
+			    const uint8_t *data,
+			    const uint64_t size);
 
 			/**
 			 * @brief
@@ -222,10 +458,33 @@ namespace BiometricEvaluation
 			 *
 			 * @see find_marker()
 			 */
-			Resolution
+			static Resolution
 			parse_res(
 			    const Memory::AutoArray<uint8_t> &res);
 
+			/**
+			 * @brief
+			 * Add a capture resolution box to a JP2 header.
+			 *
+			 * @param[in] jp2
+			 *	JP2 file without a resolution box.
+			 * @param[in] resolution
+			 *	Resolution to record.  Must have units.
+			 *
+			 * @return
+			 *	jp2 with a res superbox appended to the jp2h
+			 *	box.
+			 *
+			 * @throw Error::StrategyError
+			 *	jp2 has no jp2h box.
+			 *
+			 * @see parse_res()
+			 */
+			static Memory::uint8Array
+			addResolutionBox(
+			    const Memory::uint8Array &jp2,
+			    const Resolution &resolution);
+
 			/*
 			 * libopenjp2 stream callbacks.
 			 *
@@ -240,7 +499,11 @@ namespace BiometricEvaluation
 			getDecompressionStream()
 			    const;
 
-			/** @return libopenjp2 decompression codec. */
+			/**
+			 * @return
+			 * libopenjp2 decompression codec, using
+			 * getDecodeThreadCount() threads.
+			 */
 			void*
 			getDecompressionCodec()
 			    const;
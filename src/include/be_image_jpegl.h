@@ -37,16 +37,19 @@ namespace BiometricEvaluation
 			    const statusCallback_t &statusCallback =
 			        Image::defaultStatusCallback);
 
+			JPEGL(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
+
 			~JPEGL() = default;
 
 			Memory::uint8Array
 			getRawGrayscaleData(
 			    uint8_t depth) const;
 
-			Memory::uint8Array
-			getRawData()
-			    const;
-
 			/**
 			 * Whether or not data is a Lossless JPEG image.
 			 *
@@ -64,7 +67,41 @@ namespace BiometricEvaluation
 			    const uint8_t *data,
 			    uint64_t size);
 
+			/**
+			 * @brief
+			 * Obtain the attributes of a Lossless JPEG image from its
+			 * headers.
+			 *
+			 * @param[in] data
+			 *	The buffer to probe.
+			 * @param[in] size
+			 *	The size of data.
+			 *
+			 * @return
+			 *	Attributes of the image, as they would be
+			 *	reported by a JPEGL constructed from data.
+			 *
+			 * @throw Error::DataError
+			 *	Headers are malformed or truncated.
+			 * @throw Error::NotImplemented
+			 *	The image is not supported by JPEGL.
+			 *
+			 * @see Image::probe()
+			 */
+			static Attributes
+			probe(
+			    const uint8_t *data,
+			    const uint64_t size);
+
 		protected:
+			Memory::uint8Array
+			decodeRawData()
+			    const override;
+
+			void
+			decodeRawDataInto(
+			    Memory::uint8Array &rawData)
+			    const override;
 
 		private:
 
@@ -20,6 +20,9 @@ namespace BiometricEvaluation
 {
 	namespace Image
 	{
+		/* Forward declaration */
+		class Raw;
+
 		/**
 		 * @brief
 		 * A NetPBM-encoded image.
@@ -54,6 +57,13 @@ namespace BiometricEvaluation
 			    const statusCallback_t &statusCallback =
 			        Image::defaultStatusCallback);
 
+			NetPBM(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
+
 			~NetPBM() = default;
 
 			/**
@@ -76,10 +86,6 @@ namespace BiometricEvaluation
 			 * are expanded to 8-bit.
 			 */
 			Memory::uint8Array
-			getRawData()
-			    const;
-
-			Memory::uint8Array
 			getRawGrayscaleData(
 			    uint8_t depth) const;
 
@@ -100,6 +106,56 @@ namespace BiometricEvaluation
 			    const uint8_t *data,
 			    uint64_t size);
 
+			/**
+			 * @brief
+			 * Obtain the attributes of a NetPBM image from its
+			 * headers.
+			 *
+			 * @param[in] data
+			 *	The buffer to probe.
+			 * @param[in] size
+			 *	The size of data.
+			 *
+			 * @return
+			 *	Attributes of the image, as they would be
+			 *	reported by a NetPBM constructed from data.
+			 *
+			 * @throw Error::DataError
+			 *	Headers are malformed or truncated.
+			 * @throw Error::NotImplemented
+			 *	The image is not supported by NetPBM.
+			 *
+			 * @see Image::probe()
+			 */
+			static Attributes
+			probe(
+			    const uint8_t *data,
+			    const uint64_t size);
+
+			/**
+			 * @brief
+			 * Encode an image as a binary graymap (P5) or pixmap
+			 * (P6).
+			 *
+			 * @param[in] raw
+			 *	Image to encode: 8- or 16-bit grayscale, or
+			 *	24- or 48-bit RGB.
+			 *
+			 * @return
+			 *	NetPBM-encoded image.
+			 *
+			 * @throw Error::ParameterError
+			 *	raw is empty.
+			 * @throw Error::NotImplemented
+			 *	Unsupported depth or alpha channel.
+			 *
+			 * @note
+			 * NetPBM does not record resolution.
+			 */
+			static Memory::uint8Array
+			encode(
+			    const Raw &raw);
+
 			/*
 			 * Utility methods for parsing buffers.
 			 */
@@ -272,19 +328,43 @@ namespace BiometricEvaluation
 			    uint32_t width,
 			    uint32_t height);
 
+		protected:
+			Memory::uint8Array
+			decodeRawData()
+			    const override;
+
 		private:
 			/**
 			 * @brief
 			 * Parse dimensions and depth from the NetPBM header.
 			 *
+			 * @param[in] data
+			 *	NetPBM data.
+			 * @param[in] size
+			 *	Size of data.
+			 * @param[out] kind
+			 *	Type of NetPBM encoding used.
+			 * @param[out] maxColorValue
+			 *	Maximum color value per pixel.
+			 * @param[out] headerLength
+			 *	Size of the NetPBM header.
+			 *
+			 * @return
+			 *	Attributes described by the header.
+			 *
 			 * @throw out_of_range
 			 *	The end of data was reached before all of
 			 *	the header elements were parsed.
 			 * @throw Error::DataError
 			 *	Invalid NetPBM format.
 			 */
-			void
-			parseHeader();
+			static Attributes
+			parseHeader(
+			    const uint8_t *data,
+			    const uint64_t size,
+			    Kind &kind,
+			    uint32_t &maxColorValue,
+			    uint64_t &headerLength);
 
 			/** Maximum color value per pixel */
 			uint32_t _maxColorValue;
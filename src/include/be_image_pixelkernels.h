@@ -0,0 +1,222 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IMAGE_PIXELKERNELS_H__
+#define __BE_IMAGE_PIXELKERNELS_H__
+
+#include <cstdint>
+
+#include <be_framework_enumeration.h>
+
+namespace BiometricEvaluation
+{
+	namespace Image
+	{
+		/**
+		 * @brief
+		 * Conversions of raw pixel buffers.
+		 *
+		 * @details
+		 * Each conversion has a scalar implementation and, on x86
+		 * processors, vectorized implementations.  The fastest
+		 * implementation supported by the processor is selected
+		 * at runtime.  All implementations produce identical
+		 * output.
+		 *
+		 * Multi-byte components are in native byte order.
+		 */
+		namespace PixelKernels
+		{
+			/** Instructions used by the conversions */
+			enum class InstructionSet
+			{
+				Scalar,
+				SSE4_1,
+				AVX2
+			};
+
+			/**
+			 * @brief
+			 * Whether or not the processor supports an
+			 * instruction set.
+			 *
+			 * @param instructionSet
+			 * Instruction set to check.
+			 *
+			 * @return
+			 * true if the conversions can use instructionSet,
+			 * false otherwise.
+			 */
+			bool
+			isSupported(
+			    InstructionSet instructionSet);
+
+			/**
+			 * @return
+			 * Instruction set used by the conversions.
+			 */
+			InstructionSet
+			getInstructionSet();
+
+			/**
+			 * @brief
+			 * Change the instruction set used by the conversions.
+			 *
+			 * @param instructionSet
+			 * Instruction set to use.
+			 *
+			 * @throw Error::NotImplemented
+			 * instructionSet is not supported.
+			 *
+			 * @note
+			 * Intended for testing and benchmarking.  Not safe to
+			 * call while other threads are converting.
+			 */
+			void
+			setInstructionSet(
+			    InstructionSet instructionSet);
+
+			/**
+			 * @brief
+			 * Convert color pixels to luma.
+			 *
+			 * @param[in] in
+			 * Pixels of componentCount components of inDepth
+			 * bits, red first.
+			 * @param[out] out
+			 * Buffer of pixelCount pixels of outDepth bits.
+			 * @param[in] pixelCount
+			 * Number of pixels to convert.
+			 * @param[in] inDepth
+			 * Bits per input component, 8 or 16.
+			 * @param[in] componentCount
+			 * Components per input pixel, 3 (RGB) or 4 (RGBA,
+			 * where alpha is ignored).
+			 * @param[in] outDepth
+			 * Bits per output pixel, 8 or 16.
+			 *
+			 * @throw Error::ParameterError
+			 * Unsupported depth or component count.
+			 *
+			 * @note
+			 * Components are first scaled to outDepth as
+			 * Image::valueInColorspace() does, then weighted by
+			 * the ITU-R BT.601 luma coefficients in single
+			 * precision and truncated.
+			 */
+			void
+			colorToGray(
+			    const uint8_t *in,
+			    uint8_t *out,
+			    uint64_t pixelCount,
+			    uint8_t inDepth,
+			    uint8_t componentCount,
+			    uint8_t outDepth);
+
+			/**
+			 * @brief
+			 * Scale single-component pixels to another depth.
+			 *
+			 * @param[in] in
+			 * Pixels of inDepth bits.
+			 * @param[out] out
+			 * Buffer of pixelCount pixels of outDepth bits.
+			 * @param[in] pixelCount
+			 * Number of pixels to convert.
+			 * @param[in] inDepth
+			 * Bits per input pixel, 8 or 16.
+			 * @param[in] outDepth
+			 * Bits per output pixel, 8 or 16.
+			 *
+			 * @throw Error::ParameterError
+			 * Unsupported depth.
+			 *
+			 * @note
+			 * Values are scaled as Image::valueInColorspace()
+			 * does.
+			 */
+			void
+			rescale(
+			    const uint8_t *in,
+			    uint8_t *out,
+			    uint64_t pixelCount,
+			    uint8_t inDepth,
+			    uint8_t outDepth);
+
+			/**
+			 * @brief
+			 * Remove the last component of each pixel, such as an
+			 * alpha channel.
+			 *
+			 * @param[in] in
+			 * Pixels of componentCount components of
+			 * bytesPerComponent bytes.
+			 * @param[out] out
+			 * Buffer of pixelCount pixels of componentCount - 1
+			 * components.
+			 * @param[in] pixelCount
+			 * Number of pixels to convert.
+			 * @param[in] bytesPerComponent
+			 * Size of a component, 1 or 2.
+			 * @param[in] componentCount
+			 * Components per input pixel, 2 or 4.
+			 *
+			 * @throw Error::ParameterError
+			 * Unsupported component size or count.
+			 */
+			void
+			removeLastComponent(
+			    const uint8_t *in,
+			    uint8_t *out,
+			    uint64_t pixelCount,
+			    uint8_t bytesPerComponent,
+			    uint8_t componentCount);
+
+			/**
+			 * @brief
+			 * Weighted sum of rows of values.
+			 *
+			 * @param[in] in
+			 * First of weightCount rows, each stride values
+			 * apart.
+			 * @param[in] stride
+			 * Distance between rows, in values.
+			 * @param[in] weights
+			 * Weight of each row.
+			 * @param[in] weightCount
+			 * Number of rows and weights.
+			 * @param[out] out
+			 * Row of length values, where
+			 * out[i] = sum of weights[k] * in[(k * stride) + i].
+			 * @param[in] length
+			 * Number of values in each row.
+			 *
+			 * @note
+			 * Products are accumulated in order of k, starting
+			 * from 0, in single precision without fused
+			 * multiply-add.
+			 */
+			void
+			weightedSum(
+			    const float *in,
+			    uint64_t stride,
+			    const float *weights,
+			    uint32_t weightCount,
+			    float *out,
+			    uint64_t length);
+		}
+	}
+}
+
+BE_FRAMEWORK_ENUMERATION_DECLARATIONS(
+    BiometricEvaluation::Image::PixelKernels::InstructionSet,
+    BE_Image_PixelKernels_InstructionSet_EnumToStringMap);
+
+#endif /* __BE_IMAGE_PIXELKERNELS_H__ */
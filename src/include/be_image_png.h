@@ -17,6 +17,9 @@ namespace BiometricEvaluation
 {
 	namespace Image
 	{
+		/* Forward declaration */
+		class Raw;
+
 		/**
 		 * @brief
 		 * A PNG-encoded image.
@@ -37,16 +40,36 @@ namespace BiometricEvaluation
 			    const statusCallback_t &statusCallback =
 			        Image::defaultStatusCallback);
 
-			~PNG() = default;
+			PNG(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
 
-			Memory::uint8Array
-			getRawData()
-			    const;
+			~PNG() = default;
 
 			Memory::uint8Array
 			getRawGrayscaleData(
 			    uint8_t depth) const;
 
+			/**
+			 * @brief
+			 * Obtain a new BandReader over a region of the image.
+			 *
+			 * @details
+			 * Rows of non-interlaced images are decoded as they
+			 * are read, so that only one band is held at a time.
+			 * Interlaced images are decoded when the BandReader
+			 * is created.
+			 *
+			 * @see Image::makeBandReader()
+			 */
+			std::unique_ptr<BandReader>
+			makeBandReader(
+			    const ROI &roi = ROI())
+			    const override;
+
 			/**
 			 * Whether or not data is a PNG image.
 			 *
@@ -63,6 +86,64 @@ namespace BiometricEvaluation
 			isPNG(
 			    const uint8_t *data,
 			    uint64_t size);
+
+			/**
+			 * @brief
+			 * Obtain the attributes of a PNG image from its
+			 * headers.
+			 *
+			 * @param[in] data
+			 *	The buffer to probe.
+			 * @param[in] size
+			 *	The size of data.
+			 *
+			 * @return
+			 *	Attributes of the image, as they would be
+			 *	reported by a PNG constructed from data.
+			 *
+			 * @throw Error::DataError
+			 *	Headers are malformed or truncated.
+			 * @throw Error::NotImplemented
+			 *	The image is not supported by PNG.
+			 *
+			 * @see Image::probe()
+			 */
+			static Attributes
+			probe(
+			    const uint8_t *data,
+			    const uint64_t size);
+
+			/**
+			 * @brief
+			 * Encode an image as PNG.
+			 *
+			 * @param[in] raw
+			 *	Image to encode: 8- or 16-bit grayscale or
+			 *	RGB, with or without an alpha channel.
+			 * @param[in] compressionLevel
+			 *	zlib compression level, from 0 (fastest) to
+			 *	9 (smallest).
+			 *
+			 * @return
+			 *	PNG-encoded image.
+			 *
+			 * @throw Error::ParameterError
+			 *	compressionLevel is greater than 9, or raw
+			 *	is empty.
+			 * @throw Error::NotImplemented
+			 *	Unsupported depth.
+			 * @throw Error::StrategyError
+			 *	Error while encoding.
+			 */
+			static Memory::uint8Array
+			encode(
+			    const Raw &raw,
+			    const uint8_t compressionLevel = 6);
+
+		protected:
+			Memory::uint8Array
+			decodeRawData()
+			    const override;
 		};
 	}
 }
@@ -47,16 +47,39 @@ namespace BiometricEvaluation
 			    const statusCallback_t &statusCallback =
 			        Image::defaultStatusCallback);
 
+			Raw(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const Size dimensions,
+			    const uint32_t colorDepth,
+			    const uint16_t bitDepth,
+			    const Resolution resolution,
+			    const bool hasAlphaChannel,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
+
 			~Raw() = default;
 
 			/*
 			 * Implementations of the Image interface.
 			 */
 
+			/*
+			 * We need the remaining base class variants as well,
+			 * otherwise they are hidden by the declaration below.
+			 */
+			using Image::getRawData;
+
 			Memory::uint8Array
 			getRawData()
 			    const;
 
+			void
+			getRawData(
+			    Memory::uint8Array &rawData)
+			    const override;
+
 			Memory::uint8Array
 			getRawGrayscaleData(
 			    uint8_t depth) const;
@@ -0,0 +1,123 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IMAGE_RESAMPLE_H__
+#define __BE_IMAGE_RESAMPLE_H__
+
+#include <be_framework_enumeration.h>
+#include <be_image.h>
+#include <be_image_image.h>
+#include <be_image_raw.h>
+
+namespace BiometricEvaluation
+{
+	namespace Image
+	{
+		/** Filters used to resample images */
+		enum class ResampleFilter
+		{
+			/**
+			 * Average of the source pixels covered by each
+			 * pixel, weighted by the area covered.
+			 */
+			Area,
+			/** Triangle filter (bilinear interpolation) */
+			Bilinear,
+			/** Windowed sinc filter with three lobes */
+			Lanczos3
+		};
+
+		/**
+		 * @brief
+		 * Resample a region of an image to new dimensions.
+		 *
+		 * @param[in] image
+		 *	Image to resample.  Only the part of the image
+		 *	needed is decoded, a band at a time, with
+		 *	Image::makeBandReader().
+		 * @param[in] size
+		 *	Dimensions of the resampled image.
+		 * @param[in] filter
+		 *	Filter used to compute resampled pixels.  When
+		 *	reducing, filters are widened so that every source
+		 *	pixel contributes.
+		 * @param[in] roi
+		 *	Region of image to resample.  An ROI with no size
+		 *	is the entire image.  Filters may read pixels
+		 *	outside the region, but not outside the image.
+		 *
+		 * @return
+		 *	Raw image of size pixels, with the components and
+		 *	(at least 8-bit) depth of image->getRawData(), and
+		 *	image's resolution scaled to match size.
+		 *
+		 * @throw Error::ParameterError
+		 *	size is empty or roi is not within image.
+		 * @throw Error::DataError
+		 *	Error decoding image.
+		 *
+		 * @note
+		 * Pixels are filtered in two separable passes, whose
+		 * inner loops are PixelKernels::weightedSum().  Alpha
+		 * channels are filtered like other components.  Rows
+		 * are resampled a group at a time, so apart from the
+		 * resampled image, memory used grows with the width of
+		 * the image but not its height when image's BandReader
+		 * decodes incrementally.
+		 */
+		Raw
+		resample(
+		    const Image &image,
+		    const Size &size,
+		    const ResampleFilter filter = ResampleFilter::Area,
+		    const ROI &roi = ROI());
+
+		/**
+		 * @brief
+		 * Resample a region of an image to a resolution.
+		 *
+		 * @param[in] image
+		 *	Image to resample.
+		 * @param[in] resolution
+		 *	Resolution of the resampled image.
+		 * @param[in] filter
+		 *	Filter used to compute resampled pixels.
+		 * @param[in] roi
+		 *	Region of image to resample.  An ROI with no size
+		 *	is the entire image.
+		 *
+		 * @return
+		 *	Raw image with resolution, covering roi.
+		 *
+		 * @throw Error::ParameterError
+		 *	resolution is not positive, or roi is not within
+		 *	image.
+		 * @throw Error::StrategyError
+		 *	image or resolution has no units.
+		 * @throw Error::DataError
+		 *	Error decoding image.
+		 *
+		 * @see resample()
+		 */
+		Raw
+		normalizeResolution(
+		    const Image &image,
+		    const Resolution &resolution = Resolution(500, 500,
+		        Resolution::Units::PPI),
+		    const ResampleFilter filter = ResampleFilter::Area,
+		    const ROI &roi = ROI());
+	}
+}
+
+BE_FRAMEWORK_ENUMERATION_DECLARATIONS(
+    BiometricEvaluation::Image::ResampleFilter,
+    BE_Image_ResampleFilter_EnumToStringMap);
+
+#endif /* __BE_IMAGE_RESAMPLE_H__ */
@@ -35,17 +35,37 @@ namespace BiometricEvaluation
 			    const statusCallback_t &statusCallback =
 			        Image::defaultStatusCallback);
 
-			~TIFF() = default;
+			TIFF(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
 
-			Memory::uint8Array
-			getRawData()
-			    const;
+			~TIFF() = default;
 
 			Memory::uint8Array
 			getRawGrayscaleData(
 			    uint8_t depth)
 			    const;
 
+			/**
+			 * @brief
+			 * Obtain a new BandReader over a region of the image.
+			 *
+			 * @details
+			 * Images of whole-byte components are decoded a
+			 * band of scanlines or a row of tiles at a time, so
+			 * that only one band is held at a time.  Other
+			 * images are decoded when the BandReader is created.
+			 *
+			 * @see Image::makeBandReader()
+			 */
+			std::unique_ptr<BandReader>
+			makeBandReader(
+			    const ROI &roi = ROI())
+			    const override;
+
 			/**
 			 * @brief
 			 * Determine if image is encoded as TIFF.
@@ -64,6 +84,32 @@ namespace BiometricEvaluation
 			    const uint8_t *data,
 			    const uint64_t size);
 
+			/**
+			 * @brief
+			 * Obtain the attributes of a TIFF image from its
+			 * headers.
+			 *
+			 * @param[in] data
+			 *	The buffer to probe.
+			 * @param[in] size
+			 *	The size of data.
+			 *
+			 * @return
+			 *	Attributes of the image, as they would be
+			 *	reported by a TIFF constructed from data.
+			 *
+			 * @throw Error::DataError
+			 *	Headers are malformed or truncated.
+			 * @throw Error::NotImplemented
+			 *	The image is not supported by TIFF.
+			 *
+			 * @see Image::probe()
+			 */
+			static Attributes
+			probe(
+			    const uint8_t *data,
+			    const uint64_t size);
+
 			/**
 			 * @brief
 			 * Determine if image is encoded as TIFF.
@@ -108,6 +154,11 @@ namespace BiometricEvaluation
 				const TIFF *tiffObject{nullptr};
 			};
 
+		protected:
+			Memory::uint8Array
+			decodeRawData()
+			    const override;
+
 		private:
 
 			/**
@@ -17,6 +17,9 @@ namespace BiometricEvaluation
 {
 	namespace Image
 	{
+		/* Forward declaration */
+		class Raw;
+
 		/**
 		 * @brief
 		 * A WSQ-encoded image.
@@ -37,11 +40,26 @@ namespace BiometricEvaluation
 			    const statusCallback_t &statusCallback =
 			        Image::defaultStatusCallback);
 
+			WSQ(
+			    const std::shared_ptr<const uint8_t> &data,
+			    const uint64_t size,
+			    const std::string &identifier = "",
+			    const statusCallback_t &statusCallback =
+			        Image::defaultStatusCallback);
+
 			~WSQ() = default;
 
+			/*
+			 * We need the remaining base class variants as well,
+			 * otherwise they are hidden by the declaration below.
+			 */
+			using Image::getRawData;
+
 			Memory::uint8Array
-			getRawData()
-			    const;
+			getRawData(
+			    const uint8_t reduction,
+			    const ROI &roi)
+			    const override;
 
 			Memory::uint8Array
 			getRawGrayscaleData(
@@ -64,10 +82,93 @@ namespace BiometricEvaluation
 			    const uint8_t *data,
 			    uint64_t size);
 
+			/**
+			 * @brief
+			 * Obtain the attributes of a WSQ image from its
+			 * headers.
+			 *
+			 * @param[in] data
+			 *	The buffer to probe.
+			 * @param[in] size
+			 *	The size of data.
+			 *
+			 * @return
+			 *	Attributes of the image, as they would be
+			 *	reported by a WSQ constructed from data.
+			 *
+			 * @throw Error::DataError
+			 *	Headers are malformed or truncated.
+			 * @throw Error::NotImplemented
+			 *	The image is not supported by WSQ.
+			 *
+			 * @see Image::probe()
+			 */
+			static Attributes
+			probe(
+			    const uint8_t *data,
+			    const uint64_t size);
+
+			/**
+			 * @brief
+			 * Encode an image as WSQ.
+			 *
+			 * @param[in] raw
+			 *	Image to encode.  Images that are not 8-bit
+			 *	grayscale are converted with
+			 *	getRawGrayscaleData().
+			 * @param[in] bitRate
+			 *	Target bits per pixel.  0.75 (about 15:1)
+			 *	and 2.25 (about 5:1) are typical.
+			 *
+			 * @return
+			 *	WSQ-encoded image, with the resolution of raw
+			 *	recorded in a NISTCOM comment.
+			 *
+			 * @throw Error::ParameterError
+			 *	bitRate is not positive, or raw is empty.
+			 * @throw Error::StrategyError
+			 *	Error while encoding.
+			 *
+			 * @note
+			 * Encoding is serialized, because the NBIS WSQ
+			 * encoder keeps its state in global variables.
+			 */
+			static Memory::uint8Array
+			encode(
+			    const Raw &raw,
+			    const float bitRate = 0.75);
+
 		protected:
+			Memory::uint8Array
+			decodeRawData()
+			    const override;
 
-		private:
+			void
+			decodeRawDataInto(
+			    Memory::uint8Array &rawData)
+			    const override;
 
+		private:
+			/**
+			 * @brief
+			 * Decode at reduced resolution.
+			 *
+			 * @param[in] reduction
+			 * Number of wavelet levels to skip reconstructing,
+			 * at most WSQ_MAX_REDUCTION.
+			 * @param[out] rawData
+			 * Buffer to hold raw image data of
+			 * getReducedDimensions(reduction, ROI()), decoded
+			 * in place.
+			 *
+			 * @throw Error::DataError
+			 * Error decoding.
+			 */
+			void
+			decodeReduced(
+			    const uint8_t reduction,
+			    Memory::uint8Array &rawData)
+			    const;
 		};
 	}
 }
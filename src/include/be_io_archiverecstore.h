@@ -39,13 +39,37 @@ namespace BiometricEvaluation {
  * entries in the manifest for one key.  The last entry for the key is 
  * considered accurate.  If the last offset for a key is 
  * ARCHIVE_RECORD_REMOVED, the information is treated as unavailable.
+ *
+ * Loading a large text manifest is slow, so convertManifest() may be used
+ * to write a binary manifest: a table of the live entries, sorted by key,
+ * that is mapped into memory instead of parsed.  The text manifest
+ * remains authoritative and continues to be appended to; only entries
+ * added after the binary manifest was written are parsed on open.
  */
 		class ArchiveRecordStore : public RecordStore {
 		public:	
+			/**
+			 * @brief
+			 * Read-only view of a record's data.
+			 * @details
+			 * data remains valid for as long as owner is held,
+			 * even after the ArchiveRecordStore is destroyed.
+			 */
+			struct RecordView {
+				/** First byte of the record's data */
+				const uint8_t *data;
+				/** Size of the record's data, in bytes */
+				uint64_t size;
+				/** Keeps the memory behind data alive */
+				std::shared_ptr<const void> owner;
+			};
+
 			/** Name of the manifest file on disk */
 			static const std::string MANIFEST_FILE_NAME;
 			/** Name of the archive file on disk */
 			static const std::string ARCHIVE_FILE_NAME;
+			/** Name of the binary manifest file on disk */
+			static const std::string BINARY_MANIFEST_FILE_NAME;
 
 			/**
 			 * Create a new ArchiveRecordStore, read/write mode.
@@ -100,6 +124,8 @@ namespace BiometricEvaluation {
                         using RecordStore::replace;
 
 			void sync() const override;
+			void beginBulk() override;
+			void commitBulk() override;
 
 			void insert(
 			    const std::string &key,
@@ -117,6 +143,33 @@ namespace BiometricEvaluation {
 			uint64_t length(
 			    const std::string &key) const override;
 
+			/**
+			 * @brief
+			 * Obtain a record's data without copying it.
+			 * @details
+			 * When the store is opened read-only, the archive
+			 * file is mapped into memory and the view refers
+			 * to the record's bytes within that mapping, so
+			 * the data can be handed to consumers such as
+			 * Image::Image::openImage() without a copy, and
+			 * concurrent readers do not share a file position.
+			 * Otherwise, the record is read into a buffer
+			 * owned by the view.
+			 *
+			 * @param[in] key
+			 *	The key of the record to be read.
+			 * @return
+			 *	View of the record's data.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	A record for the key does not exist.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system, or the key is invalid.
+			 */
+			RecordView readView(
+			    const std::string &key) const;
+
 			void flush(
 			    const std::string &key) const override;
 
@@ -133,6 +186,10 @@ namespace BiometricEvaluation {
 			    const std::string &key)
 			    override;
 
+			std::unique_ptr<RecordStore::Cursor> makeReader()
+			    const
+			    override;
+
 			void move(
 			    const std::string &pathname)
 			    override;
@@ -190,6 +247,25 @@ namespace BiometricEvaluation {
 			 */
 			static void vacuum(
 			    const std::string &pathname);
+
+			/**
+			 * Write a binary manifest for an existing store
+			 * from its text manifest, so that subsequent opens
+			 * need not parse the text manifest.
+			 *
+			 * @param[in] pathname
+			 *	The pathname of the existing RecordStore.
+			 * @throw Error::ObjectDoesNotExist
+			 *	The store does not exist.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 * @note
+			 * The store should not be modified while converting.
+			 * vacuum() does not preserve the binary manifest.
+			 */
+			static void convertManifest(
+			    const std::string &pathname);
 	
 			/**
 			 * Obtain the name of the file storing the data for 
@@ -116,6 +116,8 @@ namespace BiometricEvaluation
 			uint64_t
 			getSpaceUsed() const override;
 			void sync() const override;
+			void beginBulk() override;
+			void commitBulk() override;
 			unsigned int getCount() const override;
 			std::string getPathname() const override;
 			std::string getDescription() const override;
@@ -160,11 +162,58 @@ namespace BiometricEvaluation
 			    const std::string &key)
 			    override;
 
+			std::unique_ptr<RecordStore::Cursor>
+			makeReader()
+			    const
+			    override;
+
 			void
 			move(
 			    const std::string &pathname)
 			    override;
 
+			/**
+			 * @brief
+			 * Train a compression dictionary from the next
+			 * records inserted.
+			 * @details
+			 * The next sampleCount records inserted are compressed
+			 * without a dictionary and kept in memory as samples.
+			 * A dictionary is then trained from the samples,
+			 * saved with the store, and used to compress records
+			 * inserted afterwards.  Records compressed before and
+			 * after training can both be read.  If the store is
+			 * closed before training, sampling restarts when it
+			 * is next opened read/write.  If a dictionary cannot
+			 * be trained from the samples, records continue to
+			 * be compressed without one.
+			 *
+			 * @param[in] sampleCount
+			 *	Number of records to sample.  Hundreds or
+			 *	more small records train the best dictionaries.
+			 * @param[in] maxDictionarySize
+			 *	Maximum size of the dictionary.
+			 *
+			 * @throw Error::StrategyError
+			 *	The store is read-only, the compressor does
+			 *	not support dictionaries, the store already
+			 *	has a dictionary, or a parameter is 0.
+			 */
+			void
+			trainDictionary(
+			    uint64_t sampleCount,
+			    uint64_t maxDictionarySize =
+			    Compressor::DEFAULT_DICTIONARY_SIZE);
+
+			/**
+			 * @return
+			 *	Whether records are being compressed with a
+			 *	trained dictionary.
+			 */
+			bool
+			hasDictionary()
+			    const;
+
 			/**
 			 * @brief
 			 * Copy constructor (disabled).
@@ -14,6 +14,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <be_error_exception.h>
 #include <be_framework_enumeration.h>
@@ -28,13 +29,23 @@ namespace BiometricEvaluation
 		 * @brief
 		 * Common interface for classes providing compressing and
 		 * decompressing functionality.
+		 * @details
+		 * Implementations must provide compress() and decompress()
+		 * of a raw buffer.  The remaining buffer and file variants
+		 * are implemented in terms of those two methods, and may be
+		 * overridden when an implementation can do better.
 		 */
 		class Compressor
 		{
 		public:
+			/** Default maximum size of a trained dictionary */
+			static const uint64_t DEFAULT_DICTIONARY_SIZE = 112640;
+
 			/** Kinds of Compressors (for factory) */
 			enum class Kind {
-				GZIP
+				GZIP,
+				ZSTD,
+				LZ4
 			};
 					
 			/**
@@ -82,7 +93,7 @@ namespace BiometricEvaluation
 			virtual Memory::uint8Array
 			compress(
 			    const Memory::uint8Array &uncompressedData)
-			    const = 0;
+			    const;
 
 			/**
 			 * @brief
@@ -104,7 +115,7 @@ namespace BiometricEvaluation
 			compress(
 			    const uint8_t *const uncompressedData,
 			    uint64_t uncompressedDataSize,
-			    const std::string &outputFile) const = 0;
+			    const std::string &outputFile) const;
 
 			/**
 			 * @brief
@@ -123,7 +134,7 @@ namespace BiometricEvaluation
 			virtual void
 			compress(
 			    const Memory::uint8Array &uncompressedData,
-			    const std::string &outputFile) const = 0;
+			    const std::string &outputFile) const;
 
 			/**
 			 * @brief
@@ -143,7 +154,7 @@ namespace BiometricEvaluation
 			virtual Memory::uint8Array
 			compress(
 			    const std::string &inputFile)
-			    const = 0;
+			    const;
 
 			/**
 			 * @brief
@@ -165,7 +176,7 @@ namespace BiometricEvaluation
 			virtual void
 			compress(
 			    const std::string &inputFile,
-			    const std::string &outputFile) const = 0;
+			    const std::string &outputFile) const;
 
 			/**
 			 * @brief
@@ -204,7 +215,70 @@ namespace BiometricEvaluation
    			virtual Memory::uint8Array
 			decompress(
 			    const Memory::uint8Array &compressedData)
-			    const = 0;
+			    const;
+
+			/**
+			 * @brief
+			 * Decompress a compressed buffer of known
+			 * decompressed size into a caller-provided buffer.
+			 * @details
+			 * The default implementation decompresses into a
+			 * temporary buffer and copies the result.
+			 * Implementations should override this method to
+			 * decompress directly into uncompressedData.
+			 *
+			 * @param compressedData
+			 *	Compressed data buffer to decompress.
+			 * @param compressedDataSize
+			 *	Size of compressedData.
+			 * @param uncompressedData
+			 *	Buffer that will hold the decompressed data.
+			 * @param uncompressedDataSize
+			 *	Size of the decompressed data, which must
+			 *	also be the size of uncompressedData.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error in decompression unit, or the
+			 *	decompressed data is not uncompressedDataSize
+			 *	bytes long.
+			 */
+			virtual void
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const;
+
+			/**
+			 * @brief
+			 * Decompress a compressed buffer of known
+			 * decompressed size.
+			 * @details
+			 * The returned buffer is allocated once, with
+			 * uncompressedDataSize bytes.
+			 *
+			 * @param compressedData
+			 *	Compressed data buffer to decompress.
+			 * @param compressedDataSize
+			 *	Size of compressedData.
+			 * @param uncompressedDataSize
+			 *	Size of the decompressed data.
+			 *
+			 * @return
+			 * Decompressed data.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error in decompression unit, or the
+			 *	decompressed data is not uncompressedDataSize
+			 *	bytes long.
+			 */
+			virtual Memory::uint8Array
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint64_t uncompressedDataSize)
+			    const;
 
 			/**
 			 * @brief
@@ -224,7 +298,7 @@ namespace BiometricEvaluation
    			virtual Memory::uint8Array
 			decompress(
 			    const std::string &inputFile)
-			    const = 0;
+			    const;
 
 			/**
 			 * @brief
@@ -244,7 +318,7 @@ namespace BiometricEvaluation
 			virtual void
 			decompress(
 			    const Memory::uint8Array &compressedData,
-			    const std::string &outputFile) const = 0;
+			    const std::string &outputFile) const;
 
 			/**
 			 * @brief
@@ -267,7 +341,7 @@ namespace BiometricEvaluation
 			decompress(
 			    const uint8_t *const compressedData,
 			    const uint64_t compressedDataSize,
-			    const std::string &outputFile) const = 0;
+			    const std::string &outputFile) const;
 
 			/**
 			 * @brief
@@ -289,7 +363,77 @@ namespace BiometricEvaluation
 			virtual void
 			decompress(
 			    const std::string &inputFile,
-			    const std::string &outputFile) const = 0;
+			    const std::string &outputFile) const;
+
+			/**
+			 * @brief
+			 * Whether this compressor supports dictionaries.
+			 *
+			 * @return
+			 *	true if trainDictionary() and setDictionary()
+			 *	are implemented, false otherwise.
+			 */
+			virtual bool
+			supportsDictionaries()
+			    const;
+
+			/**
+			 * @brief
+			 * Train a dictionary from samples of typical data.
+			 * @details
+			 * A dictionary can substantially improve compression
+			 * of small, similar buffers.  Not all compressors
+			 * support dictionaries.
+			 *
+			 * @param samples
+			 *	Samples of uncompressed data.
+			 * @param maxDictionarySize
+			 *	Maximum size of the dictionary.
+			 *
+			 * @return
+			 *	Trained dictionary.
+			 *
+			 * @throw Error::NotImplemented
+			 *	Compressor does not support dictionaries.
+			 * @throw Error::StrategyError
+			 *	A dictionary could not be trained from
+			 *	samples, commonly because there are too few.
+			 */
+			virtual Memory::uint8Array
+			trainDictionary(
+			    const std::vector<Memory::uint8Array> &samples,
+			    uint64_t maxDictionarySize =
+			    DEFAULT_DICTIONARY_SIZE)
+			    const;
+
+			/**
+			 * @brief
+			 * Use a dictionary for compression and decompression.
+			 *
+			 * @param dictionary
+			 *	Dictionary, as returned from
+			 *	trainDictionary().
+			 *
+			 * @throw Error::NotImplemented
+			 *	Compressor does not support dictionaries.
+			 * @throw Error::StrategyError
+			 *	dictionary is not valid for this compressor.
+			 */
+			virtual void
+			setDictionary(
+			    const Memory::uint8Array &dictionary);
+
+			/**
+			 * @brief
+			 * Obtain the dictionary in use.
+			 *
+			 * @return
+			 *	Dictionary in use, or an empty buffer if no
+			 *	dictionary has been set.
+			 */
+			virtual Memory::uint8Array
+			getDictionary()
+			    const;
 
 			/**
 			 * @brief
@@ -385,6 +529,8 @@ namespace BiometricEvaluation
 			 *
 			 * @throw Error::ObjectDoesNotExist
 			 *	Invalid compressor type.
+			 * @throw Error::NotImplemented
+			 *	Support for compressorKind was not built.
 			 */
 			static std::shared_ptr<Compressor>
 			createCompressor(
@@ -119,12 +119,18 @@ namespace BiometricEvaluation {
 			    const std::string &key)
 			    override;
 
+			std::unique_ptr<RecordStore::Cursor> makeReader()
+			    const
+			    override;
+
 			void move(
 			    const std::string &pathname)
 			    override;
 
 			uint64_t getSpaceUsed() const override;
 			void sync() const override;
+			void beginBulk() override;
+			void commitBulk() override;
 			unsigned int getCount() const override;
 			std::string getPathname() const override;
 			std::string getDescription() const override;
@@ -93,6 +93,21 @@ namespace BiometricEvaluation
 			    const Memory::uint8Array &compressedData)
 			    const;
 
+			void
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const;
+
+			Memory::uint8Array
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint64_t uncompressedDataSize)
+			    const;
+
 			Memory::uint8Array
 			decompress(
 			    const std::string &input)
@@ -201,6 +216,25 @@ namespace BiometricEvaluation
 			z_stream
 			initDecompressionStream()
 			    const;
+
+			/**
+			 * @brief
+			 * Obtain this thread's reusable decompression stream.
+			 * @details
+			 * The stream is initialized on first use by a
+			 * thread and reset on later uses, avoiding a new
+			 * allocation of inflate state for each buffer.  The
+			 * stream is released when the thread exits.
+			 *
+			 * @return
+			 *	Reset zlib stream, ready to inflate.
+			 *
+			 * @throw Error::StrategyError
+			 *	Could not initialize or reset the stream.
+			 */
+			z_stream&
+			getReusableDecompressionStream()
+			    const;
 			    
 			/**
 			 * @brief
@@ -122,6 +122,11 @@ namespace BiometricEvaluation
 			    const std::string &key)
 			    override;
 
+			std::unique_ptr<RecordStore::Cursor>
+			makeReader()
+			    const
+			    override;
+
 			void
 			move(
 			    const std::string &pathname)
@@ -0,0 +1,106 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IO_LZ4__
+#define __BE_IO_LZ4__
+
+#include <string>
+
+#include <be_io_compressor.h>
+#include <be_memory_autoarray.h>
+
+namespace BiometricEvaluation
+{
+	namespace IO
+	{
+		/**
+		 * @brief
+		 * An IO::Compressor for LZ4 compression from liblz4.
+		 * @details
+		 * Data is compressed into a single LZ4 frame that records
+		 * the decompressed size.  LZ4 trades compression ratio for
+		 * very fast compression and decompression.
+		 */
+		class LZ4 : public Compressor
+		{
+		public:
+			/*
+			 * LZ4 compressor property keys.
+			 */
+			/**
+			 * How thorough the compression should be.  0 is
+			 * the fast default, 3 and above use LZ4 HC.
+			 */
+			static const std::string COMPRESSION_LEVEL;
+
+			LZ4();
+
+			/*
+			 * We need the remaining base class variants as well,
+			 * otherwise they are hidden by the declarations below.
+			 */
+			using Compressor::compress;
+			using Compressor::decompress;
+
+			Memory::uint8Array
+			compress(
+			    const uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const override;
+
+			Memory::uint8Array
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize)
+			    const override;
+
+			void
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const override;
+
+			~LZ4();
+
+			/**
+			 * @brief
+			 * Copy constructor (disabled).
+			 * @details
+			 * Disabled because Properties member of parent cannot
+			 * be copied.
+			 *
+			 * @param other
+			 *	LZ4 to copy.
+			 */
+			LZ4(
+			    const LZ4 &other) = delete;
+
+			/**
+			 * @brief
+			 * Assignment overload (disabled).
+			 * @details
+			 * Disabled because Properties member of parent cannot
+			 * be assigned.
+			 *
+			 * @param other
+			 *	LZ4 to assign.
+			 *
+			 * @return
+			 *	lhs LZ4.
+			 */
+			LZ4&
+			operator=(
+			    const LZ4& other) = delete;
+		};
+	}
+}
+#endif /* __BE_IO_LZ4__ */
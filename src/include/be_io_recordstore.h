@@ -328,6 +328,68 @@ namespace BiometricEvaluation {
 			virtual void flush(
 			    const std::string &key) const = 0;
 
+			/**
+			 * @brief
+			 * Begin a bulk update of the RecordStore.
+			 * @details
+			 * Until commitBulk() is called, implementations may
+			 * defer work that is otherwise done for every
+			 * insert() and remove(), such as updating the record
+			 * count in the control file, committing a database
+			 * transaction, or appending to an index. Records
+			 * inserted during a bulk update can be read before
+			 * commitBulk() is called, but are not guaranteed to
+			 * be persistent until it returns. Bulk updates
+			 * cannot be nested.
+			 *
+			 * The default implementation does nothing.
+			 *
+			 * @throw Error::StrategyError
+			 *	The RecordStore was opened read-only, a bulk
+			 *	update is already in progress, or an error
+			 *	occurred when using the underlying storage
+			 *	system.
+			 */
+			virtual void beginBulk();
+
+			/**
+			 * @brief
+			 * Complete a bulk update of the RecordStore.
+			 * @details
+			 * All work deferred since beginBulk() is performed.
+			 *
+			 * The default implementation does nothing.
+			 *
+			 * @throw Error::StrategyError
+			 *	No bulk update is in progress, or an error
+			 *	occurred when using the underlying storage
+			 *	system.
+			 */
+			virtual void commitBulk();
+
+			/**
+			 * @brief
+			 * Insert a set of records into the RecordStore.
+			 * @details
+			 * The records are inserted within a single bulk
+			 * update (see beginBulk()). If an insert fails, the
+			 * records inserted before it remain in the store and
+			 * the bulk update is committed before the exception
+			 * is rethrown.
+			 *
+			 * @param[in] records
+			 *	The records to insert.
+			 * @throw Error::ObjectExists
+			 *	A record with a given key is already present.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system, or a bulk update is already
+			 *	in progress.
+			 */
+			virtual void
+			insertBatch(
+			    const std::vector<Record> &records);
+
 			/** Tell sequence() to sequence from beginning */
 			static const int BE_RECSTORE_SEQ_START = 1;
 			/** Tell sequence to sequence from current position */
@@ -409,6 +471,83 @@ namespace BiometricEvaluation {
 			virtual void setCursorAtKey(
 			    const std::string &key) = 0;
 
+			/**
+			 * @brief
+			 * An independent position within a RecordStore.
+			 * @details
+			 * A Cursor sequences through and reads the records
+			 * of the RecordStore that created it (see
+			 * makeReader()) without moving the RecordStore's own
+			 * sequence position or that of any other Cursor.
+			 * Each Cursor owns the handles it reads with, so
+			 * several Cursors over one RecordStore may be used
+			 * concurrently, each by one thread at a time.
+			 *
+			 * A Cursor must not outlive the RecordStore that
+			 * created it, and must not be used while the
+			 * RecordStore is being modified.  Records inserted
+			 * or removed after the Cursor was created may or
+			 * may not be visible to it.
+			 */
+			class Cursor
+			{
+			public:
+				/** See RecordStore::sequence() */
+				virtual RecordStore::Record
+				sequence(
+				    int cursor = BE_RECSTORE_SEQ_NEXT) = 0;
+
+				/** See RecordStore::sequenceKey() */
+				virtual std::string
+				sequenceKey(
+				    int cursor = BE_RECSTORE_SEQ_NEXT) = 0;
+
+				/** See RecordStore::setCursorAtKey() */
+				virtual void
+				setCursorAtKey(
+				    const std::string &key) = 0;
+
+				/** See RecordStore::read() */
+				virtual Memory::uint8Array
+				read(
+				    const std::string &key)
+				    const = 0;
+
+				/** See RecordStore::length() */
+				virtual uint64_t
+				length(
+				    const std::string &key)
+				    const = 0;
+
+				virtual ~Cursor() = default;
+			};
+
+			/**
+			 * @brief
+			 * Obtain a new, independent Cursor over this
+			 * RecordStore.
+			 * @details
+			 * The Cursor starts before the first record.  Cursors
+			 * let several threads scan ranges of keys or read
+			 * random records of one RecordStore concurrently,
+			 * which the RecordStore's own methods do not allow.
+			 *
+			 * The default implementation throws
+			 * Error::NotImplemented.
+			 *
+			 * @return
+			 *	A Cursor, which must not outlive this object.
+			 * @throw Error::NotImplemented
+			 *	This kind of RecordStore does not support
+			 *	Cursors.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			virtual std::unique_ptr<Cursor>
+			makeReader()
+			    const;
+
 			/**
 			 * @brief
 			 * Determines whether the RecordStore contains an
@@ -546,10 +685,15 @@ namespace BiometricEvaluation {
 			 *	to determine whether to interrupt and return.
 			 *
 			 * @throw Error::ObjectExists
-			 *	A RecordStore at mergePathname already exists.
+			 *	A RecordStore at mergePathname already exists,
+			 *	or a key exists in more than one RecordStore.
 			 * @throw Error::StrategyError
 			 *	An error occurred when using the underlying
 			 *	storage system.
+			 *
+			 * @note
+			 * Equivalent to calling the MergeOrder variant with
+			 * MergeOrder::Unordered.
 			 */
 			static void mergeRecordStores(
 			    const std::string &mergePathname,
@@ -559,6 +703,69 @@ namespace BiometricEvaluation {
 			    const std::function<bool()> &interrupt = 
 				[]() {return (false);});
 
+			/** Order of records inserted by mergeRecordStores() */
+			enum class MergeOrder
+			{
+				/** Records from all stores are interleaved */
+				Unordered,
+				/** Records are inserted in ascending key order */
+				Sorted
+			};
+
+			/**
+			 * @brief
+			 * Create a new RecordStore that contains the contents
+			 * of several other RecordStores.
+			 * @details
+			 * The source RecordStores are read concurrently by
+			 * separate threads, and their records are inserted
+			 * into the new RecordStore within a single bulk
+			 * update (see beginBulk()).
+			 *
+			 * When order is MergeOrder::Sorted, records are
+			 * inserted in ascending key order by merging the
+			 * sources' records.  Sources whose keys are already
+			 * sequenced in order (such as DBRecordStores) are
+			 * streamed; the keys of other sources are sorted
+			 * before their records are read.  Whether the order
+			 * is preserved when sequencing the new RecordStore
+			 * depends on its kind.
+			 *
+			 * @param[in] mergePathname
+			 *	The path name of the new RecordStore that
+			 *	will be created.
+			 * @param[in] description
+			 *	The text used to describe the new RecordStore.
+			 * @param[in] kind
+			 *	The kind of the new, merged RecordStore.
+			 * @param[in] pathnames
+			 *	Vector of path names to RecordStores to open.
+			 *	These are the RecordStores that will be merged
+			 *	to create the new RecordStore.
+			 * @param[in] order
+			 *	Order in which records are inserted.
+			 * @param[in] interrupt
+			 *	A function to be called after each batch of
+			 *	records is inserted to determine whether to
+			 *	interrupt and return.  Records inserted before
+			 *	the interruption remain in the new RecordStore.
+			 *
+			 * @throw Error::ObjectExists
+			 *	A RecordStore at mergePathname already exists,
+			 *	or a key exists in more than one RecordStore.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			static void mergeRecordStores(
+			    const std::string &mergePathname,
+			    const std::string &description,
+			    const IO::RecordStore::Kind &kind,
+			    const std::vector<std::string> &pathnames,
+			    const MergeOrder order,
+			    const std::function<bool()> &interrupt = 
+				[]() {return (false);});
+
 			class Impl;
 		protected:
 		private:
@@ -573,8 +780,11 @@ namespace BiometricEvaluation {
 		 * Modifying a non-const iterator does not manipulate the
 		 * underlying RecordStore.
 		 * @note
-		 * This generic iterator provides no optimization over
-		 * RecordStore::sequence().
+		 * An iterator obtained from begin() reads through its own
+		 * RecordStore::Cursor when the RecordStore supports them,
+		 * so iterators from separate calls to begin() do not
+		 * affect each other or the RecordStore's sequence().
+		 * Copies of an iterator share its position.
 		 */
 		class RecordStoreIterator
 		{
@@ -735,6 +945,11 @@ namespace BiometricEvaluation {
 			bool _atEnd{true};
 			/** Current record returned when dereferencing */
 			value_type _currentRecord{};
+			/**
+			 * Position within _recordStore, or nullptr to use
+			 * the RecordStore's own sequence position.
+			 */
+			std::shared_ptr<RecordStore::Cursor> _cursor{};
 
 			/** Iterate the first object. */
 			void
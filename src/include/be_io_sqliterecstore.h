@@ -11,6 +11,9 @@
 #ifndef __BE_IO_SQLITERECORDSTORE_H__
 #define __BE_IO_SQLITERECORDSTORE_H__
 
+#include <cstdint>
+#include <string>
+
 #include <be_io_recordstore.h>
 
 namespace BiometricEvaluation
@@ -25,6 +28,38 @@ namespace BiometricEvaluation
 		class SQLiteRecordStore : public RecordStore
 		{
 		public:
+			/**
+			 * @brief
+			 * Optional SQLite settings for a store.
+			 * @details
+			 * The profile is kept in the store's properties and
+			 * applied each time the store is opened. Members
+			 * left at their default values are not applied.
+			 */
+			struct PragmaProfile
+			{
+				/**
+				 * journal_mode: DELETE, TRUNCATE, PERSIST,
+				 * MEMORY, WAL, or OFF. Only applied when the
+				 * store is opened read/write.
+				 */
+				std::string journalMode{};
+				/** mmap_size, in bytes */
+				uint64_t mmapSize{0};
+				/**
+				 * cache_size, in pages if positive or in
+				 * KiB if negative.
+				 */
+				int64_t cacheSize{0};
+			};
+
+			/** Property holding PragmaProfile::journalMode */
+			static const std::string JOURNAL_MODE_PROPERTY;
+			/** Property holding PragmaProfile::mmapSize */
+			static const std::string MMAP_SIZE_PROPERTY;
+			/** Property holding PragmaProfile::cacheSize */
+			static const std::string CACHE_SIZE_PROPERTY;
+
 			SQLiteRecordStore(
 			    const std::string &pathname,
 			    const std::string &description);
@@ -46,6 +81,8 @@ namespace BiometricEvaluation
 			    override;
 
 			void sync() const override;
+			void beginBulk() override;
+			void commitBulk() override;
 			unsigned int getCount() const override;
 			std::string getPathname() const override;
 			std::string getDescription() const override;
@@ -97,6 +134,43 @@ namespace BiometricEvaluation
 			    const std::string &key)
 			    override;
 
+			std::unique_ptr<RecordStore::Cursor>
+			makeReader()
+			    const
+			    override;
+
+			/**
+			 * @brief
+			 * Set the SQLite settings for this store.
+			 * @details
+			 * The profile is applied immediately and saved in
+			 * the store's properties, replacing any previous
+			 * profile.
+			 *
+			 * @param[in] profile
+			 *	Settings to apply.
+			 *
+			 * @throw Error::StrategyError
+			 *	The store was opened read-only, the profile
+			 *	is invalid, or the settings could not be
+			 *	applied.
+			 */
+			void
+			setPragmaProfile(
+			    const PragmaProfile &profile);
+
+			/**
+			 * @return
+			 *	The SQLite settings saved for this store.
+			 *
+			 * @throw Error::StrategyError
+			 *	A saved setting could not be parsed, or is
+			 *	not valid.
+			 */
+			PragmaProfile
+			getPragmaProfile()
+			    const;
+
 			~SQLiteRecordStore();
 
 			SQLiteRecordStore(const SQLiteRecordStore&) = delete;
@@ -0,0 +1,189 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifndef __BE_IO_ZSTD__
+#define __BE_IO_ZSTD__
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <be_io_compressor.h>
+#include <be_memory_autoarray.h>
+
+namespace BiometricEvaluation
+{
+	namespace IO
+	{
+		/**
+		 * @brief
+		 * An IO::Compressor for Zstandard compression from libzstd.
+		 * @details
+		 * Data is compressed into a single Zstandard frame that
+		 * records the decompressed size.  A dictionary trained from
+		 * samples of similar data can substantially improve the
+		 * compression of small records.  Frames record the ID of
+		 * the dictionary used to compress them, so data compressed
+		 * without a dictionary can still be decompressed after a
+		 * dictionary has been set.
+		 */
+		class Zstd : public Compressor
+		{
+		public:
+			/*
+			 * Zstandard compressor property keys.
+			 */
+			/** How thorough the compression should be */
+			static const std::string COMPRESSION_LEVEL;
+
+			Zstd();
+
+			/*
+			 * We need the remaining base class variants as well,
+			 * otherwise they are hidden by the declarations below.
+			 */
+			using Compressor::compress;
+			using Compressor::decompress;
+
+			Memory::uint8Array
+			compress(
+			    const uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const override;
+
+			Memory::uint8Array
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize)
+			    const override;
+
+			void
+			decompress(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize,
+			    uint8_t *const uncompressedData,
+			    uint64_t uncompressedDataSize)
+			    const override;
+
+			bool
+			supportsDictionaries()
+			    const override;
+
+			Memory::uint8Array
+			trainDictionary(
+			    const std::vector<Memory::uint8Array> &samples,
+			    uint64_t maxDictionarySize =
+			    DEFAULT_DICTIONARY_SIZE)
+			    const override;
+
+			void
+			setDictionary(
+			    const Memory::uint8Array &dictionary)
+			    override;
+
+			Memory::uint8Array
+			getDictionary()
+			    const override;
+
+			~Zstd();
+
+			/**
+			 * @brief
+			 * Copy constructor (disabled).
+			 * @details
+			 * Disabled because Properties member of parent cannot
+			 * be copied.
+			 *
+			 * @param other
+			 *	Zstd to copy.
+			 */
+			Zstd(
+			    const Zstd &other) = delete;
+
+			/**
+			 * @brief
+			 * Assignment overload (disabled).
+			 * @details
+			 * Disabled because Properties member of parent cannot
+			 * be assigned.
+			 *
+			 * @param other
+			 *	Zstd to assign.
+			 *
+			 * @return
+			 *	lhs Zstd.
+			 */
+			Zstd&
+			operator=(
+			    const Zstd& other) = delete;
+
+		private:
+			/** Digested dictionary, opaque outside libzstd */
+			struct Dictionary;
+
+			/** Dictionary in use, if any */
+			std::shared_ptr<Dictionary> _dictionary;
+			/** Protects _dictionary */
+			mutable std::mutex _dictionaryMutex;
+
+			/**
+			 * @brief
+			 * Obtain the dictionary in use.
+			 *
+			 * @return
+			 *	Dictionary in use, or nullptr.
+			 */
+			std::shared_ptr<Dictionary>
+			currentDictionary()
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain the dictionary needed by a frame.
+			 *
+			 * @param dictID
+			 *	Dictionary ID recorded in the frame.
+			 *
+			 * @return
+			 *	Dictionary in use.
+			 *
+			 * @throw Error::StrategyError
+			 *	The dictionary in use is not dictID.
+			 */
+			std::shared_ptr<Dictionary>
+			frameDictionary(
+			    unsigned int dictID)
+			    const;
+
+			/**
+			 * @brief
+			 * Decompress a frame of unrecorded size.
+			 *
+			 * @param compressedData
+			 *	Compressed data buffer to decompress.
+			 * @param compressedDataSize
+			 *	Size of compressedData.
+			 *
+			 * @return
+			 *	Decompressed data.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error in decompression unit.
+			 */
+			Memory::uint8Array
+			decompressStream(
+			    const uint8_t *const compressedData,
+			    uint64_t compressedDataSize)
+			    const;
+		};
+	}
+}
+#endif /* __BE_IO_ZSTD__ */
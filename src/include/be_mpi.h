@@ -145,7 +145,14 @@ namespace BiometricEvaluation {
 			 * normal control/data messaging cannot
 			 * be used.
 			 */
-			OOB = 2
+			OOB = 2,
+			/**
+			 * @brief
+			 * The number of elements processed by a task,
+			 * and the time taken, sent with each request
+			 * for a work package.
+			 */
+			Report = 3
 		};
 
 		/** Storage type for MessageTag. */
@@ -75,6 +75,8 @@ namespace BiometricEvaluation
 			checkpointSave(const std::string &reason);
 			void
 			checkpointRestore();
+			void
+			workPackageSent(const MPI::WorkPackage &workPackage);
 
 		private:
 			std::unique_ptr<MPI::CSVResources> _resources;
@@ -28,7 +28,10 @@ namespace BiometricEvaluation
 		public:
 			/** Text file to read */
 			static const std::string INPUTCSVPROPERTY;
-			/** Number of lines sent in succession */
+			/**
+			 * Number of lines sent in succession, initially
+			 * when TARGETCHUNKTIMEPROPERTY is present
+			 */
 			static const std::string CHUNKSIZEPROPERTY;
 			/** Read file into buffer first, or read from file */
 			static const std::string USEBUFFERPROPERTY;
@@ -10,9 +10,14 @@
 #ifndef _BE_MPI_DISTRIBUTOR_H
 #define _BE_MPI_DISTRIBUTOR_H
 
+#include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <be_error_exception.h>
 #include <be_io_logsheet.h>
@@ -44,6 +49,24 @@ namespace BiometricEvaluation {
 		 * written to that sheet. Otherwise, log messages will be 
 		 * written to a Null Logsheet.
 		 *
+		 * Unless the Work Package Queue Depth property is 0, work
+		 * packages are created ahead of requests by a thread of
+		 * the Distributor task, and kept in a queue of that depth.
+		 * Work packages are sent without waiting for Receivers to
+		 * accept them, so that requests from several Receivers are
+		 * serviced at once. The depth of the queue when each
+		 * package was requested, and the time spent waiting for a
+		 * package to be created, are logged.
+		 *
+		 * With each request for a work package, Receivers report
+		 * the time their workers took to process work packages.
+		 * When the Target Chunk Time property is present, the
+		 * number of elements in a work package is chosen so that
+		 * a worker takes about that long to process it, and
+		 * reduced toward the end of the input so that workers
+		 * finish together (guided self-scheduling). Reported
+		 * throughput and chosen sizes are logged.
+		 *
 		 * @see IO::Properties
 		 * @see MPI::Receiver
 		 * @see MPI::WorkPackage
@@ -99,7 +122,15 @@ namespace BiometricEvaluation {
 			 * @details
 			 * Implementations of this class create a work package
 			 * to encapsulate the specific data type that is to
-			 * be distributed.
+			 * be distributed. A work package with no elements
+			 * indicates that there is no more work.
+			 * @note
+			 * When work packages are queued, this method is
+			 * called from a thread other than the one calling
+			 * the other methods of this class, but never while
+			 * checkpointSave() or checkpointRestore() is being
+			 * called. Writing to getLogsheet() from this method
+			 * is safe.
 			 */
 			virtual void createWorkPackage(
 			    MPI::WorkPackage &workPackage) = 0;
@@ -133,6 +164,48 @@ namespace BiometricEvaluation {
 			 */
 			virtual void checkpointRestore() = 0;
 
+			/**
+			 * @brief
+			 * Note that a work package has been sent.
+			 * @details
+			 * Work packages can be created well before they are
+			 * sent, so implementations that checkpoint update
+			 * their checkpoint state here, from the last key and
+			 * number of input elements recorded in the work
+			 * package, rather than in createWorkPackage().
+			 * The default implementation does nothing.
+			 * @param[in] workPackage
+			 * The work package that was sent.
+			 */
+			virtual void workPackageSent(
+			    const MPI::WorkPackage &workPackage);
+
+			/**
+			 * @brief
+			 * Obtain the number of elements to place in the
+			 * next work package.
+			 * @details
+			 * Implementations of createWorkPackage() call this
+			 * method to size the work package when the Target
+			 * Chunk Time property is present. The size is the
+			 * number of elements processed in that time, based
+			 * on times reported by Receivers, and no more than
+			 * an even share of the remaining elements for each
+			 * worker. The chunk size is used until times have
+			 * been reported.
+			 * @param[in] chunkSize
+			 * The configured chunk size.
+			 * @param[in] remaining
+			 * The number of elements not yet distributed.
+			 * @return
+			 * The number of elements for the next work package,
+			 * at least 1 and at most remaining, or chunkSize
+			 * if sizes are not adapted.
+			 */
+			uint64_t getWorkPackageSize(
+			    const uint64_t chunkSize,
+			    const uint64_t remaining) const;
+
 			/**
 		 	 * @brief
 			 * Get access to the Logsheet object.
@@ -163,11 +236,78 @@ namespace BiometricEvaluation {
 			/**
 			* @brief
 			* Send a single work package to a task.
+			* @details
+			* The Continue command and the work package are sent
+			* without waiting for the task to receive them.
 			*/
 			void sendWorkPackage(
 			    MPI::WorkPackage &workPackage,
 			    int MPITask);
 
+			/**
+			 * @brief
+			 * Wait for the work packages sent to tasks to
+			 * be received.
+			 * @param[in] wait
+			 * Whether to wait, or only release the sends that
+			 * have completed.
+			 */
+			void completeWorkPackageSends(
+			    bool wait);
+
+			/**
+			 * @brief
+			 * Receive the report sent by a task with a request
+			 * for a work package.
+			 * @param[in] MPITask
+			 * The task that requested a work package.
+			 */
+			void receiveReport(
+			    int MPITask);
+
+			/**
+			 * @brief
+			 * Obtain the next work package to distribute.
+			 * @param[out] workPackage
+			 * The next work package.
+			 * @return
+			 * Whether there is work to distribute.
+			 */
+			bool nextWorkPackage(
+			    std::unique_ptr<MPI::WorkPackage> &workPackage);
+
+			/**
+			 * @brief
+			 * Start creating work packages ahead of requests.
+			 */
+			void startWorkPackageQueue();
+
+			/**
+			 * @brief
+			 * Stop creating work packages ahead of requests.
+			 * @details
+			 * Work packages already created remain queued.
+			 */
+			void stopWorkPackageQueue();
+
+			/**
+			 * @brief
+			 * Write a log message while work packages may be
+			 * created by another thread.
+			 * @param[in] message
+			 * The log message.
+			 */
+			void writeLog(
+			    const std::string &message);
+
+			/**
+			 * @brief
+			 * Write the log messages deferred by writeLog().
+			 * @note
+			 * Caller must hold _logMutex.
+			 */
+			void flushLog();
+
 			/**
 			 * @brief
 			 * Shut down all MPI processing.
@@ -184,6 +324,32 @@ namespace BiometricEvaluation {
 
 			std::shared_ptr<IO::Logsheet> _logsheet;
 			std::shared_ptr<IO::PropertiesFile> _checkpointData;
+
+			/* Work packages created ahead of requests */
+			class WorkPackageQueue;
+			std::unique_ptr<WorkPackageQueue> _workPackageQueue;
+			std::thread _workPackageProducer;
+
+			/* Work packages being sent, by task */
+			class WorkPackageSend;
+			std::map<int, std::unique_ptr<WorkPackageSend>>
+			    _workPackageSends;
+
+			/* Workers of all tasks accepting work */
+			uint64_t _numWorkers{1};
+			/* Elements per work package to meet target time */
+			std::atomic<uint64_t> _adaptedChunkSize{0};
+			/* Estimated microseconds to process an element */
+			double _elementTime{0};
+			/* Elements reported processed, and time taken */
+			uint64_t _reportedElements{0};
+			uint64_t _reportedTime{0};
+
+			/* Serializes use of _logsheet across threads */
+			std::mutex _logMutex;
+			/* Log messages waiting for _logMutex */
+			std::vector<std::string> _pendingLog;
+			std::mutex _pendingLogMutex;
 		};
 	}
 }
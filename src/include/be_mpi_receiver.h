@@ -47,6 +47,14 @@ namespace BiometricEvaluation {
 		 * file, each named after the ID of the MPI task created by
 		 * the MPI runtime, and the child process created by Receiver.
 		 *
+		 * Work packages are handed to worker processes through
+		 * shared memory created before the workers are started,
+		 * one buffer per worker and one for the package being
+		 * received, sized by the Shared Package Buffer Size
+		 * property. Only small control messages are written to
+		 * the pipes between the Receiver and its workers, except
+		 * for work packages too large for a buffer.
+		 *
 		 * @see IO::Properties
 		 * @see IO::Logsheet
 		 * @see MPI::Distributor
@@ -91,9 +99,32 @@ namespace BiometricEvaluation {
 		protected:
 
 		private:
+			/*
+			 * Shared memory buffers holding work packages for
+			 * workers, defined in the implementation.
+			 */
+			class PackageBuffers;
+
 			MPI::TaskStatus requestWorkPackages();
-			void sendWorkPackage(MPI::WorkPackage &workPackage);
+
+			/*
+			 * Hand a work package to the next worker asking for
+			 * one. When buffer is not PackageBuffers::None, the
+			 * package data is in that shared buffer, which is
+			 * released once the worker is done with it.
+			 */
+			void sendWorkPackage(
+			    MPI::WorkPackage &workPackage,
+			    const uint64_t buffer);
 			void startWorkers();
+
+			/*
+			 * Account for the latency, in microseconds, of a
+			 * worker's request for a work package, as reported
+			 * in its next status message. 0 means no request
+			 * was answered.
+			 */
+			void recordLatency(const uint64_t latency);
 			void shutdown(
 			    const MPI::TaskStatus &status,
 			    const std::string &reason);
@@ -106,6 +137,25 @@ namespace BiometricEvaluation {
 			std::shared_ptr<MPI::Resources> _resources;
 			std::shared_ptr<IO::Logsheet> _logsheet;
 
+			/*
+			 * Elements processed by workers since the last
+			 * request for a work package, and the time taken,
+			 * in microseconds.
+			 */
+			uint64_t _reportedElements{0};
+			uint64_t _reportedTime{0};
+
+			/*
+			 * Work package requests answered, and their total
+			 * and maximum latency, in microseconds.
+			 */
+			uint64_t _requests{0};
+			uint64_t _totalLatency{0};
+			uint64_t _maxLatency{0};
+
+			/* Shared with workers; null when pipes are used */
+			std::shared_ptr<PackageBuffers> _packageBuffers{};
+
 			/*
 			 * Declare the class that implements process worker.
 			 */
@@ -116,7 +166,9 @@ namespace BiometricEvaluation {
 				const std::shared_ptr<MPI::WorkPackageProcessor>
 				    &workPackageProcessor,
 				const std::shared_ptr<MPI::Resources>
-				    &resources);
+				    &resources,
+				const std::shared_ptr<PackageBuffers>
+				    &packageBuffers);
 					
 			    int32_t workerMain();
 
@@ -128,6 +180,7 @@ namespace BiometricEvaluation {
 				    _workPackageProcessor;
 				std::shared_ptr<MPI::Resources> _resources;
 				std::shared_ptr<IO::Logsheet> _logsheet;
+				std::shared_ptr<PackageBuffers> _packageBuffers;
 			};
 		};
 	}
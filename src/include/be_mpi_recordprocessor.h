@@ -37,7 +37,11 @@ namespace BiometricEvaluation {
 			 * key is delivered as part of a work package.
 			 * When both key and value are part of the work
 			 * package, there is no need to have access to the
-			 * source record store.
+			 * source record store. When the Distribute Key
+			 * Ranges property is true, work packages name
+			 * ranges of keys, and the records are read from
+			 * the source record store, which must then be
+			 * accessible.
 			 * @note
 			 * The size of a single value item is limited to
 			 * 2^32 octets. If the size of the value item is
@@ -112,8 +116,30 @@ namespace BiometricEvaluation {
 			std::shared_ptr<MPI::RecordStoreResources>
 			     getResources();
 		private:
+			/**
+			 * @brief
+			 * Process the records of a work package naming a
+			 * range of keys.
+			 *
+			 * @param[in] packageData
+			 * Contents of the work package.
+			 * @param[in] numElements
+			 * Number of records in the range.
+			 *
+			 * @throw Error::Exception
+			 * The source record store is not accessible, or
+			 * processRecord() asked for termination.
+			 */
+			void processKeyRange(
+			    const Memory::uint8Array &packageData,
+			    const uint64_t numElements);
+
 			std::shared_ptr<MPI::RecordStoreResources>
 			     _resources;
+			/** Reader of the source record store, when supported */
+			std::unique_ptr<IO::RecordStore::Cursor> _cursor{};
+			/** Whether _cursor has been created or found missing */
+			bool _checkedCursor{false};
 		};
 	}
 }
@@ -81,13 +81,17 @@ namespace BiometricEvaluation {
 			createWorkPackage(MPI::WorkPackage &workPackage);
 			void checkpointSave(const std::string &reason);
 			void checkpointRestore();
+			void workPackageSent(
+			    const MPI::WorkPackage &workPackage);
 
 		private:
 			std::unique_ptr<MPI::RecordStoreResources>
 			    _resources;
 			uint64_t _recordsRemaining;
 			bool _includeValues;
+			/* Last key and number of keys sent to tasks */
 			std::string _lastDistributedKey{};
+			uint64_t _distributedKeyCount{0};
 		};
 	}
 }
@@ -35,8 +35,23 @@ namespace BiometricEvaluation {
 			/**
 			 * @brief
 			 * The property string ``Chunk Size''; required.
+			 * @details
+			 * The number of records in a work package, or in
+			 * the first work packages when the Target Chunk
+			 * Time property is present.
 			 */
 			static const std::string CHUNKSIZEPROPERTY;
+			/**
+			 * @brief
+			 * The property string ``Distribute Key Ranges'';
+			 * optional, false by default.
+			 * @details
+			 * When true, work packages name a range of keys
+			 * instead of carrying each key, and every rank
+			 * reads the records of its ranges from its own
+			 * copy of the input record store.
+			 */
+			static const std::string KEYRANGESPROPERTY;
 
 			/**
 			 * @brief
@@ -74,6 +89,15 @@ namespace BiometricEvaluation {
 
 			uint32_t getChunkSize() const;
 
+			/**
+			 * @brief
+			 * Whether work packages name ranges of keys.
+			 *
+			 * @return
+			 * Value of KEYRANGESPROPERTY, or false when absent.
+			 */
+			bool distributeKeyRanges() const;
+
 			/**
 			 * @brief
 			 * Indicator that a record store has been opened.
@@ -93,6 +117,7 @@ namespace BiometricEvaluation {
 
 		private:
 			uint32_t _chunkSize;
+			bool _distributeKeyRanges{false};
 			std::shared_ptr<IO::RecordStore> _recordStore{};
 		};
 	}
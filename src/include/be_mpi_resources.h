@@ -10,6 +10,7 @@
 #ifndef _BE_MPI_RESOURCES_H
 #define _BE_MPI_RESOURCES_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -73,6 +74,56 @@ namespace BiometricEvaluation {
 			 */
 			static const std::string CHECKPOINTPATHPROPERTY;
 
+			/**
+			 * @brief
+			 * The property string "Work Package Queue Depth";
+			 * optional.
+			 * @details
+			 * The number of work packages the Distributor
+			 * creates ahead of requests from Receivers. A value
+			 * of 0 creates each work package when it is
+			 * requested. The default is one work package for
+			 * each Receiver task, and at least two.
+			 */
+			static const std::string WORKPACKAGEQUEUEDEPTHPROPERTY;
+
+			/**
+			 * @brief
+			 * The property string "Target Chunk Time"; optional.
+			 * @details
+			 * When present, the number of milliseconds a worker
+			 * should take to process a work package. The size of
+			 * work packages is adapted to the processing times
+			 * reported by Receivers, and the Chunk Size is only
+			 * the size of the first work packages.
+			 */
+			static const std::string TARGETCHUNKTIMEPROPERTY;
+
+			/**
+			 * @brief
+			 * The property string "Maximum Chunk Size"; optional.
+			 * @details
+			 * The largest size of a work package when the Target
+			 * Chunk Time is present. By default, size is limited
+			 * only by the number of elements remaining.
+			 */
+			static const std::string MAXCHUNKSIZEPROPERTY;
+
+			/**
+			 * @brief
+			 * The property string "Shared Package Buffer Size";
+			 * optional.
+			 * @details
+			 * The size, in octets, of the shared memory each
+			 * Receiver reserves for every work package it hands
+			 * to a worker process. Work packages that fit are
+			 * received directly into shared memory instead of
+			 * being written through a pipe. A value of 0 sends
+			 * all work packages through pipes. The default is
+			 * 4 MiB.
+			 */
+			static const std::string SHAREDPACKAGESIZEPROPERTY;
+
 			/**
 			 * @brief
 			 * Obtain the list of required properties.
@@ -138,6 +189,45 @@ namespace BiometricEvaluation {
 			 */
 			std::string getCheckpointPath() const;
 
+			/**
+			 * @brief
+			 * Obtain the number of work packages to create
+			 * ahead of requests.
+			 * @return
+			 * The Work Package Queue Depth.
+			 */
+			uint32_t getWorkPackageQueueDepth() const;
+
+			/**
+			 * @brief
+			 * Obtain the time a worker should take to process
+			 * a work package.
+			 * @return
+			 * The Target Chunk Time, in milliseconds, or 0 if
+			 * work package sizes are not adapted.
+			 */
+			uint32_t getTargetChunkTime() const;
+
+			/**
+			 * @brief
+			 * Obtain the largest size of an adapted work
+			 * package.
+			 * @return
+			 * The Maximum Chunk Size, or 0 if there is no
+			 * maximum.
+			 */
+			uint32_t getMaximumChunkSize() const;
+
+			/**
+			 * @brief
+			 * Obtain the size of the shared memory reserved
+			 * for each work package handed to a worker.
+			 * @return
+			 * The Shared Package Buffer Size, in octets, or 0
+			 * if work packages are sent through pipes.
+			 */
+			uint64_t getSharedPackageSize() const;
+
 			~Resources();
 
 			int getRank() const;
@@ -151,6 +241,10 @@ namespace BiometricEvaluation {
 			int _workersPerNode;
 			std::string _logsheetURL;
 			std::string _checkpointPath;
+			uint32_t _workPackageQueueDepth;
+			uint32_t _targetChunkTime;
+			uint32_t _maximumChunkSize;
+			uint64_t _sharedPackageSize;
 		};
 	}
 }
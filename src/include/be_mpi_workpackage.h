@@ -10,6 +10,8 @@
 #ifndef _BE_MPI_WORKPACKAGE_H
 #define _BE_MPI_WORKPACKAGE_H
 
+#include <string>
+
 #include <be_memory_autoarray.h>
 
 namespace BiometricEvaluation {
@@ -83,10 +85,56 @@ namespace BiometricEvaluation {
 			 */
 			void setNumElements(const uint64_t numElements);
 
+			/**
+		 	 * @brief
+			 * Obtain the key of the last element taken from
+			 * the input for this package.
+			 * @details
+			 * Distributors record this so a checkpoint can
+			 * describe only the work packages actually sent.
+			 * @return
+			 * The last key, empty if not set.
+			 */
+			std::string getLastKey() const;
+
+			/**
+		 	 * @brief
+			 * Set the key of the last element taken from the
+			 * input for this package.
+			 * @param[in] lastKey
+			 * The last key.
+			 */
+			void setLastKey(const std::string &lastKey);
+
+			/**
+		 	 * @brief
+			 * Obtain the number of input elements consumed
+			 * to create the package.
+			 * @details
+			 * This can exceed the number of elements in the
+			 * package when some input could not be read.
+			 * @return
+			 * The number of input elements consumed, or 0
+			 * if not set.
+			 */
+			uint64_t getNumInputElements() const;
+
+			/**
+		 	 * @brief
+			 * Set the number of input elements consumed to
+			 * create the package.
+			 * @param[in] numInputElements
+			 * The number of input elements consumed.
+			 */
+			void setNumInputElements(
+			    const uint64_t numInputElements);
+
 		protected:
 		private:
 			Memory::uint8Array _data;
 			uint64_t _numElements;
+			std::string _lastKey{};
+			uint64_t _numInputElements{0};
 		};
 	}
 }
@@ -9,9 +9,10 @@
  */
  
 #include <cmath>
+#include <cstring>
 
 #include <be_image.h>
-#include <be_memory_mutableindexedbuffer.h>
+#include <be_image_pixelkernels.h>
 
 namespace BE = BiometricEvaluation;
 
@@ -320,24 +321,26 @@ BiometricEvaluation::Image::removeComponents(
 		    "for " + std::to_string(numComponents) + ' ' +
 		    std::to_string(bitDepth) + "-bit components");
 
-	BE::Memory::uint8Array out((rawData.size() / pixelStride) *
+	const uint64_t pixelCount = rawData.size() / pixelStride;
+	BE::Memory::uint8Array out(pixelCount *
 	    (numComponents - numComponentsToRemove) * componentStride);
-	BE::Memory::MutableIndexedBuffer outBuf(out);
 
-	/* Naively loop over image, skipping over specified components */
+	/* Vectorized removal of alpha channels */
+	if ((numComponentsToRemove == 1) && components.back() &&
+	    ((numComponents == 2) || (numComponents == 4))) {
+		PixelKernels::removeLastComponent(rawData, out, pixelCount,
+		    componentStride, numComponents);
+		return (out);
+	}
+
+	/* Naively loop over image, copying the remaining components */
+	uint8_t *outPtr = out;
 	for (uint64_t px = 0; px < rawData.size(); px += pixelStride) {
 		for (uint8_t comp = 0; comp < numComponents; ++comp) {
 			if (!components[comp]) {
-				switch (bitDepth) {
-				case 8:
-					outBuf.pushU8Val(rawData[px +
-					    (comp * componentStride)]);
-					break;
-				case 16:
-					outBuf.pushBeU16Val(rawData[px +
-					    (comp * componentStride)]);
-					break;
-				}
+				std::memcpy(outPtr, rawData + px +
+				    (comp * componentStride), componentStride);
+				outPtr += componentStride;
 			}
 		}
 	}
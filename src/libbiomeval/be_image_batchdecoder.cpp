@@ -0,0 +1,490 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_image_batchdecoder.h>
+
+namespace BE = BiometricEvaluation;
+
+class BiometricEvaluation::Image::BatchDecoder::Impl
+{
+public:
+	Impl(
+	    const Callback &callback,
+	    const Options &options) :
+	    _callback(callback),
+	    _threads(options.threads == 0 ?
+	        std::max(std::thread::hardware_concurrency(), 1u) :
+	        options.threads),
+	    _queueDepth(options.queueDepth == 0 ? 2 * this->_threads :
+	        options.queueDepth),
+	    _order(options.order),
+	    _grayscaleDepth(options.grayscaleDepth)
+	{
+		switch (this->_grayscaleDepth) {
+		case 0:
+			/* FALLTHROUGH */
+		case 1:
+			/* FALLTHROUGH */
+		case 8:
+			/* FALLTHROUGH */
+		case 16:
+			break;
+		default:
+			throw Error::ParameterError("Invalid grayscale depth");
+		}
+
+		for (uint32_t i = 0; i < this->_threads; i++)
+			this->_workers.emplace_back(&Impl::work, this);
+	}
+
+	~Impl()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			this->_stopping = true;
+			this->_jobs.clear();
+		}
+		this->_jobAvailable.notify_all();
+		this->_notFull.notify_all();
+		this->_resultAvailable.notify_all();
+		this->_delivered.notify_all();
+
+		for (auto &worker : this->_workers)
+			worker.join();
+	}
+
+	/** Encoded image waiting for a worker */
+	struct Job
+	{
+		uint64_t sequence{0};
+		std::string identifier{};
+		std::shared_ptr<const Memory::uint8Array> data{};
+		std::shared_ptr<IO::RecordStore> recordStore{};
+	};
+
+	uint64_t
+	submit(
+	    Job &&job)
+	{
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		if (this->_finished)
+			throw Error::ObjectExists("BatchDecoder was finished");
+		this->_notFull.wait(lock, [this]() {
+			return ((this->_undelivered < this->_queueDepth) ||
+			    this->_stopping);
+		});
+		if (this->_stopping)
+			throw Error::ObjectExists("BatchDecoder is stopping");
+
+		job.sequence = this->_nextSequence++;
+		this->_undelivered++;
+		const uint64_t sequence = job.sequence;
+		this->_jobs.push_back(std::move(job));
+		lock.unlock();
+
+		this->_jobAvailable.notify_one();
+		return (sequence);
+	}
+
+	void
+	finish()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			this->_finished = true;
+		}
+		this->_resultAvailable.notify_all();
+	}
+
+	bool
+	next(
+	    Result &result)
+	{
+		if (this->_callback)
+			throw Error::StrategyError("Results are delivered to "
+			    "a callback");
+
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		this->_resultAvailable.wait(lock, [this]() {
+			return (!this->_ready.empty() || this->_stopping ||
+			    (this->_finished && (this->_undelivered == 0)));
+		});
+		if (this->_ready.empty())
+			return (false);
+
+		result = std::move(this->_ready.front());
+		this->_ready.pop_front();
+		this->_undelivered--;
+		lock.unlock();
+
+		this->_notFull.notify_one();
+		this->_delivered.notify_all();
+		return (true);
+	}
+
+	void
+	wait()
+	{
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		this->_delivered.wait(lock, [this]() {
+			return ((this->_undelivered == 0) || this->_stopping);
+		});
+	}
+
+	uint32_t
+	getThreadCount()
+	    const
+	{
+		return (this->_threads);
+	}
+
+	Statistics
+	getStatistics()
+	    const
+	{
+		std::lock_guard<std::mutex> lock(this->_statisticsMutex);
+		return (this->_statistics);
+	}
+
+private:
+	/** Per-worker means of reading a RecordStore */
+	struct Reader
+	{
+		/** Keeps the RecordStore alive as long as cursor */
+		std::shared_ptr<IO::RecordStore> recordStore{};
+		/** nullptr when the RecordStore has no Cursors */
+		std::unique_ptr<IO::RecordStore::Cursor> cursor{};
+	};
+	using Readers = std::map<const IO::RecordStore*, Reader>;
+
+	/** Body of worker threads */
+	void
+	work()
+	{
+		Readers readers;
+		for (;;) {
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(this->_mutex);
+				this->_jobAvailable.wait(lock, [this]() {
+					return (!this->_jobs.empty() ||
+					    this->_stopping);
+				});
+				if (this->_stopping)
+					return;
+				job = std::move(this->_jobs.front());
+				this->_jobs.pop_front();
+			}
+
+			this->deliver(this->decode(job, readers));
+		}
+	}
+
+	/**
+	 * @brief
+	 * Read a record through this worker's Cursor.
+	 *
+	 * @param job
+	 * Job naming a record.
+	 * @param readers
+	 * This worker's readers.
+	 *
+	 * @return
+	 * Contents of the record.
+	 */
+	Memory::uint8Array
+	read(
+	    const Job &job,
+	    Readers &readers)
+	{
+		auto it = readers.find(job.recordStore.get());
+		if (it == readers.end()) {
+			Reader reader;
+			reader.recordStore = job.recordStore;
+			try {
+				reader.cursor = job.recordStore->makeReader();
+			} catch (const Error::NotImplemented&) {
+				reader.cursor.reset();
+			}
+			it = readers.emplace(job.recordStore.get(),
+			    std::move(reader)).first;
+		}
+
+		if (it->second.cursor)
+			return (it->second.cursor->read(job.identifier));
+
+		/* RecordStores are not otherwise safe to share */
+		std::lock_guard<std::mutex> lock(this->_readMutex);
+		return (job.recordStore->read(job.identifier));
+	}
+
+	/**
+	 * @brief
+	 * Open and decode one image.
+	 *
+	 * @param job
+	 * Image to decode.
+	 * @param readers
+	 * This worker's readers.
+	 *
+	 * @return
+	 * Result of decoding, including any exception.
+	 */
+	Result
+	decode(
+	    const Job &job,
+	    Readers &readers)
+	{
+		Result result;
+		result.sequence = job.sequence;
+		result.identifier = job.identifier;
+
+		const auto start = std::chrono::steady_clock::now();
+		CompressionAlgorithm algorithm{CompressionAlgorithm::None};
+		uint64_t encodedBytes{0};
+		try {
+			std::shared_ptr<const Memory::uint8Array> data =
+			    job.data;
+			if (job.recordStore)
+				data = std::make_shared<
+				    const Memory::uint8Array>(this->read(job,
+				    readers));
+			encodedBytes = data->size();
+
+			result.image = Image::openImage(data, job.identifier);
+			algorithm = result.image->getCompressionAlgorithm();
+			if (this->_grayscaleDepth == 0)
+				result.rawData = result.image->getRawData();
+			else
+				result.rawData =
+				    result.image->getRawGrayscaleData(
+				    this->_grayscaleDepth);
+		} catch (...) {
+			result.error = std::current_exception();
+		}
+		const auto microseconds = std::chrono::duration_cast<
+		    std::chrono::microseconds>(
+		    std::chrono::steady_clock::now() - start).count();
+
+		std::lock_guard<std::mutex> lock(this->_statisticsMutex);
+		FormatStatistics &statistics = this->_statistics[algorithm];
+		if (result.error) {
+			statistics.failures++;
+		} else {
+			statistics.images++;
+			statistics.encodedBytes += encodedBytes;
+			statistics.decodedBytes += result.rawData.size();
+		}
+		statistics.microseconds += microseconds;
+
+		return (result);
+	}
+
+	/**
+	 * @brief
+	 * Make a Result available in the configured order.
+	 *
+	 * @param result
+	 * Result of decoding.
+	 */
+	void
+	deliver(
+	    Result &&result)
+	{
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		if (this->_order == Order::Completion) {
+			this->_ready.push_back(std::move(result));
+		} else {
+			this->_completed.emplace(result.sequence,
+			    std::move(result));
+			for (auto it = this->_completed.find(
+			    this->_nextDelivery); it != this->_completed.end();
+			    it = this->_completed.find(this->_nextDelivery)) {
+				this->_ready.push_back(std::move(it->second));
+				this->_completed.erase(it);
+				this->_nextDelivery++;
+			}
+		}
+
+		if (!this->_callback) {
+			lock.unlock();
+			this->_resultAvailable.notify_all();
+			return;
+		}
+
+		/* One worker at a time drains ready Results, in order */
+		if (this->_delivering)
+			return;
+		this->_delivering = true;
+		while (!this->_ready.empty() && !this->_stopping) {
+			Result ready = std::move(this->_ready.front());
+			this->_ready.pop_front();
+			lock.unlock();
+
+			try {
+				this->_callback(ready);
+			} catch (...) {
+				/* Nowhere to report */
+			}
+
+			lock.lock();
+			this->_undelivered--;
+			this->_notFull.notify_one();
+			this->_delivered.notify_all();
+		}
+		this->_delivering = false;
+	}
+
+	const Callback _callback;
+	const uint32_t _threads;
+	const uint32_t _queueDepth;
+	const Order _order;
+	const uint8_t _grayscaleDepth;
+
+	/** Protects all but statistics and fallback reads */
+	std::mutex _mutex{};
+	std::condition_variable _jobAvailable{};
+	std::condition_variable _notFull{};
+	std::condition_variable _resultAvailable{};
+	std::condition_variable _delivered{};
+
+	std::deque<Job> _jobs{};
+	/** Results waiting for earlier sequences (Order::Submission) */
+	std::map<uint64_t, Result> _completed{};
+	/** Results that may be delivered */
+	std::deque<Result> _ready{};
+	uint64_t _nextSequence{0};
+	uint64_t _nextDelivery{0};
+	/** Submitted, but not yet retrieved or passed to callback */
+	uint64_t _undelivered{0};
+	bool _finished{false};
+	bool _stopping{false};
+	bool _delivering{false};
+
+	/** Serializes reads of RecordStores without Cursors */
+	std::mutex _readMutex{};
+
+	mutable std::mutex _statisticsMutex{};
+	Statistics _statistics{};
+
+	/** Last member, so other members outlive the workers */
+	std::vector<std::thread> _workers{};
+};
+
+BiometricEvaluation::Image::BatchDecoder::BatchDecoder(
+    const Options &options) :
+    pimpl{new BatchDecoder::Impl(Callback(), options)}
+{
+
+}
+
+BiometricEvaluation::Image::BatchDecoder::BatchDecoder() :
+    BatchDecoder(Options())
+{
+
+}
+
+BiometricEvaluation::Image::BatchDecoder::BatchDecoder(
+    const Callback &callback,
+    const Options &options)
+{
+	if (!callback)
+		throw Error::ParameterError("Empty callback");
+	this->pimpl.reset(new BatchDecoder::Impl(callback, options));
+}
+
+BiometricEvaluation::Image::BatchDecoder::BatchDecoder(
+    const Callback &callback) :
+    BatchDecoder(callback, Options())
+{
+
+}
+
+uint64_t
+BiometricEvaluation::Image::BatchDecoder::submit(
+    const std::shared_ptr<const Memory::uint8Array> &data,
+    const std::string &identifier)
+{
+	if (data == nullptr)
+		throw Error::ParameterError("No data");
+
+	Impl::Job job;
+	job.identifier = identifier;
+	job.data = data;
+	return (this->pimpl->submit(std::move(job)));
+}
+
+uint64_t
+BiometricEvaluation::Image::BatchDecoder::submit(
+    const Memory::uint8Array &data,
+    const std::string &identifier)
+{
+	return (this->submit(std::make_shared<const Memory::uint8Array>(data),
+	    identifier));
+}
+
+uint64_t
+BiometricEvaluation::Image::BatchDecoder::submit(
+    const std::shared_ptr<IO::RecordStore> &recordStore,
+    const std::string &key)
+{
+	if (recordStore == nullptr)
+		throw Error::ParameterError("No RecordStore");
+
+	Impl::Job job;
+	job.identifier = key;
+	job.recordStore = recordStore;
+	return (this->pimpl->submit(std::move(job)));
+}
+
+void
+BiometricEvaluation::Image::BatchDecoder::finish()
+{
+	this->pimpl->finish();
+}
+
+bool
+BiometricEvaluation::Image::BatchDecoder::next(
+    Result &result)
+{
+	return (this->pimpl->next(result));
+}
+
+void
+BiometricEvaluation::Image::BatchDecoder::wait()
+{
+	this->pimpl->wait();
+}
+
+uint32_t
+BiometricEvaluation::Image::BatchDecoder::getThreadCount()
+    const
+{
+	return (this->pimpl->getThreadCount());
+}
+
+BiometricEvaluation::Image::BatchDecoder::Statistics
+BiometricEvaluation::Image::BatchDecoder::getStatistics()
+    const
+{
+	return (this->pimpl->getStatistics());
+}
+
+BiometricEvaluation::Image::BatchDecoder::~BatchDecoder() = default;
@@ -21,67 +21,28 @@ BiometricEvaluation::Image::BMP::BMP(
     const uint64_t size,
     const std::string &identifier,
     const statusCallback_t &statusCallback) :
-    Image::Image(data,
+    BiometricEvaluation::Image::BMP::BMP(
+    Image::copyData(data, size),
     size,
-    CompressionAlgorithm::BMP,
     identifier,
     statusCallback)
 {
-	if (BMP::isBMP(data, size) == false)
-		throw Error::StrategyError("Not a BMP");
-
-	BITMAPINFOHEADER dibHeader;
-	try {
-		/*
-		 * Only need the BMP header here to determine
-		 * if this type of BMP is supported.
-		 */
-		BMPHeader bmpHeader;
-		BMP::getBMPHeader(data, size, &bmpHeader);
 
-		/*
-		 * The types of BMP supported in this class do not support
-		 * alpha channels. Other types of BMP do.
-		 */
-		this->setHasAlphaChannel(false);
-
-		BMP::getDIBHeader(data, size, &dibHeader);
-	} catch (const Error::NotImplemented &e) {
-		throw Error::StrategyError(e.what());
-	}
-
-	this->setDimensions(Size(dibHeader.width, abs(dibHeader.height)));
-	this->setResolution(Resolution((dibHeader.xResolution / 1000.0),
-	    (dibHeader.yResolution / 1000.0), Resolution::Units::PPMM));
-
-	this->setColorDepth(dibHeader.bitsPerPixel);
-
-	/*
-	 * Read the color table, only present when bits-per-pixel <= 8.
-	 * The color depth depends on whether the color table represents
-	 * grayscale values (R=G=B) or actual colors. In the first case,
-	 * color depth is bits-per-pixel; in the second, depth is 24.
-	 * The size of the table can be less than max possible.
-	 */
+}
 
-	if (dibHeader.bitsPerPixel <= 8) {
-		int numColors;
-		if (dibHeader.numberOfColors == 0) {
-			numColors = 1 << dibHeader.bitsPerPixel;
-		} else {
-			numColors = dibHeader.numberOfColors;
-		}
-		BMP::getColorTable(data, size, numColors, this->_colorTable);
-		for (auto cte : this->_colorTable) {
-			if ((cte.red == cte.green) && (cte.green == cte.blue)) {
-				continue;
-			} else {
-				this->setColorDepth(24);
-				break;
-			}
-		}
-	}
-	this->setBitDepth(8);
+BiometricEvaluation::Image::BMP::BMP(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
+    Image::Image(data,
+    size,
+    CompressionAlgorithm::BMP,
+    identifier,
+    statusCallback)
+{
+	this->setAttributes(parseHeaders(data.get(), size,
+	    this->_colorTable));
 }
 
 BiometricEvaluation::Image::BMP::BMP(
@@ -115,7 +76,7 @@ rawPixelFromColorTable(
 }
 
 BiometricEvaluation::Memory::AutoArray<uint8_t>
-BiometricEvaluation::Image::BMP::getRawData()
+BiometricEvaluation::Image::BMP::decodeRawData()
     const
 {
 	const uint8_t *bmpData = this->getDataPointer();
@@ -263,6 +224,79 @@ BiometricEvaluation::Image::BMP::getRawGrayscaleData(
 	return (Image::getRawGrayscaleData(depth));
 }
 
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::BMP::probe(
+    const uint8_t *data,
+    const uint64_t size)
+{
+	ColorTable colorTable;
+	return (parseHeaders(data, size, colorTable));
+}
+
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::BMP::parseHeaders(
+    const uint8_t *data,
+    const uint64_t size,
+    ColorTable &colorTable)
+{
+	if (BMP::isBMP(data, size) == false)
+		throw Error::StrategyError("Not a BMP");
+
+	BITMAPINFOHEADER dibHeader;
+	try {
+		/*
+		 * Only need the BMP header here to determine
+		 * if this type of BMP is supported.
+		 */
+		BMPHeader bmpHeader;
+		BMP::getBMPHeader(data, size, &bmpHeader);
+		BMP::getDIBHeader(data, size, &dibHeader);
+	} catch (const Error::NotImplemented &e) {
+		throw Error::StrategyError(e.what());
+	}
+
+	Attributes attributes;
+	attributes.compressionAlgorithm = CompressionAlgorithm::BMP;
+	attributes.dimensions = Size(dibHeader.width, abs(dibHeader.height));
+	attributes.resolution = Resolution((dibHeader.xResolution / 1000.0),
+	    (dibHeader.yResolution / 1000.0), Resolution::Units::PPMM);
+	attributes.colorDepth = dibHeader.bitsPerPixel;
+	attributes.bitDepth = 8;
+	/*
+	 * The types of BMP supported in this class do not support
+	 * alpha channels. Other types of BMP do.
+	 */
+	attributes.hasAlphaChannel = false;
+
+	/*
+	 * Read the color table, only present when bits-per-pixel <= 8.
+	 * The color depth depends on whether the color table represents
+	 * grayscale values (R=G=B) or actual colors. In the first case,
+	 * color depth is bits-per-pixel; in the second, depth is 24.
+	 * The size of the table can be less than max possible.
+	 */
+	colorTable.clear();
+	if (dibHeader.bitsPerPixel <= 8) {
+		int numColors;
+		if (dibHeader.numberOfColors == 0) {
+			numColors = 1 << dibHeader.bitsPerPixel;
+		} else {
+			numColors = dibHeader.numberOfColors;
+		}
+		BMP::getColorTable(data, size, numColors, colorTable);
+		for (auto cte : colorTable) {
+			if ((cte.red == cte.green) && (cte.green == cte.blue)) {
+				continue;
+			} else {
+				attributes.colorDepth = 24;
+				break;
+			}
+		}
+	}
+
+	return (attributes);
+}
+
 bool
 BiometricEvaluation::Image::BMP::isBMP(
     const uint8_t *data,
@@ -370,7 +404,10 @@ BiometricEvaluation::Image::BMP::getColorTable(
     int count,
     BE::Image::BMP::ColorTable &colorTable)
 {
-	//XXX check bufsz against header sizes + color table size
+	if ((count < 0) || ((BMPHDRSZ + DIBHDRSZ +
+	    (static_cast<uint64_t>(count) * 4)) > bufsz))
+		throw Error::DataError("Truncated color table");
+
 	/*
 	 * Skip over the headers.
 	 * Color table follows the DIB header.
@@ -0,0 +1,242 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include <be_image_decodecache.h>
+
+class BiometricEvaluation::Image::DecodeCache::Impl
+{
+public:
+	/** Combine the members of a Key */
+	struct KeyHash
+	{
+		size_t
+		operator()(
+		    const Key &key)
+		    const
+		{
+			size_t hash = std::hash<std::string>()(key.identifier);
+			hash ^= std::hash<uint64_t>()(key.hash) + 0x9E3779B9 +
+			    (hash << 6) + (hash >> 2);
+			hash ^= std::hash<uint64_t>()(key.size) + 0x9E3779B9 +
+			    (hash << 6) + (hash >> 2);
+			hash ^= static_cast<size_t>(key.representation) +
+			    0x9E3779B9 + (hash << 6) + (hash >> 2);
+			return (hash);
+		}
+	};
+
+	/** @return Bytes held by an entry */
+	static uint64_t
+	entrySize(
+	    const Key &key,
+	    const Pixels &pixels)
+	{
+		return (pixels->size() + (key.data != nullptr ? key.size : 0));
+	}
+
+	/** Most recently used first */
+	using Entries = std::list<std::pair<Key, Pixels>>;
+
+	/** Protects all but the atomic counters */
+	std::mutex mutex{};
+	Entries entries{};
+	std::unordered_map<Key, Entries::iterator, KeyHash> index{};
+	uint64_t bytes{0};
+	std::atomic<uint64_t> capacity{0};
+	std::atomic<KeyType> keyType{KeyType::Content};
+
+	std::atomic<uint64_t> hits{0};
+	std::atomic<uint64_t> retainedHits{0};
+	std::atomic<uint64_t> misses{0};
+	std::atomic<uint64_t> evictions{0};
+
+	/**
+	 * @brief
+	 * Evict least recently used entries.
+	 *
+	 * @param maxBytes
+	 * Size of pixels to remain at most.
+	 *
+	 * @note
+	 * mutex must be held.
+	 */
+	void
+	evict(
+	    uint64_t maxBytes)
+	{
+		while ((this->bytes > maxBytes) && !this->entries.empty()) {
+			this->bytes -= entrySize(this->entries.back().first,
+			    this->entries.back().second);
+			this->index.erase(this->entries.back().first);
+			this->entries.pop_back();
+			this->evictions++;
+		}
+	}
+
+	/** @return The process-wide cache */
+	static Impl&
+	instance()
+	{
+		static Impl cache;
+		return (cache);
+	}
+};
+
+bool
+BiometricEvaluation::Image::DecodeCache::Key::operator==(
+    const Key &rhs)
+    const
+{
+	if ((this->hash != rhs.hash) || (this->size != rhs.size) ||
+	    (this->representation != rhs.representation) ||
+	    (this->identifier != rhs.identifier))
+		return (false);
+
+	/* Equal hashes of different data must not match */
+	if (this->data == rhs.data)
+		return (true);
+	if ((this->data == nullptr) || (rhs.data == nullptr))
+		return (false);
+	return (std::memcmp(this->data.get(), rhs.data.get(),
+	    this->size) == 0);
+}
+
+void
+BiometricEvaluation::Image::DecodeCache::setCapacity(
+    uint64_t bytes)
+{
+	Impl &cache = Impl::instance();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	cache.capacity = bytes;
+	cache.evict(bytes);
+}
+
+uint64_t
+BiometricEvaluation::Image::DecodeCache::getCapacity()
+{
+	return (Impl::instance().capacity);
+}
+
+void
+BiometricEvaluation::Image::DecodeCache::setKeyType(
+    KeyType keyType)
+{
+	Impl &cache = Impl::instance();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	if (cache.keyType == keyType)
+		return;
+	cache.keyType = keyType;
+	cache.entries.clear();
+	cache.index.clear();
+	cache.bytes = 0;
+}
+
+BiometricEvaluation::Image::DecodeCache::KeyType
+BiometricEvaluation::Image::DecodeCache::getKeyType()
+{
+	return (Impl::instance().keyType);
+}
+
+BiometricEvaluation::Image::DecodeCache::Statistics
+BiometricEvaluation::Image::DecodeCache::getStatistics()
+{
+	Impl &cache = Impl::instance();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+
+	Statistics statistics;
+	statistics.hits = cache.hits;
+	statistics.retainedHits = cache.retainedHits;
+	statistics.misses = cache.misses;
+	statistics.evictions = cache.evictions;
+	statistics.entries = cache.entries.size();
+	statistics.bytes = cache.bytes;
+	statistics.capacity = cache.capacity;
+	return (statistics);
+}
+
+void
+BiometricEvaluation::Image::DecodeCache::resetStatistics()
+{
+	Impl &cache = Impl::instance();
+	cache.hits = 0;
+	cache.retainedHits = 0;
+	cache.misses = 0;
+	cache.evictions = 0;
+}
+
+void
+BiometricEvaluation::Image::DecodeCache::clear()
+{
+	Impl &cache = Impl::instance();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	cache.entries.clear();
+	cache.index.clear();
+	cache.bytes = 0;
+}
+
+BiometricEvaluation::Image::DecodeCache::Pixels
+BiometricEvaluation::Image::DecodeCache::find(
+    const Key &key)
+{
+	Impl &cache = Impl::instance();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+
+	const auto it = cache.index.find(key);
+	if (it == cache.index.end())
+		return (nullptr);
+
+	/* Move to most recently used */
+	cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+	cache.hits++;
+	return (it->second->second);
+}
+
+void
+BiometricEvaluation::Image::DecodeCache::insert(
+    const Key &key,
+    const Pixels &pixels)
+{
+	Impl &cache = Impl::instance();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+
+	/* Would evict everything else and itself */
+	const uint64_t size = Impl::entrySize(key, pixels);
+	if (size > cache.capacity)
+		return;
+
+	/* Decoded concurrently by another Image */
+	if (cache.index.find(key) != cache.index.end())
+		return;
+
+	cache.evict(cache.capacity - size);
+	cache.entries.emplace_front(key, pixels);
+	cache.index.emplace(key, cache.entries.begin());
+	cache.bytes += size;
+}
+
+void
+BiometricEvaluation::Image::DecodeCache::countRetainedHit()
+{
+	Impl::instance().retainedHits++;
+}
+
+void
+BiometricEvaluation::Image::DecodeCache::countMiss()
+{
+	Impl::instance().misses++;
+}
@@ -8,9 +8,14 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
 #include <stdexcept>
 #include <memory>
+#include <string_view>
 
 #include <be_image_image.h>
 #include <be_image_bmp.h>
@@ -18,6 +23,7 @@
 #include <be_image_jpeg2000.h>
 #include <be_image_jpegl.h>
 #include <be_image_netpbm.h>
+#include <be_image_pixelkernels.h>
 #include <be_image_raw.h>
 #include <be_image_png.h>
 #include <be_image_tiff.h>
@@ -28,6 +34,160 @@
 
 namespace BE = BiometricEvaluation;
 
+struct BiometricEvaluation::Image::Image::DecodedData
+{
+	/** Protects all members */
+	std::mutex mutex{};
+	/** Whether decoded data is kept */
+	bool retain{false};
+	/** Decoded data kept, by representation */
+	std::map<DecodeCache::Representation, DecodeCache::Pixels> pixels{};
+
+	/** Whether hash has been computed */
+	bool hashed{false};
+	/** Hash of the encoded data */
+	uint64_t hash{0};
+};
+
+namespace
+{
+	/** Deleter of borrowed image data, which frees nothing */
+	struct BorrowedDataDeleter
+	{
+		void
+		operator()(
+		    const uint8_t */* data */)
+		    const
+		{
+
+		}
+	};
+}
+
+/** Maximum reduction of getRawData(reduction, roi) */
+static const uint8_t MAXIMUM_REDUCTION = 31;
+
+/**
+ * @brief
+ * Size of a pixel in the data returned from getRawData().
+ *
+ * @param colorDepth
+ * Number of bits per pixel.
+ * @param bitDepth
+ * Number of bits per color component.
+ *
+ * @return
+ * Number of bytes per pixel.
+ */
+static uint32_t
+rawBytesPerPixel(
+    const uint32_t colorDepth,
+    const uint16_t bitDepth)
+{
+	if (bitDepth == 0)
+		return (1);
+
+	/* Components of fewer than 8 bits are returned as 8 bits */
+	const uint32_t components = std::max<uint32_t>(colorDepth / bitDepth,
+	    1);
+	return (components * ((std::max<uint16_t>(bitDepth, 8) + 7) / 8));
+}
+
+/**
+ * @brief
+ * Convert pixels in the format returned from getRawData() to grayscale.
+ *
+ * @param rawColor
+ * Pixels to convert.
+ * @param rawColorSize
+ * Size of rawColor, in bytes.
+ * @param rawGray
+ * Buffer receiving pixelCount grayscale pixels of depth bits, stored in
+ * whole bytes.
+ * @param pixelCount
+ * Number of pixels to convert.
+ * @param colorDepth
+ * Color depth of the pixels in rawColor.
+ * @param depth
+ * Bit depth of the grayscale pixels: 16, 8, or 1.
+ *
+ * @throw Error::NotImplemented
+ * Unsupported conversion based on colorDepth.
+ * @throw Error::StrategyError
+ * rawColor is smaller than pixelCount pixels.
+ */
+static void
+convertToGrayscale(
+    const uint8_t *rawColor,
+    const uint64_t rawColorSize,
+    uint8_t *rawGray,
+    const uint64_t pixelCount,
+    const uint32_t colorDepth,
+    const uint8_t depth)
+{
+	namespace Error = BE::Error;
+	namespace PixelKernels = BE::Image::PixelKernels;
+
+	const uint8_t bpcOut = static_cast<uint8_t>(std::ceil(depth / 8.0));
+	const uint8_t convertDepth = (depth == 16 ? 16 : 8);
+
+	/* Size of input components, and number of them per pixel */
+	uint8_t inDepth, components;
+	switch (colorDepth) {
+	case 1:
+		/* Images are upped to 8-bit in getRawData() */
+		/* FALLTHROUGH */
+	case 2:
+		/* Images are upped to 8-bit in getRawData() */
+		/* FALLTHROUGH */
+	case 4:
+		/* Images are upped to 8-bit in getRawData() */
+		/* FALLTHROUGH */
+	case 8: /* 8-bit single-channel (grayscale) */
+		inDepth = 8;
+		components = 1;
+		break;
+	case 16: /* 16-bit single-channel (grayscale) */
+		inDepth = 16;
+		components = 1;
+		break;
+	case 24: /* 8-bit RGB */
+		/* FALLTHROUGH */
+	case 32: /* 8-bit RGBA (ignoring alpha channel) */
+		inDepth = 8;
+		components = colorDepth / 8;
+		break;
+	case 48: /* 16-bit RGB */
+		/* FALLTHROUGH */
+	case 64: /* 16-bit RGBA (ignoring alpha channel) */
+		inDepth = 16;
+		components = colorDepth / 16;
+		break;
+	default:
+		throw Error::NotImplemented("Grayscale conversion "
+		    "for " + std::to_string(colorDepth) + "-bit "
+		    "depth imagery");
+	}
+	if (rawColorSize < (pixelCount * components * (inDepth / 8)))
+		throw Error::StrategyError("Raw data is smaller than image "
+		    "dimensions");
+
+	if (components == 1)
+		/* Interpolate value in the other colorspace */
+		PixelKernels::rescale(rawColor, rawGray, pixelCount, inDepth,
+		    convertDepth);
+	else
+		/* Pull Y' component from Y'CbCr */
+		PixelKernels::colorToGray(rawColor, rawGray, pixelCount,
+		    inDepth, components, convertDepth);
+
+	/* Quantize down to black and white */
+	if (depth == 1)
+		std::transform(rawGray, rawGray + (pixelCount * bpcOut),
+		    rawGray, [](const uint8_t &i) {
+			return (i <= 127 ? 0x00 : 0xFF); });
+}
+
 BiometricEvaluation::Image::Image::Image(
     const uint8_t *data,
     const uint64_t size,
@@ -39,17 +199,67 @@ BiometricEvaluation::Image::Image::Image(
     const bool hasAlphaChannel,
     const std::string &identifier,
     const statusCallback_t &statusCallback) :
+    BiometricEvaluation::Image::Image::Image(
+    Image::copyData(data, size),
+    size,
+    dimensions,
+    colorDepth,
+    bitDepth,
+    resolution,
+    compressionAlgorithm,
+    hasAlphaChannel,
+    identifier,
+    statusCallback)
+{
+
+}
+
+BiometricEvaluation::Image::Image::Image(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const Size dimensions,
+    const uint32_t colorDepth,
+    const uint16_t bitDepth,
+    const Resolution resolution,
+    const CompressionAlgorithm compressionAlgorithm,
+    const bool hasAlphaChannel,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
     _dimensions(dimensions),
     _colorDepth(colorDepth),
     _hasAlphaChannel(hasAlphaChannel),
     _bitDepth(bitDepth),
     _resolution(resolution),
-    _data(size),
+    _data(data),
+    _dataSize(size),
     _compressionAlgorithm(compressionAlgorithm),
     _identifier(identifier),
-    _statusCallback(statusCallback)
+    _statusCallback(statusCallback),
+    _decodedData(std::make_shared<DecodedData>())
+{
+	if ((_data == nullptr) && (size != 0))
+		throw Error::StrategyError("No image data");
+}
+
+BiometricEvaluation::Image::Image::Image(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const CompressionAlgorithm compressionAlgorithm,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
+    BiometricEvaluation::Image::Image::Image(
+    data,
+    size,
+    Size(),
+    0,
+    0,
+    Resolution(),
+    compressionAlgorithm,
+    false,
+    identifier,
+    statusCallback)
 {
-	std::memcpy(_data, data, size);
+
 }
 
 BiometricEvaluation::Image::Image::Image(
@@ -108,6 +318,61 @@ BiometricEvaluation::Image::Image::getBitDepth()
 	return (this->_bitDepth);
 }
 
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::Image::getRawData()
+    const
+{
+	return (this->getDecodedData(DecodeCache::Representation::Raw,
+	    [this]() { return (this->decodeRawData()); }));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::Image::decodeRawData()
+    const
+{
+	throw Error::NotImplemented("Decoding " +
+	    BE::Framework::Enumeration::to_string(
+	    this->getCompressionAlgorithm()) + " images");
+}
+
+void
+BiometricEvaluation::Image::Image::getRawData(
+    Memory::uint8Array &rawData)
+    const
+{
+	bool retain;
+	{
+		std::lock_guard<std::mutex> lock(this->_decodedData->mutex);
+		retain = this->_decodedData->retain;
+	}
+	if (!retain && (DecodeCache::getCapacity() == 0)) {
+		this->decodeRawDataInto(rawData);
+		return;
+	}
+
+	const Memory::uint8Array decoded = this->getRawData();
+	resizeBuffer(rawData, decoded.size());
+	std::memcpy(rawData, decoded, decoded.size());
+}
+
+void
+BiometricEvaluation::Image::Image::decodeRawDataInto(
+    Memory::uint8Array &rawData)
+    const
+{
+	rawData = this->decodeRawData();
+}
+
+void
+BiometricEvaluation::Image::Image::resizeBuffer(
+    Memory::uint8Array &buffer,
+    const uint64_t size)
+{
+	/* Emptying first avoids copying contents when reallocating */
+	buffer.resize(0);
+	buffer.resize(size);
+}
+
 BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::Image::Image::getRawData(
     const bool removeAlphaChannelIfPresent)
@@ -116,13 +381,159 @@ BiometricEvaluation::Image::Image::getRawData(
 	if (!removeAlphaChannelIfPresent || !this->hasAlphaChannel())
 		return (this->getRawData());
 
-	/* Set the last channel to be removed */
-	std::vector<bool> components(this->getColorDepth() /
-	    this->getBitDepth(), false);
-	*(std::prev(components.end(), 1)) = true;
+	return (this->getDecodedData(
+	    DecodeCache::Representation::RawWithoutAlpha, [this]() {
+		/* Set the last channel to be removed */
+		std::vector<bool> components(this->getColorDepth() /
+		    this->getBitDepth(), false);
+		*(std::prev(components.end(), 1)) = true;
 
-	return (BiometricEvaluation::Image::removeComponents(this->getRawData(),
-	    this->getBitDepth(), components));
+		return (BiometricEvaluation::Image::removeComponents(
+		    this->getRawData(), this->getBitDepth(), components));
+	}));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::Image::getRawData(
+    const uint8_t reduction,
+    const ROI &roi)
+    const
+{
+	const ROI region = this->getReducedROI(reduction, roi);
+	const Memory::uint8Array rawData = this->getRawData();
+	if (reduction == 0)
+		return (this->cropReducedRawData(rawData, reduction, roi));
+
+	const Size dimensions = this->getDimensions();
+	const uint32_t bytesPerPixel = rawBytesPerPixel(this->getColorDepth(),
+	    this->getBitDepth());
+	if (rawData.size() < (static_cast<uint64_t>(dimensions.xSize) *
+	    dimensions.ySize * bytesPerPixel))
+		throw Error::StrategyError("Raw data is smaller than image "
+		    "dimensions");
+
+	const uint64_t scale = static_cast<uint64_t>(1) << reduction;
+	const uint64_t rawStride = static_cast<uint64_t>(dimensions.xSize) *
+	    bytesPerPixel;
+	Memory::uint8Array reduced(static_cast<uint64_t>(region.size.xSize) *
+	    region.size.ySize * bytesPerPixel);
+	uint8_t *out = reduced;
+	for (uint64_t row = region.vertOffset; row < (static_cast<uint64_t>(
+	    region.vertOffset) + region.size.ySize); row++) {
+		const uint64_t top = row * scale;
+		const uint64_t bottom = std::min<uint64_t>(top + scale,
+		    dimensions.ySize);
+		for (uint64_t col = region.horzOffset; col < (static_cast<
+		    uint64_t>(region.horzOffset) + region.size.xSize); col++) {
+			const uint64_t left = col * scale;
+			const uint64_t right = std::min<uint64_t>(left + scale,
+			    dimensions.xSize);
+
+			/* Sample multi-byte components, whose order varies */
+			if (this->getBitDepth() > 8) {
+				std::memcpy(out, rawData + (top * rawStride) +
+				    (left * bytesPerPixel), bytesPerPixel);
+				out += bytesPerPixel;
+				continue;
+			}
+
+			/* Average byte components */
+			const uint64_t count = (bottom - top) * (right - left);
+			for (uint32_t byte = 0; byte < bytesPerPixel; byte++) {
+				uint64_t sum = 0;
+				for (uint64_t y = top; y < bottom; y++) {
+					const uint8_t *in = rawData +
+					    (y * rawStride) +
+					    (left * bytesPerPixel) + byte;
+					for (uint64_t x = left; x < right; x++) {
+						sum += *in;
+						in += bytesPerPixel;
+					}
+				}
+				*out++ = static_cast<uint8_t>((sum +
+				    (count / 2)) / count);
+			}
+		}
+	}
+
+	return (reduced);
+}
+
+BiometricEvaluation::Image::Size
+BiometricEvaluation::Image::Image::getReducedDimensions(
+    const uint8_t reduction,
+    const ROI &roi)
+    const
+{
+	return (this->getReducedROI(reduction, roi).size);
+}
+
+BiometricEvaluation::Image::ROI
+BiometricEvaluation::Image::Image::getReducedROI(
+    const uint8_t reduction,
+    const ROI &roi)
+    const
+{
+	if (reduction > MAXIMUM_REDUCTION)
+		throw Error::ParameterError("Reduction must be at most " +
+		    std::to_string(MAXIMUM_REDUCTION));
+
+	const Size dimensions = this->getDimensions();
+	uint64_t left = 0, top = 0;
+	uint64_t right = dimensions.xSize, bottom = dimensions.ySize;
+	if ((roi.size.xSize != 0) || (roi.size.ySize != 0)) {
+		left = roi.horzOffset;
+		top = roi.vertOffset;
+		right = left + roi.size.xSize;
+		bottom = top + roi.size.ySize;
+		if ((roi.size.xSize == 0) || (roi.size.ySize == 0) ||
+		    (right > dimensions.xSize) || (bottom > dimensions.ySize))
+			throw Error::ParameterError("ROI " + to_string(roi) +
+			    " is not within image of " + to_string(
+			    dimensions));
+	}
+
+	/* Smallest reduced region covering the full-resolution region */
+	const uint64_t scale = static_cast<uint64_t>(1) << reduction;
+	left /= scale;
+	top /= scale;
+	right = (right + scale - 1) / scale;
+	bottom = (bottom + scale - 1) / scale;
+
+	return (ROI(Size(static_cast<uint32_t>(right - left),
+	    static_cast<uint32_t>(bottom - top)), static_cast<uint32_t>(left),
+	    static_cast<uint32_t>(top), {}));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::Image::cropReducedRawData(
+    const Memory::uint8Array &rawData,
+    const uint8_t reduction,
+    const ROI &roi)
+    const
+{
+	const Size dimensions = this->getReducedDimensions(reduction, ROI());
+	const ROI region = this->getReducedROI(reduction, roi);
+	const uint32_t bytesPerPixel = rawBytesPerPixel(this->getColorDepth(),
+	    this->getBitDepth());
+	if (rawData.size() < (static_cast<uint64_t>(dimensions.xSize) *
+	    dimensions.ySize * bytesPerPixel))
+		throw Error::StrategyError("Raw data is smaller than image "
+		    "dimensions");
+	if (region.size == dimensions)
+		return (rawData);
+
+	const uint64_t rawStride = static_cast<uint64_t>(dimensions.xSize) *
+	    bytesPerPixel;
+	const uint64_t croppedStride = static_cast<uint64_t>(
+	    region.size.xSize) * bytesPerPixel;
+	Memory::uint8Array cropped(croppedStride * region.size.ySize);
+	for (uint32_t row = 0; row < region.size.ySize; row++)
+		std::memcpy(cropped + (row * croppedStride), rawData +
+		    ((region.vertOffset + row) * rawStride) +
+		    (region.horzOffset * bytesPerPixel), croppedStride);
+
+	return (cropped);
 }
 
 BiometricEvaluation::Memory::uint8Array
@@ -130,148 +541,195 @@ BiometricEvaluation::Image::Image::getRawGrayscaleData(
     uint8_t depth)
     const
 {
-	if (depth != 16 && depth != 8 && depth != 1)
+	DecodeCache::Representation representation;
+	switch (depth) {
+	case 1:
+		representation = DecodeCache::Representation::Grayscale1;
+		break;
+	case 8:
+		representation = DecodeCache::Representation::Grayscale8;
+		break;
+	case 16:
+		representation = DecodeCache::Representation::Grayscale16;
+		break;
+	default:
 		throw Error::ParameterError("Invalid value for bit depth");
+	}
+
+	return (this->getDecodedData(representation,
+	    [this, depth]() { return (this->decodeRawGrayscaleData(depth)); }));
+}
 
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::Image::decodeRawGrayscaleData(
+    uint8_t depth)
+    const
+{
 	/* Return no-effort conversion */
 	if (this->getColorDepth() == depth)
 		return (this->getRawData());
 
-	const uint8_t bpcIn = static_cast<uint8_t>(
-	    std::ceil(this->getColorDepth() / 8.0));
 	const Memory::uint8Array rawColor{this->getRawData()};
-	Memory::IndexedBuffer inBuffer{rawColor};
+	const uint64_t pixelCount = static_cast<uint64_t>(
+	    this->getDimensions().xSize) * this->getDimensions().ySize;
 
+	/* 1,2,4-bit conversions will be quantized after converting to 8-bit */
 	const uint8_t bpcOut = static_cast<uint8_t>(std::ceil(depth / 8.0));
-	Memory::uint8Array rawGray(
-	    bpcOut * this->getDimensions().xSize * this->getDimensions().ySize);
-	Memory::MutableIndexedBuffer outBuffer(rawGray);
+	Memory::uint8Array rawGray(bpcOut * pixelCount);
+	convertToGrayscale(rawColor, rawColor.size(), rawGray, pixelCount,
+	    this->getColorDepth(), depth);
 
-	/* Constants from ITU-R BT.601 */
-	static const float redFactor = 0.299;
-	static const float greenFactor = 0.587;
-	static const float blueFactor = 0.114;
+	return (rawGray);
+}
 
-	uint16_t rValue, bValue, gValue;
+/** Rows in each band of a BandReader over decoded data */
+static const uint32_t DECODED_BAND_ROWS = 64;
 
-	/*
-	 * Convert to 16-bit or 8-bit. 1,2,4-bit conversions will be quantized
-	 * after converting to 8-bit.
-	 */
-	for (uint32_t i = 0; i < rawColor.size(); i += bpcIn) {
-		switch (this->getColorDepth()) {
-		case 1:
-			/* Images are upped to 8-bit in getRawData() */
-			/* FALLTHROUGH */
-		case 2:
-			/* Images are upped to 8-bit in getRawData() */
-			/* FALLTHROUGH */
-		case 4:
-			/* Images are upped to 8-bit in getRawData() */
-			/* FALLTHROUGH */
-		case 8: /* 8-bit single-channel (grayscale) */
-			if (depth == 8) {
-				outBuffer.pushU8Val(inBuffer.scanU8Val());
-			} else if (depth == 16) {
-				/* Get 16-bit colorspace interpolated value */
-				outBuffer.pushU16Val(valueInColorspace(
-				    inBuffer.scanU8Val(), UINT8_MAX, 16));
-			}
+/** BandReader copying bands out of a region decoded at once */
+class DecodedBandReader : public BE::Image::Image::BandReader
+{
+public:
+	DecodedBandReader(
+	    const BE::Image::Image &image,
+	    const BE::Image::ROI &region) :
+	    BandReader(image, region, std::min(DECODED_BAND_ROWS,
+	        region.size.ySize)),
+	    _rawData(image.getRawData(0, region))
+	{
+		if (this->_rawData.size() < (this->getRowSize() *
+		    region.size.ySize))
+			throw BE::Error::StrategyError("Raw data is smaller "
+			    "than image dimensions");
+	}
 
-			break;
-		case 16: /* 16-bit single-channel (grayscale) */
-			if (depth == 8) {
-				/* Interpolate value in 8-bit colorspace */
-				outBuffer.pushU8Val(valueInColorspace(
-				    inBuffer.scanU16Val(), UINT16_MAX, 8));
-			}
+protected:
+	uint32_t
+	decodeBand(
+	    uint8_t *band,
+	    const uint32_t row)
+	    override
+	{
+		const BE::Image::ROI region = this->getRegion();
+		const uint32_t rows = std::min(this->getMaximumBandRows(),
+		    region.vertOffset + region.size.ySize - row);
+		std::memcpy(band, this->_rawData + ((row - region.vertOffset) *
+		    this->getRowSize()), rows * this->getRowSize());
+		return (rows);
+	}
 
-			break;
-		case 32: /* 8-bit RGBA */
-			/* FALLTHROUGH (ignoring alpha channel) */
-		case 24: /* 8-bit RGB */
-			if (depth == 16) {
-				/* Get 16-bit colorspace interpolated value */
-				rValue = static_cast<uint16_t>(
-				    valueInColorspace(inBuffer.scanU8Val(),
-				    UINT8_MAX, 16));
-				gValue = static_cast<uint16_t>(
-				    valueInColorspace(inBuffer.scanU8Val(),
-				    UINT8_MAX, 16));
-				bValue = static_cast<uint16_t>(
-				    valueInColorspace(inBuffer.scanU8Val(),
-				    UINT8_MAX, 16));
-
-				/* Pull Y' component from Y'CbCr */
-				outBuffer.pushU16Val((rValue * redFactor) +
-				    (gValue * greenFactor) +
-				    (bValue * blueFactor));
-			} else {
-				/* Pull Y' component from Y'CbCr */
-				outBuffer.pushU8Val(static_cast<uint8_t>(
-				    (inBuffer.scanU8Val() * redFactor) +
-				    (inBuffer.scanU8Val() * greenFactor) +
-				    (inBuffer.scanU8Val() * blueFactor)));
-			}
+private:
+	/** Pixels of the region */
+	const BE::Memory::uint8Array _rawData;
+};
 
-			/* Increment over the alpha channel */
-			if (this->getColorDepth() == 32)
-				inBuffer.scanU8Val();
-
-			break;
-		case 64: /* 16-bit RGBA */
-			/* FALLTHROUGH (ignoring alpha channel) */
-		case 48: /* 16-bit RGB */
-			/* Extract 16-bit values */
-			rValue = inBuffer.scanU16Val();
-			gValue = inBuffer.scanU16Val();
-			bValue = inBuffer.scanU16Val();
-
-			if (depth == 16) {
-				/* Y' component from Y'CbCr */
-				outBuffer.pushU16Val((rValue * redFactor) +
-				    (gValue * greenFactor) +
-				    (bValue * blueFactor));
-			} else {
-				/* Interpolate colors in 8-bit colorspace */
-				rValue = static_cast<uint8_t>(
-				    valueInColorspace(rValue, UINT16_MAX, 8));
-				gValue = static_cast<uint8_t>(
-				    valueInColorspace(gValue, UINT16_MAX, 8));
-				bValue = static_cast<uint8_t>(
-				    valueInColorspace(bValue, UINT16_MAX, 8));
-
-				/* Pull Y' component from Y'CbCr */
-				outBuffer.pushU8Val((rValue * redFactor) +
-				    (gValue * greenFactor) +
-				    (bValue * blueFactor));
-			}
+BiometricEvaluation::Image::Image::BandReader::BandReader(
+    const Image &image,
+    const ROI &region,
+    const uint32_t maximumBandRows) :
+    _region(region),
+    _maximumBandRows(std::max<uint32_t>(maximumBandRows, 1)),
+    _rowSize(static_cast<uint64_t>(region.size.xSize) * rawBytesPerPixel(
+        image.getColorDepth(), image.getBitDepth())),
+    _colorDepth(image.getColorDepth()),
+    _nextRow(region.vertOffset)
+{
 
-			/* Increment over the alpha channel */
-			if (this->getColorDepth() == 64)
-				inBuffer.scanU16Val();
+}
 
-			break;
-		default:
-			throw BE::Error::NotImplemented("Grayscale conversion "
-			    "for " + std::to_string(this->getColorDepth()) + "-bit "
-			    "depth imagery");
-		}
-	}
+uint32_t
+BiometricEvaluation::Image::Image::BandReader::read(
+    Memory::uint8Array &band)
+{
+	if (this->_nextRow >= (this->_region.vertOffset +
+	    this->_region.size.ySize))
+		return (0);
 
-	/* Quantize down to black and white */
-	if (depth == 1)
-		std::transform(rawGray.begin(), rawGray.end(), rawGray.begin(),
-		    [](const uint8_t &i) { return (i <= 127 ? 0x00 : 0xFF); });
+	if (band.size() < this->getBandSize())
+		band.resize(this->getBandSize());
+	const uint32_t rows = this->decodeBand(band, this->_nextRow);
+	this->_nextRow += rows;
+	return (rows);
+}
 
-	return (rawGray);
+uint32_t
+BiometricEvaluation::Image::Image::BandReader::readGrayscale(
+    Memory::uint8Array &band,
+    uint8_t depth)
+{
+	if ((depth != 1) && (depth != 8) && (depth != 16))
+		throw Error::ParameterError("Invalid value for bit depth");
+
+	/* Return no-effort conversion */
+	if (this->_colorDepth == depth)
+		return (this->read(band));
+
+	const uint32_t rows = this->read(this->_colorBand);
+	if (rows == 0)
+		return (0);
+
+	const uint64_t pixelCount = static_cast<uint64_t>(
+	    this->_region.size.xSize) * rows;
+	const uint64_t graySize = pixelCount * static_cast<uint8_t>(
+	    std::ceil(depth / 8.0));
+	if (band.size() < graySize)
+		band.resize(graySize);
+	convertToGrayscale(this->_colorBand, rows * this->_rowSize, band,
+	    pixelCount, this->_colorDepth, depth);
+
+	return (rows);
+}
+
+BiometricEvaluation::Image::ROI
+BiometricEvaluation::Image::Image::BandReader::getRegion()
+    const
+{
+	return (this->_region);
+}
+
+uint32_t
+BiometricEvaluation::Image::Image::BandReader::getNextRow()
+    const
+{
+	return (this->_nextRow);
+}
+
+uint64_t
+BiometricEvaluation::Image::Image::BandReader::getRowSize()
+    const
+{
+	return (this->_rowSize);
+}
+
+uint32_t
+BiometricEvaluation::Image::Image::BandReader::getMaximumBandRows()
+    const
+{
+	return (this->_maximumBandRows);
+}
+
+uint64_t
+BiometricEvaluation::Image::Image::BandReader::getBandSize()
+    const
+{
+	return (this->_rowSize * this->_maximumBandRows);
+}
+
+std::unique_ptr<BiometricEvaluation::Image::Image::BandReader>
+BiometricEvaluation::Image::Image::makeBandReader(
+    const ROI &roi)
+    const
+{
+	return (std::make_unique<DecodedBandReader>(*this,
+	    this->getReducedROI(0, roi)));
 }
 
 BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::Image::Image::getData()
     const
 {
-	return (Memory::uint8Array(_data));
+	Memory::uint8Array data(this->_dataSize);
+	data.copy(this->_data.get(), this->_dataSize);
+	return (data);
 }
 
 void
@@ -302,18 +760,157 @@ BiometricEvaluation::Image::Image::setBitDepth(
 	this->_bitDepth = bitDepth;
 }
 
+void
+BiometricEvaluation::Image::Image::setAttributes(
+    const Attributes &attributes)
+{
+	this->setDimensions(attributes.dimensions);
+	this->setColorDepth(attributes.colorDepth);
+	this->setBitDepth(attributes.bitDepth);
+	this->setResolution(attributes.resolution);
+	this->setHasAlphaChannel(attributes.hasAlphaChannel);
+}
+
 const uint8_t *
 BiometricEvaluation::Image::Image::getDataPointer()
     const
 {
-	return (&(*(this->_data)));
+	return (this->_data.get());
 }
 
 uint64_t
 BiometricEvaluation::Image::Image::getDataSize()
     const
 {
-	return (this->_data.size());
+	return (this->_dataSize);
+}
+
+std::shared_ptr<const uint8_t>
+BiometricEvaluation::Image::Image::copyData(
+    const uint8_t *data,
+    const uint64_t size)
+{
+	const auto copy = std::make_shared<Memory::uint8Array>(size);
+	copy->copy(data, size);
+	return (Image::shareData(copy));
+}
+
+std::shared_ptr<const uint8_t>
+BiometricEvaluation::Image::Image::shareData(
+    const std::shared_ptr<const Memory::uint8Array> &data)
+{
+	if (data == nullptr)
+		return (nullptr);
+
+	/* Pointer to the contents that keeps the AutoArray alive */
+	return (std::shared_ptr<const uint8_t>(data,
+	    static_cast<const uint8_t *>(*data)));
+}
+
+std::shared_ptr<const uint8_t>
+BiometricEvaluation::Image::Image::borrowData(
+    const uint8_t *data)
+{
+	/* Pointer to the contents that frees nothing */
+	return (std::shared_ptr<const uint8_t>(data, BorrowedDataDeleter()));
+}
+
+void
+BiometricEvaluation::Image::Image::setRetainDecodedData(
+    bool retain)
+{
+	std::lock_guard<std::mutex> lock(this->_decodedData->mutex);
+	this->_decodedData->retain = retain;
+	if (!retain)
+		this->_decodedData->pixels.clear();
+}
+
+bool
+BiometricEvaluation::Image::Image::getRetainDecodedData()
+    const
+{
+	std::lock_guard<std::mutex> lock(this->_decodedData->mutex);
+	return (this->_decodedData->retain);
+}
+
+void
+BiometricEvaluation::Image::Image::releaseDecodedData()
+    const
+{
+	std::lock_guard<std::mutex> lock(this->_decodedData->mutex);
+	this->_decodedData->pixels.clear();
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::Image::getDecodedData(
+    DecodeCache::Representation representation,
+    const std::function<Memory::uint8Array()> &decode)
+    const
+{
+	bool retain;
+	{
+		std::lock_guard<std::mutex> lock(this->_decodedData->mutex);
+		retain = this->_decodedData->retain;
+		if (retain) {
+			const auto it = this->_decodedData->pixels.find(
+			    representation);
+			if (it != this->_decodedData->pixels.end()) {
+				DecodeCache::countRetainedHit();
+				return (Memory::uint8Array(*(it->second)));
+			}
+		}
+	}
+	const bool shared = (DecodeCache::getCapacity() > 0);
+	if (!retain && !shared)
+		return (decode());
+
+	DecodeCache::Key key;
+	DecodeCache::Pixels pixels;
+	if (shared) {
+		key.size = this->getDataSize();
+		key.representation = representation;
+		if ((DecodeCache::getKeyType() ==
+		    DecodeCache::KeyType::Identifier) &&
+		    !this->_identifier.empty()) {
+			key.identifier = this->_identifier;
+		} else {
+			std::lock_guard<std::mutex> lock(
+			    this->_decodedData->mutex);
+			if (!this->_decodedData->hashed) {
+				this->_decodedData->hash =
+				    std::hash<std::string_view>()(
+				    std::string_view(reinterpret_cast<
+				    const char *>(this->getDataPointer()),
+				    this->getDataSize()));
+				this->_decodedData->hashed = true;
+			}
+			key.hash = this->_decodedData->hash;
+			key.data = this->_data;
+		}
+		pixels = DecodeCache::find(key);
+	}
+
+	if (pixels == nullptr) {
+		pixels = std::make_shared<const Memory::uint8Array>(decode());
+		DecodeCache::countMiss();
+		if (shared) {
+			/* Borrowed data may be freed while the entry exists */
+			if ((key.data != nullptr) &&
+			    (std::get_deleter<BorrowedDataDeleter>(
+			    this->_data) != nullptr))
+				key.data = Image::copyData(
+				    this->getDataPointer(),
+				    this->getDataSize());
+			DecodeCache::insert(key, pixels);
+		}
+	}
+
+	if (retain) {
+		std::lock_guard<std::mutex> lock(this->_decodedData->mutex);
+		if (this->_decodedData->retain)
+			this->_decodedData->pixels[representation] = pixels;
+	}
+	return (Memory::uint8Array(*pixels));
 }
 
 BiometricEvaluation::Image::Image::~Image()
@@ -345,7 +942,24 @@ BiometricEvaluation::Image::Image::openImage(
     const std::string &identifier,
     const statusCallback_t &statusCallback)
 {
-	switch (Image::getCompressionAlgorithm(data, size)) {
+	/* Don't copy data that can't be opened */
+	if (Image::getCompressionAlgorithm(data, size) ==
+	    CompressionAlgorithm::None)
+		throw Error::StrategyError("Could not determine compression "
+		    "algorithm");
+
+	return (Image::openImage(Image::copyData(data, size), size,
+	    identifier, statusCallback));
+}
+
+std::shared_ptr<BiometricEvaluation::Image::Image>
+BiometricEvaluation::Image::Image::openImage(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback)
+{
+	switch (Image::getCompressionAlgorithm(data.get(), size)) {
 	case CompressionAlgorithm::JPEGB:
 		return (std::shared_ptr<Image>(new JPEG(data, size,
 		    identifier, statusCallback)));
@@ -412,13 +1026,27 @@ BiometricEvaluation::Image::Image::openImage(
 	    statusCallback));
 }
 
+std::shared_ptr<BiometricEvaluation::Image::Image>
+BiometricEvaluation::Image::Image::openImage(
+    const std::shared_ptr<const Memory::uint8Array> &data,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback)
+{
+	if (data == nullptr)
+		throw Error::ParameterError("No image data");
+
+	return (Image::openImage(Image::shareData(data), data->size(),
+	    identifier, statusCallback));
+}
+
 std::shared_ptr<BiometricEvaluation::Image::Image>
 BiometricEvaluation::Image::Image::openImage(
     const std::string &path,
     const statusCallback_t &statusCallback)
 {
-	Memory::uint8Array data = IO::Utility::readFile(path);
-	return (Image::openImage(data, path, statusCallback));
+	/* The Image takes the file contents without copying them */
+	return (Image::openImage(std::make_shared<const Memory::uint8Array>(
+	    IO::Utility::readFile(path)), path, statusCallback));
 }
 
 BiometricEvaluation::Image::CompressionAlgorithm
@@ -426,22 +1054,57 @@ BiometricEvaluation::Image::Image::getCompressionAlgorithm(
     const uint8_t *data,
     const uint64_t size)
 {
-	if (NetPBM::isNetPBM(data, size))
-		return (CompressionAlgorithm::NetPBM);
-	else if (JPEG2000::isJPEG2000(data, size))
-		return (CompressionAlgorithm::JP2);
-	else if (JPEG::isJPEG(data, size))
-		return (CompressionAlgorithm::JPEGB);
-	else if (JPEGL::isJPEGL(data, size))
-		return (CompressionAlgorithm::JPEGL);
-	else if (PNG::isPNG(data, size))
-		return (CompressionAlgorithm::PNG);
-	else if (BMP::isBMP(data, size))
-		return (CompressionAlgorithm::BMP);
-	else if (WSQ::isWSQ(data, size))
-		return (CompressionAlgorithm::WSQ20);
-	else if (TIFF::isTIFF(data, size))
-		return (CompressionAlgorithm::TIFF);
+	if ((data == nullptr) || (size == 0))
+		return (CompressionAlgorithm::None);
+
+	/*
+	 * Only check the formats whose magic numbers can begin with the
+	 * first byte, in the order they were historically checked.
+	 */
+	switch (data[0]) {
+	case '#':	/* NetPBM comment */
+		if (NetPBM::isNetPBM(data, size))
+			return (CompressionAlgorithm::NetPBM);
+		break;
+	case 'P':	/* NetPBM "P1"-"P6" or BMP "PT" */
+		if (NetPBM::isNetPBM(data, size))
+			return (CompressionAlgorithm::NetPBM);
+		else if (BMP::isBMP(data, size))
+			return (CompressionAlgorithm::BMP);
+		break;
+	case 0x00:	/* JPEG 2000 signature box */
+		if (JPEG2000::isJPEG2000(data, size))
+			return (CompressionAlgorithm::JP2);
+		break;
+	case 0xFF:	/* JPEG, Lossless JPEG, or WSQ start of image */
+		if (JPEG::isJPEG(data, size))
+			return (CompressionAlgorithm::JPEGB);
+		else if (JPEGL::isJPEGL(data, size))
+			return (CompressionAlgorithm::JPEGL);
+		else if (WSQ::isWSQ(data, size))
+			return (CompressionAlgorithm::WSQ20);
+		break;
+	case 0x89:	/* PNG signature */
+		if (PNG::isPNG(data, size))
+			return (CompressionAlgorithm::PNG);
+		break;
+	case 'B':	/* BMP "BM" or "BA" */
+		/* FALLTHROUGH */
+	case 'C':	/* BMP "CI" or "CP" */
+		if (BMP::isBMP(data, size))
+			return (CompressionAlgorithm::BMP);
+		break;
+	case 'I':	/* BMP "IC" or little-endian TIFF */
+		if (BMP::isBMP(data, size))
+			return (CompressionAlgorithm::BMP);
+		else if (TIFF::isTIFF(data, size))
+			return (CompressionAlgorithm::TIFF);
+		break;
+	case 'M':	/* Big-endian TIFF */
+		if (TIFF::isTIFF(data, size))
+			return (CompressionAlgorithm::TIFF);
+		break;
+	}
 
 	return (CompressionAlgorithm::None);
 }
@@ -461,6 +1124,43 @@ BiometricEvaluation::Image::Image::getCompressionAlgorithm(
 	return (Image::getCompressionAlgorithm(data));
 }
 
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::Image::probe(
+    const uint8_t *data,
+    const uint64_t size)
+{
+	switch (Image::getCompressionAlgorithm(data, size)) {
+	case CompressionAlgorithm::JPEGB:
+		return (JPEG::probe(data, size));
+	case CompressionAlgorithm::JPEGL:
+		return (JPEGL::probe(data, size));
+	case CompressionAlgorithm::JP2:
+		/* FALLTHROUGH */
+	case CompressionAlgorithm::JP2L:
+		return (JPEG2000::probe(data, size));
+	case CompressionAlgorithm::PNG:
+		return (PNG::probe(data, size));
+	case CompressionAlgorithm::NetPBM:
+		return (NetPBM::probe(data, size));
+	case CompressionAlgorithm::WSQ20:
+		return (WSQ::probe(data, size));
+	case CompressionAlgorithm::BMP:
+		return (BMP::probe(data, size));
+	case CompressionAlgorithm::TIFF:
+		return (TIFF::probe(data, size));
+	default:
+		throw Error::StrategyError("Could not determine compression "
+		    "algorithm");
+	}
+}
+
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::Image::probe(
+    const Memory::uint8Array &data)
+{
+	return (Image::probe(data, data.size()));
+}
+
 BiometricEvaluation::Image::Raw
 BiometricEvaluation::Image::Image::getRawImage(
     const std::shared_ptr<BiometricEvaluation::Image::Image> &image)
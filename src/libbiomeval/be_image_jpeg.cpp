@@ -8,7 +8,12 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>		/* Needed for NBIS headers */
+#include <cstring>
+#include <memory>
+#include <vector>
 
 extern "C" {
 	#include <computil.h>
@@ -18,14 +23,193 @@ extern "C" {
 }
 
 #include <be_image_jpeg.h>
+#include <be_image_raw.h>
+#include <be_memory_indexedbuffer.h>
 
 namespace BE = BiometricEvaluation;
 
+/**
+ * @brief
+ * libjpeg decompression object reused by the calling thread.
+ *
+ * @details
+ * Each thread keeps one decompression object, which is reset with
+ * jpeg_abort_decompress() between images instead of being created and
+ * destroyed for every image.  A nested use on the same thread gets its
+ * own object.
+ */
+class JPEGDecompressor
+{
+public:
+	/** Error handling routines of a jpeg_error_mgr */
+	struct Handlers
+	{
+		void (*error_exit)(j_common_ptr);
+		void (*emit_message)(j_common_ptr, int);
+		void (*output_message)(j_common_ptr);
+	};
+
+	/**
+	 * @brief
+	 * Borrow the calling thread's decompression object.
+	 *
+	 * @param handlers
+	 * Error handling routines, which must throw from error_exit.
+	 * @param clientData
+	 * Value for client_data while borrowed.
+	 */
+	JPEGDecompressor(
+	    const Handlers &handlers,
+	    const void *clientData) :
+	    _context(&JPEGDecompressor::threadContext(handlers))
+	{
+		if (this->_context->inUse) {
+			this->_owned.reset(new Context(handlers));
+			this->_context = this->_owned.get();
+		}
+		this->_context->inUse = true;
+		this->_context->dinfo.client_data = const_cast<void *>(
+		    clientData);
+	}
+
+	/** Return the object to its initial state for the next image. */
+	~JPEGDecompressor()
+	{
+		jpeg_abort_decompress(&this->_context->dinfo);
+		this->_context->dinfo.client_data = nullptr;
+		this->_context->inUse = false;
+	}
+
+	/** @return libjpeg decompression object. */
+	j_decompress_ptr
+	get()
+	{
+		return (&this->_context->dinfo);
+	}
+
+	JPEGDecompressor(const JPEGDecompressor&) = delete;
+	JPEGDecompressor& operator=(const JPEGDecompressor&) = delete;
+
+private:
+	/** Decompression object and the error manager it refers to */
+	struct Context
+	{
+		Context(
+		    const Handlers &handlers)
+		{
+			jpeg_std_error(&this->err);
+			this->err.error_exit = handlers.error_exit;
+			this->err.emit_message = handlers.emit_message;
+			this->err.output_message = handlers.output_message;
+
+			this->dinfo.err = &this->err;
+			this->dinfo.client_data = nullptr;
+			jpeg_create_decompress(&this->dinfo);
+		}
+
+		~Context()
+		{
+			jpeg_destroy_decompress(&this->dinfo);
+		}
+
+		struct jpeg_error_mgr err;
+		struct jpeg_decompress_struct dinfo;
+		bool inUse{false};
+	};
+
+	static Context&
+	threadContext(
+	    const Handlers &handlers)
+	{
+		thread_local Context context(handlers);
+		return (context);
+	}
+
+	Context *_context;
+	std::unique_ptr<Context> _owned{};
+};
+
+/** libjpeg destination manager writing to an AutoArray. */
+struct jpeg_output_buffer
+{
+	/** libjpeg's view of the destination (must be first) */
+	struct jpeg_destination_mgr manager;
+	/** JPEG-encoded buffer, with spare capacity */
+	BE::Memory::uint8Array data;
+};
+
+/**
+ * @brief
+ * libjpeg callback to prepare the destination.
+ *
+ * @param cinfo
+ * libjpeg compression struct, whose dest is a jpeg_output_buffer.
+ */
+static void
+init_destination_mem(
+    j_compress_ptr cinfo);
+
+/**
+ * @brief
+ * libjpeg callback when the destination is full.
+ *
+ * @param cinfo
+ * libjpeg compression struct, whose dest is a jpeg_output_buffer.
+ *
+ * @return
+ * TRUE, after the destination has grown.
+ */
+static boolean
+empty_output_buffer_mem(
+    j_compress_ptr cinfo);
+
+/**
+ * @brief
+ * libjpeg callback after the last data has been written.
+ *
+ * @param cinfo
+ * libjpeg compression struct, whose dest is a jpeg_output_buffer.
+ */
+static void
+term_destination_mem(
+    j_compress_ptr cinfo);
+
+/**
+ * @brief
+ * Decode the remaining scanlines straight into a buffer.
+ *
+ * @param dinfo
+ * libjpeg decompression struct, after jpeg_start_decompress().
+ * @param output
+ * Buffer of at least output_height rows of row_stride bytes.
+ * @param row_stride
+ * Size of one decoded row.
+ */
+static void
+readScanlines(
+    j_decompress_ptr dinfo,
+    uint8_t *output,
+    const uint64_t row_stride);
+
 BiometricEvaluation::Image::JPEG::JPEG(
     const uint8_t *data,
     const uint64_t size,
     const std::string &identifier,
     const statusCallback_t &statusCallback) :
+    BiometricEvaluation::Image::JPEG::JPEG(
+    Image::copyData(data, size),
+    size,
+    identifier,
+    statusCallback)
+{
+
+}
+
+BiometricEvaluation::Image::JPEG::JPEG(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
     Image::Image(
     data,
     size,
@@ -33,17 +217,10 @@ BiometricEvaluation::Image::JPEG::JPEG(
     identifier,
     statusCallback)
 {
-	/* Initialize custom JPEG error manager to throw exceptions */
-	struct jpeg_error_mgr jpeg_error_mgr;
-	jpeg_std_error(&jpeg_error_mgr);
-	jpeg_error_mgr.error_exit = JPEG::error_exit;
-	jpeg_error_mgr.emit_message = JPEG::emit_message;
-	jpeg_error_mgr.output_message = JPEG::output_message;
-
-	struct jpeg_decompress_struct dinfo;
-	dinfo.err = &jpeg_error_mgr;
-	dinfo.client_data = (void *)this;
-	jpeg_create_decompress(&dinfo);
+	/* Custom JPEG error manager throws exceptions */
+	JPEGDecompressor decompressor({JPEG::error_exit, JPEG::emit_message,
+	    JPEG::output_message}, this);
+	struct jpeg_decompress_struct &dinfo = *decompressor.get();
 
 #if JPEG_LIB_VERSION >= 80
 	::jpeg_mem_src(&dinfo, (unsigned char *)this->getDataPointer(),
@@ -63,8 +240,6 @@ BiometricEvaluation::Image::JPEG::JPEG(
 	setResolution(Resolution(dinfo.X_density, dinfo.Y_density,
 	    Resolution::Units::PPI));
 
-	/* Clean up after libjpeg */
-	jpeg_destroy_decompress(&dinfo);
 }
 
 BiometricEvaluation::Image::JPEG::JPEG(
@@ -81,20 +256,23 @@ BiometricEvaluation::Image::JPEG::JPEG(
 }
 
 BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::Image::JPEG::getRawData()
+BiometricEvaluation::Image::JPEG::decodeRawData()
     const
 {
-	/* Initialize custom JPEG error manager to throw exceptions */
-	struct jpeg_error_mgr jpeg_error_mgr;
-	jpeg_std_error(&jpeg_error_mgr);
-	jpeg_error_mgr.error_exit = JPEG::error_exit;
-	jpeg_error_mgr.emit_message = JPEG::emit_message;
-	jpeg_error_mgr.output_message = JPEG::output_message;
+	Memory::uint8Array rawData;
+	this->decodeRawDataInto(rawData);
+	return (rawData);
+}
 
-	struct jpeg_decompress_struct dinfo;
-	dinfo.err = &jpeg_error_mgr;
-	dinfo.client_data = (void *)this;
-	jpeg_create_decompress(&dinfo);
+void
+BiometricEvaluation::Image::JPEG::decodeRawDataInto(
+    Memory::uint8Array &rawData)
+    const
+{
+	/* Custom JPEG error manager throws exceptions */
+	JPEGDecompressor decompressor({JPEG::error_exit, JPEG::emit_message,
+	    JPEG::output_message}, this);
+	struct jpeg_decompress_struct &dinfo = *decompressor.get();
 
 #if JPEG_LIB_VERSION >= 80
 	::jpeg_mem_src(&dinfo, (unsigned char *)this->getDataPointer(),
@@ -109,43 +287,119 @@ BiometricEvaluation::Image::JPEG::getRawData()
 	if (jpeg_start_decompress(&dinfo) != TRUE)
 		throw Error::StrategyError("jpeg_start_decompress()");
 
-	uint64_t row_stride = dinfo.output_width * dinfo.output_components;
-	Memory::uint8Array rawData(dinfo.output_height * row_stride);
+	const uint64_t row_stride = static_cast<uint64_t>(
+	    dinfo.output_width) * dinfo.output_components;
+	resizeBuffer(rawData, dinfo.output_height * row_stride);
+	readScanlines(&dinfo, rawData, row_stride);
+
+	jpeg_finish_decompress(&dinfo);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::JPEG::getRawData(
+    const uint8_t reduction,
+    const ROI &roi)
+    const
+{
+	/* libjpeg scales DCT blocks by at most 1/8 */
+	if (reduction > 3)
+		return (Image::getRawData(reduction, roi));
+	const ROI region = this->getReducedROI(reduction, roi);
+
+	/* Full resolution may already be decoded */
+	if ((reduction == 0) && (region.size == this->getDimensions()))
+		return (Image::getRawData(reduction, roi));
+
+	/* Custom JPEG error manager throws exceptions */
+	JPEGDecompressor decompressor({JPEG::error_exit, JPEG::emit_message,
+	    JPEG::output_message}, this);
+	struct jpeg_decompress_struct &dinfo = *decompressor.get();
+
+#if JPEG_LIB_VERSION >= 80
+	::jpeg_mem_src(&dinfo, (unsigned char *)this->getDataPointer(),
+	    this->getDataSize());
+#else
+	JPEG::jpeg_mem_src(&dinfo, (unsigned char *)this->getDataPointer(),
+	    this->getDataSize());
+#endif
+
+	if (jpeg_read_header(&dinfo, TRUE) != JPEG_HEADER_OK)
+		throw Error::StrategyError("jpeg_read_header()");
+	dinfo.scale_num = 1;
+	dinfo.scale_denom = 1 << reduction;
+	if (jpeg_start_decompress(&dinfo) != TRUE)
+		throw Error::StrategyError("jpeg_start_decompress()");
+	if ((region.horzOffset + region.size.xSize > dinfo.output_width) ||
+	    (region.vertOffset + region.size.ySize > dinfo.output_height))
+		throw Error::StrategyError("Scaled image is smaller than "
+		    "expected");
+
+	/*
+	 * Decode only the columns and rows covering the region, with a
+	 * margin on either side so that upsampled chroma at the edges of
+	 * the region matches that of a full decode.
+	 */
+	const JDIMENSION margin = dinfo.max_h_samp_factor *
+	    dinfo.min_DCT_scaled_size;
+	JDIMENSION xOffset = (region.horzOffset > margin) ?
+	    region.horzOffset - margin : 0;
+	JDIMENSION width = std::min<JDIMENSION>(region.horzOffset +
+	    region.size.xSize + margin, dinfo.output_width) - xOffset;
+#ifdef LIBJPEG_TURBO_VERSION_NUMBER
+	jpeg_crop_scanline(&dinfo, &xOffset, &width);
+	if (jpeg_skip_scanlines(&dinfo, region.vertOffset) !=
+	    region.vertOffset)
+		throw Error::StrategyError("jpeg_skip_scanlines()");
+#else
+	xOffset = 0;
+	width = dinfo.output_width;
+#endif
+
+	const uint64_t row_stride = static_cast<uint64_t>(region.size.xSize) *
+	    dinfo.output_components;
+	Memory::uint8Array rawData(region.size.ySize * row_stride);
 
 	JSAMPARRAY buffer = (*dinfo.mem->alloc_sarray)(
-	    (j_common_ptr)&dinfo, JPOOL_IMAGE, row_stride, 1);
+	    (j_common_ptr)&dinfo, JPOOL_IMAGE, width *
+	    dinfo.output_components, 1);
+	const uint64_t skip = static_cast<uint64_t>(region.horzOffset -
+	    xOffset) * dinfo.output_components;
+	/* Decoded rows that are exactly the region's rows */
+	const bool direct = ((skip == 0) && (static_cast<uint64_t>(width) *
+	    dinfo.output_components == row_stride));
+
+	const JDIMENSION end = region.vertOffset + region.size.ySize;
+	for (int n = 0; dinfo.output_scanline < end; ) {
+		const bool inRegion = (dinfo.output_scanline >=
+		    region.vertOffset);
+		if (inRegion && direct) {
+			JSAMPROW row = &rawData[n++ * row_stride];
+			jpeg_read_scanlines(&dinfo, &row, 1);
+			continue;
+		}
 
-	for (int n = 0; dinfo.output_scanline < dinfo.output_height; n++) {
 		jpeg_read_scanlines(&dinfo, buffer, 1);
-		memcpy(&rawData[n * row_stride], buffer[0], row_stride);
+		if (inRegion)
+			memcpy(&rawData[n++ * row_stride], buffer[0] + skip,
+			    row_stride);
 	}
 
-	/* Clean up after libjpeg */
-	jpeg_finish_decompress(&dinfo);
-	jpeg_destroy_decompress(&dinfo);
-
+	/* Remaining rows are not needed, and are discarded on abort */
 	return (rawData);
 }
 
 BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::Image::JPEG::getRawGrayscaleData(
+BiometricEvaluation::Image::JPEG::decodeRawGrayscaleData(
     uint8_t depth)
     const
 {
 	if (depth != 8 && depth != 1)
 		throw Error::ParameterError("Invalid value for bit depth");
 
-	/* Initialize custom JPEG error manager to throw exceptions */
-	struct jpeg_error_mgr jpeg_error_mgr;
-	jpeg_std_error(&jpeg_error_mgr);
-	jpeg_error_mgr.error_exit = JPEG::error_exit;
-	jpeg_error_mgr.emit_message = JPEG::emit_message;
-	jpeg_error_mgr.output_message = JPEG::output_message;
-
-	struct jpeg_decompress_struct dinfo;
-	dinfo.err = &jpeg_error_mgr;
-	dinfo.client_data = (void *)this;
-	jpeg_create_decompress(&dinfo);
+	/* Custom JPEG error manager throws exceptions */
+	JPEGDecompressor decompressor({JPEG::error_exit, JPEG::emit_message,
+	    JPEG::output_message}, this);
+	struct jpeg_decompress_struct &dinfo = *decompressor.get();
 
 #if JPEG_LIB_VERSION >= 80
 	::jpeg_mem_src(&dinfo, (unsigned char *)this->getDataPointer(),
@@ -174,34 +428,26 @@ BiometricEvaluation::Image::JPEG::getRawGrayscaleData(
 	if (jpeg_start_decompress(&dinfo) != TRUE)
 		throw Error::StrategyError("jpeg_start_decompress()");
 
-	uint64_t row_stride = dinfo.output_width * dinfo.output_components;
+	const uint64_t row_stride = static_cast<uint64_t>(
+	    dinfo.output_width) * dinfo.output_components;
 	Memory::uint8Array rawGray(dinfo.output_height * row_stride);
+	readScanlines(&dinfo, rawGray, row_stride);
 
-	JSAMPARRAY buffer = (*dinfo.mem->alloc_sarray)(
-	    (j_common_ptr)&dinfo, JPOOL_IMAGE, row_stride, 1);
-
-	for (int n = 0; dinfo.output_scanline < dinfo.output_height; n++) {
-		jpeg_read_scanlines(&dinfo, buffer, 1);
-
-		switch (depth) {
-		case 1:
-			/*
-			 * Quantize 1 bit per pixel value into an 8 bit
-			 * container by mapping 1 to 255.
-			 *
-			 * TODO: Use a colormap to support 2-7 bit depth.
-			 */
-			for (uint64_t i = 0; i < row_stride; i++)
-				if (buffer[0][i] == 0x01)
-					buffer[0][i] = 0xFF;
-			break;
-		}
-		memcpy(&rawGray[n * row_stride], buffer[0], row_stride);
+	switch (depth) {
+	case 1:
+		/*
+		 * Quantize 1 bit per pixel value into an 8 bit
+		 * container by mapping 1 to 255.
+		 *
+		 * TODO: Use a colormap to support 2-7 bit depth.
+		 */
+		for (uint64_t i = 0; i < rawGray.size(); i++)
+			if (rawGray[i] == 0x01)
+				rawGray[i] = 0xFF;
+		break;
 	}
 
-	/* Clean up after libjpeg */
 	jpeg_finish_decompress(&dinfo);
-	jpeg_destroy_decompress(&dinfo);
 
 	return (rawGray);
 }
@@ -365,6 +611,206 @@ BiometricEvaluation::Image::JPEG::emit_message(
 	}
 }
 
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::JPEG::probe(
+    const uint8_t *data,
+    const uint64_t size)
+{
+	/*
+	 * JPEG markers (ISO/IEC 10918-1:1993), without the leading 0xFF
+	 */
+	static const uint8_t startOfImage = 0xD8;
+	static const uint8_t endOfImage = 0xD9;
+	static const uint8_t startOfScan = 0xDA;
+	static const uint8_t temporary = 0x01;
+	static const uint8_t restart0 = 0xD0;
+	static const uint8_t restart7 = 0xD7;
+	static const uint8_t application0 = 0xE0;
+	static const uint8_t defineHuffmanTables = 0xC4;
+	static const uint8_t extensions = 0xC8;
+	static const uint8_t defineArithmeticConditioning = 0xCC;
+	static const uint8_t startOfFrameFirst = 0xC0;
+	static const uint8_t startOfFrameLast = 0xCF;
+
+	/* JFIF APP0 identifier and minimum length, as required by libjpeg */
+	static const uint8_t JFIFIdentifier[5] = {'J', 'F', 'I', 'F', 0x00};
+	static const uint16_t JFIFLength = 14;
+
+	Attributes attributes;
+	attributes.compressionAlgorithm = CompressionAlgorithm::JPEGB;
+	attributes.bitDepth = 8;
+	attributes.hasAlphaChannel = false;
+	/* libjpeg's density when there is no JFIF segment */
+	attributes.resolution = Resolution(1, 1, Resolution::Units::PPI);
+
+	Memory::IndexedBuffer buffer(data, size);
+	if ((buffer.scanU8Val() != 0xFF) ||
+	    (buffer.scanU8Val() != startOfImage))
+		throw Error::DataError("No SOI marker");
+
+	/* Read marker segments until the first scan, as libjpeg does */
+	bool sawFrame = false;
+	for (;;) {
+		/* Markers may be preceded by any number of fill bytes */
+		if (buffer.scanU8Val() != 0xFF)
+			throw Error::DataError("Expected marker at offset " +
+			    std::to_string(buffer.getIndex() - 1));
+		uint8_t marker;
+		do {
+			marker = buffer.scanU8Val();
+		} while (marker == 0xFF);
+
+		if ((marker == startOfScan) || (marker == endOfImage))
+			break;
+		/* Markers without a segment */
+		if ((marker == temporary) ||
+		    ((marker >= restart0) && (marker <= restart7)))
+			continue;
+
+		/* Length includes itself, but not the marker */
+		const uint16_t length = buffer.scanBeU16Val();
+		if (length < sizeof(length))
+			throw Error::DataError("Invalid marker segment length");
+		const uint64_t segment = buffer.getIndex();
+		const uint64_t next = segment + length - sizeof(length);
+		if (next > size)
+			throw Error::DataError("Truncated marker segment");
+
+		if ((marker == application0) && (length >= JFIFLength) &&
+		    (std::memcmp(data + segment, JFIFIdentifier,
+		    sizeof(JFIFIdentifier)) == 0)) {
+			/* Skip identifier, version, and units */
+			buffer.setIndex(segment + sizeof(JFIFIdentifier) + 3);
+			const uint16_t xDensity = buffer.scanBeU16Val();
+			const uint16_t yDensity = buffer.scanBeU16Val();
+			attributes.resolution = Resolution(xDensity, yDensity,
+			    Resolution::Units::PPI);
+		} else if ((marker >= startOfFrameFirst) &&
+		    (marker <= startOfFrameLast) &&
+		    (marker != defineHuffmanTables) &&
+		    (marker != extensions) &&
+		    (marker != defineArithmeticConditioning) && !sawFrame) {
+			/* Precision, height, width, and number of components */
+			buffer.scanU8Val();
+			const uint16_t height = buffer.scanBeU16Val();
+			const uint16_t width = buffer.scanBeU16Val();
+			const uint8_t components = buffer.scanU8Val();
+			attributes.dimensions = Size(width, height);
+			attributes.colorDepth = components * 8;
+			sawFrame = true;
+		}
+
+		buffer.setIndex(next);
+	}
+
+	if (!sawFrame)
+		throw Error::DataError("No SOF marker before first scan");
+
+	return (attributes);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::JPEG::encode(
+    const Raw &raw,
+    const uint8_t quality)
+{
+	if ((quality < 1) || (quality > 100))
+		throw Error::ParameterError("Invalid quality");
+	const Size dimensions = raw.getDimensions();
+	if ((dimensions.xSize == 0) || (dimensions.ySize == 0))
+		throw Error::ParameterError("No pixels to encode");
+	if (raw.getBitDepth() != 8)
+		throw Error::NotImplemented("Encoding " + std::to_string(
+		    raw.getBitDepth()) + "-bit components");
+	if (raw.hasAlphaChannel())
+		throw Error::NotImplemented("Encoding an alpha channel");
+
+	J_COLOR_SPACE colorSpace;
+	switch (raw.getColorDepth()) {
+	case 8:
+		colorSpace = JCS_GRAYSCALE;
+		break;
+	case 24:
+		colorSpace = JCS_RGB;
+		break;
+	default:
+		throw Error::NotImplemented("Encoding " + std::to_string(
+		    raw.getColorDepth()) + "-bit pixels");
+	}
+	const uint8_t components = raw.getColorDepth() / 8;
+
+	const Memory::uint8Array rawData = raw.getRawData();
+	const uint64_t rowbytes = static_cast<uint64_t>(dimensions.xSize) *
+	    components;
+	if (rawData.size() < (rowbytes * dimensions.ySize))
+		throw Error::ParameterError("Raw data is smaller than "
+		    "dimensions");
+
+	struct jpeg_error_mgr jpeg_error_mgr;
+	jpeg_std_error(&jpeg_error_mgr);
+	jpeg_error_mgr.error_exit = JPEG::error_exit;
+	jpeg_error_mgr.emit_message = JPEG::emit_message;
+	jpeg_error_mgr.output_message = JPEG::output_message;
+
+	struct jpeg_compress_struct cinfo;
+	cinfo.err = &jpeg_error_mgr;
+	cinfo.client_data = nullptr;
+	jpeg_create_compress(&cinfo);
+
+	/* Start with a guess of 8:1 compression */
+	jpeg_output_buffer output;
+	output.data.resize((rowbytes * dimensions.ySize / 8) + 1024);
+	output.manager.init_destination = init_destination_mem;
+	output.manager.empty_output_buffer = empty_output_buffer_mem;
+	output.manager.term_destination = term_destination_mem;
+	cinfo.dest = &output.manager;
+
+	try {
+		cinfo.image_width = dimensions.xSize;
+		cinfo.image_height = dimensions.ySize;
+		cinfo.input_components = components;
+		cinfo.in_color_space = colorSpace;
+		jpeg_set_defaults(&cinfo);
+		jpeg_set_quality(&cinfo, quality, TRUE);
+
+		/* JFIF density is only defined in inches and centimeters */
+		const Resolution resolution = raw.getResolution();
+		switch (resolution.units) {
+		case Resolution::Units::PPI:
+			cinfo.density_unit = 1;
+			cinfo.X_density = std::lround(resolution.xRes);
+			cinfo.Y_density = std::lround(resolution.yRes);
+			break;
+		case Resolution::Units::PPCM:
+			/* FALLTHROUGH */
+		case Resolution::Units::PPMM: {
+			const Resolution ppcm = resolution.toUnits(
+			    Resolution::Units::PPCM);
+			cinfo.density_unit = 2;
+			cinfo.X_density = std::lround(ppcm.xRes);
+			cinfo.Y_density = std::lround(ppcm.yRes);
+			break;
+		}
+		case Resolution::Units::NA:
+			break;
+		}
+
+		jpeg_start_compress(&cinfo, TRUE);
+		while (cinfo.next_scanline < cinfo.image_height) {
+			JSAMPROW row = const_cast<JSAMPROW>(rawData +
+			    (cinfo.next_scanline * rowbytes));
+			jpeg_write_scanlines(&cinfo, &row, 1);
+		}
+		jpeg_finish_compress(&cinfo);
+	} catch (...) {
+		jpeg_destroy_compress(&cinfo);
+		throw;
+	}
+	jpeg_destroy_compress(&cinfo);
+
+	return (output.data);
+}
+
 int
 BiometricEvaluation::Image::JPEG::getc_skip_marker_segment(
     const unsigned short marker,
@@ -469,4 +915,55 @@ BiometricEvaluation::Image::JPEG::term_source_mem(
 }
 #endif /* JPEG_LIB_VERSION */
 
+void
+init_destination_mem(
+    j_compress_ptr cinfo)
+{
+	jpeg_output_buffer *output = reinterpret_cast<jpeg_output_buffer *>(
+	    cinfo->dest);
+	output->manager.next_output_byte = output->data;
+	output->manager.free_in_buffer = output->data.size();
+}
+
+boolean
+empty_output_buffer_mem(
+    j_compress_ptr cinfo)
+{
+	/* libjpeg ignores free_in_buffer, and expects the whole buffer used */
+	jpeg_output_buffer *output = reinterpret_cast<jpeg_output_buffer *>(
+	    cinfo->dest);
+	const uint64_t used = output->data.size();
+	output->data.resize(used * 2);
+	output->manager.next_output_byte = output->data + used;
+	output->manager.free_in_buffer = output->data.size() - used;
 
+	return (TRUE);
+}
+
+void
+term_destination_mem(
+    j_compress_ptr cinfo)
+{
+	jpeg_output_buffer *output = reinterpret_cast<jpeg_output_buffer *>(
+	    cinfo->dest);
+	output->data.resize(output->data.size() -
+	    output->manager.free_in_buffer);
+}
+
+void
+readScanlines(
+    j_decompress_ptr dinfo,
+    uint8_t *output,
+    const uint64_t row_stride)
+{
+	/* Ask for as many rows as libjpeg produces at once */
+	std::vector<JSAMPROW> rows(std::max(dinfo->rec_outbuf_height, 1));
+	while (dinfo->output_scanline < dinfo->output_height) {
+		const JDIMENSION count = std::min<JDIMENSION>(rows.size(),
+		    dinfo->output_height - dinfo->output_scanline);
+		for (JDIMENSION i = 0; i < count; i++)
+			rows[i] = output + ((dinfo->output_scanline + i) *
+			    row_stride);
+		jpeg_read_scanlines(dinfo, rows.data(), count);
+	}
+}
@@ -10,8 +10,13 @@
 
 #include <openjpeg.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <mutex>
 #include <be_image_jpeg2000.h>
+#include <be_image_raw.h>
 #include <be_memory_mutableindexedbuffer.h>
 
 namespace BE = BiometricEvaluation;
@@ -73,34 +78,140 @@ struct OpenJPEG_StreamDeleter
 	}
 };
 
+/* libopenjp2 added opj_codec_set_threads() in 2.2 */
+#if defined(OPJ_VERSION_MAJOR) && ((OPJ_VERSION_MAJOR > 2) || \
+    ((OPJ_VERSION_MAJOR == 2) && (OPJ_VERSION_MINOR >= 2)))
+#define BE_IMAGE_JPEG2000_THREADS 1
+#endif
+
+/** Decode thread count of JPEG2000 objects constructed from now on */
+static std::atomic<uint32_t> DefaultDecodeThreadCount{1};
+/** Whether JPEG2000 objects constructed from now on hold their header */
+static std::atomic<bool> DefaultRetainHeader{false};
+
+struct BiometricEvaluation::Image::JPEG2000::Decompression
+{
+	/** Protects all members */
+	std::mutex mutex{};
+	/** Object whose address was given to the codec's handlers */
+	const JPEG2000 *owner{nullptr};
+	/** Threads the codec was set up to use */
+	uint32_t threads{1};
+
+	std::unique_ptr<opj_codec_t, OpenJPEG_CodecDeleter> codec{};
+	std::unique_ptr<opj_stream_t, OpenJPEG_StreamDeleter> stream{};
+	/** Header read from stream */
+	std::unique_ptr<opj_image_t, OpenJPEG_ImageDeleter> image{};
+};
+
+/** Destination of an OpenJPEG output stream */
+struct OpenJPEG_OutputBuffer
+{
+	/** Encoded data, with spare capacity */
+	BE::Memory::uint8Array data;
+	/** Position of the next write */
+	uint64_t offset;
+	/** Number of bytes written */
+	uint64_t length;
+};
+
+/**
+ * @brief
+ * libopenjp2 callback to write to an OpenJPEG_OutputBuffer.
+ *
+ * @param p_buffer
+ * Data to write.
+ * @param p_nb_bytes
+ * Size of p_buffer.
+ * @param p_user_data
+ * Pointer to an OpenJPEG_OutputBuffer.
+ *
+ * @return
+ * Number of bytes written.
+ */
+static OPJ_SIZE_T
+libopenjp2WriteMem(
+    void *p_buffer,
+    OPJ_SIZE_T p_nb_bytes,
+    void *p_user_data);
+
+/**
+ * @brief
+ * libopenjp2 callback to skip ahead in an OpenJPEG_OutputBuffer.
+ *
+ * @param p_nb_bytes
+ * Number of bytes to skip.
+ * @param p_user_data
+ * Pointer to an OpenJPEG_OutputBuffer.
+ *
+ * @return
+ * Number of bytes skipped.
+ */
+static OPJ_OFF_T
+libopenjp2SkipMem(
+    OPJ_OFF_T p_nb_bytes,
+    void *p_user_data);
+
+/**
+ * @brief
+ * libopenjp2 callback to move within an OpenJPEG_OutputBuffer.
+ *
+ * @param p_nb_bytes
+ * Absolute position.
+ * @param p_user_data
+ * Pointer to an OpenJPEG_OutputBuffer.
+ *
+ * @return
+ * OPJ_TRUE.
+ */
+static OPJ_BOOL
+libopenjp2SeekMem(
+    OPJ_OFF_T p_nb_bytes,
+    void *p_user_data);
+
 BiometricEvaluation::Image::JPEG2000::JPEG2000(
     const uint8_t *data,
     const uint64_t size,
     const std::string &identifier,
     const statusCallback_t &statusCallback,
     const int8_t codecFormat) :
+    BiometricEvaluation::Image::JPEG2000::JPEG2000(
+    Image::copyData(data, size),
+    size,
+    identifier,
+    statusCallback,
+    codecFormat)
+{
+
+}
+
+BiometricEvaluation::Image::JPEG2000::JPEG2000(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback,
+    const int8_t codecFormat) :
     Image::Image(
     data,
     size,
     CompressionAlgorithm::JP2,
     identifier,
     statusCallback),
-    _codecFormat(codecFormat)
+    _codecFormat(codecFormat),
+    _decodeThreadCount(DefaultDecodeThreadCount)
 {
 	std::unique_ptr<opj_codec_t, OpenJPEG_CodecDeleter> codec(
-	    static_cast<opj_codec_t*>(this->getDecompressionCodec()),
-	    OpenJPEG_CodecDeleter{});
+	    static_cast<opj_codec_t*>(this->getDecompressionCodec()));
 	std::unique_ptr<opj_stream_t, OpenJPEG_StreamDeleter> stream(
-	    static_cast<opj_stream_t*>(this->getDecompressionStream()),
-	    OpenJPEG_StreamDeleter{});
+	    static_cast<opj_stream_t*>(this->getDecompressionStream()));
 
 	opj_image_t *imagePtr = nullptr;
 	if (opj_read_header(stream.get(), codec.get(), &imagePtr) == OPJ_FALSE)
 		throw Error::Exception("Could not read header");
 	if (imagePtr == nullptr)
 		throw Error::Exception("Parsed header is empty");
-	std::unique_ptr<opj_image_t, OpenJPEG_ImageDeleter> image(
-	    imagePtr, OpenJPEG_ImageDeleter{});
+	std::unique_ptr<opj_image_t, OpenJPEG_ImageDeleter> header(imagePtr);
+	const opj_image_t *image = imagePtr;
 
 	if (image->numcomps <= 0)
 		throw Error::NotImplemented("No components");
@@ -129,11 +240,11 @@ BiometricEvaluation::Image::JPEG2000::JPEG2000(
 	/* Resolution */
 	static const uint8_t resc[4] = { 0x72, 0x65, 0x73, 0x63 };
 	static const uint8_t resc_box_size = 10;
+	const uint64_t headerSize = getHeaderSize(data.get(), size);
 	/* The Capture Resolution Box is optional under some codecs */
 	try {
-		setResolution(parse_res(find_marker(resc, 4,
-		    this->getDataPointer(), this->getDataSize(),
-		    resc_box_size)));
+		setResolution(parse_res(find_marker(resc, 4, data.get(),
+		    headerSize, resc_box_size)));
 	} catch (const Error::ObjectDoesNotExist&) {
 		setResolution(Resolution(72, 72, Resolution::Units::PPI));
 	}
@@ -143,7 +254,8 @@ BiometricEvaluation::Image::JPEG2000::JPEG2000(
 	 * not Grayscale or RGB (such as RGBA).
 	 */
 	try {
-		this->setHasAlphaChannel(checkForAlphaInCDEF());
+		this->setHasAlphaChannel(checkForAlphaInCDEF(data.get(),
+		    headerSize));
 	} catch (const BE::Error::Exception &) {
 		/* Take best guess on alpha channel presence */
 		this->setHasAlphaChannel((
@@ -156,6 +268,17 @@ BiometricEvaluation::Image::JPEG2000::JPEG2000(
 		    ((image->color_space == OPJ_CLRSPC_UNSPECIFIED) &&
 		    (image->numcomps == 4)));
 	}
+
+	/* Keep the header parsed here for the first decode, if asked */
+	if (DefaultRetainHeader) {
+		this->_decompression = std::make_shared<Decompression>();
+		Decompression &decompression = *this->_decompression;
+		decompression.owner = this;
+		decompression.threads = this->_decodeThreadCount;
+		decompression.codec = std::move(codec);
+		decompression.stream = std::move(stream);
+		decompression.image = std::move(header);
+	}
 }
 
 BiometricEvaluation::Image::JPEG2000::JPEG2000(
@@ -172,34 +295,108 @@ BiometricEvaluation::Image::JPEG2000::JPEG2000(
 }
 
 BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::Image::JPEG2000::getRawData()
+BiometricEvaluation::Image::JPEG2000::decodeRawData()
     const
 {
-	std::unique_ptr<opj_codec_t, OpenJPEG_CodecDeleter> codec(
-	    static_cast<opj_codec_t*>(this->getDecompressionCodec()),
-	    OpenJPEG_CodecDeleter{});
-	std::unique_ptr<opj_stream_t, OpenJPEG_StreamDeleter> stream(
-	    static_cast<opj_stream_t*>(this->getDecompressionStream()),
-	    OpenJPEG_StreamDeleter{});
+	return (this->decodeRegion(0, ROI()));
+}
 
-	opj_image_t *imagePtr = nullptr;
-	if (opj_read_header(stream.get(), codec.get(), &imagePtr) == OPJ_FALSE)
-		throw Error::Exception("Could not read header");
-	if (imagePtr == nullptr)
-		throw Error::Exception("Parsed header is empty");
-	std::unique_ptr<opj_image_t, OpenJPEG_ImageDeleter> image(
-	    imagePtr, OpenJPEG_ImageDeleter{});
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::JPEG2000::getRawData(
+    const uint8_t reduction,
+    const ROI &roi)
+    const
+{
+	/* Full resolution may already be decoded */
+	if ((reduction == 0) &&
+	    (this->getReducedDimensions(reduction, roi) == this->getDimensions()))
+		return (Image::getRawData(reduction, roi));
+
+	try {
+		return (this->decodeRegion(reduction, roi));
+	} catch (const Error::NotImplemented&) {
+		/* e.g., fewer resolution levels than reduction */
+		return (Image::getRawData(reduction, roi));
+	}
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::JPEG2000::decodeRegion(
+    const uint8_t reduction,
+    const ROI &roi)
+    const
+{
+	const ROI region = this->getReducedROI(reduction, roi);
+
+	std::unique_ptr<opj_codec_t, OpenJPEG_CodecDeleter> codec{};
+	std::unique_ptr<opj_stream_t, OpenJPEG_StreamDeleter> stream{};
+	std::unique_ptr<opj_image_t, OpenJPEG_ImageDeleter> image{};
+
+	/*
+	 * A codec is only good for one decode, so the first decode takes
+	 * the codec whose header the constructor read, when held (unless
+	 * copies of this object or changes in thread count have made it
+	 * unusable).
+	 */
+	if (this->_decompression != nullptr) {
+		std::lock_guard<std::mutex> lock(this->_decompression->mutex);
+		Decompression &decompression = *this->_decompression;
+		if ((decompression.owner == this) &&
+		    (decompression.threads == this->_decodeThreadCount)) {
+			codec = std::move(decompression.codec);
+			stream = std::move(decompression.stream);
+			image = std::move(decompression.image);
+		}
+		decompression.owner = nullptr;
+	}
+
+	if (image == nullptr) {
+		codec.reset(static_cast<opj_codec_t*>(
+		    this->getDecompressionCodec()));
+		stream.reset(static_cast<opj_stream_t*>(
+		    this->getDecompressionStream()));
+
+		opj_image_t *imagePtr = nullptr;
+		if (opj_read_header(stream.get(), codec.get(),
+		    &imagePtr) == OPJ_FALSE)
+			throw Error::Exception("Could not read header");
+		if (imagePtr == nullptr)
+			throw Error::Exception("Parsed header is empty");
+		image.reset(imagePtr);
+	}
 
 	if (image->numcomps <= 0)
 		throw Error::NotImplemented("No components");
 	if (image->comps[0].sgnd == 1)
 		throw Error::NotImplemented("Signed buffers");
 
+	/* Skip discarding the highest resolution levels */
+	if (reduction > 0)
+		if (opj_set_decoded_resolution_factor(codec.get(),
+		    reduction) == OPJ_FALSE)
+			throw Error::NotImplemented("Reduction by " +
+			    std::to_string(reduction) + " levels");
+
+	/* Skip decoding code blocks outside of the region */
+	if (region.size != this->getReducedDimensions(reduction, ROI())) {
+		/*
+		 * OpenJPEG rounds the start of the area up at reduced
+		 * resolution, so start on a reduced pixel boundary.
+		 */
+		if (opj_set_decode_area(codec.get(), image.get(),
+		    region.horzOffset << reduction,
+		    region.vertOffset << reduction,
+		    roi.horzOffset + roi.size.xSize,
+		    roi.vertOffset + roi.size.ySize) == OPJ_FALSE)
+			throw Error::StrategyError("Could not set decode "
+			    "area");
+	}
+
 	if (opj_decode(codec.get(), stream.get(), image.get()) == OPJ_FALSE)
 		throw Error::StrategyError("Could not initialize decoding");
 
-	const uint32_t w = this->getDimensions().xSize;
-	const uint32_t h = this->getDimensions().ySize;
+	const uint32_t w = region.size.xSize;
+	const uint32_t h = region.size.ySize;
 	const uint8_t bpc = image->comps[0].prec;
 
 	std::vector<int32_t*> ptr;
@@ -210,8 +407,8 @@ BiometricEvaluation::Image::JPEG2000::getRawData()
 			throw Error::NotImplemented("Non-equal components");
 	}
 
-	Memory::uint8Array rawData(image->numcomps * (bpc / 8) * image->x1 *
-	    image->y1);
+	Memory::uint8Array rawData(image->numcomps * (bpc / 8) *
+	    static_cast<uint64_t>(w) * h);
 	Memory::MutableIndexedBuffer buffer(rawData);
 
 	const int32_t mask = (1 << image->comps[0].prec) - 1;
@@ -262,6 +459,310 @@ BiometricEvaluation::Image::JPEG2000::isJPEG2000(
 	return (memcmp(data, SOC, SOC_size) == 0);
 }
 
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::JPEG2000::probe(
+    const uint8_t *data,
+    const uint64_t size)
+{
+	/* Box types (ISO/IEC 15444-1:2004 Annex I) */
+	static constexpr uint8_t jp2h[4] = { 0x6A, 0x70, 0x32, 0x68 };
+	static constexpr uint8_t colr[4] = { 0x63, 0x6F, 0x6C, 0x72 };
+	static constexpr uint8_t resc[4] = { 0x72, 0x65, 0x73, 0x63 };
+	static constexpr uint8_t boxTypeSize{4};
+	static constexpr uint8_t resc_box_size{10};
+	/* Codestream markers (ISO/IEC 15444-1:2004 Annex A) */
+	static constexpr uint16_t SOC{0xFF4F};
+	static constexpr uint16_t SIZ{0xFF51};
+	/* Enumerated colourspaces (I.5.3.3) */
+	static constexpr uint32_t sRGB{16};
+	static constexpr uint32_t greyscale{17};
+	static constexpr uint32_t sYCC{18};
+	static constexpr uint32_t eYCC{24};
+	static constexpr uint32_t CMYK{12};
+
+	if (!isJPEG2000(data, size))
+		throw Error::DataError("Not a JP2 image");
+
+	/* Colourspace, as libopenjp2 reports from the colr box */
+	OPJ_COLOR_SPACE colorSpace{OPJ_CLRSPC_UNKNOWN};
+	const uint64_t headerSize = getHeaderSize(data, size);
+	if (headerSize == size)
+		throw Error::DataError("No Contiguous Codestream box");
+
+	/* Colour Specification box within the JP2 Header box */
+	try {
+		const uint64_t jp2hOffset{find_marker_offset(jp2h,
+		    boxTypeSize, data, headerSize)};
+		const uint64_t colrOffset{jp2hOffset + find_marker_offset(
+		    colr, boxTypeSize, data + jp2hOffset,
+		    headerSize - jp2hOffset)};
+		BE::Memory::IndexedBuffer ib(data + colrOffset,
+		    headerSize - colrOffset);
+		ib.scan(nullptr, boxTypeSize);
+		/* METH, PREC, APPROX, and EnumCS when METH is 1 */
+		if (ib.scanU8Val() == 1) {
+			ib.scan(nullptr, 2);
+			switch (ib.scanBeU32Val()) {
+			case sRGB:
+				colorSpace = OPJ_CLRSPC_SRGB;
+				break;
+			case greyscale:
+				colorSpace = OPJ_CLRSPC_GRAY;
+				break;
+			case sYCC:
+				colorSpace = OPJ_CLRSPC_SYCC;
+				break;
+			case eYCC:
+				colorSpace = OPJ_CLRSPC_EYCC;
+				break;
+			case CMYK:
+				colorSpace = OPJ_CLRSPC_CMYK;
+				break;
+			}
+		}
+	} catch (const Error::ObjectDoesNotExist&) {
+		/* No colr box */
+	}
+	if ((colorSpace != OPJ_CLRSPC_SRGB) &&
+	    (colorSpace != OPJ_CLRSPC_GRAY))
+		throw Error::NotImplemented("Colorspace " +
+		    std::to_string(colorSpace));
+
+	/* Image and tile size marker segment follows start of codestream */
+	BE::Memory::IndexedBuffer ib(data, size);
+	ib.setIndex(headerSize);
+	if (ib.scanBeU32Val() == 1)
+		ib.scan(nullptr, boxTypeSize + 8);
+	else
+		ib.scan(nullptr, boxTypeSize);
+	if (ib.scanBeU16Val() != SOC)
+		throw Error::DataError("No SOC marker");
+	if (ib.scanBeU16Val() != SIZ)
+		throw Error::DataError("No SIZ marker");
+
+	/* Lsiz, Rsiz */
+	ib.scan(nullptr, 4);
+	const uint32_t Xsiz{ib.scanBeU32Val()};
+	const uint32_t Ysiz{ib.scanBeU32Val()};
+	/* XOsiz, YOsiz, XTsiz, YTsiz, XTOsiz, YTOsiz */
+	ib.scan(nullptr, 24);
+	const uint16_t Csiz{ib.scanBeU16Val()};
+	if (Csiz == 0)
+		throw Error::NotImplemented("No components");
+
+	/* Ssiz, XRsiz, YRsiz */
+	const uint32_t prec = (ib.scanU8Val() & 0x7F) + 1;
+	ib.scan(nullptr, 2);
+	for (uint16_t component = 1; component < Csiz; ++component) {
+		if (static_cast<uint32_t>((ib.scanU8Val() & 0x7F) + 1) != prec)
+			throw Error::NotImplemented("Non-equivalent component "
+			    "bit depths");
+		ib.scan(nullptr, 2);
+	}
+
+	Attributes attributes;
+	attributes.compressionAlgorithm = CompressionAlgorithm::JP2;
+	attributes.dimensions = Size(Xsiz, Ysiz);
+	attributes.colorDepth = Csiz * prec;
+	attributes.bitDepth = prec;
+
+	/* The Capture Resolution Box is optional under some codecs */
+	try {
+		attributes.resolution = parse_res(find_marker(resc,
+		    boxTypeSize, data, headerSize, resc_box_size));
+	} catch (const Error::ObjectDoesNotExist&) {
+		attributes.resolution = Resolution(72, 72,
+		    Resolution::Units::PPI);
+	}
+
+	try {
+		attributes.hasAlphaChannel = checkForAlphaInCDEF(data,
+		    headerSize);
+	} catch (const BE::Error::Exception &) {
+		/* Take best guess on alpha channel presence */
+		attributes.hasAlphaChannel = (
+		    ((colorSpace == OPJ_CLRSPC_GRAY) && (Csiz == 2)) ||
+		    ((colorSpace == OPJ_CLRSPC_SRGB) && (Csiz == 4)));
+	}
+
+	return (attributes);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::JPEG2000::encode(
+    const Raw &raw,
+    const float compressionRatio)
+{
+	if (compressionRatio < 0)
+		throw Error::ParameterError("Invalid compression ratio");
+	const Size dimensions = raw.getDimensions();
+	if ((dimensions.xSize == 0) || (dimensions.ySize == 0))
+		throw Error::ParameterError("No pixels to encode");
+	const uint8_t bitDepth = raw.getBitDepth();
+	if ((bitDepth != 8) && (bitDepth != 16))
+		throw Error::NotImplemented("Encoding " + std::to_string(
+		    bitDepth) + "-bit components");
+	const uint8_t numComponents = raw.getColorDepth() / bitDepth;
+	if ((numComponents < 1) || (numComponents > 4) ||
+	    ((numComponents * bitDepth) != raw.getColorDepth()))
+		throw Error::NotImplemented("Encoding " + std::to_string(
+		    raw.getColorDepth()) + "-bit pixels");
+
+	const uint64_t pixelCount = static_cast<uint64_t>(dimensions.xSize) *
+	    dimensions.ySize;
+	const Memory::uint8Array rawData = raw.getRawData();
+	if (rawData.size() < (pixelCount * numComponents * (bitDepth / 8)))
+		throw Error::ParameterError("Raw data is smaller than "
+		    "dimensions");
+
+	/* Interleaved pixels to planar components */
+	opj_image_cmptparm_t parameters[4]{};
+	for (uint8_t i = 0; i < numComponents; ++i) {
+		parameters[i].dx = 1;
+		parameters[i].dy = 1;
+		parameters[i].w = dimensions.xSize;
+		parameters[i].h = dimensions.ySize;
+		parameters[i].prec = bitDepth;
+		parameters[i].sgnd = 0;
+	}
+	const OPJ_COLOR_SPACE colorSpace = (numComponents < 3 ?
+	    OPJ_CLRSPC_GRAY : OPJ_CLRSPC_SRGB);
+	std::unique_ptr<opj_image_t, OpenJPEG_ImageDeleter> image(
+	    opj_image_create(numComponents, parameters, colorSpace),
+	    OpenJPEG_ImageDeleter{});
+	if (image == nullptr)
+		throw Error::StrategyError("Could not create image");
+	image->x0 = 0;
+	image->y0 = 0;
+	image->x1 = dimensions.xSize;
+	image->y1 = dimensions.ySize;
+	if (raw.hasAlphaChannel() && ((numComponents == 2) ||
+	    (numComponents == 4)))
+		image->comps[numComponents - 1].alpha = 1;
+
+	Memory::IndexedBuffer buffer(rawData);
+	for (uint64_t pixel = 0; pixel < pixelCount; ++pixel) {
+		for (uint8_t i = 0; i < numComponents; ++i) {
+			if (bitDepth == 8)
+				image->comps[i].data[pixel] =
+				    buffer.scanU8Val();
+			else
+				image->comps[i].data[pixel] =
+				    buffer.scanU16Val();
+		}
+	}
+
+	opj_cparameters_t encoderParameters;
+	opj_set_default_encoder_parameters(&encoderParameters);
+	encoderParameters.tcp_numlayers = 1;
+	encoderParameters.cp_disto_alloc = 1;
+	if (compressionRatio > 0) {
+		encoderParameters.irreversible = 1;
+		encoderParameters.tcp_rates[0] = compressionRatio;
+	} else {
+		/* Rate of 0 is lossless */
+		encoderParameters.irreversible = 0;
+		encoderParameters.tcp_rates[0] = 0;
+	}
+	/* Each decomposition level halves the smallest dimension */
+	while ((encoderParameters.numresolution > 1) &&
+	    ((std::min(dimensions.xSize, dimensions.ySize) >>
+	    (encoderParameters.numresolution - 1)) == 0))
+		encoderParameters.numresolution--;
+	/* Multiple component transform between RGB and YCC */
+	encoderParameters.tcp_mct = (numComponents >= 3 ? 1 : 0);
+
+	std::unique_ptr<opj_codec_t, OpenJPEG_CodecDeleter> codec(
+	    opj_create_compress(OPJ_CODEC_JP2), OpenJPEG_CodecDeleter{});
+	if (codec == nullptr)
+		throw Error::StrategyError("Could not create codec");
+	opj_set_error_handler(codec.get(), openjpeg_error, nullptr);
+	opj_set_warning_handler(codec.get(), openjpeg_warning, nullptr);
+	opj_set_info_handler(codec.get(), openjpeg_info, nullptr);
+	if (opj_setup_encoder(codec.get(), &encoderParameters,
+	    image.get()) == OPJ_FALSE)
+		throw Error::StrategyError("Could not initialize encoding");
+
+	/* Start with a guess of the requested compression ratio */
+	OpenJPEG_OutputBuffer output;
+	output.data.resize((rawData.size() / std::max(compressionRatio,
+	    2.0f)) + 1024);
+	output.offset = 0;
+	output.length = 0;
+	std::unique_ptr<opj_stream_t, OpenJPEG_StreamDeleter> stream(
+	    opj_stream_default_create(OPJ_FALSE), OpenJPEG_StreamDeleter{});
+	if (stream == nullptr)
+		throw Error::StrategyError("Could not create stream");
+	opj_stream_set_user_data(stream.get(), &output, nullptr);
+	opj_stream_set_write_function(stream.get(), libopenjp2WriteMem);
+	opj_stream_set_skip_function(stream.get(), libopenjp2SkipMem);
+	opj_stream_set_seek_function(stream.get(), libopenjp2SeekMem);
+
+	if (opj_start_compress(codec.get(), image.get(), stream.get()) ==
+	    OPJ_FALSE)
+		throw Error::StrategyError("Could not start encoding");
+	if (opj_encode(codec.get(), stream.get()) == OPJ_FALSE)
+		throw Error::StrategyError("Could not encode");
+	if (opj_end_compress(codec.get(), stream.get()) == OPJ_FALSE)
+		throw Error::StrategyError("Could not finish encoding");
+	output.data.resize(output.length);
+
+	/* OpenJPEG does not write resolution */
+	if (raw.getResolution().units == Resolution::Units::NA)
+		return (output.data);
+	return (addResolutionBox(output.data, raw.getResolution()));
+}
+
+void
+BiometricEvaluation::Image::JPEG2000::setDefaultDecodeThreadCount(
+    const uint32_t threads)
+{
+	DefaultDecodeThreadCount = threads;
+}
+
+uint32_t
+BiometricEvaluation::Image::JPEG2000::getDefaultDecodeThreadCount()
+{
+	return (DefaultDecodeThreadCount);
+}
+
+void
+BiometricEvaluation::Image::JPEG2000::setDefaultRetainHeader(
+    const bool retain)
+{
+	DefaultRetainHeader = retain;
+}
+
+bool
+BiometricEvaluation::Image::JPEG2000::getDefaultRetainHeader()
+{
+	return (DefaultRetainHeader);
+}
+
+bool
+BiometricEvaluation::Image::JPEG2000::isMultithreadedDecodingSupported()
+{
+#ifdef BE_IMAGE_JPEG2000_THREADS
+	return (opj_has_thread_support() == OPJ_TRUE);
+#else
+	return (false);
+#endif /* BE_IMAGE_JPEG2000_THREADS */
+}
+
+void
+BiometricEvaluation::Image::JPEG2000::setDecodeThreadCount(
+    const uint32_t threads)
+{
+	this->_decodeThreadCount = threads;
+}
+
+uint32_t
+BiometricEvaluation::Image::JPEG2000::getDecodeThreadCount()
+    const
+{
+	return (this->_decodeThreadCount);
+}
+
 void
 BiometricEvaluation::Image::JPEG2000::openjpeg_error(
     const char *msg,
@@ -304,16 +805,17 @@ BiometricEvaluation::Image::JPEG2000::openjpeg_info(
 }
 
 bool
-BiometricEvaluation::Image::JPEG2000::checkForAlphaInCDEF()
+BiometricEvaluation::Image::JPEG2000::checkForAlphaInCDEF(
+    const uint8_t *data,
+    const uint64_t size)
 {
 	static constexpr uint8_t cdef[4] = { 0x63, 0x64, 0x65, 0x66 };
 	static constexpr uint8_t cdefTagSize{4};
 
 	const uint64_t offset{find_marker_offset(cdef, cdefTagSize,
-	    this->getDataPointer(), this->getDataSize())};
+	    data, size)};
 
-	BE::Memory::IndexedBuffer ib(this->getDataPointer(),
-	    this->getDataSize());
+	BE::Memory::IndexedBuffer ib(data, size);
 	ib.scan(nullptr, offset + cdefTagSize);
 
 	volatile uint16_t typ{};
@@ -331,6 +833,40 @@ BiometricEvaluation::Image::JPEG2000::checkForAlphaInCDEF()
 	return (false);
 }
 
+uint64_t
+BiometricEvaluation::Image::JPEG2000::getHeaderSize(
+    const uint8_t *data,
+    const uint64_t size)
+{
+	static constexpr uint8_t jp2c[4] = { 0x6A, 0x70, 0x32, 0x63 };
+
+	/* I.4: LBox, TBox, and XLBox when LBox is 1 */
+	uint64_t offset{0};
+	while ((offset + 8) <= size) {
+		BE::Memory::IndexedBuffer ib(data + offset, size - offset);
+		uint64_t length{ib.scanBeU32Val()};
+		if (std::memcmp(data + offset + 4, jp2c, sizeof(jp2c)) == 0)
+			return (offset);
+		ib.scan(nullptr, sizeof(jp2c));
+
+		if (length == 0) {
+			/* Last box */
+			break;
+		} else if (length == 1) {
+			if ((offset + 16) > size)
+				break;
+			length = (static_cast<uint64_t>(ib.scanBeU32Val()) <<
+			    32) | ib.scanBeU32Val();
+		}
+		if ((length < 8) || (length > (size - offset)))
+			break;
+		offset += length;
+	}
+
+	/* Not a JP2 file format, so all data could be header */
+	return (size);
+}
+
 uint64_t
 BiometricEvaluation::Image::JPEG2000::find_marker_offset(
     const uint8_t *marker,
@@ -395,6 +931,68 @@ BiometricEvaluation::Image::JPEG2000::parse_res(
 	    Resolution::Units::PPCM));
 }
 
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::JPEG2000::addResolutionBox(
+    const BiometricEvaluation::Memory::uint8Array &jp2,
+    const Resolution &resolution)
+{
+	static constexpr uint8_t jp2h[4] = { 0x6A, 0x70, 0x32, 0x68 };
+	static constexpr uint8_t res[4] = { 0x72, 0x65, 0x73, 0x20 };
+	static constexpr uint8_t resc[4] = { 0x72, 0x65, 0x73, 0x63 };
+	/* res superbox header, resc box header, resc box contents */
+	static constexpr uint32_t resBoxSize = 8 + 8 + 10;
+
+	/* jp2h is a superbox, so its length is never 0 or 1 */
+	uint64_t offset{0};
+	uint32_t length{0};
+	while ((offset + 8) <= jp2.size()) {
+		Memory::IndexedBuffer ib(jp2 + offset, jp2.size() - offset);
+		length = ib.scanBeU32Val();
+		if (std::memcmp(jp2 + offset + 4, jp2h, sizeof(jp2h)) == 0)
+			break;
+		if ((length < 8) || (length > (jp2.size() - offset)))
+			throw Error::StrategyError("No JP2 header box");
+		offset += length;
+	}
+	if (((offset + 8) > jp2.size()) || (length < 8) ||
+	    (length > (jp2.size() - offset)))
+		throw Error::StrategyError("No JP2 header box");
+
+	/* I.7.3.6.1: Grid points per meter, as N / D * 10^E */
+	const Resolution ppcm = resolution.toUnits(Resolution::Units::PPCM);
+	const auto toFraction = [](float ppm, uint16_t &n, int8_t &e) {
+		e = 0;
+		while ((std::lround(ppm) > UINT16_MAX) && (e < INT8_MAX)) {
+			ppm /= 10;
+			e++;
+		}
+		n = static_cast<uint16_t>(std::lround(ppm));
+	};
+	uint16_t vrN, hrN;
+	int8_t vrE, hrE;
+	toFraction(ppcm.yRes * 100, vrN, vrE);
+	toFraction(ppcm.xRes * 100, hrN, hrE);
+
+	Memory::uint8Array output(jp2.size() + resBoxSize);
+	Memory::MutableIndexedBuffer buffer(output);
+	buffer.push(jp2, offset);
+	buffer.pushBeU32Val(length + resBoxSize);
+	buffer.push(jp2 + offset + 4, length - 4);
+	buffer.pushBeU32Val(resBoxSize);
+	buffer.push(res, sizeof(res));
+	buffer.pushBeU32Val(resBoxSize - 8);
+	buffer.push(resc, sizeof(resc));
+	buffer.pushBeU16Val(vrN);
+	buffer.pushBeU16Val(1);
+	buffer.pushBeU16Val(hrN);
+	buffer.pushBeU16Val(1);
+	buffer.pushU8Val(static_cast<uint8_t>(vrE));
+	buffer.pushU8Val(static_cast<uint8_t>(hrE));
+	buffer.push(jp2 + offset + length, jp2.size() - offset - length);
+
+	return (output);
+}
+
 void*
 BiometricEvaluation::Image::JPEG2000::getDecompressionCodec()
     const
@@ -431,6 +1029,20 @@ BiometricEvaluation::Image::JPEG2000::getDecompressionCodec()
 		throw Error::StrategyError("Could not initialize decoding");
 	}
 
+#ifdef BE_IMAGE_JPEG2000_THREADS
+	/* Must be set before the header is read */
+	if ((this->_decodeThreadCount != 1) && opj_has_thread_support()) {
+		const int threads = (this->_decodeThreadCount == 0 ?
+		    opj_get_num_cpus() : static_cast<int>(std::min<uint32_t>(
+		    this->_decodeThreadCount, INT32_MAX)));
+		if (opj_codec_set_threads(codec, threads) == OPJ_FALSE) {
+			opj_destroy_codec(codec);
+			throw Error::StrategyError("Could not set decoding "
+			    "threads");
+		}
+	}
+#endif /* BE_IMAGE_JPEG2000_THREADS */
+
 	return (codec);
 }
 
@@ -514,3 +1126,54 @@ BiometricEvaluation::Image::JPEG2000::libopenjp2Seek(
 		return (OPJ_FALSE);
 	}
 }
+
+OPJ_SIZE_T
+libopenjp2WriteMem(
+    void *p_buffer,
+    OPJ_SIZE_T p_nb_bytes,
+    void *p_user_data)
+{
+	OpenJPEG_OutputBuffer *output = static_cast<OpenJPEG_OutputBuffer *>(
+	    p_user_data);
+
+	const uint64_t end = output->offset + p_nb_bytes;
+	if (end > output->data.size())
+		output->data.resize(std::max<uint64_t>(end,
+		    output->data.size() * 2));
+	std::memcpy(output->data + output->offset, p_buffer, p_nb_bytes);
+	output->offset = end;
+	output->length = std::max(output->length, end);
+
+	return (p_nb_bytes);
+}
+
+OPJ_OFF_T
+libopenjp2SkipMem(
+    OPJ_OFF_T p_nb_bytes,
+    void *p_user_data)
+{
+	if (!libopenjp2SeekMem(static_cast<OpenJPEG_OutputBuffer *>(
+	    p_user_data)->offset + p_nb_bytes, p_user_data))
+		return (-1);
+	return (p_nb_bytes);
+}
+
+OPJ_BOOL
+libopenjp2SeekMem(
+    OPJ_OFF_T p_nb_bytes,
+    void *p_user_data)
+{
+	OpenJPEG_OutputBuffer *output = static_cast<OpenJPEG_OutputBuffer *>(
+	    p_user_data);
+	if (p_nb_bytes < 0)
+		return (OPJ_FALSE);
+
+	/* Skipped bytes are written later */
+	const uint64_t end = static_cast<uint64_t>(p_nb_bytes);
+	if (end > output->data.size())
+		output->data.resize(std::max<uint64_t>(end,
+		    output->data.size() * 2));
+	output->offset = end;
+
+	return (OPJ_TRUE);
+}
@@ -9,6 +9,7 @@
  */
 
 #include <cstdio>
+#include <cstring>
 
 extern "C" {
 	#include <dataio.h>
@@ -23,6 +24,20 @@ BiometricEvaluation::Image::JPEGL::JPEGL(
     const uint64_t size,
     const std::string &identifier,
     const statusCallback_t &statusCallback) :
+    BiometricEvaluation::Image::JPEGL::JPEGL(
+    Image::copyData(data, size),
+    size,
+    identifier,
+    statusCallback)
+{
+
+}
+
+BiometricEvaluation::Image::JPEGL::JPEGL(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
     Image::Image(
     data,
     size,
@@ -30,9 +45,82 @@ BiometricEvaluation::Image::JPEGL::JPEGL(
     identifier,
     statusCallback)
 {
-	uint8_t *markerBuf = (uint8_t *)this->getDataPointer();
-	uint8_t *endPtr = (uint8_t *)this->getDataPointer() +
-	    this->getDataSize();
+	this->setAttributes(JPEGL::probe(data.get(), size));
+}
+
+BiometricEvaluation::Image::JPEGL::JPEGL(
+    const BiometricEvaluation::Memory::uint8Array &data,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
+    BiometricEvaluation::Image::JPEGL::JPEGL(
+    data,
+    data.size(),
+    identifier,
+    statusCallback)
+{
+
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::JPEGL::decodeRawData()
+    const
+{
+	Memory::uint8Array rawData;
+	this->decodeRawDataInto(rawData);
+	return (rawData);
+}
+
+void
+BiometricEvaluation::Image::JPEGL::decodeRawDataInto(
+    Memory::uint8Array &rawData)
+    const
+{
+	IMG_DAT *imgDat = nullptr;
+	int32_t lossy;
+	if (biomeval_nbis_jpegl_decode_mem(&imgDat, &lossy,
+	    (unsigned char *)this->getDataPointer(), this->getDataSize()))
+		throw Error::DataError("Could not decode Lossless JPEG data");
+
+	/*
+	 * Copy component planes straight from the IMG_DAT, consecutively,
+	 * as biomeval_nbis_get_IMG_DAT_image() would (without its
+	 * intermediate copy).
+	 */
+	uint64_t rawSize{0};
+	for (int32_t i = 0; i < imgDat->n_cmpnts; i++)
+		rawSize += static_cast<uint64_t>(imgDat->samp_width[i]) *
+		    imgDat->samp_height[i];
+	resizeBuffer(rawData, rawSize);
+
+	uint64_t offset{0};
+	for (int32_t i = 0; i < imgDat->n_cmpnts; i++) {
+		const uint64_t planeSize = static_cast<uint64_t>(
+		    imgDat->samp_width[i]) * imgDat->samp_height[i];
+		std::memcpy(rawData + offset, imgDat->image[i], planeSize);
+		offset += planeSize;
+	}
+
+	biomeval_nbis_free_IMG_DAT(imgDat, FREE_IMAGE);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::JPEGL::getRawGrayscaleData(
+    uint8_t depth)
+    const
+{
+	return (Image::getRawGrayscaleData(depth));
+}
+
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::JPEGL::probe(
+    const uint8_t *data,
+    const uint64_t size)
+{
+	uint8_t *markerBuf = (uint8_t *)data;
+	uint8_t *endPtr = (uint8_t *)data + size;
+
+	Attributes attributes;
+	attributes.compressionAlgorithm = CompressionAlgorithm::JPEGL;
 
 	uint16_t marker;
 	if (biomeval_nbis_getc_marker_jpegl(&marker, SOI, &markerBuf, endPtr))
@@ -47,17 +135,17 @@ BiometricEvaluation::Image::JPEGL::JPEGL(
 
 	switch (JFIFHeader->units) {
 	case 1:	/* PPI */
-		setResolution(Resolution(JFIFHeader->dx, JFIFHeader->dy,
-		    Resolution::Units::PPI));
+		attributes.resolution = Resolution(JFIFHeader->dx,
+		    JFIFHeader->dy, Resolution::Units::PPI);
 		break;
 	case 2:	/* PPCM */
-		setResolution(Resolution(JFIFHeader->dx, JFIFHeader->dy,
-		    Resolution::Units::PPCM));
+		attributes.resolution = Resolution(JFIFHeader->dx,
+		    JFIFHeader->dy, Resolution::Units::PPCM);
 		break;
 	case 0:	/* Resolution undefined */
 		/* FALLTHROUGH */
 	default:
-		setResolution(Resolution(0,0));
+		attributes.resolution = Resolution(0,0);
 		break;
 	}
 	free(JFIFHeader);
@@ -65,7 +153,8 @@ BiometricEvaluation::Image::JPEGL::JPEGL(
 	/* Step through any tables up to the "start of frame" marker */
 	uint16_t tableSize;
 	for (;;) {
-		if (biomeval_nbis_getc_marker_jpegl(&marker, TBLS_N_SOF, &markerBuf, endPtr))
+		if (biomeval_nbis_getc_marker_jpegl(&marker, TBLS_N_SOF,
+		    &markerBuf, endPtr))
 			throw Error::DataError("Could not read to TBLS_N_SOF");
 
 		if (marker == SOF3)
@@ -79,60 +168,16 @@ BiometricEvaluation::Image::JPEGL::JPEGL(
 
 	/* Parse frame header for depth and dimension information */
 	FRM_HEADER_JPEGL *frameHeader;
-	if (biomeval_nbis_getc_frame_header_jpegl(&frameHeader, &markerBuf, endPtr))
+	if (biomeval_nbis_getc_frame_header_jpegl(&frameHeader, &markerBuf,
+	    endPtr))
 		throw Error::DataError("Could not read frame header");
-	setColorDepth((uint16_t)frameHeader->Nf * 8);
-	this->setBitDepth(8);
-	this->setHasAlphaChannel(false);
-	setDimensions(Size(frameHeader->x, frameHeader->y));
+	attributes.colorDepth = (uint16_t)frameHeader->Nf * 8;
+	attributes.bitDepth = 8;
+	attributes.hasAlphaChannel = false;
+	attributes.dimensions = Size(frameHeader->x, frameHeader->y);
 	free(frameHeader);
-}
-
-BiometricEvaluation::Image::JPEGL::JPEGL(
-    const BiometricEvaluation::Memory::uint8Array &data,
-    const std::string &identifier,
-    const statusCallback_t &statusCallback) :
-    BiometricEvaluation::Image::JPEGL::JPEGL(
-    data,
-    data.size(),
-    identifier,
-    statusCallback)
-{
 
-}
-
-BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::Image::JPEGL::getRawData()
-    const
-{
-	/* TODO: Extract the raw data without using the IMG_DAT struct */
-	IMG_DAT *imgDat = nullptr;
-	int32_t lossy;
-	if (biomeval_nbis_jpegl_decode_mem(&imgDat, &lossy,
-	    (unsigned char *)this->getDataPointer(), this->getDataSize()))
-		throw Error::DataError("Could not decode Lossless JPEG data");
-
-	uint8_t *rawDataPtr = nullptr;
-	int32_t width, height, depth, ppi, rawSize;
-	if (biomeval_nbis_get_IMG_DAT_image(&rawDataPtr, &rawSize, &width, &height, &depth,
-	    &ppi, imgDat)) {
-		biomeval_nbis_free_IMG_DAT(imgDat, NO_FREE_IMAGE);
-		throw Error::DataError("Could not extract raw data");
-	}
-	Memory::uint8Array rawData(rawSize);
-	rawData.copy(rawDataPtr);
-
-	biomeval_nbis_free_IMG_DAT(imgDat, FREE_IMAGE);
-
-	return (rawData);
-}
-
-BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::Image::JPEGL::getRawGrayscaleData(
-    uint8_t depth)
-    const
-{
-	return (Image::getRawGrayscaleData(depth));
+	return (attributes);
 }
 
 bool
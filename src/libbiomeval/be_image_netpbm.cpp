@@ -10,11 +10,13 @@
 
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <type_traits>
 
 #include <be_memory.h>
 #include <be_image_netpbm.h>
+#include <be_image_raw.h>
 #include <be_memory_mutableindexedbuffer.h>
 
 const std::map<BiometricEvaluation::Image::NetPBM::Kind, std::string>
@@ -35,6 +37,20 @@ BiometricEvaluation::Image::NetPBM::NetPBM(
     const uint64_t size,
     const std::string &identifier,
     const statusCallback_t &statusCallback) :
+    BiometricEvaluation::Image::NetPBM::NetPBM(
+    Image::copyData(data, size),
+    size,
+    identifier,
+    statusCallback)
+{
+
+}
+
+BiometricEvaluation::Image::NetPBM::NetPBM(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
     Image::Image(
     data,
     size,
@@ -42,46 +58,53 @@ BiometricEvaluation::Image::NetPBM::NetPBM(
     identifier,
     statusCallback)
 {
-	if (isNetPBM(data, size) != true)
+	if (isNetPBM(data.get(), size) != true)
 		throw Error::DataError("Not a NetPBM formatted image");
 
 	try {
-		parseHeader();
+		this->setAttributes(parseHeader(data.get(), size,
+		    this->_kind, this->_maxColorValue, this->_headerLength));
 	} catch (const std::out_of_range&) {
 		throw Error::DataError("Invalid header for NetPBM image");
 	}
 }
 
-void
-BiometricEvaluation::Image::NetPBM::parseHeader()
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::NetPBM::parseHeader(
+    const uint8_t *data,
+    const uint64_t dataSize,
+    Kind &kind,
+    uint32_t &maxColorValue,
+    uint64_t &headerLength)
 {
-	const uint8_t *data = this->getDataPointer();
-	const uint64_t dataSize = this->getDataSize();
+	Attributes attributes;
+	attributes.compressionAlgorithm = CompressionAlgorithm::NetPBM;
+	maxColorValue = 0;
 
 	size_t offset = 0;
-	skipComment(data, this->getDataSize(), offset);
+	skipComment(data, dataSize, offset);
 	if (data[offset++] != 'P')
 		throw Error::DataError("Not a valid NetPBM file");
 
 	/* Integer at second byte indiciates the format of the image data */
 	switch (data[offset++]) {
 	case '1':
-		_kind = Kind::ASCIIPortableBitmap;
+		kind = Kind::ASCIIPortableBitmap;
 		break;
 	case '2':
-		_kind = Kind::ASCIIPortableGraymap;
+		kind = Kind::ASCIIPortableGraymap;
 		break;
 	case '3':
-		_kind = Kind::ASCIIPortablePixmap;
+		kind = Kind::ASCIIPortablePixmap;
 		break;
 	case '4':
-		_kind = Kind::BinaryPortableBitmap;
+		kind = Kind::BinaryPortableBitmap;
 		break;
 	case '5':
-		_kind = Kind::BinaryPortableGraymap;
+		kind = Kind::BinaryPortableGraymap;
 		break;
 	case '6':
-		_kind = Kind::BinaryPortablePixmap;
+		kind = Kind::BinaryPortablePixmap;
 		break;
 	default:
 		throw Error::DataError("Not a valid NetPBM magic number");
@@ -90,10 +113,10 @@ BiometricEvaluation::Image::NetPBM::parseHeader()
 	/* Space separated width and height immediately follow magic number */
 	uint32_t width = atoi((char *)getNextValue(data, dataSize, offset).c_str());
 	uint32_t height = atoi((char *)getNextValue(data, dataSize, offset).c_str());
-	setDimensions(Size(width, height));
+	attributes.dimensions = Size(width, height);
 
 	/* Maximum color value follow dimensions on non-bitmap formats */
-	switch (_kind) {
+	switch (kind) {
 	case Kind::ASCIIPortableGraymap:
 		/* FALLTHROUGH */
 	case Kind::BinaryPortableGraymap:
@@ -101,7 +124,7 @@ BiometricEvaluation::Image::NetPBM::parseHeader()
 	case Kind::ASCIIPortablePixmap:
 		/* FALLTHROUGH */
 	case Kind::BinaryPortablePixmap:
-		_maxColorValue =
+		maxColorValue =
 		    atoi((char *)getNextValue(data, dataSize, offset).c_str());
 		break;
 	default:
@@ -109,50 +132,52 @@ BiometricEvaluation::Image::NetPBM::parseHeader()
 	}
 
 	/* Set depth (based on max color value) */
-	switch (_kind) {
+	switch (kind) {
 	case Kind::ASCIIPortableBitmap:
 		/* FALLTHROUGH */
 	case Kind::BinaryPortableBitmap:
 		/* Bitmaps are 1-bit depth by definition */
-		setColorDepth(1);
-		this->setBitDepth(1);
-		this->setHasAlphaChannel(false);
+		attributes.colorDepth = 1;
+		attributes.bitDepth = 1;
+		attributes.hasAlphaChannel = false;
 		break;
 	case Kind::ASCIIPortableGraymap:
 		/* FALLTHROUGH */
 	case Kind::BinaryPortableGraymap:
 		/* Graymaps can provide gray levels in the 1 - 65535 range */
-		if (this->_maxColorValue < 256) {
-			this->setColorDepth(8);
-			this->setBitDepth(8);
+		if (maxColorValue < 256) {
+			attributes.colorDepth = 8;
+			attributes.bitDepth = 8;
 		} else {
-			this->setColorDepth(16);
-			this->setBitDepth(16);
+			attributes.colorDepth = 16;
+			attributes.bitDepth = 16;
 		}
-		this->setHasAlphaChannel(false);
+		attributes.hasAlphaChannel = false;
 		break;
 	case Kind::ASCIIPortablePixmap:
 		/* FALLTHROUGH */
 	case Kind::BinaryPortablePixmap:
 		/* Pixmaps can provide R, G, B values in the 1 - 65535 range */
-		if (this->_maxColorValue < 256) {
-			this->setColorDepth(24);
-			this->setBitDepth(8);
+		if (maxColorValue < 256) {
+			attributes.colorDepth = 24;
+			attributes.bitDepth = 8;
 		} else {
-			this->setColorDepth(48);
-			this->setBitDepth(16);
+			attributes.colorDepth = 48;
+			attributes.bitDepth = 16;
 		}
-		this->setHasAlphaChannel(false);
+		attributes.hasAlphaChannel = false;
 		break;
 	default:
 		break;
 	}
 
 	/* Resolution is unspecified */
-	setResolution(Resolution(72, 72, Resolution::Units::PPI));
+	attributes.resolution = Resolution(72, 72, Resolution::Units::PPI);
 
 	/* Payload comes a minimum of one whitespace after last header item */
-	_headerLength = offset + 1;
+	headerLength = offset + 1;
+
+	return (attributes);
 }
 
 BiometricEvaluation::Image::NetPBM::NetPBM(
@@ -239,7 +264,7 @@ BiometricEvaluation::Image::NetPBM::skipLine(
 }
 
 BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::Image::NetPBM::getRawData()
+BiometricEvaluation::Image::NetPBM::decodeRawData()
     const
 {
 	const uint8_t *data = this->getDataPointer() + this->_headerLength;
@@ -388,6 +413,84 @@ BiometricEvaluation::Image::NetPBM::getRawGrayscaleData(
 	return (Image::getRawGrayscaleData(depth));
 }
 
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::NetPBM::probe(
+    const uint8_t *data,
+    const uint64_t size)
+{
+	if (isNetPBM(data, size) != true)
+		throw Error::DataError("Not a NetPBM formatted image");
+
+	Kind kind;
+	uint32_t maxColorValue;
+	uint64_t headerLength;
+	try {
+		return (parseHeader(data, size, kind, maxColorValue,
+		    headerLength));
+	} catch (const std::out_of_range&) {
+		throw Error::DataError("Invalid header for NetPBM image");
+	}
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::NetPBM::encode(
+    const Raw &raw)
+{
+	const Size dimensions = raw.getDimensions();
+	if ((dimensions.xSize == 0) || (dimensions.ySize == 0))
+		throw Error::ParameterError("No pixels to encode");
+	if (raw.hasAlphaChannel())
+		throw Error::NotImplemented("Encoding an alpha channel");
+
+	char magic;
+	uint32_t maxColorValue;
+	switch (raw.getColorDepth()) {
+	case 8:
+		magic = '5';
+		maxColorValue = UINT8_MAX;
+		break;
+	case 16:
+		magic = '5';
+		maxColorValue = UINT16_MAX;
+		break;
+	case 24:
+		magic = '6';
+		maxColorValue = UINT8_MAX;
+		break;
+	case 48:
+		magic = '6';
+		maxColorValue = UINT16_MAX;
+		break;
+	default:
+		throw Error::NotImplemented("Encoding " + std::to_string(
+		    raw.getColorDepth()) + "-bit pixels");
+	}
+
+	const Memory::uint8Array rawData = raw.getRawData();
+	const uint64_t payloadSize = static_cast<uint64_t>(dimensions.xSize) *
+	    dimensions.ySize * (raw.getColorDepth() / 8);
+	if (rawData.size() < payloadSize)
+		throw Error::ParameterError("Raw data is smaller than "
+		    "dimensions");
+
+	const std::string header = std::string("P") + magic + "\n" +
+	    std::to_string(dimensions.xSize) + " " +
+	    std::to_string(dimensions.ySize) + "\n" +
+	    std::to_string(maxColorValue) + "\n";
+
+	Memory::uint8Array output(header.size() + payloadSize);
+	std::memcpy(output, header.data(), header.size());
+	std::memcpy(output + header.size(), rawData, payloadSize);
+
+	/* NetPBM stores data big-endian */
+	if ((maxColorValue == UINT16_MAX) && Memory::isLittleEndian())
+		for (uint64_t i = header.size(); i < (output.size() - 1);
+		    i += 2)
+			std::swap(output[i], output[i + 1]);
+
+	return (output);
+}
+
 bool
 BiometricEvaluation::Image::NetPBM::isNetPBM(
     const uint8_t *data,
@@ -0,0 +1,854 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <string>
+
+#include <be_error_exception.h>
+#include <be_image_pixelkernels.h>
+
+/* Vectorized implementations are compiled per function, for runtime choice */
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define BE_IMAGE_PIXELKERNELS_X86
+#include <immintrin.h>
+#define BE_TARGET_SSE4_1 __attribute__((target("sse4.1")))
+#define BE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace BE = BiometricEvaluation;
+namespace PixelKernels = BiometricEvaluation::Image::PixelKernels;
+
+const std::map<PixelKernels::InstructionSet, std::string>
+BE_Image_PixelKernels_InstructionSet_EnumToStringMap = {
+	{PixelKernels::InstructionSet::Scalar, "Scalar"},
+	{PixelKernels::InstructionSet::SSE4_1, "SSE4.1"},
+	{PixelKernels::InstructionSet::AVX2, "AVX2"}
+};
+
+BE_FRAMEWORK_ENUMERATION_DEFINITIONS(
+    BiometricEvaluation::Image::PixelKernels::InstructionSet,
+    BE_Image_PixelKernels_InstructionSet_EnumToStringMap);
+
+/* Constants from ITU-R BT.601, as used by Image::getRawGrayscaleData() */
+static const float RedFactor = 0.299f;
+static const float GreenFactor = 0.587f;
+static const float BlueFactor = 0.114f;
+
+/** @return Fastest instruction set supported by the processor */
+static PixelKernels::InstructionSet
+bestInstructionSet()
+{
+	if (PixelKernels::isSupported(PixelKernels::InstructionSet::AVX2))
+		return (PixelKernels::InstructionSet::AVX2);
+	if (PixelKernels::isSupported(PixelKernels::InstructionSet::SSE4_1))
+		return (PixelKernels::InstructionSet::SSE4_1);
+	return (PixelKernels::InstructionSet::Scalar);
+}
+
+/** Instruction set used by all conversions */
+static std::atomic<PixelKernels::InstructionSet> currentInstructionSet{
+    bestInstructionSet()};
+
+/*
+ * Scalar implementations, which define the results of the vectorized
+ * implementations and convert the pixels left over by them.
+ */
+
+/** @return Native-order 16-bit value at data */
+static inline uint16_t
+loadU16(
+    const uint8_t *data)
+{
+	uint16_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return (value);
+}
+
+/** Store native-order 16-bit value at data */
+static inline void
+storeU16(
+    uint8_t *data,
+    uint16_t value)
+{
+	std::memcpy(data, &value, sizeof(value));
+}
+
+/** @return Component scaled to the output depth */
+template<bool In16, bool Out16>
+static inline uint16_t
+scaleComponent(
+    const uint8_t *component)
+{
+	if (In16) {
+		const uint16_t value = loadU16(component);
+		return (Out16 ? value : static_cast<uint16_t>(value / 257));
+	}
+	return (Out16 ? static_cast<uint16_t>(*component * 257) : *component);
+}
+
+template<bool In16, bool Out16>
+static void
+scalarColorToGray(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t componentCount)
+{
+	const uint8_t bytesPerComponent = (In16 ? 2 : 1);
+	const uint8_t bytesPerPixel = componentCount * bytesPerComponent;
+	for (uint64_t i = 0; i < pixelCount; i++, in += bytesPerPixel) {
+		const float gray = (scaleComponent<In16, Out16>(in) *
+		    RedFactor) + (scaleComponent<In16, Out16>(in +
+		    bytesPerComponent) * GreenFactor) +
+		    (scaleComponent<In16, Out16>(in + (2 * bytesPerComponent)) *
+		    BlueFactor);
+		if (Out16)
+			storeU16(out + (i * 2), static_cast<uint16_t>(gray));
+		else
+			out[i] = static_cast<uint8_t>(gray);
+	}
+}
+
+static void
+scalarRescale(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t inDepth)
+{
+	if (inDepth == 8)
+		for (uint64_t i = 0; i < pixelCount; i++)
+			storeU16(out + (i * 2), static_cast<uint16_t>(
+			    in[i] * 257));
+	else
+		for (uint64_t i = 0; i < pixelCount; i++)
+			out[i] = static_cast<uint8_t>(loadU16(in + (i * 2)) /
+			    257);
+}
+
+static void
+scalarRemoveLastComponent(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t bytesPerComponent,
+    uint8_t componentCount)
+{
+	const uint8_t inStride = bytesPerComponent * componentCount;
+	const uint8_t outStride = inStride - bytesPerComponent;
+	for (uint64_t i = 0; i < pixelCount; i++)
+		std::memcpy(out + (i * outStride), in + (i * inStride),
+		    outStride);
+}
+
+static void
+scalarWeightedSum(
+    const float *in,
+    uint64_t stride,
+    const float *weights,
+    uint32_t weightCount,
+    float *out,
+    uint64_t length)
+{
+	for (uint64_t i = 0; i < length; i++) {
+		float sum = 0;
+		for (uint32_t k = 0; k < weightCount; k++)
+			sum += weights[k] * in[(k * stride) + i];
+		out[i] = sum;
+	}
+}
+
+#ifdef BE_IMAGE_PIXELKERNELS_X86
+
+/*
+ * SSE4.1 implementations.  Each returns the number of pixels converted,
+ * never reading or writing beyond pixelCount pixels.
+ */
+
+/** @return Truncated luma of four pixels */
+BE_TARGET_SSE4_1 static inline __m128i
+sse41Luma(
+    __m128i red,
+    __m128i green,
+    __m128i blue)
+{
+	/* Same operations, in the same order, as the scalar version */
+	const __m128 gray = _mm_add_ps(_mm_add_ps(
+	    _mm_mul_ps(_mm_cvtepi32_ps(red), _mm_set1_ps(RedFactor)),
+	    _mm_mul_ps(_mm_cvtepi32_ps(green), _mm_set1_ps(GreenFactor))),
+	    _mm_mul_ps(_mm_cvtepi32_ps(blue), _mm_set1_ps(BlueFactor)));
+	return (_mm_cvttps_epi32(gray));
+}
+
+/** @return floor(value / 257) of each 16-bit value */
+BE_TARGET_SSE4_1 static inline __m128i
+sse41DivideBy257(
+    __m128i values)
+{
+	return (_mm_srli_epi16(_mm_mulhi_epu16(values, _mm_set1_epi16(
+	    static_cast<short>(0xFF01))), 8));
+}
+
+/**
+ * @return
+ * Shuffle gathering 8-bit red, green, and blue of four pixels into the
+ * first 12 bytes.
+ */
+BE_TARGET_SSE4_1 static inline __m128i
+sse41GatherU8RGB(
+    uint8_t componentCount)
+{
+	const char c = componentCount;
+	return (_mm_setr_epi8(0, c, 2 * c, 3 * c, 1, 1 + c, 1 + (2 * c),
+	    1 + (3 * c), 2, 2 + c, 2 + (2 * c), 2 + (3 * c), -1, -1, -1, -1));
+}
+
+/**
+ * @return
+ * Shuffle gathering 16-bit red, green, and blue of two pixels at byte
+ * offset into words [R R G G B B].
+ */
+BE_TARGET_SSE4_1 static inline __m128i
+sse41GatherU16RGB(
+    uint8_t componentCount,
+    uint8_t offset)
+{
+	const char o = offset;
+	const char c = 2 * componentCount;
+	return (_mm_setr_epi8(o, o + 1, o + c, o + c + 1, o + 2, o + 3,
+	    o + c + 2, o + c + 3, o + 4, o + 5, o + c + 4, o + c + 5,
+	    -1, -1, -1, -1));
+}
+
+/**
+ * @brief
+ * Load red, green, and blue of four pixels as 32-bit values, scaled to
+ * the output depth.
+ */
+template<bool In16, bool Out16>
+BE_TARGET_SSE4_1 static inline void
+sse41LoadRGB(
+    const uint8_t *in,
+    uint8_t componentCount,
+    __m128i &red,
+    __m128i &green,
+    __m128i &blue)
+{
+	if (In16) {
+		/* Second load ends at the end of the fourth pixel */
+		const uint8_t hiOffset = (componentCount == 3 ? 8 : 16);
+		const __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128(
+		    reinterpret_cast<const __m128i*>(in)),
+		    sse41GatherU16RGB(componentCount, 0));
+		const __m128i hi = _mm_shuffle_epi8(_mm_loadu_si128(
+		    reinterpret_cast<const __m128i*>(in + hiOffset)),
+		    sse41GatherU16RGB(componentCount,
+		    (4 * componentCount) - hiOffset));
+		__m128i rg = _mm_unpacklo_epi32(lo, hi);
+		__m128i bx = _mm_unpackhi_epi32(lo, hi);
+		if (!Out16) {
+			rg = sse41DivideBy257(rg);
+			bx = sse41DivideBy257(bx);
+		}
+		red = _mm_cvtepu16_epi32(rg);
+		green = _mm_cvtepu16_epi32(_mm_srli_si128(rg, 8));
+		blue = _mm_cvtepu16_epi32(bx);
+	} else {
+		const __m128i rgb = _mm_shuffle_epi8(_mm_loadu_si128(
+		    reinterpret_cast<const __m128i*>(in)),
+		    sse41GatherU8RGB(componentCount));
+		red = _mm_cvtepu8_epi32(rgb);
+		green = _mm_cvtepu8_epi32(_mm_srli_si128(rgb, 4));
+		blue = _mm_cvtepu8_epi32(_mm_srli_si128(rgb, 8));
+		if (Out16) {
+			const __m128i scale = _mm_set1_epi32(257);
+			red = _mm_mullo_epi32(red, scale);
+			green = _mm_mullo_epi32(green, scale);
+			blue = _mm_mullo_epi32(blue, scale);
+		}
+	}
+}
+
+template<bool In16, bool Out16>
+BE_TARGET_SSE4_1 static uint64_t
+sse41ColorToGray(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t componentCount)
+{
+	const uint8_t bytesPerPixel = componentCount * (In16 ? 2 : 1);
+	/* 8-bit RGB reads 16 bytes for 12 bytes of pixels */
+	const uint64_t minimum = ((!In16 && (componentCount == 3)) ? 6 : 4);
+
+	uint64_t i = 0;
+	__m128i red, green, blue;
+	for (; (pixelCount - i) >= minimum; i += 4) {
+		sse41LoadRGB<In16, Out16>(in + (i * bytesPerPixel),
+		    componentCount, red, green, blue);
+		const __m128i gray = _mm_packus_epi32(sse41Luma(red, green,
+		    blue), _mm_setzero_si128());
+		if (Out16) {
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(
+			    out + (i * 2)), gray);
+		} else {
+			const int32_t gray8 = _mm_cvtsi128_si32(
+			    _mm_packus_epi16(gray, gray));
+			std::memcpy(out + i, &gray8, sizeof(gray8));
+		}
+	}
+	return (i);
+}
+
+BE_TARGET_SSE4_1 static uint64_t
+sse41Rescale(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t inDepth)
+{
+	uint64_t i = 0;
+	if (inDepth == 8) {
+		/* (v << 8) | v == v * 257 */
+		for (; (pixelCount - i) >= 16; i += 16) {
+			const __m128i v = _mm_loadu_si128(
+			    reinterpret_cast<const __m128i*>(in + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(
+			    out + (i * 2)), _mm_unpacklo_epi8(v, v));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(
+			    out + (i * 2) + 16), _mm_unpackhi_epi8(v, v));
+		}
+	} else {
+		for (; (pixelCount - i) >= 16; i += 16) {
+			const __m128i lo = sse41DivideBy257(_mm_loadu_si128(
+			    reinterpret_cast<const __m128i*>(in + (i * 2))));
+			const __m128i hi = sse41DivideBy257(_mm_loadu_si128(
+			    reinterpret_cast<const __m128i*>(in + (i * 2) +
+			    16)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+			    _mm_packus_epi16(lo, hi));
+		}
+	}
+	return (i);
+}
+
+BE_TARGET_SSE4_1 static uint64_t
+sse41RemoveLastComponent(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t bytesPerComponent,
+    uint8_t componentCount)
+{
+	uint64_t i = 0;
+	if (componentCount == 2) {
+		/* 16 bytes in, 8 bytes out */
+		const uint8_t step = (bytesPerComponent == 1 ? 8 : 4);
+		const __m128i gather = (bytesPerComponent == 1 ?
+		    _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14,
+		    -1, -1, -1, -1, -1, -1, -1, -1) :
+		    _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13,
+		    -1, -1, -1, -1, -1, -1, -1, -1));
+		for (; (pixelCount - i) >= step; i += step)
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(
+			    out + (i * bytesPerComponent)),
+			    _mm_shuffle_epi8(_mm_loadu_si128(
+			    reinterpret_cast<const __m128i*>(in + (i * 2 *
+			    bytesPerComponent))), gather));
+	} else {
+		/* 16 bytes in, 12 bytes out */
+		const uint8_t step = (bytesPerComponent == 1 ? 4 : 2);
+		const __m128i gather = (bytesPerComponent == 1 ?
+		    _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+		    -1, -1, -1, -1) :
+		    _mm_setr_epi8(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13,
+		    -1, -1, -1, -1));
+		for (; (pixelCount - i) >= step; i += step) {
+			const __m128i rgb = _mm_shuffle_epi8(_mm_loadu_si128(
+			    reinterpret_cast<const __m128i*>(in + (i * 4 *
+			    bytesPerComponent))), gather);
+			uint8_t *dst = out + (i * 3 * bytesPerComponent);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst), rgb);
+			const int32_t last = _mm_cvtsi128_si32(
+			    _mm_srli_si128(rgb, 8));
+			std::memcpy(dst + 8, &last, sizeof(last));
+		}
+	}
+	return (i);
+}
+
+BE_TARGET_SSE4_1 static uint64_t
+sse41WeightedSum(
+    const float *in,
+    uint64_t stride,
+    const float *weights,
+    uint32_t weightCount,
+    float *out,
+    uint64_t length)
+{
+	uint64_t i = 0;
+	for (; (length - i) >= 4; i += 4) {
+		__m128 sum = _mm_setzero_ps();
+		for (uint32_t k = 0; k < weightCount; k++)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(
+			    weights[k]), _mm_loadu_ps(in + (k * stride) + i)));
+		_mm_storeu_ps(out + i, sum);
+	}
+	return (i);
+}
+
+/*
+ * AVX2 implementations, processing twice the pixels of the SSE4.1
+ * implementations per iteration.
+ */
+
+/** @return Truncated luma of eight pixels */
+BE_TARGET_AVX2 static inline __m256i
+avx2Luma(
+    __m256i red,
+    __m256i green,
+    __m256i blue)
+{
+	/* Same operations, in the same order, as the scalar version */
+	const __m256 gray = _mm256_add_ps(_mm256_add_ps(
+	    _mm256_mul_ps(_mm256_cvtepi32_ps(red),
+	    _mm256_set1_ps(RedFactor)),
+	    _mm256_mul_ps(_mm256_cvtepi32_ps(green),
+	    _mm256_set1_ps(GreenFactor))),
+	    _mm256_mul_ps(_mm256_cvtepi32_ps(blue),
+	    _mm256_set1_ps(BlueFactor)));
+	return (_mm256_cvttps_epi32(gray));
+}
+
+/** @return floor(value / 257) of each 16-bit value */
+BE_TARGET_AVX2 static inline __m256i
+avx2DivideBy257(
+    __m256i values)
+{
+	return (_mm256_srli_epi16(_mm256_mulhi_epu16(values,
+	    _mm256_set1_epi16(static_cast<short>(0xFF01))), 8));
+}
+
+template<bool In16, bool Out16>
+BE_TARGET_AVX2 static uint64_t
+avx2ColorToGray(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t componentCount)
+{
+	const uint8_t bytesPerPixel = componentCount * (In16 ? 2 : 1);
+	/* 8-bit RGB reads 16 bytes for the last 12 bytes of pixels */
+	const uint64_t minimum = ((!In16 && (componentCount == 3)) ? 10 : 8);
+
+	const char c = componentCount;
+	const __m128i gatherU8 = _mm_setr_epi8(0, c, 2 * c, 3 * c, 1, 1 + c,
+	    1 + (2 * c), 1 + (3 * c), 2, 2 + c, 2 + (2 * c), 2 + (3 * c),
+	    -1, -1, -1, -1);
+	const uint8_t hiOffset = (componentCount == 3 ? 8 : 16);
+	const char w = 2 * componentCount;
+	const char o = (4 * componentCount) - hiOffset;
+	const __m128i gatherU16Lo = _mm_setr_epi8(0, 1, w, w + 1, 2, 3,
+	    w + 2, w + 3, 4, 5, w + 4, w + 5, -1, -1, -1, -1);
+	const __m128i gatherU16Hi = _mm_setr_epi8(o, o + 1, o + w,
+	    o + w + 1, o + 2, o + 3, o + w + 2, o + w + 3, o + 4, o + 5,
+	    o + w + 4, o + w + 5, -1, -1, -1, -1);
+
+	uint64_t i = 0;
+	__m256i red, green, blue;
+	for (; (pixelCount - i) >= minimum; i += 8) {
+		const uint8_t *src = in + (i * bytesPerPixel);
+		if (In16) {
+			/* Words [R R R R G G G G] and [B B B B x x x x] */
+			__m128i rg[2], bx[2];
+			for (int half = 0; half < 2; half++) {
+				const uint8_t *p = src + (half * 4 *
+				    bytesPerPixel);
+				const __m128i lo = _mm_shuffle_epi8(
+				    _mm_loadu_si128(reinterpret_cast<
+				    const __m128i*>(p)), gatherU16Lo);
+				const __m128i hi = _mm_shuffle_epi8(
+				    _mm_loadu_si128(reinterpret_cast<
+				    const __m128i*>(p + hiOffset)),
+				    gatherU16Hi);
+				rg[half] = _mm_unpacklo_epi32(lo, hi);
+				bx[half] = _mm_unpackhi_epi32(lo, hi);
+			}
+			__m256i r = _mm256_cvtepu16_epi32(
+			    _mm_unpacklo_epi64(rg[0], rg[1]));
+			__m256i g = _mm256_cvtepu16_epi32(
+			    _mm_unpackhi_epi64(rg[0], rg[1]));
+			__m256i b = _mm256_cvtepu16_epi32(
+			    _mm_unpacklo_epi64(bx[0], bx[1]));
+			if (!Out16) {
+				/* Values fit in 16 bits of each 32 */
+				r = avx2DivideBy257(r);
+				g = avx2DivideBy257(g);
+				b = avx2DivideBy257(b);
+			}
+			red = r;
+			green = g;
+			blue = b;
+		} else {
+			/* Bytes [R R R R G G G G B B B B x x x x] */
+			const __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128(
+			    reinterpret_cast<const __m128i*>(src)), gatherU8);
+			const __m128i hi = _mm_shuffle_epi8(_mm_loadu_si128(
+			    reinterpret_cast<const __m128i*>(src + (4 *
+			    bytesPerPixel))), gatherU8);
+			const __m128i rg = _mm_unpacklo_epi32(lo, hi);
+			red = _mm256_cvtepu8_epi32(rg);
+			green = _mm256_cvtepu8_epi32(_mm_srli_si128(rg, 8));
+			blue = _mm256_cvtepu8_epi32(_mm_unpackhi_epi32(lo,
+			    hi));
+			if (Out16) {
+				const __m256i scale = _mm256_set1_epi32(257);
+				red = _mm256_mullo_epi32(red, scale);
+				green = _mm256_mullo_epi32(green, scale);
+				blue = _mm256_mullo_epi32(blue, scale);
+			}
+		}
+
+		const __m256i gray = avx2Luma(red, green, blue);
+		const __m128i gray16 = _mm_packus_epi32(
+		    _mm256_castsi256_si128(gray),
+		    _mm256_extracti128_si256(gray, 1));
+		if (Out16)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(
+			    out + (i * 2)), gray16);
+		else
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i),
+			    _mm_packus_epi16(gray16, gray16));
+	}
+	return (i);
+}
+
+BE_TARGET_AVX2 static uint64_t
+avx2Rescale(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t inDepth)
+{
+	uint64_t i = 0;
+	if (inDepth == 8) {
+		const __m256i scale = _mm256_set1_epi16(257);
+		for (; (pixelCount - i) >= 16; i += 16)
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(
+			    out + (i * 2)), _mm256_mullo_epi16(
+			    _mm256_cvtepu8_epi16(_mm_loadu_si128(
+			    reinterpret_cast<const __m128i*>(in + i))),
+			    scale));
+	} else {
+		for (; (pixelCount - i) >= 32; i += 32) {
+			const __m256i lo = avx2DivideBy257(_mm256_loadu_si256(
+			    reinterpret_cast<const __m256i*>(in + (i * 2))));
+			const __m256i hi = avx2DivideBy257(_mm256_loadu_si256(
+			    reinterpret_cast<const __m256i*>(in + (i * 2) +
+			    32)));
+			/* Packing interleaves the 128-bit lanes */
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+			    _mm256_permute4x64_epi64(_mm256_packus_epi16(lo,
+			    hi), 0xD8));
+		}
+	}
+	return (i);
+}
+
+BE_TARGET_AVX2 static uint64_t
+avx2RemoveLastComponent(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t bytesPerComponent,
+    uint8_t componentCount)
+{
+	uint64_t i = 0;
+	if (componentCount == 2) {
+		/* 32 bytes in, 16 bytes out */
+		const uint8_t step = (bytesPerComponent == 1 ? 16 : 8);
+		const __m256i gather = (bytesPerComponent == 1 ?
+		    _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14,
+		    -1, -1, -1, -1, -1, -1, -1, -1,
+		    0, 2, 4, 6, 8, 10, 12, 14,
+		    -1, -1, -1, -1, -1, -1, -1, -1) :
+		    _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13,
+		    -1, -1, -1, -1, -1, -1, -1, -1,
+		    0, 1, 4, 5, 8, 9, 12, 13,
+		    -1, -1, -1, -1, -1, -1, -1, -1));
+		for (; (pixelCount - i) >= step; i += step) {
+			const __m256i packed = _mm256_permute4x64_epi64(
+			    _mm256_shuffle_epi8(_mm256_loadu_si256(
+			    reinterpret_cast<const __m256i*>(in + (i * 2 *
+			    bytesPerComponent))), gather), 0x08);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(
+			    out + (i * bytesPerComponent)),
+			    _mm256_castsi256_si128(packed));
+		}
+	} else {
+		/* 32 bytes in, 24 bytes out */
+		const uint8_t step = (bytesPerComponent == 1 ? 8 : 4);
+		const __m256i gather = (bytesPerComponent == 1 ?
+		    _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+		    -1, -1, -1, -1,
+		    0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+		    -1, -1, -1, -1) :
+		    _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13,
+		    -1, -1, -1, -1,
+		    0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13,
+		    -1, -1, -1, -1));
+		const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6,
+		    3, 7);
+		for (; (pixelCount - i) >= step; i += step) {
+			const __m256i rgb = _mm256_permutevar8x32_epi32(
+			    _mm256_shuffle_epi8(_mm256_loadu_si256(
+			    reinterpret_cast<const __m256i*>(in + (i * 4 *
+			    bytesPerComponent))), gather), compact);
+			uint8_t *dst = out + (i * 3 * bytesPerComponent);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+			    _mm256_castsi256_si128(rgb));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 16),
+			    _mm256_extracti128_si256(rgb, 1));
+		}
+	}
+	return (i);
+}
+
+BE_TARGET_AVX2 static uint64_t
+avx2WeightedSum(
+    const float *in,
+    uint64_t stride,
+    const float *weights,
+    uint32_t weightCount,
+    float *out,
+    uint64_t length)
+{
+	uint64_t i = 0;
+	for (; (length - i) >= 8; i += 8) {
+		__m256 sum = _mm256_setzero_ps();
+		for (uint32_t k = 0; k < weightCount; k++)
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(
+			    weights[k]), _mm256_loadu_ps(in + (k * stride) + i)));
+		_mm256_storeu_ps(out + i, sum);
+	}
+	return (i);
+}
+
+#endif /* BE_IMAGE_PIXELKERNELS_X86 */
+
+bool
+BiometricEvaluation::Image::PixelKernels::isSupported(
+    InstructionSet instructionSet)
+{
+	switch (instructionSet) {
+	case InstructionSet::Scalar:
+		return (true);
+#ifdef BE_IMAGE_PIXELKERNELS_X86
+	case InstructionSet::SSE4_1:
+		/* May be called before libgcc's own initialization */
+		__builtin_cpu_init();
+		return (__builtin_cpu_supports("sse4.1"));
+	case InstructionSet::AVX2:
+		__builtin_cpu_init();
+		return (__builtin_cpu_supports("avx2"));
+#endif
+	default:
+		return (false);
+	}
+}
+
+BiometricEvaluation::Image::PixelKernels::InstructionSet
+BiometricEvaluation::Image::PixelKernels::getInstructionSet()
+{
+	return (currentInstructionSet);
+}
+
+void
+BiometricEvaluation::Image::PixelKernels::setInstructionSet(
+    InstructionSet instructionSet)
+{
+	if (!isSupported(instructionSet))
+		throw BE::Error::NotImplemented(BE::Framework::Enumeration::
+		    to_string(instructionSet) + " instructions");
+	currentInstructionSet = instructionSet;
+}
+
+/**
+ * @brief
+ * Convert color to gray with the current instruction set.
+ */
+template<bool In16, bool Out16>
+static void
+dispatchColorToGray(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t componentCount)
+{
+	uint64_t done = 0;
+#ifdef BE_IMAGE_PIXELKERNELS_X86
+	switch (currentInstructionSet) {
+	case PixelKernels::InstructionSet::AVX2:
+		done = avx2ColorToGray<In16, Out16>(in, out, pixelCount,
+		    componentCount);
+		break;
+	case PixelKernels::InstructionSet::SSE4_1:
+		done = sse41ColorToGray<In16, Out16>(in, out, pixelCount,
+		    componentCount);
+		break;
+	case PixelKernels::InstructionSet::Scalar:
+		break;
+	}
+#endif
+
+	scalarColorToGray<In16, Out16>(in + (done * componentCount *
+	    (In16 ? 2 : 1)), out + (done * (Out16 ? 2 : 1)),
+	    pixelCount - done, componentCount);
+}
+
+void
+BiometricEvaluation::Image::PixelKernels::colorToGray(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t inDepth,
+    uint8_t componentCount,
+    uint8_t outDepth)
+{
+	if ((inDepth != 8) && (inDepth != 16))
+		throw BE::Error::ParameterError("Unsupported input depth (" +
+		    std::to_string(inDepth) + ")");
+	if ((outDepth != 8) && (outDepth != 16))
+		throw BE::Error::ParameterError("Unsupported output depth (" +
+		    std::to_string(outDepth) + ")");
+	if ((componentCount != 3) && (componentCount != 4))
+		throw BE::Error::ParameterError("Unsupported number of "
+		    "components (" + std::to_string(componentCount) + ")");
+
+	if (inDepth == 8) {
+		if (outDepth == 8)
+			dispatchColorToGray<false, false>(in, out, pixelCount,
+			    componentCount);
+		else
+			dispatchColorToGray<false, true>(in, out, pixelCount,
+			    componentCount);
+	} else {
+		if (outDepth == 8)
+			dispatchColorToGray<true, false>(in, out, pixelCount,
+			    componentCount);
+		else
+			dispatchColorToGray<true, true>(in, out, pixelCount,
+			    componentCount);
+	}
+}
+
+void
+BiometricEvaluation::Image::PixelKernels::rescale(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t inDepth,
+    uint8_t outDepth)
+{
+	if (((inDepth != 8) && (inDepth != 16)) ||
+	    ((outDepth != 8) && (outDepth != 16)))
+		throw BE::Error::ParameterError("Unsupported depths (" +
+		    std::to_string(inDepth) + " to " +
+		    std::to_string(outDepth) + ")");
+	if (inDepth == outDepth) {
+		std::memcpy(out, in, pixelCount * (inDepth / 8));
+		return;
+	}
+
+	uint64_t done = 0;
+#ifdef BE_IMAGE_PIXELKERNELS_X86
+	switch (currentInstructionSet) {
+	case InstructionSet::AVX2:
+		done = avx2Rescale(in, out, pixelCount, inDepth);
+		break;
+	case InstructionSet::SSE4_1:
+		done = sse41Rescale(in, out, pixelCount, inDepth);
+		break;
+	case InstructionSet::Scalar:
+		break;
+	}
+#endif
+
+	scalarRescale(in + (done * (inDepth / 8)), out + (done *
+	    (outDepth / 8)), pixelCount - done, inDepth);
+}
+
+void
+BiometricEvaluation::Image::PixelKernels::removeLastComponent(
+    const uint8_t *in,
+    uint8_t *out,
+    uint64_t pixelCount,
+    uint8_t bytesPerComponent,
+    uint8_t componentCount)
+{
+	if ((bytesPerComponent != 1) && (bytesPerComponent != 2))
+		throw BE::Error::ParameterError("Unsupported component size (" +
+		    std::to_string(bytesPerComponent) + ")");
+	if ((componentCount != 2) && (componentCount != 4))
+		throw BE::Error::ParameterError("Unsupported number of "
+		    "components (" + std::to_string(componentCount) + ")");
+
+	uint64_t done = 0;
+#ifdef BE_IMAGE_PIXELKERNELS_X86
+	switch (currentInstructionSet) {
+	case InstructionSet::AVX2:
+		done = avx2RemoveLastComponent(in, out, pixelCount,
+		    bytesPerComponent, componentCount);
+		break;
+	case InstructionSet::SSE4_1:
+		done = sse41RemoveLastComponent(in, out, pixelCount,
+		    bytesPerComponent, componentCount);
+		break;
+	case InstructionSet::Scalar:
+		break;
+	}
+#endif
+
+	scalarRemoveLastComponent(in + (done * bytesPerComponent *
+	    componentCount), out + (done * bytesPerComponent *
+	    (componentCount - 1)), pixelCount - done, bytesPerComponent,
+	    componentCount);
+}
+
+void
+BiometricEvaluation::Image::PixelKernels::weightedSum(
+    const float *in,
+    uint64_t stride,
+    const float *weights,
+    uint32_t weightCount,
+    float *out,
+    uint64_t length)
+{
+	uint64_t done = 0;
+#ifdef BE_IMAGE_PIXELKERNELS_X86
+	switch (currentInstructionSet) {
+	case InstructionSet::AVX2:
+		done = avx2WeightedSum(in, stride, weights, weightCount, out,
+		    length);
+		break;
+	case InstructionSet::SSE4_1:
+		done = sse41WeightedSum(in, stride, weights, weightCount, out,
+		    length);
+		break;
+	case InstructionSet::Scalar:
+		break;
+	}
+#endif
+
+	scalarWeightedSum(in + done, stride, weights, weightCount, out + done,
+	    length - done);
+}
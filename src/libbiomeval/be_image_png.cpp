@@ -8,11 +8,17 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #include <png.h>
 
 #include <be_image_png.h>
+#include <be_image_raw.h>
 #include <be_memory.h>
 #include <be_memory_autoarray.h>
+#include <be_memory_indexedbuffer.h>
 #include <be_memory_mutableindexedbuffer.h>
 
 namespace BE = BiometricEvaluation;
@@ -52,6 +58,44 @@ png_read_mem_src(
     png_bytep buffer,
     png_size_t length);
 
+/** Wrapper for writing PNG-encoded data to an AutoArray with libpng. */
+struct png_output_buffer
+{
+	/** PNG-encoded buffer, with spare capacity */
+	BE::Memory::uint8Array data;
+	/** Number of bytes written by libpng */
+	png_size_t offset;
+};
+using png_output_buffer = struct png_output_buffer;
+
+/**
+ * @brief
+ * libpng callback to write data to an AutoArray.
+ *
+ * @param png_ptr
+ * Pointer to a PNG struct for the image.
+ * @param buffer
+ * Encoded data to append to the png_output_buffer.
+ * @param length
+ * Size of buffer.
+ */
+static void
+png_write_mem_dest(
+    png_structp png_ptr,
+    png_bytep buffer,
+    png_size_t length);
+
+/**
+ * @brief
+ * libpng callback to flush written data (no-op).
+ *
+ * @param png_ptr
+ * Pointer to a PNG struct for the image.
+ */
+static void
+png_flush_mem_dest(
+    png_structp png_ptr);
+
 /**
  * @brief
  * Call statusCallback from libpng errors.
@@ -88,6 +132,20 @@ BiometricEvaluation::Image::PNG::PNG(
     const uint64_t size,
     const std::string &identifier,
     const statusCallback_t &statusCallback) :
+    BiometricEvaluation::Image::PNG::PNG(
+    Image::copyData(data, size),
+    size,
+    identifier,
+    statusCallback)
+{
+
+}
+
+BiometricEvaluation::Image::PNG::PNG(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
     Image::Image(
     data,
     size,
@@ -179,60 +237,78 @@ BiometricEvaluation::Image::PNG::PNG(
 
 }
 
+/**
+ * @brief
+ * Start decoding a PNG image, with the transformations producing the
+ * format returned from getRawData().
+ *
+ * @param png
+ * Image to decode.
+ * @param png_buf
+ * Buffer over the encoded data of png, which must outlive png_ptr.
+ * @param png_ptr
+ * Set to a new PNG read struct, positioned at the first row.
+ * @param png_info_ptr
+ * Set to a new PNG info struct.
+ *
+ * @throw Error::StrategyError
+ * Error initializing libpng or reading headers.  Nothing needs to be
+ * destroyed.
+ *
+ * @note
+ * Caller must call png_destroy_read_struct() on png_ptr and png_info_ptr.
+ */
+static void
+png_start_read(
+    const BE::Image::PNG *png,
+    png_buffer &png_buf,
+    png_structp &png_ptr,
+    png_infop &png_info_ptr);
+
+/** BandReader decoding rows of non-interlaced PNG images */
+class PNGBandReader : public BE::Image::Image::BandReader
+{
+public:
+	PNGBandReader(
+	    const BE::Image::PNG &png,
+	    const BE::Image::ROI &region,
+	    png_buffer &&png_buf,
+	    png_structp png_ptr,
+	    png_infop png_info_ptr);
+
+	~PNGBandReader();
+
+protected:
+	uint32_t
+	decodeBand(
+	    uint8_t *band,
+	    const uint32_t row)
+	    override;
+
+private:
+	/** Encoded data read by libpng */
+	png_buffer _png_buf;
+	/** Decompression state */
+	png_structp _png_ptr;
+	/** Image information */
+	png_infop _png_info_ptr;
+	/** Row of the image that libpng decodes next */
+	uint32_t _pngRow{0};
+	/** Entire row, when the region is narrower than the image */
+	BE::Memory::uint8Array _row{};
+};
+
+/** Rows in each band of a PNGBandReader */
+static const uint32_t PNG_BAND_ROWS = 32;
+
 BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::Image::PNG::getRawData()
+BiometricEvaluation::Image::PNG::decodeRawData()
     const
 {
-	png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING,
-	    (void *)this, png_error_callback, png_warning_callback);
-	if (png_ptr == nullptr)
-		throw Error::StrategyError("Could not initialize reading");
-
-	/* Read encoded PNG data from a buffer using our extension */
 	png_buffer png_buf = { this->getDataPointer(), this->getDataSize(), 0 };
-	png_set_read_fn(png_ptr, &png_buf, png_read_mem_src);
-
-	/* Read the header information */
-	png_infop png_info_ptr = png_create_info_struct(png_ptr);
-	if (png_info_ptr == nullptr) {
-		png_destroy_read_struct(&png_ptr, nullptr, nullptr);
-		throw Error::StrategyError("Could not initialize container for "
-		    "information");
-	}
-	png_read_info(png_ptr, png_info_ptr);
-
-	/* PNG default storage is big-endian */
-	auto pngBitDepth = png_get_bit_depth(png_ptr, png_info_ptr);
-	if ((pngBitDepth > 8) && BiometricEvaluation::Memory::isLittleEndian())
-		png_set_swap(png_ptr);
-
-
-	/* Let libpng help us do transformations. */
-	bool didTransformations{false};
-	auto color_type = png_get_color_type(png_ptr, png_info_ptr);
-	if ((color_type == PNG_COLOR_TYPE_GRAY) && (pngBitDepth < 8)) {
-		png_set_expand_gray_1_2_4_to_8(png_ptr);
-		didTransformations = true;
-	}
-
-	/* De-paletteize */
-	if (color_type == PNG_COLOR_TYPE_PALETTE) {
-		png_set_palette_to_rgb(png_ptr);
-		didTransformations = true;
-	}
-
-	/* Interpret tRNS block into alpha channel */
-	if (png_get_valid(png_ptr, png_info_ptr, PNG_INFO_tRNS)) {
-		png_set_tRNS_to_alpha(png_ptr);
-		didTransformations = true;
-	}
-
-	/* Update the info_ptr. Can only be called once! */
-	if (didTransformations) {
-		png_read_update_info(png_ptr, png_info_ptr);
-		pngBitDepth = png_get_bit_depth(png_ptr, png_info_ptr);
-		color_type = png_get_color_type(png_ptr, png_info_ptr);
-	}
+	png_structp png_ptr;
+	png_infop png_info_ptr;
+	png_start_read(this, png_buf, png_ptr, png_info_ptr);
 
 	/* Determine size of decompressed data */
 	const png_uint_32 rowbytes = png_get_rowbytes(png_ptr, png_info_ptr);
@@ -249,6 +325,96 @@ BiometricEvaluation::Image::PNG::getRawData()
 	return (rawData);
 }
 
+std::unique_ptr<BiometricEvaluation::Image::Image::BandReader>
+BiometricEvaluation::Image::PNG::makeBandReader(
+    const ROI &roi)
+    const
+{
+	const ROI region = this->getReducedROI(0, roi);
+
+	png_buffer png_buf = { this->getDataPointer(), this->getDataSize(), 0 };
+	png_structp png_ptr;
+	png_infop png_info_ptr;
+	png_start_read(this, png_buf, png_ptr, png_info_ptr);
+
+	/* Passes of interlaced images each cover the entire image */
+	if (png_get_interlace_type(png_ptr, png_info_ptr) !=
+	    PNG_INTERLACE_NONE) {
+		png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
+		return (Image::makeBandReader(roi));
+	}
+
+	try {
+		return (std::make_unique<PNGBandReader>(*this, region,
+		    std::move(png_buf), png_ptr, png_info_ptr));
+	} catch (...) {
+		png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
+		throw;
+	}
+}
+
+PNGBandReader::PNGBandReader(
+    const BE::Image::PNG &png,
+    const BE::Image::ROI &region,
+    png_buffer &&png_buf,
+    png_structp png_ptr,
+    png_infop png_info_ptr) :
+    BandReader(png, region, std::min(PNG_BAND_ROWS, region.size.ySize)),
+    _png_buf(png_buf),
+    _png_ptr(png_ptr),
+    _png_info_ptr(png_info_ptr)
+{
+	/* libpng reads through the copied buffer from now on */
+	png_set_read_fn(this->_png_ptr, &this->_png_buf, png_read_mem_src);
+
+	const uint64_t rowbytes = png_get_rowbytes(this->_png_ptr,
+	    this->_png_info_ptr);
+	if (rowbytes < this->getRowSize())
+		throw BE::Error::StrategyError("Raw data is smaller than "
+		    "image dimensions");
+	if (rowbytes != this->getRowSize())
+		this->_row.resize(rowbytes);
+}
+
+PNGBandReader::~PNGBandReader()
+{
+	png_destroy_read_struct(&this->_png_ptr, &this->_png_info_ptr,
+	    nullptr);
+}
+
+uint32_t
+PNGBandReader::decodeBand(
+    uint8_t *band,
+    const uint32_t row)
+{
+	const BE::Image::ROI region = this->getRegion();
+	const uint32_t rows = std::min(this->getMaximumBandRows(),
+	    region.vertOffset + region.size.ySize - row);
+
+	/* Rows above the region are decoded and discarded */
+	if (this->_row.size() == 0)
+		this->_row.resize(this->getRowSize());
+	for (; this->_pngRow < row; this->_pngRow++)
+		png_read_row(this->_png_ptr, this->_row, nullptr);
+
+	const uint64_t rowSize = this->getRowSize();
+	const uint64_t offset = (this->_row.size() == rowSize ? 0 :
+	    (this->_row.size() / png_get_image_width(this->_png_ptr,
+	    this->_png_info_ptr)) * region.horzOffset);
+	for (uint32_t i = 0; i < rows; i++, this->_pngRow++) {
+		if (this->_row.size() == rowSize) {
+			png_read_row(this->_png_ptr, band + (i * rowSize),
+			    nullptr);
+		} else {
+			png_read_row(this->_png_ptr, this->_row, nullptr);
+			std::memcpy(band + (i * rowSize), this->_row + offset,
+			    rowSize);
+		}
+	}
+
+	return (rows);
+}
+
 BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::Image::PNG::getRawGrayscaleData(
     uint8_t depth)
@@ -271,6 +437,217 @@ BiometricEvaluation::Image::PNG::isPNG(
 	return (png_sig_cmp(header, 0, PNG_SIG_LENGTH) == 0);
 }
 
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::PNG::probe(
+    const uint8_t *data,
+    const uint64_t size)
+{
+	static const png_size_t PNG_SIG_LENGTH = 8;
+	/* Chunk types (ISO/IEC 15948:2003) */
+	static const uint8_t IHDR[4] = {'I', 'H', 'D', 'R'};
+	static const uint8_t pHYs[4] = {'p', 'H', 'Y', 's'};
+	static const uint8_t IDAT[4] = {'I', 'D', 'A', 'T'};
+	static const uint8_t IEND[4] = {'I', 'E', 'N', 'D'};
+	/* Size of chunk type and CRC surrounding the chunk data */
+	static const uint8_t TYPE_LENGTH = 4;
+	static const uint8_t CRC_LENGTH = 4;
+
+	if (!PNG::isPNG(data, size))
+		throw Error::DataError("No PNG signature");
+	/* Signature, IHDR length and type, IHDR data, and CRC */
+	if (size < (PNG_SIG_LENGTH + 4 + TYPE_LENGTH + 13 + CRC_LENGTH))
+		throw Error::DataError("Truncated IHDR");
+
+	Attributes attributes;
+	attributes.compressionAlgorithm = CompressionAlgorithm::PNG;
+	/* Default when pHYs is not present (see constructor) */
+	attributes.resolution = Resolution(72, 72, Resolution::Units::PPI);
+
+	Memory::IndexedBuffer buffer(data, size);
+	buffer.setIndex(PNG_SIG_LENGTH);
+
+	/* IHDR must be first */
+	if (buffer.scanBeU32Val() != 13)
+		throw Error::DataError("Invalid IHDR length");
+	if (std::memcmp(data + buffer.getIndex(), IHDR, TYPE_LENGTH) != 0)
+		throw Error::DataError("IHDR is not the first chunk");
+	buffer.setIndex(buffer.getIndex() + TYPE_LENGTH);
+	const uint32_t width = buffer.scanBeU32Val();
+	const uint32_t height = buffer.scanBeU32Val();
+	const uint8_t pngBitDepth = buffer.scanU8Val();
+	const uint8_t colorType = buffer.scanU8Val();
+
+	uint8_t channels;
+	switch (colorType) {
+	case PNG_COLOR_TYPE_GRAY:
+		channels = 1;
+		break;
+	case PNG_COLOR_TYPE_RGB:
+		channels = 3;
+		break;
+	case PNG_COLOR_TYPE_PALETTE:
+		channels = 1;
+		break;
+	case PNG_COLOR_TYPE_GRAY_ALPHA:
+		channels = 2;
+		break;
+	case PNG_COLOR_TYPE_RGB_ALPHA:
+		channels = 4;
+		break;
+	default:
+		throw Error::DataError("Invalid color type (" +
+		    std::to_string(colorType) + ")");
+	}
+	attributes.colorDepth = pngBitDepth * channels;
+	/* Possible this could be <8-bit palette color */
+	if ((attributes.colorDepth <= 8) &&
+	    ((colorType & PNG_COLOR_MASK_PALETTE) == PNG_COLOR_MASK_PALETTE))
+		throw BE::Error::NotImplemented("Color palette PNG image, "
+		    "bit depth = " + std::to_string(pngBitDepth) + ", color "
+		    "type = " + std::to_string(colorType));
+	attributes.bitDepth = pngBitDepth;
+	attributes.dimensions = Size(width, height);
+	attributes.hasAlphaChannel = ((colorType & PNG_COLOR_MASK_ALPHA) ==
+	    PNG_COLOR_MASK_ALPHA);
+
+	/* Skip compression, filter, interlace, and CRC */
+	buffer.setIndex(buffer.getIndex() + 3 + CRC_LENGTH);
+
+	/* pHYs must precede the image data */
+	while (buffer.getIndex() < size) {
+		const uint32_t length = buffer.scanBeU32Val();
+		const uint8_t *type = data + buffer.getIndex();
+		if ((buffer.getIndex() + TYPE_LENGTH) > size)
+			throw Error::DataError("Truncated chunk");
+		if ((std::memcmp(type, IDAT, TYPE_LENGTH) == 0) ||
+		    (std::memcmp(type, IEND, TYPE_LENGTH) == 0))
+			break;
+		buffer.setIndex(buffer.getIndex() + TYPE_LENGTH);
+
+		if (std::memcmp(type, pHYs, TYPE_LENGTH) == 0) {
+			const uint32_t xres = buffer.scanBeU32Val();
+			const uint32_t yres = buffer.scanBeU32Val();
+			switch (buffer.scanU8Val()) {
+			case PNG_RESOLUTION_METER:
+				attributes.resolution = Resolution(
+				    xres / 100.0, yres / 100.0,
+				    Resolution::Units::PPCM);
+				break;
+			default:
+				/*
+				 * For our purposes, there really is no good
+				 * way to unambiguously set a resolution.
+				 */
+				attributes.resolution = Resolution(0, 0,
+				    Resolution::Units::PPCM);
+				break;
+			}
+			break;
+		}
+
+		if ((static_cast<uint64_t>(buffer.getIndex()) + length +
+		    CRC_LENGTH) > size)
+			throw Error::DataError("Truncated chunk");
+		buffer.setIndex(buffer.getIndex() + length + CRC_LENGTH);
+	}
+
+	return (attributes);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::PNG::encode(
+    const Raw &raw,
+    const uint8_t compressionLevel)
+{
+	if (compressionLevel > 9)
+		throw Error::ParameterError("Invalid compression level");
+	const Size dimensions = raw.getDimensions();
+	if ((dimensions.xSize == 0) || (dimensions.ySize == 0))
+		throw Error::ParameterError("No pixels to encode");
+
+	const uint16_t bitDepth = raw.getBitDepth();
+	if ((bitDepth != 8) && (bitDepth != 16))
+		throw Error::NotImplemented("Encoding " + std::to_string(
+		    bitDepth) + "-bit components");
+	int colorType;
+	switch (raw.getColorDepth() / bitDepth) {
+	case 1:
+		colorType = PNG_COLOR_TYPE_GRAY;
+		break;
+	case 2:
+		colorType = PNG_COLOR_TYPE_GRAY_ALPHA;
+		break;
+	case 3:
+		colorType = PNG_COLOR_TYPE_RGB;
+		break;
+	case 4:
+		colorType = PNG_COLOR_TYPE_RGB_ALPHA;
+		break;
+	default:
+		throw Error::NotImplemented("Encoding " + std::to_string(
+		    raw.getColorDepth()) + "-bit pixels");
+	}
+
+	const Memory::uint8Array rawData = raw.getRawData();
+	const uint64_t rowbytes = static_cast<uint64_t>(dimensions.xSize) *
+	    (raw.getColorDepth() / 8);
+	if (rawData.size() < (rowbytes * dimensions.ySize))
+		throw Error::ParameterError("Raw data is smaller than "
+		    "dimensions");
+
+	png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
+	    nullptr, png_error_callback, png_warning_callback);
+	if (png_ptr == nullptr)
+		throw Error::StrategyError("Could not initialize writing");
+	png_infop png_info_ptr = png_create_info_struct(png_ptr);
+	if (png_info_ptr == nullptr) {
+		png_destroy_write_struct(&png_ptr, nullptr);
+		throw Error::StrategyError("Could not initialize container for "
+		    "information");
+	}
+
+	/* Start with a guess of 2:1 compression */
+	png_output_buffer png_buf = {
+	    Memory::uint8Array((rowbytes * dimensions.ySize / 2) + 1024), 0};
+	try {
+		png_set_write_fn(png_ptr, &png_buf, png_write_mem_dest,
+		    png_flush_mem_dest);
+		png_set_compression_level(png_ptr, compressionLevel);
+		png_set_IHDR(png_ptr, png_info_ptr, dimensions.xSize,
+		    dimensions.ySize, bitDepth, colorType, PNG_INTERLACE_NONE,
+		    PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+
+		/* pHYs is only defined in meters */
+		if (raw.getResolution().units != Resolution::Units::NA) {
+			const Resolution ppcm = raw.getResolution().toUnits(
+			    Resolution::Units::PPCM);
+			png_set_pHYs(png_ptr, png_info_ptr,
+			    static_cast<png_uint_32>(std::lround(ppcm.xRes *
+			    100)), static_cast<png_uint_32>(std::lround(
+			    ppcm.yRes * 100)), PNG_RESOLUTION_METER);
+		}
+		png_write_info(png_ptr, png_info_ptr);
+
+		/* PNG default storage is big-endian */
+		if ((bitDepth > 8) && Memory::isLittleEndian())
+			png_set_swap(png_ptr);
+
+		Memory::AutoArray<png_bytep> row_pointers(dimensions.ySize);
+		for (uint32_t row = 0; row < dimensions.ySize; row++)
+			row_pointers[row] = const_cast<png_bytep>(
+			    rawData + (row * rowbytes));
+		png_write_image(png_ptr, row_pointers);
+		png_write_end(png_ptr, nullptr);
+	} catch (...) {
+		png_destroy_write_struct(&png_ptr, &png_info_ptr);
+		throw;
+	}
+	png_destroy_write_struct(&png_ptr, &png_info_ptr);
+
+	png_buf.data.resize(png_buf.offset);
+	return (png_buf.data);
+}
+
 void
 png_read_mem_src(
     png_structp png_ptr,
@@ -295,6 +672,32 @@ png_read_mem_src(
 	input->offset += length;
 }
 
+void
+png_write_mem_dest(
+    png_structp png_ptr,
+    png_bytep buffer,
+    png_size_t length)
+{
+	png_output_buffer *output = static_cast<png_output_buffer *>(
+	    png_get_io_ptr(png_ptr));
+	if (output == nullptr)
+		throw BE::Error::StrategyError("Lost current offset while "
+		    "writing to memory");
+
+	if ((output->offset + length) > output->data.size())
+		output->data.resize(std::max<png_size_t>(
+		    output->data.size() * 2, output->offset + length));
+	std::memcpy(output->data + output->offset, buffer, length);
+	output->offset += length;
+}
+
+void
+png_flush_mem_dest(
+    png_structp /* png_ptr */)
+{
+	/* NOP */
+}
+
 void
 png_error_callback(
     png_structp png_ptr,
@@ -329,3 +732,63 @@ png_warning_callback(
 	png->getStatusCallback()({BE::Framework::Status::Type::Error, msg,
 	    png->getIdentifier()});
 }
+
+void
+png_start_read(
+    const BE::Image::PNG *png,
+    png_buffer &png_buf,
+    png_structp &png_ptr,
+    png_infop &png_info_ptr)
+{
+	png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING,
+	    (void *)png, png_error_callback, png_warning_callback);
+	if (png_ptr == nullptr)
+		throw BE::Error::StrategyError("Could not initialize reading");
+
+	/* Read encoded PNG data from a buffer using our extension */
+	png_set_read_fn(png_ptr, &png_buf, png_read_mem_src);
+
+	/* Read the header information */
+	png_info_ptr = png_create_info_struct(png_ptr);
+	if (png_info_ptr == nullptr) {
+		png_destroy_read_struct(&png_ptr, nullptr, nullptr);
+		throw BE::Error::StrategyError("Could not initialize container "
+		    "for information");
+	}
+	try {
+		png_read_info(png_ptr, png_info_ptr);
+	} catch (...) {
+		png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
+		throw;
+	}
+
+	/* PNG default storage is big-endian */
+	auto pngBitDepth = png_get_bit_depth(png_ptr, png_info_ptr);
+	if ((pngBitDepth > 8) && BiometricEvaluation::Memory::isLittleEndian())
+		png_set_swap(png_ptr);
+
+
+	/* Let libpng help us do transformations. */
+	bool didTransformations{false};
+	auto color_type = png_get_color_type(png_ptr, png_info_ptr);
+	if ((color_type == PNG_COLOR_TYPE_GRAY) && (pngBitDepth < 8)) {
+		png_set_expand_gray_1_2_4_to_8(png_ptr);
+		didTransformations = true;
+	}
+
+	/* De-paletteize */
+	if (color_type == PNG_COLOR_TYPE_PALETTE) {
+		png_set_palette_to_rgb(png_ptr);
+		didTransformations = true;
+	}
+
+	/* Interpret tRNS block into alpha channel */
+	if (png_get_valid(png_ptr, png_info_ptr, PNG_INFO_tRNS)) {
+		png_set_tRNS_to_alpha(png_ptr);
+		didTransformations = true;
+	}
+
+	/* Update the info_ptr. Can only be called once! */
+	if (didTransformations)
+		png_read_update_info(png_ptr, png_info_ptr);
+}
@@ -8,6 +8,8 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <cstring>
+
 #include <be_image_raw.h>
 #include <be_memory_autoarray.h>
 
@@ -57,6 +59,30 @@ BiometricEvaluation::Image::Raw::Raw(
 
 }
 
+BiometricEvaluation::Image::Raw::Raw(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const Size dimensions,
+    const uint32_t colorDepth,
+    const uint16_t bitDepth,
+    const Resolution resolution,
+    const bool hasAlphaChannel,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
+    Image(data,
+    size,
+    dimensions,
+    colorDepth,
+    bitDepth,
+    resolution,
+    CompressionAlgorithm::None,
+    hasAlphaChannel,
+    identifier,
+    statusCallback)
+{
+
+}
+
 BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::Image::Raw::getRawData()
     const
@@ -64,6 +90,15 @@ BiometricEvaluation::Image::Raw::getRawData()
 	return (this->getData());
 }
 
+void
+BiometricEvaluation::Image::Raw::getRawData(
+    Memory::uint8Array &rawData)
+    const
+{
+	resizeBuffer(rawData, this->getDataSize());
+	std::memcpy(rawData, this->getDataPointer(), this->getDataSize());
+}
+
 BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::Image::Raw::getRawGrayscaleData(
     uint8_t depth)
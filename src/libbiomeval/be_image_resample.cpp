@@ -0,0 +1,497 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_image_pixelkernels.h>
+#include <be_image_resample.h>
+
+namespace BE = BiometricEvaluation;
+
+const std::map<BE::Image::ResampleFilter, std::string>
+BE_Image_ResampleFilter_EnumToStringMap = {
+	{BE::Image::ResampleFilter::Area, "Area"},
+	{BE::Image::ResampleFilter::Bilinear, "Bilinear"},
+	{BE::Image::ResampleFilter::Lanczos3, "Lanczos3"}
+};
+
+BE_FRAMEWORK_ENUMERATION_DEFINITIONS(
+    BiometricEvaluation::Image::ResampleFilter,
+    BE_Image_ResampleFilter_EnumToStringMap);
+
+/** Pixels per side of the tiles transposed at once */
+static const uint32_t TransposeTile = 16;
+
+/** Resampled rows computed at once */
+static const uint32_t GroupRows = 64;
+
+/** Source pixels contributing to each resampled pixel, along one axis */
+struct Contributions
+{
+	/** First source pixel of each resampled pixel */
+	std::vector<uint32_t> first{};
+	/** Number of source pixels of each resampled pixel */
+	std::vector<uint32_t> count{};
+	/** Weights of each resampled pixel, stride apart */
+	std::vector<float> weights{};
+	/** Distance between weights of consecutive resampled pixels */
+	uint32_t stride{0};
+};
+
+/**
+ * @brief
+ * Evaluate an interpolating filter.
+ *
+ * @param filter
+ * Filter to evaluate (not ResampleFilter::Area).
+ * @param x
+ * Distance from the center of the filter, in pixels.
+ *
+ * @return
+ * Unnormalized weight of a pixel x from the center.
+ */
+static double
+filterValue(
+    const BE::Image::ResampleFilter filter,
+    double x)
+{
+	x = std::fabs(x);
+	switch (filter) {
+	case BE::Image::ResampleFilter::Bilinear:
+		return (x < 1.0 ? 1.0 - x : 0.0);
+	case BE::Image::ResampleFilter::Lanczos3:
+		if (x == 0.0)
+			return (1.0);
+		if (x >= 3.0)
+			return (0.0);
+		return ((3.0 * std::sin(M_PI * x) * std::sin(M_PI * x / 3.0)) /
+		    (M_PI * M_PI * x * x));
+	default:
+		return (0.0);
+	}
+}
+
+/**
+ * @brief
+ * Compute the contributions of source pixels along one axis.
+ *
+ * @param filter
+ * Filter to use.
+ * @param offset
+ * Start of the resampled region, in source pixels.
+ * @param length
+ * Length of the resampled region, in source pixels.
+ * @param limit
+ * Length of the source image, in pixels.
+ * @param resampledLength
+ * Length of the resampled image, in pixels.
+ *
+ * @return
+ * Normalized contributions, in source image coordinates.
+ */
+static Contributions
+computeContributions(
+    const BE::Image::ResampleFilter filter,
+    const uint32_t offset,
+    const uint32_t length,
+    const uint32_t limit,
+    const uint32_t resampledLength)
+{
+	const double scale = static_cast<double>(length) / resampledLength;
+	/* Widen filters when reducing, so that every pixel contributes */
+	const double filterScale = std::max(scale, 1.0);
+	const double support = (filter == BE::Image::ResampleFilter::Lanczos3 ?
+	    3.0 : 1.0) * filterScale;
+
+	std::vector<std::vector<double>> weights(resampledLength);
+	Contributions contributions;
+	contributions.first.resize(resampledLength);
+	contributions.count.resize(resampledLength);
+	for (uint32_t i = 0; i < resampledLength; i++) {
+		int64_t first, end;
+		std::vector<double> &w = weights[i];
+		if (filter == BE::Image::ResampleFilter::Area) {
+			/* Overlap of the resampled pixel with each pixel */
+			const double begin = offset + (i * scale);
+			const double finish = offset + ((i + 1) * scale);
+			first = static_cast<int64_t>(std::floor(begin));
+			end = std::min<int64_t>(static_cast<int64_t>(
+			    std::ceil(finish)), limit);
+			for (int64_t j = first; j < end; j++)
+				w.push_back(std::min<double>(finish, j + 1) -
+				    std::max<double>(begin, j));
+		} else {
+			const double center = offset + ((i + 0.5) * scale);
+			first = std::max<int64_t>(static_cast<int64_t>(
+			    std::floor(center - support)), 0);
+			end = std::min<int64_t>(static_cast<int64_t>(
+			    std::ceil(center + support)), limit);
+			for (int64_t j = first; j < end; j++)
+				w.push_back(filterValue(filter,
+				    (j + 0.5 - center) / filterScale));
+		}
+
+		/* Trim pixels that do not contribute */
+		while (!w.empty() && (w.back() == 0.0))
+			w.pop_back();
+		while (!w.empty() && (w.front() == 0.0)) {
+			w.erase(w.begin());
+			first++;
+		}
+
+		double sum{0};
+		for (const double value : w)
+			sum += value;
+		if (w.empty() || (sum == 0.0)) {
+			/* Nearest pixel */
+			w.assign(1, 1.0);
+			first = std::min<int64_t>(static_cast<int64_t>(offset +
+			    ((i + 0.5) * scale)), limit - 1);
+			sum = 1.0;
+		}
+		for (double &value : w)
+			value /= sum;
+
+		contributions.first[i] = static_cast<uint32_t>(first);
+		contributions.count[i] = static_cast<uint32_t>(w.size());
+		contributions.stride = std::max<uint32_t>(contributions.stride,
+		    w.size());
+	}
+
+	contributions.weights.resize(static_cast<uint64_t>(resampledLength) *
+	    contributions.stride);
+	for (uint32_t i = 0; i < resampledLength; i++)
+		for (uint32_t k = 0; k < contributions.count[i]; k++)
+			contributions.weights[(static_cast<uint64_t>(i) *
+			    contributions.stride) + k] =
+			    static_cast<float>(weights[i][k]);
+
+	return (contributions);
+}
+
+/**
+ * @brief
+ * Filter rows of pixels, producing new rows.
+ *
+ * @param in
+ * Rows of rowLength values.
+ * @param rowLength
+ * Values per row.
+ * @param contributions
+ * Contributions of rows in to each row of out.
+ * @param base
+ * Row of the source image that is the first row of in.
+ * @param out
+ * Buffer of contributions.first.size() rows of rowLength values.
+ */
+static void
+filterRows(
+    const float *in,
+    const uint64_t rowLength,
+    const Contributions &contributions,
+    const uint32_t base,
+    float *out)
+{
+	for (uint64_t row = 0; row < contributions.first.size(); row++)
+		BE::Image::PixelKernels::weightedSum(in + ((contributions.first[
+		    row] - base) * rowLength), rowLength,
+		    contributions.weights.data() + (row * contributions.stride),
+		    contributions.count[row], out + (row * rowLength),
+		    rowLength);
+}
+
+/**
+ * @brief
+ * Transpose pixels of several values.
+ *
+ * @param in
+ * rows rows of columns pixels.
+ * @param rows
+ * Number of rows of in.
+ * @param columns
+ * Number of pixels in each row of in.
+ * @param components
+ * Values in each pixel.
+ * @param store
+ * Function called to store each value of out, with the index of the
+ * value in out (columns rows of rows pixels) and the value.
+ */
+template<typename Store>
+static void
+transpose(
+    const float *in,
+    const uint64_t rows,
+    const uint64_t columns,
+    const uint8_t components,
+    Store store)
+{
+	for (uint64_t r0 = 0; r0 < rows; r0 += TransposeTile) {
+		const uint64_t rEnd = std::min<uint64_t>(r0 + TransposeTile,
+		    rows);
+		for (uint64_t c0 = 0; c0 < columns; c0 += TransposeTile) {
+			const uint64_t cEnd = std::min<uint64_t>(c0 +
+			    TransposeTile, columns);
+			for (uint64_t c = c0; c < cEnd; c++)
+				for (uint64_t r = r0; r < rEnd; r++)
+					for (uint8_t i = 0; i < components; i++)
+						store((((c * rows) + r) *
+						    components) + i, in[(((r *
+						    columns) + c) *
+						    components) + i]);
+		}
+	}
+}
+
+/**
+ * @brief
+ * Resample a region of an image.
+ *
+ * @param image
+ * Image to resample.
+ * @param size
+ * Dimensions of the resampled image.
+ * @param filter
+ * Filter to use.
+ * @param roi
+ * Region of image to resample, or an ROI with no size for all of image.
+ * @param resolution
+ * Resolution of the resampled image, or nullptr to scale the resolution
+ * of image.
+ *
+ * @return
+ * Resampled image.
+ */
+static BE::Image::Raw
+resampleRegion(
+    const BE::Image::Image &image,
+    const BE::Image::Size &size,
+    const BE::Image::ResampleFilter filter,
+    const BE::Image::ROI &roi,
+    const BE::Image::Resolution *resolution)
+{
+	using namespace BE::Image;
+	namespace Error = BE::Error;
+	namespace Memory = BE::Memory;
+
+	if ((size.xSize == 0) || (size.ySize == 0))
+		throw Error::ParameterError("Resampled size is empty");
+
+	const Size dimensions = image.getDimensions();
+	ROI region(dimensions, 0, 0, {});
+	if ((roi.size.xSize != 0) && (roi.size.ySize != 0)) {
+		/* Throws if roi is not within the image */
+		image.getReducedDimensions(0, roi);
+		region = ROI(roi.size, roi.horzOffset, roi.vertOffset, {});
+	}
+
+	const Contributions horizontal = computeContributions(filter,
+	    region.horzOffset, region.size.xSize, dimensions.xSize,
+	    size.xSize);
+	const Contributions vertical = computeContributions(filter,
+	    region.vertOffset, region.size.ySize, dimensions.ySize,
+	    size.ySize);
+
+	/* Decode only source pixels that contribute */
+	uint32_t left{UINT32_MAX}, right{0}, top{UINT32_MAX}, bottom{0};
+	for (uint32_t i = 0; i < size.xSize; i++) {
+		left = std::min(left, horizontal.first[i]);
+		right = std::max(right, horizontal.first[i] +
+		    horizontal.count[i]);
+	}
+	for (uint32_t i = 0; i < size.ySize; i++) {
+		top = std::min(top, vertical.first[i]);
+		bottom = std::max(bottom, vertical.first[i] +
+		    vertical.count[i]);
+	}
+	const ROI source(Size(right - left, bottom - top), left, top, {});
+	const auto reader = image.makeBandReader(source);
+
+	const uint8_t components = std::max<uint8_t>(image.getColorDepth() /
+	    image.getBitDepth(), 1);
+	const uint64_t sourceRowLength = static_cast<uint64_t>(
+	    source.size.xSize) * components;
+	const uint64_t bytesPerComponent = reader->getRowSize() /
+	    sourceRowLength;
+	if (((bytesPerComponent != 1) && (bytesPerComponent != 2)) ||
+	    (reader->getRowSize() != (sourceRowLength * bytesPerComponent)))
+		throw Error::NotImplemented("Resampling " + std::to_string(
+		    image.getColorDepth()) + "-bit images");
+
+	const auto output = std::make_shared<Memory::uint8Array>(
+	    static_cast<uint64_t>(size.xSize) * size.ySize * components *
+	    bytesPerComponent);
+	const float maximum = (bytesPerComponent == 1 ? UINT8_MAX :
+	    UINT16_MAX);
+
+	/* First source row needed by each resampled row and after */
+	std::vector<uint32_t> keep(size.ySize);
+	for (uint32_t row = size.ySize; row-- > 0; )
+		keep[row] = (row == (size.ySize - 1) ? vertical.first[row] :
+		    std::min(vertical.first[row], keep[row + 1]));
+
+	/*
+	 * Resampled rows are computed in groups, so that memory used
+	 * depends on the width of the image and not its height.  Source
+	 * rows are decoded a band at a time, and discarded once no
+	 * remaining resampled row needs them.
+	 */
+	std::vector<float> window;
+	uint32_t windowTop{top};
+	Memory::uint8Array band(reader->getBandSize());
+	std::vector<float> columns, transposed, resampled;
+	for (uint32_t groupTop = 0; groupTop < size.ySize;
+	    groupTop += GroupRows) {
+		const uint32_t groupRows = std::min(GroupRows,
+		    size.ySize - groupTop);
+
+		/* Vertical pass, from source rows to resampled rows */
+		columns.resize(sourceRowLength * groupRows);
+		for (uint32_t row = groupTop; row < (groupTop + groupRows);
+		    row++) {
+			const uint32_t end = vertical.first[row] +
+			    vertical.count[row];
+			while ((windowTop + (window.size() / sourceRowLength)) <
+			    end) {
+				const uint64_t discard = std::min<uint64_t>(
+				    keep[row] - windowTop, window.size() /
+				    sourceRowLength);
+				window.erase(window.begin(), window.begin() +
+				    (discard * sourceRowLength));
+				windowTop += discard;
+
+				const uint32_t rows = reader->read(band);
+				if (rows == 0)
+					throw Error::StrategyError("Fewer rows "
+					    "decoded than image dimensions");
+				const uint64_t count = rows * sourceRowLength;
+				const uint64_t offset = window.size();
+				window.resize(offset + count);
+				if (bytesPerComponent == 1) {
+					for (uint64_t i = 0; i < count; i++)
+						window[offset + i] = band[i];
+				} else {
+					uint16_t value;
+					for (uint64_t i = 0; i < count; i++) {
+						std::memcpy(&value, band +
+						    (i * 2), sizeof(value));
+						window[offset + i] = value;
+					}
+				}
+			}
+
+			PixelKernels::weightedSum(window.data() +
+			    ((vertical.first[row] - windowTop) *
+			    sourceRowLength), sourceRowLength,
+			    vertical.weights.data() + (static_cast<uint64_t>(
+			    row) * vertical.stride), vertical.count[row],
+			    columns.data() + ((row - groupTop) *
+			    sourceRowLength), sourceRowLength);
+		}
+
+		/*
+		 * Horizontal pass, as a vertical pass over transposed
+		 * pixels, so that it also uses vectorized weighted sums.
+		 */
+		const uint64_t columnLength = static_cast<uint64_t>(
+		    groupRows) * components;
+		transposed.resize(columns.size());
+		transpose(columns.data(), groupRows, source.size.xSize,
+		    components, [&transposed](uint64_t i, float value) {
+			transposed[i] = value;
+		});
+		resampled.resize(columnLength * size.xSize);
+		filterRows(transposed.data(), columnLength, horizontal, left,
+		    resampled.data());
+
+		/* Transpose back, rounding to the source depth */
+		uint8_t *out = *output + (static_cast<uint64_t>(groupTop) *
+		    size.xSize * components * bytesPerComponent);
+		if (bytesPerComponent == 1) {
+			transpose(resampled.data(), size.xSize, groupRows,
+			    components, [out, maximum](uint64_t i,
+			    float value) {
+				out[i] = static_cast<uint8_t>(std::floor(
+				    std::min(std::max(value, 0.0f), maximum) +
+				    0.5f));
+			});
+		} else {
+			transpose(resampled.data(), size.xSize, groupRows,
+			    components, [out, maximum](uint64_t i,
+			    float value) {
+				const uint16_t rounded = static_cast<uint16_t>(
+				    std::floor(std::min(std::max(value, 0.0f),
+				    maximum) + 0.5f));
+				std::memcpy(out + (i * 2), &rounded,
+				    sizeof(rounded));
+			});
+		}
+	}
+
+	Resolution resampledResolution = image.getResolution();
+	if (resolution != nullptr) {
+		resampledResolution = *resolution;
+	} else {
+		resampledResolution.xRes *= static_cast<double>(size.xSize) /
+		    region.size.xSize;
+		resampledResolution.yRes *= static_cast<double>(size.ySize) /
+		    region.size.ySize;
+	}
+
+	return (Raw(Image::shareData(output), output->size(), size,
+	    components * bytesPerComponent * 8, bytesPerComponent * 8,
+	    resampledResolution, image.hasAlphaChannel(),
+	    image.getIdentifier()));
+}
+
+BiometricEvaluation::Image::Raw
+BiometricEvaluation::Image::resample(
+    const Image &image,
+    const Size &size,
+    const ResampleFilter filter,
+    const ROI &roi)
+{
+	return (resampleRegion(image, size, filter, roi, nullptr));
+}
+
+BiometricEvaluation::Image::Raw
+BiometricEvaluation::Image::normalizeResolution(
+    const Image &image,
+    const Resolution &resolution,
+    const ResampleFilter filter,
+    const ROI &roi)
+{
+	if ((resolution.xRes <= 0) || (resolution.yRes <= 0))
+		throw Error::ParameterError("Resolution is not positive");
+
+	Size size = image.getDimensions();
+	if ((roi.size.xSize != 0) && (roi.size.ySize != 0))
+		size = roi.size;
+
+	/* Throws StrategyError without units */
+	const Resolution current = image.getResolution().toUnits(
+	    resolution.units);
+	if ((current.xRes <= 0) || (current.yRes <= 0))
+		throw Error::StrategyError("Image resolution is not positive");
+
+	const Size resampledSize(
+	    std::max<uint32_t>(static_cast<uint32_t>(std::lround(size.xSize *
+	    resolution.xRes / current.xRes)), 1),
+	    std::max<uint32_t>(static_cast<uint32_t>(std::lround(size.ySize *
+	    resolution.yRes / current.yRes)), 1));
+
+	return (resampleRegion(image, resampledSize, filter, roi,
+	    &resolution));
+}
@@ -8,12 +8,63 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <cstring>
+
 #include <tiffio.h>
 
 #include <be_image_tiff.h>
 
 namespace BE = BiometricEvaluation;
 
+/** Largest number of scanlines in each band of a TIFFBandReader */
+static const uint32_t TIFF_BAND_ROWS = 64;
+
+/**
+ * BandReader decoding bands of scanlines, or rows of tiles, of TIFF
+ * images with whole-byte pixels.
+ */
+class TIFFBandReader : public BE::Image::Image::BandReader
+{
+public:
+	/**
+	 * @param tiff
+	 * TIFF whose pixels are a whole number of bytes.
+	 * @param region
+	 * Region of tiff to decode.
+	 * @param stream
+	 * Decompression stream of tiff, taken by the reader.
+	 */
+	TIFFBandReader(
+	    const BE::Image::TIFF &tiff,
+	    const BE::Image::ROI &region,
+	    std::unique_ptr<::TIFF, void(*)(::TIFF*)> &&stream);
+
+protected:
+	uint32_t
+	decodeBand(
+	    uint8_t *band,
+	    const uint32_t row)
+	    override;
+
+private:
+	/** Number of rows of each band of an image */
+	static uint32_t
+	bandRows(
+	    ::TIFF *stream);
+
+	/** Decompression stream */
+	std::unique_ptr<::TIFF, void(*)(::TIFF*)> _stream;
+	/** Size of a pixel */
+	uint64_t _pixelSize;
+	/** Whether the image is tiled */
+	bool _tiled;
+	/** Dimensions of tiles */
+	uint32_t _tileWidth{0}, _tileLength{0};
+	/** Decoded scanline or tile */
+	BE::Memory::uint8Array _buffer{};
+};
+
 /*
  * Avoid needing tiffio.h in header file by defining I/O functions here.
  * TODO: pimpl.
@@ -167,6 +218,20 @@ BiometricEvaluation::Image::TIFF::TIFF(
     const uint64_t size,
     const std::string &identifier,
     const statusCallback_t &statusCallback) :
+    BiometricEvaluation::Image::TIFF::TIFF(
+    Image::copyData(data, size),
+    size,
+    identifier,
+    statusCallback)
+{
+
+}
+
+BiometricEvaluation::Image::TIFF::TIFF(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
     Image(
     data,
     size,
@@ -174,7 +239,7 @@ BiometricEvaluation::Image::TIFF::TIFF(
     identifier,
     statusCallback)
 {
-	if (!isTIFF(data, size))
+	if (!isTIFF(data.get(), size))
 		throw BE::Error::StrategyError("Not a TIFF image");
 
 	TIFFSetWarningHandlerExt(BE_TIFFWarningHandler);
@@ -275,14 +340,31 @@ BiometricEvaluation::Image::TIFF::TIFF(
 }
 
 BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::Image::TIFF::getRawData()
+BiometricEvaluation::Image::TIFF::decodeRawData()
     const
 {
 	std::unique_ptr<::TIFF, void(*)(::TIFF*)> tiff(
 	    static_cast<::TIFF*>(this->getDecompressionStream()), TIFFClose);
 
-	const auto rowBytes = TIFFScanlineSize64(tiff.get());
 	const auto dim = this->getDimensions();
+	/* Tiles can't be read as scanlines */
+	if (TIFFIsTiled(tiff.get()) && ((this->getColorDepth() % 8) == 0)) {
+		TIFFBandReader reader(*this, BE::Image::ROI(dim, 0, 0, {}),
+		    std::move(tiff));
+		BE::Memory::uint8Array rawData(reader.getRowSize() *
+		    dim.ySize);
+		BE::Memory::uint8Array band(reader.getBandSize());
+		uint32_t rows;
+		uint64_t offset{0};
+		while ((rows = reader.read(band)) != 0) {
+			std::memcpy(rawData + offset, band, rows *
+			    reader.getRowSize());
+			offset += rows * reader.getRowSize();
+		}
+		return (rawData);
+	}
+
+	const auto rowBytes = TIFFScanlineSize64(tiff.get());
 	BE::Memory::uint8Array rawData(dim.ySize * rowBytes);
 
 	for (uint32_t i{0}; i < dim.ySize; ++i) {
@@ -296,6 +378,117 @@ BiometricEvaluation::Image::TIFF::getRawData()
 	return (rawData);
 }
 
+std::unique_ptr<BiometricEvaluation::Image::Image::BandReader>
+BiometricEvaluation::Image::TIFF::makeBandReader(
+    const ROI &roi)
+    const
+{
+	/* Scanlines of components of fewer than 8 bits are packed */
+	if ((this->getColorDepth() % 8) != 0)
+		return (Image::makeBandReader(roi));
+
+	const ROI region = this->getReducedROI(0, roi);
+	std::unique_ptr<::TIFF, void(*)(::TIFF*)> tiff(
+	    static_cast<::TIFF*>(this->getDecompressionStream()), TIFFClose);
+	return (std::make_unique<TIFFBandReader>(*this, region,
+	    std::move(tiff)));
+}
+
+TIFFBandReader::TIFFBandReader(
+    const BE::Image::TIFF &tiff,
+    const BE::Image::ROI &region,
+    std::unique_ptr<::TIFF, void(*)(::TIFF*)> &&stream) :
+    BandReader(tiff, region, std::min(bandRows(stream.get()),
+        region.size.ySize)),
+    _stream(std::move(stream)),
+    _pixelSize(tiff.getColorDepth() / 8),
+    _tiled(TIFFIsTiled(this->_stream.get()))
+{
+	::TIFF *tiffStream = this->_stream.get();
+	if (this->_tiled) {
+		if ((TIFFGetField(tiffStream, TIFFTAG_TILEWIDTH,
+		    &this->_tileWidth) != 1) || (TIFFGetField(tiffStream,
+		    TIFFTAG_TILELENGTH, &this->_tileLength) != 1) ||
+		    (this->_tileWidth == 0) || (this->_tileLength == 0))
+			throw BE::Error::StrategyError("Could not read tile "
+			    "dimensions");
+		this->_buffer.resize(TIFFTileSize64(tiffStream));
+	} else {
+		this->_buffer.resize(TIFFScanlineSize64(tiffStream));
+	}
+}
+
+uint32_t
+TIFFBandReader::bandRows(
+    ::TIFF *stream)
+{
+	uint32_t rows{0};
+	if (TIFFIsTiled(stream)) {
+		if (TIFFGetField(stream, TIFFTAG_TILELENGTH, &rows) != 1)
+			throw BE::Error::StrategyError("Could not read tile "
+			    "length");
+		return (rows);
+	}
+
+	/* Strips may hold the whole image, so limit bands of scanlines */
+	if (TIFFGetFieldDefaulted(stream, TIFFTAG_ROWSPERSTRIP, &rows) != 1)
+		rows = TIFF_BAND_ROWS;
+	return (std::min(rows, TIFF_BAND_ROWS));
+}
+
+uint32_t
+TIFFBandReader::decodeBand(
+    uint8_t *band,
+    const uint32_t row)
+{
+	const BE::Image::ROI region = this->getRegion();
+	const uint32_t bottom = region.vertOffset + region.size.ySize;
+	const uint64_t rowSize = this->getRowSize();
+
+	if (!this->_tiled) {
+		const uint32_t rows = std::min(this->getMaximumBandRows(),
+		    bottom - row);
+		for (uint32_t i = 0; i < rows; i++) {
+			if (TIFFReadScanline(this->_stream.get(),
+			    this->_buffer, row + i, 0) != 1)
+				throw BE::Error::DataError("Error reading "
+				    "scanline " + std::to_string(row + i));
+			std::memcpy(band + (i * rowSize), this->_buffer +
+			    (region.horzOffset * this->_pixelSize), rowSize);
+		}
+		return (rows);
+	}
+
+	/* Bands end at the bottom of a row of tiles */
+	const uint32_t tileTop = (row / this->_tileLength) * this->_tileLength;
+	const uint32_t rows = std::min(tileTop + this->_tileLength, bottom) -
+	    row;
+	const uint32_t left = region.horzOffset;
+	const uint32_t right = left + region.size.xSize;
+	for (uint32_t tileLeft = (left / this->_tileWidth) * this->_tileWidth;
+	    tileLeft < right; tileLeft += this->_tileWidth) {
+		const ttile_t tile = TIFFComputeTile(this->_stream.get(),
+		    tileLeft, tileTop, 0, 0);
+		if (TIFFReadEncodedTile(this->_stream.get(), tile,
+		    this->_buffer, this->_buffer.size()) < 0)
+			throw BE::Error::DataError("Error reading tile " +
+			    std::to_string(tile));
+
+		/* Part of the tile within the region */
+		const uint32_t first = std::max(tileLeft, left);
+		const uint32_t last = std::min(tileLeft + this->_tileWidth,
+		    right);
+		for (uint32_t i = 0; i < rows; i++)
+			std::memcpy(band + (i * rowSize) + ((first - left) *
+			    this->_pixelSize), this->_buffer + (((static_cast<
+			    uint64_t>(row + i - tileTop) * this->_tileWidth) +
+			    (first - tileLeft)) * this->_pixelSize),
+			    (last - first) * this->_pixelSize);
+	}
+
+	return (rows);
+}
+
 BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::Image::TIFF::getRawGrayscaleData(
     uint8_t depth)
@@ -304,6 +497,189 @@ BiometricEvaluation::Image::TIFF::getRawGrayscaleData(
 	return (BE::Image::Image::getRawGrayscaleData(depth));
 }
 
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::TIFF::probe(
+    const uint8_t *data,
+    const uint64_t size)
+{
+	if (!isTIFF(data, size))
+		throw BE::Error::StrategyError("Not a TIFF image");
+
+	BE::Memory::IndexedBuffer buf(data, size);
+	const bool bigEndian = (buf.scanU16Val() == TIFF_BIGENDIAN);
+
+	/* Read an unsigned value of byteCount bytes in file byte order */
+	const auto readValue = [&](uint64_t offset, uint8_t byteCount) ->
+	    uint64_t {
+		if ((offset + byteCount) > size)
+			throw BE::Error::DataError("Can't read beyond end of "
+			    "buffer");
+		uint64_t value{0};
+		for (uint8_t i = 0; i < byteCount; i++) {
+			if (bigEndian)
+				value = (value << 8) | data[offset + i];
+			else
+				value |= static_cast<uint64_t>(
+				    data[offset + i]) << (8 * i);
+		}
+		return (value);
+	};
+
+	/* Classic TIFF and BigTIFF differ in the size of offsets */
+	const uint16_t version = readValue(2, 2);
+	uint8_t offsetSize;
+	uint64_t directoryOffset;
+	uint64_t entryCount;
+	switch (version) {
+	case TIFF_VERSION_CLASSIC:
+		offsetSize = 4;
+		directoryOffset = readValue(4, 4);
+		entryCount = readValue(directoryOffset, 2);
+		directoryOffset += 2;
+		break;
+	case TIFF_VERSION_BIG:
+		offsetSize = 8;
+		directoryOffset = readValue(8, 8);
+		entryCount = readValue(directoryOffset, 8);
+		directoryOffset += 8;
+		break;
+	default:
+		throw BE::Error::DataError("Unsupported TIFF version: " +
+		    std::to_string(version));
+	}
+	/* Tag, type, count, and value or offset */
+	const uint8_t entrySize = 4 + (2 * offsetSize);
+
+	/* Defaults, as returned by TIFFGetFieldDefaulted() */
+	uint16_t colorType{};
+	uint32_t width{}, height{};
+	bool haveWidth{false}, haveHeight{false};
+	uint16_t bitsPerSample{1};
+	uint16_t samplesPerPixel{1};
+	uint16_t extraSamples{0};
+	float xRes{72}, yRes{72};
+	uint16_t planarConfig{PLANARCONFIG_CONTIG};
+	uint16_t rawResUnits{RESUNIT_INCH};
+
+	for (uint64_t entry = 0; entry < entryCount; entry++) {
+		const uint64_t entryOffset = directoryOffset +
+		    (entry * entrySize);
+		const uint16_t tag = readValue(entryOffset, 2);
+		const uint16_t type = readValue(entryOffset + 2, 2);
+		const uint64_t count = readValue(entryOffset + 4, offsetSize);
+		const uint64_t valueOffset = entryOffset + 4 + offsetSize;
+
+		/* First value of an integral field, stored in the entry */
+		const auto integral = [&]() -> uint64_t {
+			switch (type) {
+			case TIFF_BYTE:
+				return (readValue(valueOffset, 1));
+			case TIFF_SHORT:
+				return (readValue(valueOffset, 2));
+			case TIFF_LONG:
+				return (readValue(valueOffset, 4));
+			case TIFF_LONG8:
+				return (readValue(valueOffset, 8));
+			default:
+				throw BE::Error::DataError("Unexpected type " +
+				    std::to_string(type) + " for tag " +
+				    std::to_string(tag));
+			}
+		};
+		/* Single RATIONAL, stored at an offset (classic TIFF) */
+		const auto rational = [&]() -> float {
+			if (type != TIFF_RATIONAL)
+				throw BE::Error::DataError("Unexpected type " +
+				    std::to_string(type) + " for tag " +
+				    std::to_string(tag));
+			const uint64_t offset = (offsetSize == 8 ?
+			    valueOffset : readValue(valueOffset, offsetSize));
+			const uint32_t numerator = readValue(offset, 4);
+			const uint32_t denominator = readValue(offset + 4, 4);
+			return (static_cast<float>(numerator) / denominator);
+		};
+
+		switch (tag) {
+		case TIFFTAG_IMAGEWIDTH:
+			width = integral();
+			haveWidth = true;
+			break;
+		case TIFFTAG_IMAGELENGTH:
+			height = integral();
+			haveHeight = true;
+			break;
+		case TIFFTAG_BITSPERSAMPLE:
+			bitsPerSample = integral();
+			break;
+		case TIFFTAG_PHOTOMETRIC:
+			colorType = integral();
+			break;
+		case TIFFTAG_SAMPLESPERPIXEL:
+			samplesPerPixel = integral();
+			break;
+		case TIFFTAG_XRESOLUTION:
+			xRes = rational();
+			break;
+		case TIFFTAG_YRESOLUTION:
+			yRes = rational();
+			break;
+		case TIFFTAG_PLANARCONFIG:
+			planarConfig = integral();
+			break;
+		case TIFFTAG_RESOLUTIONUNIT:
+			rawResUnits = integral();
+			break;
+		case TIFFTAG_EXTRASAMPLES:
+			extraSamples = count;
+			break;
+		}
+	}
+
+	/* Same checks, in the same order, as the constructor */
+	if ((colorType != PHOTOMETRIC_MINISBLACK) &&
+	    (colorType != PHOTOMETRIC_RGB))
+		throw BE::Error::NotImplemented("Unsupported TIFF colortype: " +
+		    std::to_string(colorType));
+	if (!haveWidth)
+		throw BE::Error::StrategyError("Could not read width");
+	if (!haveHeight)
+		throw BE::Error::StrategyError("Could not read height");
+
+	Attributes attributes;
+	attributes.compressionAlgorithm = CompressionAlgorithm::TIFF;
+	attributes.dimensions = {width, height};
+	attributes.bitDepth = bitsPerSample;
+	attributes.colorDepth = samplesPerPixel * bitsPerSample;
+
+	if ((samplesPerPixel == 1) || (samplesPerPixel == 3))
+		attributes.hasAlphaChannel = false;
+	else if (extraSamples == EXTRASAMPLE_ASSOCALPHA)
+		attributes.hasAlphaChannel = true;
+	else
+		throw BE::Error::NotImplemented("Unusual color depth, "
+		    "and unsure what do to with extra samples");
+
+	if (planarConfig != PLANARCONFIG_CONTIG)
+		throw BE::Error::NotImplemented("TIFF images separated by "
+		    "component are not yet supported");
+
+	BE::Image::Resolution::Units resUnits{BE::Image::Resolution::Units::NA};
+	switch (rawResUnits) {
+	case RESUNIT_INCH:
+		resUnits = BE::Image::Resolution::Units::PPI;
+		break;
+	case RESUNIT_CENTIMETER:
+		resUnits = BE::Image::Resolution::Units::PPCM;
+		break;
+	default:
+		resUnits = BE::Image::Resolution::Units::NA;
+		break;
+	}
+	attributes.resolution = {xRes, yRes, resUnits};
+
+	return (attributes);
+}
+
 bool
 BiometricEvaluation::Image::TIFF::isTIFF(
     const uint8_t *data,
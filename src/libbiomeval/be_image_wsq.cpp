@@ -8,7 +8,9 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <cmath>
 #include <cstdio>
+#include <mutex>
 
 extern "C" {
 	#include <dataio.h>
@@ -16,6 +18,7 @@ extern "C" {
 	int biomeval_nbis_debug = 0;	/* Required by libwsq */
 }
 
+#include <be_image_raw.h>
 #include <be_image_wsq.h>
 
 BiometricEvaluation::Image::WSQ::WSQ(
@@ -23,6 +26,20 @@ BiometricEvaluation::Image::WSQ::WSQ(
     const uint64_t size,
     const std::string &identifier,
     const statusCallback_t &statusCallback) :
+    BiometricEvaluation::Image::WSQ::WSQ(
+    Image::copyData(data, size),
+    size,
+    identifier,
+    statusCallback)
+{
+
+}
+
+BiometricEvaluation::Image::WSQ::WSQ(
+    const std::shared_ptr<const uint8_t> &data,
+    const uint64_t size,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
     Image::Image(
     data,
     size,
@@ -30,9 +47,97 @@ BiometricEvaluation::Image::WSQ::WSQ(
     identifier,
     statusCallback)
 {
-	uint8_t *marker_buf = (uint8_t *)this->getDataPointer();
+	this->setAttributes(WSQ::probe(data.get(), size));
+}
+
+BiometricEvaluation::Image::WSQ::WSQ(
+    const BiometricEvaluation::Memory::uint8Array &data,
+    const std::string &identifier,
+    const statusCallback_t &statusCallback) :
+    BiometricEvaluation::Image::WSQ::WSQ(
+    data,
+    data.size(),
+    identifier,
+    statusCallback)
+{
+
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::WSQ::decodeRawData()
+    const
+{
+	Memory::uint8Array rawData;
+	this->decodeReduced(0, rawData);
+	return (rawData);
+}
+
+void
+BiometricEvaluation::Image::WSQ::decodeRawDataInto(
+    Memory::uint8Array &rawData)
+    const
+{
+	this->decodeReduced(0, rawData);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::WSQ::getRawData(
+    const uint8_t reduction,
+    const ROI &roi)
+    const
+{
+	/* Full resolution may already be decoded */
+	if ((reduction == 0) || (reduction > WSQ_MAX_REDUCTION))
+		return (Image::getRawData(reduction, roi));
+
+	/* Coarse wavelet levels cover the entire image */
+	Memory::uint8Array reduced;
+	this->decodeReduced(reduction, reduced);
+	return (this->cropReducedRawData(reduced, reduction, roi));
+}
+
+void
+BiometricEvaluation::Image::WSQ::decodeReduced(
+    const uint8_t reduction,
+    Memory::uint8Array &rawData)
+    const
+{
+	/* WSQ is always 8-bit grayscale */
+	const Size dimensions = this->getReducedDimensions(reduction, ROI());
+	resizeBuffer(rawData, static_cast<uint64_t>(dimensions.xSize) *
+	    dimensions.ySize);
+
+	/* Decoder state is kept on the stack so that decodes may overlap */
+	DECODE_CTX_WSQ ctx;
+	int32_t depth, height, lossy, ppi, rv, width;
+	if ((rv = biomeval_nbis_wsq_decode_mem_reduced_buf_r(&ctx, rawData,
+	    static_cast<int>(rawData.size()), &width, &height, &depth, &ppi,
+	    &lossy, (unsigned char *)this->getDataPointer(),
+	    this->getDataSize(), reduction)))
+		throw Error::DataError("Could not convert WSQ to raw.");
+
+	rawData.resize(static_cast<uint64_t>(width) * height * (depth / 8));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::WSQ::getRawGrayscaleData(
+    uint8_t depth)
+    const
+{
+	return (Image::getRawGrayscaleData(depth));
+}
+
+BiometricEvaluation::Image::Image::Attributes
+BiometricEvaluation::Image::WSQ::probe(
+    const uint8_t *data,
+    const uint64_t size)
+{
+	uint8_t *marker_buf = (uint8_t *)data;
 	uint8_t *wsq_buf = marker_buf;
 
+	Attributes attributes;
+	attributes.compressionAlgorithm = CompressionAlgorithm::WSQ20;
+
 	/* Read to the "start of image" marker */
 	uint16_t marker, tbl_size;
 	uint32_t rv = 0;
@@ -62,73 +167,28 @@ BiometricEvaluation::Image::WSQ::WSQ(
 	if ((rv = biomeval_nbis_getc_frame_header_wsq(&wsq_header, &marker_buf,
 	    wsq_buf + size)))
 		throw Error::DataError("Could not read frame header");
-	setDimensions(Size(wsq_header.width, wsq_header.height));
+	attributes.dimensions = Size(wsq_header.width, wsq_header.height);
 
 	/* Read PPI from NISTCOM, if present */
 	int ppi{-1};
-	if (biomeval_nbis_getc_ppi_wsq(&ppi, wsq_buf, size) == 0) {
-		/* Resolution does not have to be defined */
-		if (ppi == -1)
-			/* WSQ is a 500 ppi specification */
-			setResolution(Resolution(500, 500,
-			    Resolution::Units::PPI));
-		else
-			setResolution(Resolution(ppi, ppi,
-			    Resolution::Units::PPI));
-	} else {
+	if ((biomeval_nbis_getc_ppi_wsq(&ppi, wsq_buf, size) == 0) &&
+	    (ppi != -1))
+		attributes.resolution = Resolution(ppi, ppi,
+		    Resolution::Units::PPI);
+	else
 		/* WSQ is a 500 ppi specification */
-		setResolution(Resolution(500, 500, Resolution::Units::PPI));
-	}
+		attributes.resolution = Resolution(500, 500,
+		    Resolution::Units::PPI);
 
 	/*
 	 * "Source fingerprint images shall be captured with 8 bits of
 	 * precision per pixel."
 	 */
-	setColorDepth(8);
-	this->setBitDepth(8);
-
-	this->setHasAlphaChannel(false);
-}
-
-BiometricEvaluation::Image::WSQ::WSQ(
-    const BiometricEvaluation::Memory::uint8Array &data,
-    const std::string &identifier,
-    const statusCallback_t &statusCallback) :
-    BiometricEvaluation::Image::WSQ::WSQ(
-    data,
-    data.size(),
-    identifier,
-    statusCallback)
-{
+	attributes.colorDepth = 8;
+	attributes.bitDepth = 8;
+	attributes.hasAlphaChannel = false;
 
-}
-
-BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::Image::WSQ::getRawData()
-    const
-{
-	uint8_t *rawbuf = nullptr;
-	int32_t depth, height, lossy, ppi, rv, width;
-	if ((rv = biomeval_nbis_wsq_decode_mem(&rawbuf, &width, &height, &depth, &ppi,
-	    &lossy, (unsigned char *)this->getDataPointer(),
-	    this->getDataSize())))
-		throw Error::DataError("Could not convert WSQ to raw.");
-
-	/* rawbuf allocated within libwsq.  Copy to manage with AutoArray. */
-	/* TODO: AutoBuffer-wrapped AutoArray */
-	Memory::uint8Array rawData(width * height * (depth / 8));
-	rawData.copy(rawbuf);
-	free(rawbuf);
-
-	return (rawData);
-}
-
-BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::Image::WSQ::getRawGrayscaleData(
-    uint8_t depth)
-    const
-{
-	return (Image::getRawGrayscaleData(depth));
+	return (attributes);
 }
 
 bool
@@ -142,3 +202,50 @@ BiometricEvaluation::Image::WSQ::isWSQ(
 
 	return (memcmp(data, WSQ_SOI, 2) == 0);
 }
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::Image::WSQ::encode(
+    const Raw &raw,
+    const float bitRate)
+{
+	/* libwsq's encoder shares global trees and quantization tables */
+	static std::mutex encoderMutex;
+
+	if (bitRate <= 0)
+		throw Error::ParameterError("Bit rate must be positive");
+	const Size dimensions = raw.getDimensions();
+	if ((dimensions.xSize == 0) || (dimensions.ySize == 0))
+		throw Error::ParameterError("No pixels to encode");
+
+	Memory::uint8Array pixels;
+	if ((raw.getColorDepth() == 8) && (raw.getBitDepth() == 8))
+		pixels = raw.getRawData();
+	else
+		pixels = raw.getRawGrayscaleData(8);
+
+	/* NISTCOM records -1 when resolution is unknown */
+	int ppi{-1};
+	if (raw.getResolution().units != Resolution::Units::NA)
+		ppi = static_cast<int>(std::lround(raw.getResolution().toUnits(
+		    Resolution::Units::PPI).xRes));
+
+	unsigned char *wsqData = nullptr;
+	int wsqSize{0};
+	int rv;
+	{
+		std::lock_guard<std::mutex> lock(encoderMutex);
+		rv = biomeval_nbis_wsq_encode_mem(&wsqData, &wsqSize, bitRate,
+		    pixels, dimensions.xSize, dimensions.ySize, 8, ppi,
+		    nullptr);
+	}
+	if (rv != 0)
+		throw Error::StrategyError("Could not encode WSQ (" +
+		    std::to_string(rv) + ")");
+
+	/* wsqData allocated within libwsq.  Copy to manage with AutoArray. */
+	Memory::uint8Array wsq(wsqSize);
+	wsq.copy(wsqData);
+	free(wsqData);
+
+	return (wsq);
+}
@@ -14,6 +14,8 @@ const std::string BiometricEvaluation::IO::ArchiveRecordStore::
     MANIFEST_FILE_NAME{"manifest"};
 const std::string BiometricEvaluation::IO::ArchiveRecordStore::
     ARCHIVE_FILE_NAME{"archive"};
+const std::string BiometricEvaluation::IO::ArchiveRecordStore::
+    BINARY_MANIFEST_FILE_NAME{"manifest.bin"};
 
 BiometricEvaluation::IO::ArchiveRecordStore::ArchiveRecordStore(
     const std::string &pathname,
@@ -58,6 +60,18 @@ BiometricEvaluation::IO::ArchiveRecordStore::sync()
 	this->pimpl->sync();
 }
 
+void
+BiometricEvaluation::IO::ArchiveRecordStore::beginBulk()
+{
+	this->pimpl->beginBulk();
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::commitBulk()
+{
+	this->pimpl->commitBulk();
+}
+
 void
 BiometricEvaluation::IO::ArchiveRecordStore::insert( 
     const std::string &key,
@@ -82,6 +96,14 @@ BiometricEvaluation::IO::ArchiveRecordStore::read(
 	return (this->pimpl->read(key));
 }
 
+BiometricEvaluation::IO::ArchiveRecordStore::RecordView
+BiometricEvaluation::IO::ArchiveRecordStore::readView(
+    const std::string &key)
+    const
+{
+	return (this->pimpl->readView(key));
+}
+
 uint64_t
 BiometricEvaluation::IO::ArchiveRecordStore::length(
     const std::string &key)
@@ -119,6 +141,13 @@ BiometricEvaluation::IO::ArchiveRecordStore::setCursorAtKey(
 	this->pimpl->setCursorAtKey(key);
 }
 
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::ArchiveRecordStore::makeReader()
+    const
+{
+	return (this->pimpl->makeReader());
+}
+
 unsigned int
 BiometricEvaluation::IO::ArchiveRecordStore::getCount()
     const
@@ -167,6 +196,13 @@ BiometricEvaluation::IO::ArchiveRecordStore::vacuum(
 	return (IO::ArchiveRecordStore::Impl::vacuum(pathname));
 }
 
+void
+BiometricEvaluation::IO::ArchiveRecordStore::convertManifest(
+    const std::string &pathname)
+{
+	IO::ArchiveRecordStore::Impl::convertManifest(pathname);
+}
+
 std::string
 BiometricEvaluation::IO::ArchiveRecordStore::getArchiveName() const
 {
@@ -10,6 +10,11 @@
 
 #include "be_io_archiverecstore_impl.h"
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 
 #include <algorithm>
@@ -18,6 +23,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <be_error.h>
 #include <be_io_utility.h>
@@ -28,10 +35,21 @@
 
 namespace BE = BiometricEvaluation;
 
+const char BiometricEvaluation::IO::ArchiveRecordStore::Impl::
+    BINARY_MANIFEST_MAGIC[8] = {'B', 'E', 'A', 'R', 'M', 'A', 'N', '1'};
+
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::Impl(
     const std::string &pathname,
     const std::string &description) :
-    RecordStore::Impl(pathname, description, RecordStore::Kind::Archive)
+    RecordStore::Impl(pathname, description, RecordStore::Kind::Archive),
+    _binaryEntries(nullptr),
+    _binaryCount(0),
+    _binaryKeys(nullptr),
+    _manifestStart(0),
+    _manifestLength(0),
+    _binaryCursor(0),
+    _entriesAtStart(true),
+    _stagedOffset(0)
 {
 	_dirty = false;
 
@@ -45,13 +63,23 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::Impl(
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::Impl(
     const std::string &pathname,
     IO::Mode mode) :
-    RecordStore::Impl(pathname, mode)
+    RecordStore::Impl(pathname, mode),
+    _binaryEntries(nullptr),
+    _binaryCount(0),
+    _binaryKeys(nullptr),
+    _manifestStart(0),
+    _manifestLength(0),
+    _binaryCursor(0),
+    _entriesAtStart(true),
+    _stagedOffset(0)
 {
 	_dirty = false;
 
 	try {
 		this->open_streams();
 		read_manifest();
+		if (mode == Mode::ReadOnly)
+			_mapping = map_file(canonicalName(ARCHIVE_FILE_NAME));
 	} catch (const Error::ConversionError &e) {
 		throw Error::StrategyError(e.what());
 	} catch (const Error::FileError &e) {
@@ -62,6 +90,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::Impl(
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::~Impl()
 {
 	try {
+		write_staged();
 		close_streams();
 	} catch (const Error::StrategyError &) {
 		/* 
@@ -138,6 +167,53 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::open_streams()
 	_manifestfp.clear();
 }
 
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::FileMapping::
+    ~FileMapping()
+{
+#ifndef _WIN32
+	munmap(this->address, this->length);
+#endif
+}
+
+std::shared_ptr<const BiometricEvaluation::IO::ArchiveRecordStore::Impl::
+    FileMapping>
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::map_file(
+    const std::string &name)
+{
+#ifndef _WIN32
+	int fd = ::open(name.c_str(), O_RDONLY);
+	if (fd == -1)
+		throw Error::FileError("Could not open " + name +
+		    " for mapping");
+
+	struct stat sb;
+	if (fstat(fd, &sb) != 0) {
+		::close(fd);
+		throw Error::FileError("Could not stat " + name);
+	}
+	/* Zero-length mappings are invalid */
+	if (sb.st_size == 0) {
+		::close(fd);
+		return (nullptr);
+	}
+
+	void *address = mmap(nullptr, sb.st_size, PROT_READ, MAP_PRIVATE,
+	    fd, 0);
+	/* The mapping holds its own reference to the file */
+	::close(fd);
+	if (address == MAP_FAILED)
+		throw Error::FileError("Could not map " + name + ": " +
+		    Error::errorStr());
+
+	auto mapping = std::make_shared<FileMapping>();
+	mapping->address = address;
+	mapping->length = sb.st_size;
+	return (mapping);
+#else
+	return (nullptr);
+#endif
+}
+
 void
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::close_streams()
 {
@@ -179,6 +255,16 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::getSpaceUsed()
 		throw Error::StrategyError("Could not find archive file");
 	}
 
+	if (IO::Utility::fileExists(canonicalName(BINARY_MANIFEST_FILE_NAME))) {
+		try {
+			total += BE::IO::Utility::getFileSize(canonicalName(
+			    BINARY_MANIFEST_FILE_NAME));
+		} catch (const BE::Error::Exception &e) {
+			throw Error::StrategyError("Could not get size of "
+			    "binary manifest file: " + e.whatString());
+		}
+	}
+
 	return (total);
 }
 
@@ -190,6 +276,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::sync()
 		return;
 
 	RecordStore::Impl::sync();
+	this->write_staged();
 	if (_manifestfp.is_open()) {
 		_manifestfp.clear();
 		_manifestfp.sync();
@@ -210,15 +297,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::length(
     const std::string &key)
     const
 {
-	if (!validateKeyString(key))
-		throw Error::StrategyError("Invalid key format");
-	const std::shared_ptr<ManifestMap::value_type> entry =
-	    _entries.find_quick(key);
-	if ((entry.get() == nullptr) ||
-	    (entry->second.offset == OFFSET_RECORD_REMOVED))
-		throw Error::ObjectDoesNotExist(key);
-
-	return ((entry->second).size);
+	return (this->find_entry(key).size);
 }
 
 void
@@ -231,12 +310,17 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::read_manifest()
 	if (_manifestfp.is_open() == false)
 		this->open_streams();
 	_manifestfp.clear();
+
+	/* Only entries after those in the binary manifest are parsed */
+	if (!this->load_binary_manifest())
+		_manifestStart = 0;
 	
 	/* Rewind */
-	_manifestfp.seekg(0, std::ios_base::beg);
+	_manifestfp.seekg(_manifestStart, std::ios_base::beg);
 	if (!_manifestfp)
 		throw Error::FileError("Could not rewind manifest");
 		
+	_manifestLength = _manifestStart;
 	std::vector<std::string> pieces;
 	for (;;) {
 		getline(_manifestfp, linebuf);
@@ -245,6 +329,8 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::read_manifest()
 		if (!_manifestfp)
 			throw Error::FileError("Error reading entry from "
 			    "manifest.");
+		/* Unterminated last lines end at EOF, so are never counted */
+		_manifestLength = _manifestfp.tellg();
 		
 		pieces = Text::split(linebuf, ' ');
 		if (pieces.size() < 3)
@@ -272,8 +358,179 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::read_manifest()
 	}
 }
 
-BiometricEvaluation::Memory::uint8Array
-BiometricEvaluation::IO::ArchiveRecordStore::Impl::read(
+bool
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::load_binary_manifest()
+{
+	const std::string name = canonicalName(
+	    BINARY_MANIFEST_FILE_NAME);
+	if (!IO::Utility::fileExists(name))
+		return (false);
+
+	auto mapping = map_file(name);
+	if (mapping.get() == nullptr)
+		return (false);
+
+	if (mapping->length < sizeof(BinaryManifestHeader))
+		throw Error::FileError("Binary manifest is truncated");
+	const auto base = static_cast<const char *>(mapping->address);
+	BinaryManifestHeader header;
+	std::memcpy(&header, base, sizeof(header));
+	if (std::memcmp(header.magic, BINARY_MANIFEST_MAGIC,
+	    sizeof(header.magic)) != 0)
+		throw Error::FileError("Binary manifest has an unknown "
+		    "format");
+	if ((mapping->length - sizeof(header)) / sizeof(BinaryManifestEntry) <
+	    header.count)
+		throw Error::FileError("Binary manifest is truncated");
+
+	/*
+	 * The text manifest is only ever appended to, so a binary manifest
+	 * describing more than the text manifest holds is out of date.
+	 */
+	if (header.textLength > IO::Utility::getFileSize(canonicalName(
+	    MANIFEST_FILE_NAME)))
+		return (false);
+
+	/* Every key must lie within the key blob, else rebuild from text */
+	const auto entries = reinterpret_cast<const BinaryManifestEntry *>(
+	    base + sizeof(header));
+	const uint64_t keysLength = mapping->length - sizeof(header) -
+	    (header.count * sizeof(BinaryManifestEntry));
+	for (uint64_t i = 0; i < header.count; i++)
+		if ((entries[i].keyOffset > keysLength) ||
+		    (entries[i].keyLength > keysLength - entries[i].keyOffset))
+			return (false);
+
+	_binaryManifest = mapping;
+	_binaryEntries = entries;
+	_binaryCount = header.count;
+	_binaryKeys = reinterpret_cast<const char *>(_binaryEntries +
+	    _binaryCount);
+	_manifestStart = header.textLength;
+	if (header.dirty != 0)
+		_dirty = true;
+
+	return (true);
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::write_binary_manifest()
+    const
+{
+	/* Merge the binary manifest with entries appended since */
+	std::vector<std::pair<std::string, ManifestEntry>> live;
+	live.reserve(_binaryCount + _entries.size());
+	for (uint64_t i = 0; i < _binaryCount; i++) {
+		std::string key = this->binary_key(i);
+		if (!_entries.keyExists(key))
+			live.emplace_back(key, ManifestEntry{
+			    (long)_binaryEntries[i].offset,
+			    _binaryEntries[i].size});
+	}
+	for (const auto &entry : _entries)
+		if (entry.second.offset != OFFSET_RECORD_REMOVED)
+			live.push_back(entry);
+	std::sort(live.begin(), live.end(),
+	    [](const std::pair<std::string, ManifestEntry> &lhs,
+	    const std::pair<std::string, ManifestEntry> &rhs) {
+		return (lhs.first < rhs.first);
+	});
+
+	BinaryManifestHeader header;
+	std::memcpy(header.magic, BINARY_MANIFEST_MAGIC,
+	    sizeof(header.magic));
+	header.textLength = _manifestLength;
+	header.count = live.size();
+	header.dirty = (_dirty ? 1 : 0);
+
+	/* Write beside the final name so the rename is atomic */
+	const std::string tempName = IO::Utility::createTemporaryFile(
+	    "", this->getPathname());
+	std::ofstream out(tempName, std::ios_base::binary |
+	    std::ios_base::trunc);
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	uint64_t keyOffset = 0;
+	for (const auto &entry : live) {
+		const BinaryManifestEntry binaryEntry{keyOffset,
+		    entry.first.length(), entry.second.offset,
+		    entry.second.size};
+		out.write(reinterpret_cast<const char *>(&binaryEntry),
+		    sizeof(binaryEntry));
+		keyOffset += entry.first.length();
+	}
+	for (const auto &entry : live)
+		out.write(entry.first.data(), entry.first.length());
+	out.close();
+	if (!out) {
+		std::remove(tempName.c_str());
+		throw Error::StrategyError("Could not write binary manifest");
+	}
+
+	if (std::rename(tempName.c_str(), canonicalName(
+	    BINARY_MANIFEST_FILE_NAME).c_str()) != 0) {
+		std::remove(tempName.c_str());
+		throw Error::StrategyError("Could not rename binary "
+		    "manifest: " + Error::errorStr());
+	}
+}
+
+std::string
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::binary_key(
+    uint64_t index)
+    const
+{
+	return (std::string(_binaryKeys + _binaryEntries[index].keyOffset,
+	    _binaryEntries[index].keyLength));
+}
+
+bool
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::find_binary(
+    const std::string &key,
+    uint64_t &index)
+    const
+{
+	uint64_t low = 0, high = _binaryCount;
+	while (low < high) {
+		const uint64_t mid = low + ((high - low) / 2);
+		const int cmp = key.compare(0, std::string::npos, _binaryKeys +
+		    _binaryEntries[mid].keyOffset,
+		    _binaryEntries[mid].keyLength);
+		if (cmp == 0) {
+			index = mid;
+			return (true);
+		}
+		if (cmp < 0)
+			high = mid;
+		else
+			low = mid + 1;
+	}
+	return (false);
+}
+
+bool
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::lookup(
+    const std::string &key,
+    ManifestEntry &entry)
+    const
+{
+	/* Entries in the text manifest are newer */
+	const std::shared_ptr<ManifestMap::value_type> textEntry =
+	    _entries.find_quick(key);
+	if (textEntry.get() != nullptr) {
+		entry = textEntry->second;
+		return (true);
+	}
+
+	uint64_t index;
+	if (!this->find_binary(key, index))
+		return (false);
+	entry.offset = (long)_binaryEntries[index].offset;
+	entry.size = _binaryEntries[index].size;
+	return (true);
+}
+
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::ManifestEntry
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::find_entry(
     const std::string &key)
     const
 {
@@ -281,15 +538,34 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::read(
 		throw Error::StrategyError("Invalid key format");
 
 	/* Check for existance */
-	std::shared_ptr<ManifestMap::value_type> entry =
-	    _entries.find_quick(key);
-	if (entry.get() == nullptr)
+	ManifestEntry entry;
+	if (!this->lookup(key, entry))
 		throw Error::ObjectDoesNotExist(key);
 	
 	/* Check for "removal" */
-	if (entry->second.offset == OFFSET_RECORD_REMOVED)
+	if (entry.offset == OFFSET_RECORD_REMOVED)
 		throw Error::ObjectDoesNotExist(key + " was removed");
 
+	/* Mapped records must lie within the mapping */
+	if ((_mapping.get() != nullptr) &&
+	    ((entry.offset + entry.size) > _mapping->length))
+		throw Error::StrategyError("Manifest entry for " + key +
+		    " extends beyond the archive");
+
+	return (entry);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::read(
+    const std::string &key)
+    const
+{
+	const ManifestEntry entry = this->find_entry(key);
+
+	Memory::uint8Array data(entry.size);
+	if (this->read_memory(entry, data))
+		return (data);
+
 	if (_archivefp.is_open() == false) {
 		try {
 			this->open_streams();
@@ -297,17 +573,71 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::read(
 			throw Error::StrategyError(e.what());
 		}
 	}
-	_archivefp.clear();
-	_archivefp.seekg(entry->second.offset, std::ios_base::beg);
-	if (!_archivefp)
+	read_stream(_archivefp, entry, data);
+
+	return (data);
+}
+
+bool
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::read_memory(
+    const ManifestEntry &entry,
+    Memory::uint8Array &data)
+    const
+{
+	if (_mapping.get() != nullptr) {
+		/* No stream position to share, so no seek */
+		std::memcpy(data, static_cast<const uint8_t *>(
+		    _mapping->address) + entry.offset, entry.size);
+		return (true);
+	}
+	if (!_stagedData.empty() &&
+	    (static_cast<uint64_t>(entry.offset) >= _stagedOffset)) {
+		/* Inserted during a bulk update and not yet written */
+		std::memcpy(data, _stagedData.data() +
+		    (entry.offset - _stagedOffset), entry.size);
+		return (true);
+	}
+
+	return (false);
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::read_stream(
+    std::istream &stream,
+    const ManifestEntry &entry,
+    Memory::uint8Array &data)
+{
+	stream.clear();
+	stream.seekg(entry.offset, std::ios_base::beg);
+	if (!stream)
 		throw Error::StrategyError("Archive cannot seek");
 
-	Memory::uint8Array data(entry->second.size);
-	_archivefp.read((char *)&data[0], entry->second.size);
-	if (!_archivefp)
+	stream.read((char *)&data[0], entry.size);
+	if (!stream)
 		throw Error::StrategyError("Archive cannot read");
+}
 
-	return (data);
+BiometricEvaluation::IO::ArchiveRecordStore::RecordView
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::readView(
+    const std::string &key)
+    const
+{
+	RecordView view;
+	if (_mapping.get() != nullptr) {
+		const ManifestEntry entry = this->find_entry(key);
+		view.data = static_cast<const uint8_t *>(_mapping->address) +
+		    entry.offset;
+		view.size = entry.size;
+		view.owner = _mapping;
+	} else {
+		auto data = std::make_shared<Memory::uint8Array>(
+		    this->read(key));
+		view.data = *data;
+		view.size = data->size();
+		view.owner = data;
+	}
+
+	return (view);
 }
 
 void
@@ -335,12 +665,31 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::insert(
 		}
 	}
 	_archivefp.clear();
-	offset = _archivefp.tellp();
-	if (!_archivefp)
-		throw Error::StrategyError("Could not get archive position");
-	_archivefp.write(static_cast<const char *>(data), size);
-	if (!_archivefp)
-		throw Error::StrategyError("Could not write to archive file");
+	if (this->inBulk()) {
+		/* Stage the data, to be written in one piece */
+		if (_stagedData.empty()) {
+			_archivefp.seekp(0, std::ios_base::end);
+			_stagedOffset = _archivefp.tellp();
+			if (!_archivefp)
+				throw Error::StrategyError("Could not get "
+				    "archive position");
+		}
+		offset = _stagedOffset + _stagedData.size();
+		_stagedData.insert(_stagedData.end(),
+		    static_cast<const uint8_t *>(data),
+		    static_cast<const uint8_t *>(data) + size);
+	} else {
+		/* Reads share the stream position, so seek to the end */
+		_archivefp.seekp(0, std::ios_base::end);
+		offset = _archivefp.tellp();
+		if (!_archivefp)
+			throw Error::StrategyError("Could not get archive "
+			    "position");
+		_archivefp.write(static_cast<const char *>(data), size);
+		if (!_archivefp)
+			throw Error::StrategyError("Could not write to "
+			    "archive file");
+	}
 
 	/* Write to manifest */
 	ManifestEntry entry;
@@ -352,6 +701,46 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::insert(
 	} catch (const Error::StrategyError &) {
 		throw;	
 	}
+
+	if (_stagedData.size() >= BULK_STAGING_SIZE)
+		this->write_staged();
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::commitBulk()
+{
+	if (!this->inBulk())
+		throw Error::StrategyError("No bulk update in progress");
+
+	this->write_staged();
+	RecordStore::Impl::commitBulk();
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::write_staged()
+    const
+{
+	if (!_stagedData.empty()) {
+		_archivefp.clear();
+		_archivefp.seekp(0, std::ios_base::end);
+		_archivefp.write(reinterpret_cast<const char *>(
+		    _stagedData.data()), _stagedData.size());
+		if (!_archivefp)
+			throw Error::StrategyError("Could not write to "
+			    "archive file");
+		_stagedData.clear();
+	}
+
+	/* Manifest entries follow the data they describe */
+	if (!_stagedManifest.empty()) {
+		_manifestfp.clear();
+		_manifestfp.write(_stagedManifest.data(),
+		    _stagedManifest.size());
+		if (!_manifestfp)
+			throw Error::StrategyError("Couldn't write manifest "
+			    "entries");
+		_stagedManifest.clear();
+	}
 }
 
 void
@@ -366,11 +755,17 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::write_manifest_entry(
 			throw Error::StrategyError(e.what());
 		}
 	}
-	_manifestfp.clear();
-	_manifestfp << key << " " << entry.size << " " << entry.offset << '\n';
-	if (!_manifestfp)
-		throw Error::StrategyError("Couldn't write manifest entry "
-		    "for " + key);
+	if (this->inBulk()) {
+		_stagedManifest += key + " " + std::to_string(entry.size) +
+		    " " + std::to_string(entry.offset) + '\n';
+	} else {
+		_manifestfp.clear();
+		_manifestfp << key << " " << entry.size << " " <<
+		    entry.offset << '\n';
+		if (!_manifestfp)
+			throw Error::StrategyError("Couldn't write manifest "
+			    "entry for " + key);
+	}
 
 	efficient_insert(_entries, key, entry);
 }
@@ -388,15 +783,11 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::remove(
 		throw Error::ObjectDoesNotExist(key);
 
 	/* At this point, the key is known to exist */
-	std::shared_ptr<ManifestMap::value_type> entry =
-	    _entries.find_quick(key);
-	if (entry.get() == nullptr)
-		throw Error::ObjectDoesNotExist(key);
-	entry->second.offset = OFFSET_RECORD_REMOVED;
-	_entries[key] = entry->second;
+	ManifestEntry entry = this->find_entry(key);
+	entry.offset = OFFSET_RECORD_REMOVED;
 	    
 	try {
-		write_manifest_entry(key, entry->second);
+		write_manifest_entry(key, entry);
 		RecordStore::Impl::remove(key);
 		_dirty = true;
 	} catch (const Error::StrategyError &) {
@@ -415,12 +806,10 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::flush(
 		throw Error::StrategyError("Invalid key format");
 
 	/* Fulfill the RecordStore contract */
-	ManifestMap::const_iterator lb = _entries.find(key);
-	if (lb == _entries.end() ||
-	    (lb->second).offset == OFFSET_RECORD_REMOVED)
-		throw Error::ObjectDoesNotExist(key);
+	(void)this->find_entry(key);
 
 	/* Flush the streams, not necessarily for the key passed */
+	this->write_staged();
 	if (_manifestfp.is_open()) {
 		_manifestfp.clear();
 		_manifestfp.flush();
@@ -446,7 +835,7 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::i_sequence(
 	    	throw Error::StrategyError("Invalid cursor position as "
 		    "argument");
 
-	if (_entries.begin() == _entries.end())
+	if ((_binaryCount == 0) && (_entries.begin() == _entries.end()))
 		throw Error::ObjectDoesNotExist("Empty RecordStore");
 
 	/* If the current cursor position is START, then it doesn't matter
@@ -454,6 +843,28 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::i_sequence(
 	 */
 	if ((getCursor() == BE_RECSTORE_SEQ_START) ||
 	    (cursor == BE_RECSTORE_SEQ_START)) {
+		_binaryCursor = 0;
+		_entriesAtStart = true;
+	}
+
+	/* Binary manifest entries not superseded by the text manifest */
+	while (_binaryCursor < _binaryCount) {
+		std::string key = this->binary_key(_binaryCursor++);
+		if (_entries.keyExists(key))
+			continue;
+
+		setCursor(BE_RECSTORE_SEQ_NEXT);
+		BE::IO::RecordStore::Record record;
+		record.key = std::move(key);
+		if (returnData)
+			record.data = this->read(record.key);
+		return (record);
+	}
+
+	if (_entries.begin() == _entries.end())
+		throw Error::ObjectDoesNotExist("No record at position");
+	if (_entriesAtStart) {
+		_entriesAtStart = false;
 		_cursorPos = _entries.begin();
 		/* If client hasn't vacuumed, begin() might not be first item */
 		while (_cursorPos->second.offset == OFFSET_RECORD_REMOVED) {
@@ -508,26 +919,179 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::setCursorAtKey(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
-	/* Check for existance */
-	ManifestMap::iterator lb = _entries.find(key);
-	if (lb == _entries.end())
-		throw Error::ObjectDoesNotExist(key);
+	/* Check for existance and "removal" */
+	(void)this->find_entry(key);
 
-	/* Check for "removal" */
-	ManifestEntry entry = lb->second;
-	if (entry.offset == OFFSET_RECORD_REMOVED)
-		throw Error::ObjectDoesNotExist(key + " was removed");
+	ManifestMap::iterator lb = _entries.find(key);
+	if (lb == _entries.end()) {
+		/* Sequence from the key's place in the binary manifest */
+		this->find_binary(key, _binaryCursor);
+		_entriesAtStart = true;
+	} else {
+		/*
+		 * If the key we sequence to is the first key in _entries,
+		 * sequence() must start from begin() instead of advancing
+		 * before reading.
+		 */
+		_binaryCursor = _binaryCount;
+		if (lb == _entries.begin())
+			_entriesAtStart = true;
+		else {
+			_entriesAtStart = false;
+			this->_cursorPos = --lb;
+		}
+	}
+	this->setCursor(BE_RECSTORE_SEQ_NEXT);
+}
 
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::makeReader()
+    const
+{
 	/*
-	 * If the key we sequence to is the first key in _entries, we need
-	 * to set the special cursor value to start so that we don't advance
-	 * before reading in sequence().
+	 * The Cursor's stream must see everything written so far. Readers
+	 * may be made from several threads at once, each flushing.
 	 */
-	if (lb == _entries.begin()) {
-		this->_cursorPos = lb;
-		this->setCursor(BE_RECSTORE_SEQ_START);
-	} else
-		this->_cursorPos = --lb;
+	if (getMode() == Mode::ReadWrite) {
+		std::lock_guard<std::mutex> lock(this->_flushMutex);
+		if (_archivefp.is_open()) {
+			_archivefp.clear();
+			_archivefp.flush();
+			if (!_archivefp)
+				throw Error::StrategyError("Could not flush "
+				    "archive");
+		}
+	}
+
+	return (std::unique_ptr<RecordStore::Cursor>(new Cursor(*this)));
+}
+
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::Cursor::Cursor(
+    const ArchiveRecordStore::Impl &store) :
+    _store(store)
+{
+
+}
+
+std::string
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::Cursor::nextKey(
+    int cursor)
+{
+	if ((cursor != BE_RECSTORE_SEQ_START) &&
+	    (cursor != BE_RECSTORE_SEQ_NEXT))
+	    	throw Error::StrategyError("Invalid cursor position as "
+		    "argument");
+
+	const ManifestMap &entries = _store._entries;
+	if ((_store._binaryCount == 0) && (entries.begin() == entries.end()))
+		throw Error::ObjectDoesNotExist("Empty RecordStore");
+
+	if (_atStart || (cursor == BE_RECSTORE_SEQ_START)) {
+		_atStart = false;
+		_binaryCursor = 0;
+		_entriesAtStart = true;
+	}
+
+	/* Binary manifest entries not superseded by the text manifest */
+	while (_binaryCursor < _store._binaryCount) {
+		std::string key = _store.binary_key(_binaryCursor++);
+		if (!entries.keyExists(key))
+			return (key);
+	}
+
+	if (entries.begin() == entries.end())
+		throw Error::ObjectDoesNotExist("No record at position");
+	if (_entriesAtStart) {
+		_entriesAtStart = false;
+		_cursorPos = entries.begin();
+	} else {
+		if (_cursorPos == entries.end())
+			throw Error::ObjectDoesNotExist("No record at "
+			    "position");
+		_cursorPos++;
+	}
+
+	/* Skip entries of records that have been removed */
+	while ((_cursorPos != entries.end()) &&
+	    (_cursorPos->second.offset == OFFSET_RECORD_REMOVED))
+		_cursorPos++;
+	if (_cursorPos == entries.end())
+		throw Error::ObjectDoesNotExist("No record at position");
+
+	return (_cursorPos->first);
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::Cursor::sequence(
+    int cursor)
+{
+	RecordStore::Record record;
+	record.key = this->nextKey(cursor);
+	record.data = this->read(record.key);
+	return (record);
+}
+
+std::string
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::Cursor::sequenceKey(
+    int cursor)
+{
+	return (this->nextKey(cursor));
+}
+
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::Cursor::setCursorAtKey(
+    const std::string &key)
+{
+	/* Check for existance and "removal" */
+	(void)_store.find_entry(key);
+
+	const ManifestMap &entries = _store._entries;
+	if (!entries.keyExists(key)) {
+		/* Sequence from the key's place in the binary manifest */
+		_store.find_binary(key, _binaryCursor);
+		_entriesAtStart = true;
+	} else {
+		_binaryCursor = _store._binaryCount;
+		ManifestMap::const_iterator lb = entries.find(key);
+		if (lb == entries.begin())
+			_entriesAtStart = true;
+		else {
+			_entriesAtStart = false;
+			_cursorPos = --lb;
+		}
+	}
+	_atStart = false;
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::Cursor::read(
+    const std::string &key)
+    const
+{
+	const ManifestEntry entry = _store.find_entry(key);
+
+	Memory::uint8Array data(entry.size);
+	if (_store.read_memory(entry, data))
+		return (data);
+
+	if (!_archive.is_open()) {
+		_archive.open(_store.getArchiveName(),
+		    std::ios_base::in | std::ios_base::binary);
+		if (!_archive)
+			throw Error::StrategyError("Could not open " +
+			    _store.getArchiveName());
+	}
+	read_stream(_archive, entry, data);
+
+	return (data);
+}
+
+uint64_t
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::Cursor::length(
+    const std::string &key)
+    const
+{
+	return (_store.find_entry(key).size);
 }
 
 void
@@ -583,10 +1147,19 @@ BiometricEvaluation::IO::ArchiveRecordStore::Impl::move(
 	if (this->getMode() == Mode::ReadOnly)
 		throw Error::StrategyError("RecordStore was opened read-only");
 	
+	this->write_staged();
 	this->close_streams();
 	RecordStore::Impl::move(pathname);
 }
 
+void
+BiometricEvaluation::IO::ArchiveRecordStore::Impl::convertManifest(
+    const std::string &pathname)
+{
+	ArchiveRecordStore::Impl rs{pathname, Mode::ReadOnly};
+	rs.write_binary_manifest();
+}
+
 bool
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::needsVacuum()
 {
@@ -608,17 +1181,9 @@ bool
 BiometricEvaluation::IO::ArchiveRecordStore::Impl::keyExists(
     const ManifestMap::key_type &k)
 {
-	/* O(1) */
-	if (!_dirty)
-		return (_entries.keyExists(k));
-	if (_entries.keyExists(k) == false)
-		return (false);
-	
-	/* Check if key was removed -- O(1) */
-	std::shared_ptr<ManifestMap::value_type> entry =
-	    _entries.find_quick(k);
-	return ((entry.get() != nullptr) &&
-	    (entry->second.offset != OFFSET_RECORD_REMOVED));
+	ManifestEntry entry;
+	return (this->lookup(k, entry) &&
+	    (entry.offset != OFFSET_RECORD_REMOVED));
 }
 
 std::string
@@ -13,7 +13,10 @@
 
 #include <exception>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <be_io_archiverecstore.h>
 #include "be_io_recordstore_impl.h"
@@ -81,12 +84,26 @@ namespace BiometricEvaluation {
 			void remove(
 			    const std::string &key);
 
+			/**
+			 * @brief
+			 * Complete a bulk update, writing the staged
+			 * records and manifest entries.
+			 *
+			 * @throw Error::StrategyError
+			 *	No bulk update in progress, or problem with
+			 *	storage system.
+			 */
+			void commitBulk();
+
 			Memory::uint8Array read(
 			    const std::string &key) const;
 
 			uint64_t length(
 			    const std::string &key) const;
 
+			ArchiveRecordStore::RecordView readView(
+			    const std::string &key) const;
+
 			void flush(
 			    const std::string &key) const;
 
@@ -100,6 +117,21 @@ namespace BiometricEvaluation {
 			void setCursorAtKey(
 			    const std::string &key);
 
+			/**
+			 * @brief
+			 * A RecordStore::Cursor with its own manifest
+			 * position and archive file stream.
+			 * @details
+			 * The manifest is shared with the store and only
+			 * read.  When the archive is mapped, no stream is
+			 * opened.
+			 */
+			class Cursor;
+
+			/** See RecordStore::makeReader() */
+			std::unique_ptr<RecordStore::Cursor> makeReader()
+			    const;
+
 			void move(
 			    const std::string &pathname);
 	
@@ -149,6 +181,21 @@ namespace BiometricEvaluation {
 			 */
 			static void vacuum(
 			    const std::string &pathname);
+
+			/**
+			 * Write the binary manifest for an existing store
+			 * from its text manifest.
+			 *
+			 * @param[in] pathname
+			 *	The pathname of the existing RecordStore.
+			 * @throw Error::ObjectDoesNotExist
+			 *	The store does not exist.
+			 * @throw Error::StrategyError
+			 *	An error occurred when using the underlying
+			 *	storage system.
+			 */
+			static void convertManifest(
+			    const std::string &pathname);
 	
 			/**
 			 * Obtain the name of the file storing the data for 
@@ -193,28 +240,144 @@ namespace BiometricEvaluation {
 			using ManifestMap =
 			    Memory::OrderedMap<std::string, ManifestEntry>;
 
+			/** Read-only memory mapping of a file */
+			struct FileMapping
+			{
+				/** Start of the mapping */
+				void *address;
+				/** Length of the mapping */
+				size_t length;
+
+				~FileMapping();
+			};
+
+			/** Start of the binary manifest file */
+			struct BinaryManifestHeader
+			{
+				/** Identifies the file and its version */
+				char magic[8];
+				/**
+				 * Length of the prefix of the text manifest
+				 * that this file summarizes.
+				 */
+				uint64_t textLength;
+				/** Number of entries in the key table */
+				uint64_t count;
+				/** Nonzero if the store needs vacuum() */
+				uint64_t dirty;
+			};
+
+			/**
+			 * Entry in the binary manifest's key table, which
+			 * follows the header and is sorted by key.  Keys are
+			 * stored in a pool following the table.
+			 */
+			struct BinaryManifestEntry
+			{
+				/** Offset of the key within the key pool */
+				uint64_t keyOffset;
+				/** Length of the key */
+				uint64_t keyLength;
+				/** Offset of the record within the archive */
+				int64_t offset;
+				/** Size of the record */
+				uint64_t size;
+			};
+
+			/** Identifies version 1 of the binary manifest */
+			static const char BINARY_MANIFEST_MAGIC[8];
+
+			/**
+			 * Amount of record data staged during a bulk update
+			 * before it is written to the archive.
+			 */
+			static const uint64_t BULK_STAGING_SIZE = 4 * 1024 * 1024;
+
 			/** Manifest file handle */
 			mutable std::fstream _manifestfp;
 			/** Archive file handle */
 			mutable std::fstream _archivefp;
+			/** Serializes flushes of _archivefp by makeReader() */
+			mutable std::mutex _flushMutex;
+
+			/**
+			 * Mapping of the archive, present only in read-only
+			 * mode when mapping is supported.  Shared with any
+			 * outstanding RecordViews.
+			 */
+			std::shared_ptr<const FileMapping> _mapping;
+
+			/** Mapping of the binary manifest, if present */
+			std::shared_ptr<const FileMapping> _binaryManifest;
+			/** Sorted key table within _binaryManifest */
+			const BinaryManifestEntry *_binaryEntries;
+			/** Number of entries in _binaryEntries */
+			uint64_t _binaryCount;
+			/** Key pool within _binaryManifest */
+			const char *_binaryKeys;
+
+			/** Text manifest offset where parsing starts */
+			uint64_t _manifestStart;
+			/** Text manifest length consumed by parsing */
+			uint64_t _manifestLength;
 	
 			/*
 			 * Offsets and sizes of data chunks within the archive.
+			 * When a binary manifest is present, only holds the
+			 * entries appended to the text manifest since the
+			 * binary manifest was written, which take precedence.
 			 */
 			ManifestMap _entries;
 	
 			/** Position of iterator (for sequence()) */
 			ManifestMap::const_iterator _cursorPos;
+			/**
+			 * Next binary manifest entry to consider in
+			 * sequence(), which visits the binary manifest
+			 * before _entries.
+			 */
+			uint64_t _binaryCursor;
+			/** Whether sequence() is to start at _entries.begin() */
+			bool _entriesAtStart;
 
 			/**
 			 * Whether or not the ArchiveRecordStore contains a 
 			 * deleted entry and would benefit from vacuum().
 			 */
 			bool _dirty;
+
+			/**
+			 * Record data inserted during a bulk update and not
+			 * yet written to the archive.
+			 */
+			mutable std::vector<uint8_t> _stagedData;
+			/** Archive offset at which _stagedData will be written */
+			mutable uint64_t _stagedOffset;
+			/**
+			 * Manifest lines written during a bulk update and not
+			 * yet written to the manifest.
+			 */
+			mutable std::string _stagedManifest;
+
+			/**
+			 * @brief
+			 * Write the data and manifest lines staged during a
+			 * bulk update.
+			 *
+			 * @throw Error::StrategyError
+			 *	Problem with storage system
+			 */
+			void
+			write_staged()
+			    const;
 			
 			/**
 			 * @brief
 			 * Read the manifest.
+			 * @details
+			 * Uses the binary manifest, when present, for all
+			 * entries it covers, then parses the remainder of
+			 * the text manifest.
 			 *
 			 * @throw Error::ConversionError
 			 *	Size or offset in manifest couldn't be parsed.
@@ -249,6 +412,156 @@ namespace BiometricEvaluation {
 			void
 			open_streams() const;
 	
+			/**
+			 * @brief
+			 * Map a file into memory, read-only.
+			 *
+			 * @param[in] name
+			 *	Path to the file.
+			 * @return
+			 *	The mapping, or nullptr when the file is
+			 *	empty or the platform does not support mapping.
+			 *
+			 * @throw Error::FileError
+			 *	Unable to map the file.
+			 */
+			static std::shared_ptr<const FileMapping>
+			map_file(
+			    const std::string &name);
+
+			/**
+			 * @brief
+			 * Map the binary manifest, if one is present and
+			 * describes the current text manifest.
+			 *
+			 * @return
+			 *	true if the binary manifest was loaded.
+			 *
+			 * @throw Error::FileError
+			 *	The binary manifest is malformed.
+			 */
+			bool
+			load_binary_manifest();
+
+			/**
+			 * @brief
+			 * Write the binary manifest from the current
+			 * entries.
+			 *
+			 * @throw Error::StrategyError
+			 *	Unable to write the binary manifest.
+			 */
+			void
+			write_binary_manifest()
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain a key from the binary manifest.
+			 *
+			 * @param[in] index
+			 *	Index within the key table.
+			 * @return
+			 *	The key.
+			 */
+			std::string
+			binary_key(
+			    uint64_t index)
+			    const;
+
+			/**
+			 * @brief
+			 * Search the binary manifest for a key.
+			 *
+			 * @param[in] key
+			 *	The key to look for.
+			 * @param[out] index
+			 *	Index of key within the key table, if found.
+			 * @return
+			 *	true if key is in the binary manifest.
+			 */
+			bool
+			find_binary(
+			    const std::string &key,
+			    uint64_t &index)
+			    const;
+
+			/**
+			 * @brief
+			 * Find the latest manifest entry for a key.
+			 *
+			 * @param[in] key
+			 *	The key to look for.
+			 * @param[out] entry
+			 *	The entry for key, if found.  May be marked
+			 *	as removed.
+			 * @return
+			 *	true if key has an entry.
+			 */
+			bool
+			lookup(
+			    const std::string &key,
+			    ManifestEntry &entry)
+			    const;
+
+			/**
+			 * @brief
+			 * Find the live manifest entry for a key.
+			 *
+			 * @param[in] key
+			 *	The key to look for.
+			 * @return
+			 *	The manifest entry for key.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	key does not exist or was removed.
+			 * @throw Error::StrategyError
+			 *	key is invalid.
+			 */
+			ManifestEntry
+			find_entry(
+			    const std::string &key)
+			    const;
+
+			/**
+			 * @brief
+			 * Copy a record that is held in memory, either
+			 * mapped or staged during a bulk update.
+			 *
+			 * @param[in] entry
+			 *	Manifest entry for the record.
+			 * @param[out] data
+			 *	Buffer of entry.size bytes.
+			 * @return
+			 *	true if the record was copied, false if it
+			 *	must be read from the archive file.
+			 */
+			bool
+			read_memory(
+			    const ManifestEntry &entry,
+			    Memory::uint8Array &data)
+			    const;
+
+			/**
+			 * @brief
+			 * Read a record from an archive file stream.
+			 *
+			 * @param[in] stream
+			 *	Open stream of the archive file.
+			 * @param[in] entry
+			 *	Manifest entry for the record.
+			 * @param[out] data
+			 *	Buffer of entry.size bytes.
+			 *
+			 * @throw Error::StrategyError
+			 *	Could not seek or read.
+			 */
+			static void
+			read_stream(
+			    std::istream &stream,
+			    const ManifestEntry &entry,
+			    Memory::uint8Array &data);
+
 			/**
 			 * @brief
 			 * Close the manifest and archive file streams
@@ -313,6 +626,64 @@ namespace BiometricEvaluation {
 			    bool returnData,
 			    int cursor); 
 		};
+
+		class ArchiveRecordStore::Impl::Cursor :
+		    public RecordStore::Cursor
+		{
+		public:
+			/**
+			 * @param[in] store
+			 *	Store to read.
+			 */
+			Cursor(
+			    const ArchiveRecordStore::Impl &store);
+
+			RecordStore::Record
+			sequence(
+			    int cursor = BE_RECSTORE_SEQ_NEXT)
+			    override;
+
+			std::string
+			sequenceKey(
+			    int cursor = BE_RECSTORE_SEQ_NEXT)
+			    override;
+
+			void
+			setCursorAtKey(
+			    const std::string &key)
+			    override;
+
+			Memory::uint8Array
+			read(
+			    const std::string &key)
+			    const
+			    override;
+
+			uint64_t
+			length(
+			    const std::string &key)
+			    const
+			    override;
+
+		private:
+			/** Store being read */
+			const ArchiveRecordStore::Impl &_store;
+			/** Archive file, opened on first unmapped read */
+			mutable std::ifstream _archive;
+			/** Whether sequencing is to start at the first record */
+			bool _atStart{true};
+			/** See ArchiveRecordStore::Impl::_binaryCursor */
+			uint64_t _binaryCursor{0};
+			/** See ArchiveRecordStore::Impl::_entriesAtStart */
+			bool _entriesAtStart{true};
+			/** See ArchiveRecordStore::Impl::_cursorPos */
+			ManifestMap::const_iterator _cursorPos{};
+
+			/** See ArchiveRecordStore::Impl::i_sequence() */
+			std::string
+			nextKey(
+			    int cursor);
+		};
 	}
 }
 
@@ -74,6 +74,18 @@ BiometricEvaluation::IO::CompressedRecordStore::sync()
 	this->pimpl->sync();
 }
 
+void
+BiometricEvaluation::IO::CompressedRecordStore::beginBulk()
+{
+	this->pimpl->beginBulk();
+}
+
+void
+BiometricEvaluation::IO::CompressedRecordStore::commitBulk()
+{
+	this->pimpl->commitBulk();
+}
+
 void
 BiometricEvaluation::IO::CompressedRecordStore::insert( 
     const std::string &key,
@@ -135,6 +147,13 @@ BiometricEvaluation::IO::CompressedRecordStore::setCursorAtKey(
 	this->pimpl->setCursorAtKey(key);
 }
 
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::CompressedRecordStore::makeReader()
+    const
+{
+	return (this->pimpl->makeReader());
+}
+
 unsigned int
 BiometricEvaluation::IO::CompressedRecordStore::getCount()
     const
@@ -163,3 +182,17 @@ BiometricEvaluation::IO::CompressedRecordStore::changeDescription(
 	return (this->pimpl->changeDescription(description));
 }
 
+void
+BiometricEvaluation::IO::CompressedRecordStore::trainDictionary(
+    uint64_t sampleCount,
+    uint64_t maxDictionarySize)
+{
+	this->pimpl->trainDictionary(sampleCount, maxDictionarySize);
+}
+
+bool
+BiometricEvaluation::IO::CompressedRecordStore::hasDictionary()
+    const
+{
+	return (this->pimpl->hasDictionary());
+}
@@ -15,6 +15,7 @@
 #include "be_io_compressedrecstore_impl.h"
 #include <be_memory_autoarrayutility.h>
 #include <be_io_properties.h>
+#include <be_text.h>
 
 namespace BE = BiometricEvaluation;
 
@@ -23,6 +24,19 @@ using namespace BE::Framework::Enumeration;
 const std::string BACKING_STORE{"theBackingStore"};
 const std::string COMPRESSOR_TYPE_KEY{"Compressor_Type"};
 const std::string METADATA_SUFFIX{"_md"};
+const std::string DICTIONARY_KEY{"Compressor_Dictionary"};
+const std::string DICTIONARY_SAMPLES_KEY{"Compressor_Dictionary_Samples"};
+const std::string DICTIONARY_SIZE_KEY{"Compressor_Dictionary_Size"};
+
+/* Decompressed length of a record, from its metadata record */
+static uint64_t
+decompressedLength(
+    const BE::Memory::uint8Array &metadata)
+{
+	return (static_cast<uint64_t>(atoll(
+	    BE::Memory::AutoArrayUtility::getString(metadata,
+	    metadata.size()).c_str())));
+}
 
 BiometricEvaluation::IO::CompressedRecordStore::Impl::Impl(
     const std::string &pathname,
@@ -99,6 +113,7 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::Impl(
 		throw Error::StrategyError(compressorType + " is not a valid "
 		    "compressor type: " + e.whatString());
 	}
+	this->loadDictionary();
 }
 
 BiometricEvaluation::IO::CompressedRecordStore::Impl::~Impl()
@@ -126,6 +141,9 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::insert(
 	_mdrs->insert(key, sizeBuf);
 	
 	RecordStore::Impl::insert(key, data, size);
+
+	if (this->_dictionarySamplesNeeded != 0)
+		this->addDictionarySample(data, size);
 }
 
 uint64_t
@@ -133,9 +151,7 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::length(
     const std::string &key)
     const
 {
-	Memory::uint8Array buf = _mdrs->read(key);
-	return (static_cast<uint64_t>(atoll(
-	    Memory::AutoArrayUtility::getString(buf, buf.size()).c_str())));
+	return (decompressedLength(_mdrs->read(key)));
 }
 
 BiometricEvaluation::Memory::uint8Array
@@ -144,10 +160,10 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::read(
     const
 {
 	Memory::uint8Array compressedData = _rs->read(key);
-	
-	Memory::uint8Array decompressedData = _compressor->decompress(
-	    compressedData);
-	return (decompressedData);
+
+	/* Decompressed size is known, so decompress in a single pass */
+	return (_compressor->decompress(compressedData, compressedData.size(),
+	    this->length(key)));
 }
 
 BiometricEvaluation::IO::RecordStore::Record
@@ -220,6 +236,117 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::move(
 	_rs = RecordStore::Impl::openRecordStore(rsPath, IO::Mode::ReadWrite);
 	rsPath = rsPath + METADATA_SUFFIX;
 	_mdrs = RecordStore::Impl::openRecordStore(rsPath, IO::Mode::ReadWrite);
+
+	/* Closing the backing stores completed their bulk updates */
+	if (this->inBulk()) {
+		_rs->beginBulk();
+		_mdrs->beginBulk();
+	}
+}
+
+void
+BiometricEvaluation::IO::CompressedRecordStore::Impl::beginBulk()
+{
+	RecordStore::Impl::beginBulk();
+	_rs->beginBulk();
+	_mdrs->beginBulk();
+}
+
+void
+BiometricEvaluation::IO::CompressedRecordStore::Impl::commitBulk()
+{
+	if (!this->inBulk())
+		throw Error::StrategyError("No bulk update in progress");
+
+	_rs->commitBulk();
+	_mdrs->commitBulk();
+	RecordStore::Impl::commitBulk();
+}
+
+void
+BiometricEvaluation::IO::CompressedRecordStore::Impl::trainDictionary(
+    uint64_t sampleCount,
+    uint64_t maxDictionarySize)
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+	if (!this->_compressor->supportsDictionaries())
+		throw Error::StrategyError("Compressor does not support "
+		    "dictionaries");
+	if (this->hasDictionary())
+		throw Error::StrategyError("Dictionary already trained");
+	if ((sampleCount == 0) || (maxDictionarySize == 0))
+		throw Error::StrategyError("Invalid dictionary parameters");
+
+	/* Saved so training continues after the store is reopened */
+	std::shared_ptr<IO::Properties> props = this->getProperties();
+	props->setPropertyFromInteger(DICTIONARY_SAMPLES_KEY, sampleCount);
+	props->setPropertyFromInteger(DICTIONARY_SIZE_KEY, maxDictionarySize);
+	this->setProperties(props);
+
+	this->_dictionarySamplesNeeded = sampleCount;
+	this->_dictionarySize = maxDictionarySize;
+	this->_dictionarySamples.clear();
+}
+
+bool
+BiometricEvaluation::IO::CompressedRecordStore::Impl::hasDictionary()
+    const
+{
+	return (this->_compressor->getDictionary().size() != 0);
+}
+
+void
+BiometricEvaluation::IO::CompressedRecordStore::Impl::loadDictionary()
+{
+	std::shared_ptr<IO::Properties> props = this->getProperties();
+	try {
+		this->_compressor->setDictionary(Text::decodeBase64(
+		    props->getProperty(DICTIONARY_KEY)));
+		return;
+	} catch (const Error::ObjectDoesNotExist&) {}
+
+	try {
+		this->_dictionarySamplesNeeded = props->getPropertyAsInteger(
+		    DICTIONARY_SAMPLES_KEY);
+		this->_dictionarySize = props->getPropertyAsInteger(
+		    DICTIONARY_SIZE_KEY);
+	} catch (const Error::ObjectDoesNotExist&) {
+		this->_dictionarySamplesNeeded = 0;
+	}
+}
+
+void
+BiometricEvaluation::IO::CompressedRecordStore::Impl::addDictionarySample(
+    const void *const data,
+    const uint64_t size)
+{
+	Memory::uint8Array sample(size);
+	sample.copy(static_cast<const uint8_t *>(data), size);
+	this->_dictionarySamples.push_back(std::move(sample));
+	if (this->_dictionarySamples.size() < this->_dictionarySamplesNeeded)
+		return;
+
+	std::shared_ptr<IO::Properties> props = this->getProperties();
+	try {
+		const Memory::uint8Array dictionary =
+		    this->_compressor->trainDictionary(
+		    this->_dictionarySamples, this->_dictionarySize);
+		this->_compressor->setDictionary(dictionary);
+		props->setProperty(DICTIONARY_KEY,
+		    Text::encodeBase64(dictionary));
+	} catch (const Error::StrategyError&) {
+		/*
+		 * The samples were unsuitable (e.g., too few or too
+		 * small). Continue compressing without a dictionary.
+		 */
+	}
+	props->removeProperty(DICTIONARY_SAMPLES_KEY);
+	props->removeProperty(DICTIONARY_SIZE_KEY);
+	this->setProperties(props);
+
+	this->_dictionarySamplesNeeded = 0;
+	this->_dictionarySamples.clear();
 }
 
 void
@@ -229,6 +356,65 @@ BiometricEvaluation::IO::CompressedRecordStore::Impl::setCursorAtKey(
 	_rs->setCursorAtKey(key);
 }
     
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::CompressedRecordStore::Impl::makeReader()
+    const
+{
+	return (std::unique_ptr<RecordStore::Cursor>(new Cursor(*this)));
+}
+
+BiometricEvaluation::IO::CompressedRecordStore::Impl::Cursor::Cursor(
+    const CompressedRecordStore::Impl &store) :
+    _store(store),
+    _data(store._rs->makeReader()),
+    _metadata(store._mdrs->makeReader())
+{
+
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::CompressedRecordStore::Impl::Cursor::sequence(
+    int cursor)
+{
+	RecordStore::Record record;
+	/* Obtain the next key, but not data, since it is compressed */
+	record.key = _data->sequenceKey(cursor);
+	record.data = this->read(record.key);
+	return (record);
+}
+
+std::string
+BiometricEvaluation::IO::CompressedRecordStore::Impl::Cursor::sequenceKey(
+    int cursor)
+{
+	return (_data->sequenceKey(cursor));
+}
+
+void
+BiometricEvaluation::IO::CompressedRecordStore::Impl::Cursor::setCursorAtKey(
+    const std::string &key)
+{
+	_data->setCursorAtKey(key);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::CompressedRecordStore::Impl::Cursor::read(
+    const std::string &key)
+    const
+{
+	Memory::uint8Array compressedData = _data->read(key);
+	return (_store._compressor->decompress(compressedData,
+	    compressedData.size(), this->length(key)));
+}
+
+uint64_t
+BiometricEvaluation::IO::CompressedRecordStore::Impl::Cursor::length(
+    const std::string &key)
+    const
+{
+	return (decompressedLength(_metadata->read(key)));
+}
+
 uint64_t
 BiometricEvaluation::IO::CompressedRecordStore::Impl::getSpaceUsed()
     const
@@ -11,6 +11,8 @@
 #ifndef __BE_IO_COMPRESSEDRECSTORE_IMPL_H__
 #define __BE_IO_COMPRESSEDRECSTORE_IMPL_H__
 
+#include <vector>
+
 #include <be_io_compressedrecstore.h>
 #include "be_io_recordstore_impl.h"
 
@@ -117,6 +119,15 @@ namespace BiometricEvaluation
 			remove(
 			    const std::string &key);
 
+			/*
+			 * Bulk updates are forwarded to the backing stores.
+			 */
+			void
+			beginBulk();
+
+			void
+			commitBulk();
+
 			Memory::uint8Array
 			read(
 			    const std::string &key) const;
@@ -141,10 +152,77 @@ namespace BiometricEvaluation
 			setCursorAtKey(
 			    const std::string &key);
 
+			/**
+			 * A RecordStore::Cursor over Cursors of the backing
+			 * stores, decompressing each record it reads.
+			 */
+			class Cursor : public RecordStore::Cursor
+			{
+			public:
+				/**
+				 * @param store
+				 *	Store to read.
+				 *
+				 * @throw Error::NotImplemented
+				 *	Backing stores do not support Cursors.
+				 * @throw Error::StrategyError
+				 *	Error creating backing store Cursors.
+				 */
+				Cursor(
+				    const CompressedRecordStore::Impl &store);
+
+				RecordStore::Record
+				sequence(
+				    int cursor = BE_RECSTORE_SEQ_NEXT)
+				    override;
+
+				std::string
+				sequenceKey(
+				    int cursor = BE_RECSTORE_SEQ_NEXT)
+				    override;
+
+				void
+				setCursorAtKey(
+				    const std::string &key)
+				    override;
+
+				Memory::uint8Array
+				read(
+				    const std::string &key)
+				    const
+				    override;
+
+				uint64_t
+				length(
+				    const std::string &key)
+				    const
+				    override;
+
+			private:
+				/** Store being read */
+				const CompressedRecordStore::Impl &_store;
+				/** Cursor over the compressed data */
+				std::unique_ptr<RecordStore::Cursor> _data;
+				/** Cursor over the metadata */
+				std::unique_ptr<RecordStore::Cursor> _metadata;
+			};
+
+			std::unique_ptr<RecordStore::Cursor>
+			makeReader()
+			    const;
+
 			void
 			move(
 			    const std::string &pathname);
 
+			void
+			trainDictionary(
+			    uint64_t sampleCount,
+			    uint64_t maxDictionarySize);
+
+			bool
+			hasDictionary() const;
+
 			/**
 			 * @brief
 			 * Copy constructor (disabled).
@@ -185,7 +263,38 @@ namespace BiometricEvaluation
 			
 			/** Underlying Compressor */
 			std::shared_ptr<IO::Compressor> _compressor;
-			
+
+			/** Records still to sample before training */
+			uint64_t _dictionarySamplesNeeded{0};
+			/** Maximum size of the trained dictionary */
+			uint64_t _dictionarySize{0};
+			/** Records sampled for training, uncompressed */
+			std::vector<Memory::uint8Array> _dictionarySamples{};
+
+			/**
+			 * Restore the dictionary, or the pending training
+			 * request, from the store's properties.
+			 * @throw Error::StrategyError
+			 *	The saved dictionary could not be used.
+			 */
+			void
+			loadDictionary();
+
+			/**
+			 * Keep a copy of a record for dictionary training,
+			 * and train once enough records have been kept.
+			 * @param[in] data
+			 *	The uncompressed record.
+			 * @param[in] size
+			 *	The size of data.
+			 * @throw Error::StrategyError
+			 *	The dictionary could not be saved.
+			 */
+			void
+			addDictionarySample(
+			    const void *const data,
+			    const uint64_t size);
+
 			/**
 			 * Internal implementation of sequencing through a
 			 * store, returning the key, and optionally, the
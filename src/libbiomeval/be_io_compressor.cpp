@@ -8,15 +8,22 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <cstring>
+
 #include <be_framework_enumeration.h>
 #include <be_io_compressor.h>
+#include <be_io_utility.h>
 
 /* Include children for factory */
 #include <be_io_gzip.h>
+#include <be_io_lz4.h>
+#include <be_io_zstd.h>
 
 const std::map<BiometricEvaluation::IO::Compressor::Kind, std::string>
 BE_IO_Compressor_Kind_EnumToStringMap = {
-	{BiometricEvaluation::IO::Compressor::Kind::GZIP, "GZIP"}
+	{BiometricEvaluation::IO::Compressor::Kind::GZIP, "GZIP"},
+	{BiometricEvaluation::IO::Compressor::Kind::ZSTD, "ZSTD"},
+	{BiometricEvaluation::IO::Compressor::Kind::LZ4, "LZ4"}
 };
 
 BE_FRAMEWORK_ENUMERATION_DEFINITIONS(
@@ -76,11 +83,200 @@ BiometricEvaluation::IO::Compressor::createCompressor(
 	switch (compressorKind) {
 	case Kind::GZIP:
 		return (std::shared_ptr<Compressor>(new GZip()));
+	case Kind::ZSTD:
+#ifdef BIOMEVAL_WITH_ZSTD
+		return (std::shared_ptr<Compressor>(new Zstd()));
+#else
+		throw Error::NotImplemented("Built without Zstandard support");
+#endif /* BIOMEVAL_WITH_ZSTD */
+	case Kind::LZ4:
+#ifdef BIOMEVAL_WITH_LZ4
+		return (std::shared_ptr<Compressor>(new LZ4()));
+#else
+		throw Error::NotImplemented("Built without LZ4 support");
+#endif /* BIOMEVAL_WITH_LZ4 */
 	default:
 		throw Error::ObjectDoesNotExist("Invalid compressor type");
 	}
 }
 
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Compressor::compress(
+    const Memory::uint8Array &uncompressedData)
+    const
+{
+	return (this->compress(uncompressedData, uncompressedData.size()));
+}
+
+void
+BiometricEvaluation::IO::Compressor::compress(
+    const uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	const Memory::uint8Array compressedData = this->compress(
+	    uncompressedData, uncompressedDataSize);
+	IO::Utility::writeFile(compressedData, compressedData.size(),
+	    outputFile);
+}
+
+void
+BiometricEvaluation::IO::Compressor::compress(
+    const Memory::uint8Array &uncompressedData,
+    const std::string &outputFile)
+    const
+{
+	this->compress(uncompressedData, uncompressedData.size(), outputFile);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Compressor::compress(
+    const std::string &inputFile)
+    const
+{
+	if (IO::Utility::fileExists(inputFile) == false)
+		throw Error::ObjectDoesNotExist(inputFile);
+
+	return (this->compress(IO::Utility::readFile(inputFile)));
+}
+
+void
+BiometricEvaluation::IO::Compressor::compress(
+    const std::string &inputFile,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(inputFile) == false)
+		throw Error::ObjectDoesNotExist(inputFile);
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	this->compress(IO::Utility::readFile(inputFile), outputFile);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Compressor::decompress(
+    const Memory::uint8Array &compressedData)
+    const
+{
+	return (this->decompress(compressedData, compressedData.size()));
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Compressor::decompress(
+    const std::string &inputFile)
+    const
+{
+	if (IO::Utility::fileExists(inputFile) == false)
+		throw Error::ObjectDoesNotExist(inputFile);
+
+	return (this->decompress(IO::Utility::readFile(inputFile)));
+}
+
+void
+BiometricEvaluation::IO::Compressor::decompress(
+    const Memory::uint8Array &compressedData,
+    const std::string &outputFile)
+    const
+{
+	this->decompress(compressedData, compressedData.size(), outputFile);
+}
+
+void
+BiometricEvaluation::IO::Compressor::decompress(
+    const uint8_t *const compressedData,
+    const uint64_t compressedDataSize,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	const Memory::uint8Array uncompressedData = this->decompress(
+	    compressedData, compressedDataSize);
+	IO::Utility::writeFile(uncompressedData, uncompressedData.size(),
+	    outputFile);
+}
+
+void
+BiometricEvaluation::IO::Compressor::decompress(
+    const std::string &inputFile,
+    const std::string &outputFile)
+    const
+{
+	if (IO::Utility::fileExists(inputFile) == false)
+		throw Error::ObjectDoesNotExist(inputFile);
+	if (IO::Utility::fileExists(outputFile))
+		throw Error::ObjectExists(outputFile);
+
+	this->decompress(IO::Utility::readFile(inputFile), outputFile);
+}
+
+void
+BiometricEvaluation::IO::Compressor::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	const Memory::uint8Array data = this->decompress(compressedData,
+	    compressedDataSize);
+	if (data.size() != uncompressedDataSize)
+		throw Error::StrategyError("Decompressed size does not match "
+		    "expected size");
+	std::memcpy(uncompressedData, data, uncompressedDataSize);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Compressor::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint64_t uncompressedDataSize)
+    const
+{
+	Memory::uint8Array uncompressedData(uncompressedDataSize);
+	this->decompress(compressedData, compressedDataSize, uncompressedData,
+	    uncompressedDataSize);
+	return (uncompressedData);
+}
+
+bool
+BiometricEvaluation::IO::Compressor::supportsDictionaries()
+    const
+{
+	return (false);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Compressor::trainDictionary(
+    const std::vector<Memory::uint8Array> & /* samples */,
+    uint64_t /* maxDictionarySize */)
+    const
+{
+	throw Error::NotImplemented("Compressor does not support "
+	    "dictionaries");
+}
+
+void
+BiometricEvaluation::IO::Compressor::setDictionary(
+    const Memory::uint8Array & /* dictionary */)
+{
+	throw Error::NotImplemented("Compressor does not support "
+	    "dictionaries");
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Compressor::getDictionary()
+    const
+{
+	return (Memory::uint8Array());
+}
+
 BiometricEvaluation::IO::Compressor::~Compressor()
 {
 
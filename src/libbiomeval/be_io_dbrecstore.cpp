@@ -57,6 +57,18 @@ BiometricEvaluation::IO::DBRecordStore::sync()
 	this->pimpl->sync();
 }
 
+void
+BiometricEvaluation::IO::DBRecordStore::beginBulk()
+{
+	this->pimpl->beginBulk();
+}
+
+void
+BiometricEvaluation::IO::DBRecordStore::commitBulk()
+{
+	this->pimpl->commitBulk();
+}
+
 void
 BiometricEvaluation::IO::DBRecordStore::insert( 
     const std::string &key,
@@ -118,6 +130,13 @@ BiometricEvaluation::IO::DBRecordStore::setCursorAtKey(
 	this->pimpl->setCursorAtKey(key);
 }
 
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::DBRecordStore::makeReader()
+    const
+{
+	return (this->pimpl->makeReader());
+}
+
 unsigned int
 BiometricEvaluation::IO::DBRecordStore::getCount()
     const
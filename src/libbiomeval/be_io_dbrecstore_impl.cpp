@@ -376,6 +376,19 @@ BiometricEvaluation::IO::DBRecordStore::Impl::insert(
 		throw Error::StrategyError("Invalid key format");
 
 	insertRecordSegments(key, data, size);
+
+	/* During a bulk update, the cursor is updated once, when needed */
+	if (this->inBulk())
+		this->_cursorNeedsUpdate = true;
+	else
+		this->updateCursorAfterInsert();
+	RecordStore::Impl::insert(key, data, size);
+}
+
+void
+BiometricEvaluation::IO::DBRecordStore::Impl::updateCursorAfterInsert()
+{
+	this->_cursorNeedsUpdate = false;
 	if (!this->_cursorIsInit) {
 		Dbt dbtkey;
 		Dbt dbtdata;
@@ -405,7 +418,17 @@ BiometricEvaluation::IO::DBRecordStore::Impl::insert(
 			this->_atEnd = false;
 		}
 	}
-	RecordStore::Impl::insert(key, data, size);
+}
+
+void
+BiometricEvaluation::IO::DBRecordStore::Impl::commitBulk()
+{
+	if (!this->inBulk())
+		throw Error::StrategyError("No bulk update in progress");
+
+	if (this->_cursorNeedsUpdate)
+		this->updateCursorAfterInsert();
+	RecordStore::Impl::commitBulk();
 }
 
 void
@@ -417,6 +440,9 @@ BiometricEvaluation::IO::DBRecordStore::Impl::remove(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
+	if (this->_cursorNeedsUpdate)
+		this->updateCursorAfterInsert();
+
 	/* Allow exceptions to float out of this function. */
 	removeRecordSegments(key);
 
@@ -508,6 +534,9 @@ BiometricEvaluation::IO::DBRecordStore::Impl::i_sequence(
 		throw Error::StrategyError("Invalid cursor position as "
 		    "argument");
 	}
+	if (this->_cursorNeedsUpdate)
+		this->updateCursorAfterInsert();
+
 	/* If the current cursor position is START, then it doesn't matter
 	 * what the client requests; we start at the first record.
 	*/
@@ -620,6 +649,160 @@ BiometricEvaluation::IO::DBRecordStore::Impl::setCursorAtKey(
 	setCursor(BE_RECSTORE_SEQ_NEXT);
 }
 
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::DBRecordStore::Impl::makeReader()
+    const
+{
+	this->sync();
+	return (std::unique_ptr<RecordStore::Cursor>(new Cursor(*this)));
+}
+
+BiometricEvaluation::IO::DBRecordStore::Impl::Cursor::Cursor(
+    const DBRecordStore::Impl &store) :
+    _store(store)
+{
+	try {
+		this->_dbP = std::make_shared<Db>(nullptr, 0);
+		setBtreeInfo(this->_dbP);
+		this->_dbP->open(nullptr, store._dbnameP.c_str(), nullptr,
+		    DB_BTREE, DB_RDONLY, 0);
+		this->_dbP->cursor(nullptr, &this->_dbC, 0);
+
+		/* Older stores may not have a subordinate DB */
+		if (IO::Utility::fileExists(store._dbnameS)) {
+			this->_dbS = std::make_shared<Db>(nullptr, 0);
+			setBtreeInfo(this->_dbS);
+			this->_dbS->open(nullptr, store._dbnameS.c_str(),
+			    nullptr, DB_BTREE, DB_RDONLY, 0);
+		}
+	} catch (const DbException &e) {
+		throw Error::StrategyError("Could not open DB for cursor (DB "
+		    "error = " + std::to_string(e.get_errno()) + " -- " +
+		    e.what() + ")");
+	} catch (const std::exception &) {
+		throw Error::StrategyError("Could not open DB for cursor (" +
+		    Error::errorStr() + ")");
+	}
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::DBRecordStore::Impl::Cursor::i_sequence(
+    bool returnData,
+    int cursor)
+{
+	if ((cursor != IO::RecordStore::BE_RECSTORE_SEQ_START) &&
+	    (cursor != IO::RecordStore::BE_RECSTORE_SEQ_NEXT)) {
+		throw Error::StrategyError("Invalid cursor position as "
+		    "argument");
+	}
+	if (cursor == IO::RecordStore::BE_RECSTORE_SEQ_START) {
+		this->_nextOp = DB_FIRST;
+		this->_atEnd = false;
+	}
+	if (this->_atEnd)
+		throw BE::Error::ObjectDoesNotExist();
+
+	/* Do not read any data, which may span into subordinate */
+	Dbt dbtkey;
+	Dbt dbtdata;
+	dbtdata.set_dlen(0);
+	dbtdata.set_flags(DB_DBT_PARTIAL);
+	int rv;
+	try {
+		rv = this->_dbC->get(&dbtkey, &dbtdata, this->_nextOp);
+	} catch (const DbException &e) {
+		throw BE::Error::StrategyError("Could not move Dbc (DB "
+		    "error = " + std::to_string(e.get_errno()) + " -- " +
+		    e.what() + ")");
+	}
+	if (rv == DB_NOTFOUND) {
+		this->_atEnd = true;
+		throw BE::Error::ObjectDoesNotExist();
+	}
+	if (rv != 0)
+		throw BE::Error::StrategyError("Could not move Dbc (" +
+		    std::to_string(rv) + ")");
+	this->_nextOp = DB_NEXT;
+
+	BE::IO::RecordStore::Record record;
+	record.key.assign((const char *)dbtkey.get_data(), dbtkey.get_size());
+	if (returnData)
+		record.data = this->read(record.key);
+	return (record);
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::DBRecordStore::Impl::Cursor::sequence(
+    int cursor)
+{
+	return (this->i_sequence(true, cursor));
+}
+
+std::string
+BiometricEvaluation::IO::DBRecordStore::Impl::Cursor::sequenceKey(
+    int cursor)
+{
+	return (this->i_sequence(false, cursor).key);
+}
+
+void
+BiometricEvaluation::IO::DBRecordStore::Impl::Cursor::setCursorAtKey(
+    const std::string &key)
+{
+	if (!this->_store.validateKeyString(key))
+		throw Error::StrategyError("Invalid key format");
+
+	Dbt dbtkey, dbtdata;
+	dbtkey.set_data((void *)key.data());
+	dbtkey.set_size(key.length());
+	dbtdata.set_dlen(0);
+	dbtdata.set_flags(DB_DBT_PARTIAL);
+	try {
+		if (this->_dbC->get(&dbtkey, &dbtdata, DB_SET) == DB_NOTFOUND)
+			throw BE::Error::ObjectDoesNotExist(key);
+	} catch (const DbException &e) {
+		throw BE::Error::StrategyError("Could not set Dbc (DB "
+		    "error = " + std::to_string(e.get_errno()) + " -- " +
+		    e.what() + ")");
+	}
+
+	/* Next sequence() returns key */
+	this->_nextOp = DB_CURRENT;
+	this->_atEnd = false;
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::DBRecordStore::Impl::Cursor::read(
+    const std::string &key)
+    const
+{
+	BE::Memory::uint8Array data;
+	data.resize(this->length(key));
+	this->_store.readRecordSegments(this->_dbP, this->_dbS, key, data);
+	return (data);
+}
+
+uint64_t
+BiometricEvaluation::IO::DBRecordStore::Impl::Cursor::length(
+    const std::string &key)
+    const
+{
+	return (this->_store.readRecordSegments(this->_dbP, this->_dbS, key,
+	    nullptr));
+}
+
+BiometricEvaluation::IO::DBRecordStore::Impl::Cursor::~Cursor()
+{
+	try {
+		if (this->_dbC != nullptr)
+			this->_dbC->close();
+		if (this->_dbP != nullptr)
+			this->_dbP->close(0);
+		if (this->_dbS != nullptr)
+			this->_dbS->close(0);
+	} catch (const std::exception&) {}
+}
+
 /*
  * Private method implementations.
  */
@@ -732,6 +915,17 @@ BiometricEvaluation::IO::DBRecordStore::Impl::readRecordSegments(
     const std::string &key,
     void *const data)
     const
+{
+	return (this->readRecordSegments(this->_dbP, this->_dbS, key, data));
+}
+
+uint64_t
+BiometricEvaluation::IO::DBRecordStore::Impl::readRecordSegments(
+    const std::shared_ptr<Db> &dbP,
+    const std::shared_ptr<Db> &dbS,
+    const std::string &key,
+    void *const data)
+    const
 {
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
@@ -748,7 +942,7 @@ BiometricEvaluation::IO::DBRecordStore::Impl::readRecordSegments(
 	uint8_t *ptr = (uint8_t *)data;
 
 	/* Start with the primary DB file */
-	std::shared_ptr<Db> DBin = this->_dbP;
+	std::shared_ptr<Db> DBin = dbP;
 	do {
 		dbtkey.set_data((void *)keyseg.data());
 		dbtkey.set_size(keyseg.length());
@@ -764,10 +958,10 @@ BiometricEvaluation::IO::DBRecordStore::Impl::readRecordSegments(
 				keyseg = genKeySegName(key, segnum);
 				segnum++;
 				/* Switch to the subordinate DB */
-				DBin = this->_dbS;
+				DBin = dbS;
 				break;
 			case DB_NOTFOUND:
-				if (DBin == this->_dbP) /* first time through */
+				if (DBin == dbP) /* first time through */
 					throw Error::ObjectDoesNotExist(
 					    "Key not in database");
 				else
@@ -10,6 +10,7 @@
 #ifndef __BE_DBRECSTORE_IMPL_H__
 #define __BE_DBRECSTORE_IMPL_H__
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -94,6 +95,20 @@ namespace BiometricEvaluation {
 			void remove(
 			    const std::string &key);
 
+			/**
+			 * @brief
+			 * Complete a bulk update.
+			 * @details
+			 * The DB handles are not opened within an
+			 * environment, so no transaction is used; the
+			 * record count and cursor are updated once.
+			 *
+			 * @throw Error::StrategyError
+			 *	No bulk update in progress, or the cursor
+			 *	could not be moved.
+			 */
+			void commitBulk();
+
 			uint64_t length(
 			    const std::string &key) const;
 
@@ -108,6 +123,86 @@ namespace BiometricEvaluation {
 			void setCursorAtKey(
 			    const std::string &key);
 
+			/**
+			 * @brief
+			 * A RecordStore::Cursor with its own read-only
+			 * handles to the database files.
+			 * @details
+			 * Berkeley DB returns data in memory owned by the
+			 * handle, so handles cannot be shared between
+			 * threads.
+			 */
+			class Cursor : public RecordStore::Cursor
+			{
+			public:
+				/**
+				 * @param[in] store
+				 *	Store to read.
+				 *
+				 * @throw Error::StrategyError
+				 *	Could not open the database files.
+				 */
+				Cursor(
+				    const DBRecordStore::Impl &store);
+
+				RecordStore::Record
+				sequence(
+				    int cursor = BE_RECSTORE_SEQ_NEXT)
+				    override;
+
+				std::string
+				sequenceKey(
+				    int cursor = BE_RECSTORE_SEQ_NEXT)
+				    override;
+
+				void
+				setCursorAtKey(
+				    const std::string &key)
+				    override;
+
+				Memory::uint8Array
+				read(
+				    const std::string &key)
+				    const
+				    override;
+
+				uint64_t
+				length(
+				    const std::string &key)
+				    const
+				    override;
+
+				~Cursor();
+
+			private:
+				/** Store being read */
+				const DBRecordStore::Impl &_store;
+				/** Handle to the primary database */
+				std::shared_ptr<Db> _dbP{};
+				/** Handle to the subordinate database */
+				std::shared_ptr<Db> _dbS{};
+				/** Handle to cursor within _dbP */
+				Dbc *_dbC{nullptr};
+				/** Cursor operation returning the next key */
+				u_int32_t _nextOp{DB_FIRST};
+				/** Whether sequencing has reached the end */
+				bool _atEnd{false};
+
+				/** See DBRecordStore::Impl::i_sequence() */
+				RecordStore::Record
+				i_sequence(
+				    bool returnData,
+				    int cursor);
+			};
+
+			/**
+			 * @brief
+			 * Obtain a Cursor, first writing any cached
+			 * changes so the Cursor's handles can see them.
+			 */
+			std::unique_ptr<RecordStore::Cursor> makeReader()
+			    const;
+
 			void move(
 			    const std::string &pathname);
 
@@ -153,6 +248,18 @@ namespace BiometricEvaluation {
 			 */
 			bool _atEnd{};
 
+			/*
+			 * Indicator that records were inserted during a bulk
+			 * update without updating the cursor.
+			 */
+			bool _cursorNeedsUpdate{};
+
+			/*
+			 * Initialize the cursor, or move it past the end,
+			 * after records have been inserted.
+			 */
+			void updateCursorAfterInsert();
+
 			/*
 			 * Open the underlying database handle objects.
 			 */
@@ -172,6 +279,12 @@ namespace BiometricEvaluation {
 			    const std::string &key,
 			    void *const data) const;
 
+			uint64_t readRecordSegments(
+			    const std::shared_ptr<Db> &dbP,
+			    const std::shared_ptr<Db> &dbS,
+			    const std::string &key,
+			    void *const data) const;
+
 			void removeRecordSegments(const std::string &key);
 
 			/**
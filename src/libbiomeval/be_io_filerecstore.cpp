@@ -56,6 +56,18 @@ BiometricEvaluation::IO::FileRecordStore::sync()
 	this->pimpl->sync();
 }
 
+void
+BiometricEvaluation::IO::FileRecordStore::beginBulk()
+{
+	this->pimpl->beginBulk();
+}
+
+void
+BiometricEvaluation::IO::FileRecordStore::commitBulk()
+{
+	this->pimpl->commitBulk();
+}
+
 void
 BiometricEvaluation::IO::FileRecordStore::insert( 
     const std::string &key,
@@ -126,6 +138,13 @@ BiometricEvaluation::IO::FileRecordStore::setCursorAtKey(
 	this->pimpl->setCursorAtKey(key);
 }
 
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::FileRecordStore::makeReader()
+    const
+{
+	return (this->pimpl->makeReader());
+}
+
 unsigned int
 BiometricEvaluation::IO::FileRecordStore::getCount()
     const
@@ -27,9 +27,9 @@ static const std::string _fileArea = "theFiles";
 BiometricEvaluation::IO::FileRecordStore::Impl::Impl(
     const std::string &pathname,
     const std::string &description) :
-    RecordStore::Impl(pathname, description, RecordStore::Kind::File)
+    RecordStore::Impl(pathname, description, RecordStore::Kind::File),
+    _keyIndexBuilt(false)
 {
-	_cursorPos = 1;
 	_theFilesDir = RecordStore::Impl::canonicalName(_fileArea);
 	if (mkdir(_theFilesDir.c_str(), S_IRWXU | S_IRWXG | S_IRWXO) != 0)
 		throw Error::StrategyError("Could not create file area "
@@ -39,9 +39,9 @@ BiometricEvaluation::IO::FileRecordStore::Impl::Impl(
 BiometricEvaluation::IO::FileRecordStore::Impl::Impl(
     const std::string &pathname,
     IO::Mode mode) :
-    RecordStore::Impl(pathname, mode)
+    RecordStore::Impl(pathname, mode),
+    _keyIndexBuilt(false)
 {
-	_cursorPos = 1;
 	_theFilesDir = RecordStore::Impl::canonicalName(_fileArea);
 }
 
@@ -134,6 +134,10 @@ BiometricEvaluation::IO::FileRecordStore::Impl::insert(
 		throw;
 	}
 	RecordStore::Impl::insert(key, data, size);
+
+	/* New keys don't disturb the position of the cursor */
+	if (this->_keyIndexBuilt)
+		this->_keyIndex.insert(key);
 }
 
 void
@@ -153,6 +157,16 @@ BiometricEvaluation::IO::FileRecordStore::Impl::remove(
 		throw Error::StrategyError("Could not remove " + pathname);
 
 	RecordStore::Impl::remove(key);
+
+	if (this->_keyIndexBuilt) {
+		const auto it = this->_keyIndex.find(key);
+		if (it != this->_keyIndex.cend()) {
+			/* Keep the cursor valid by moving it past the key */
+			if (it == this->_cursorKey)
+				++this->_cursorKey;
+			this->_keyIndex.erase(it);
+		}
+	}
 }
 
 BiometricEvaluation::Memory::uint8Array
@@ -248,92 +262,25 @@ BiometricEvaluation::IO::FileRecordStore::Impl::i_sequence(
 		throw Error::StrategyError("Invalid cursor position as "
 		    "argument");
 
-	DIR *dir;
-	dir = opendir(_theFilesDir.c_str());
-	if (dir == nullptr)
-		throw Error::StrategyError("Cannot open store directory");
+	if (!this->_keyIndexBuilt)
+		this->buildKeyIndex();
 
 	/* If the current cursor position is START, then it doesn't matter
 	 * what the client requests; we start at the first record.
 	*/
 	if ((getCursor() == BE_RECSTORE_SEQ_START) ||
 	    (cursor == BE_RECSTORE_SEQ_START))
-		_cursorPos = 1;
-
-	if (_cursorPos > getCount()) { /* Client needs to start over */
-		const std::string errorStr{"No record at position"};
-		if (dir != nullptr) {
-			if (closedir(dir)) {
-				throw Error::StrategyError("Could not close " +
-				    this->_theFilesDir + "(" + 
-				    Error::errorStr() + ") while exiting with "
-				    "error " + errorStr);
-			}
-		}
-
-		throw Error::ObjectDoesNotExist(errorStr);
-	}
-
-	struct dirent *entry;
-	struct stat sb;
-	uint64_t i = 1;
-	std::string cname;
-	while ((entry = readdir(dir)) != nullptr) {
-#ifndef _WIN32
-		if (entry->d_ino == 0)
-			continue;
-#endif
-		cname = _theFilesDir + "/" + entry->d_name;
-		if (stat(cname.c_str(), &sb) != 0) {
-			const std::string errorStr{"Cannot stat store file (" +
-				Error::errorStr() + ")"};
-			if (dir != nullptr) {
-				if (closedir(dir)) {
-					throw Error::StrategyError("Could not "
-					    "close " + this->_theFilesDir + " "
-					    "(" + Error::errorStr() + ") "
-					    "while exiting with error " +
-					    errorStr);
-				}
-			}
-
-			throw BE::Error::StrategyError{errorStr};
-		}
-		if ((S_IFMT & sb.st_mode) == S_IFDIR)	/* skip '.' and '..' */
-			continue;
-		if (i == _cursorPos)
-			break;
-		i++;
-	}	
-	/* Sanity check */
-	if (i > _cursorPos) {
-		const std::string errorStr{"Record cursor position out of "
-		    "sync"};
-		if (dir != nullptr) {
-			if (closedir(dir)) {
-				throw Error::StrategyError("Could not close " +
-				    this->_theFilesDir + " (" + 
-				    Error::errorStr() + ") while exiting with "
-				    "error " + errorStr);
-			}
-		}
+		this->_cursorKey = this->_keyIndex.cbegin();
 
-		throw Error::StrategyError{errorStr};
-	}
+	/* Client needs to start over */
+	if (this->_cursorKey == this->_keyIndex.cend())
+		throw Error::ObjectDoesNotExist("No record at position");
 
 	BE::IO::RecordStore::Record record;
-	record.key = entry->d_name;
+	record.key = *this->_cursorKey;
 	setCursor(BE_RECSTORE_SEQ_NEXT);
-	_cursorPos = i + 1;
+	++this->_cursorKey;
 
-	if (dir != nullptr) {
-		if (closedir(dir)) {
-			throw Error::StrategyError("Could not close " + 
-			    _theFilesDir + " (" + Error::errorStr() + 
-			    ")");
-		}
-	}
-	
 	if (returnData)
 		record.data = FileRecordStore::Impl::read(record.key);
 	return (record);
@@ -361,44 +308,104 @@ BiometricEvaluation::IO::FileRecordStore::Impl::setCursorAtKey(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
-	DIR *dir;
-	dir = opendir(_theFilesDir.c_str());
-	if (dir == nullptr)
-		throw Error::StrategyError("Cannot open store directory");
+	if (!this->_keyIndexBuilt)
+		this->buildKeyIndex();
 
-	struct dirent *entry;
-	struct stat sb;
-	int i = 1;
-	std::string cname;
-	while ((entry = readdir(dir)) != nullptr) {
-#ifndef _WIN32
-		if (entry->d_ino == 0)
-			continue;
-#endif
-		cname = _theFilesDir + "/" + entry->d_name;
-		if (stat(cname.c_str(), &sb) != 0)	
-			throw Error::StrategyError("Cannot stat store file (" +
-			    Error::errorStr() + ")");
-		if ((S_IFMT & sb.st_mode) == S_IFDIR)	/* skip '.' and '..' */
-			continue;
-		if (key == entry->d_name) {
-			_cursorPos = i;
-			break;
+	const auto it = this->_keyIndex.find(key);
+	if (it == this->_keyIndex.cend())
+		throw Error::ObjectDoesNotExist(key);
+
+	this->_cursorKey = it;
+	setCursor(BE_RECSTORE_SEQ_NEXT);
+}
+
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::FileRecordStore::Impl::makeReader()
+    const
+{
+	/* Copying the index is cheaper than reading the file area */
+	std::set<std::string> keys = (this->_keyIndexBuilt ?
+	    this->_keyIndex : this->scanKeys());
+	return (std::unique_ptr<RecordStore::Cursor>(new Cursor(*this,
+	    std::move(keys))));
+}
+
+BiometricEvaluation::IO::FileRecordStore::Impl::Cursor::Cursor(
+    const FileRecordStore::Impl &store,
+    std::set<std::string> &&keys) :
+    _store(store),
+    _keys(std::move(keys)),
+    _cursorKey(_keys.cbegin())
+{
+
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::FileRecordStore::Impl::Cursor::sequence(
+    int cursor)
+{
+	/* Skip records removed since the keys were copied */
+	RecordStore::Record record;
+	for (;;) {
+		record.key = this->sequenceKey(cursor);
+		try {
+			record.data = _store.read(record.key);
+			return (record);
+		} catch (const Error::ObjectDoesNotExist&) {
+			cursor = BE_RECSTORE_SEQ_NEXT;
 		}
-		i++;
 	}
+}
 
-	/* Exited the loop by exhausting the directory */
-	if (entry == nullptr)
-		throw Error::ObjectDoesNotExist(key);
+std::string
+BiometricEvaluation::IO::FileRecordStore::Impl::Cursor::sequenceKey(
+    int cursor)
+{
+	if ((cursor != BE_RECSTORE_SEQ_START) &&
+	    (cursor != BE_RECSTORE_SEQ_NEXT))
+		throw Error::StrategyError("Invalid cursor position as "
+		    "argument");
 
-	if (dir != nullptr) {
-		if (closedir(dir)) {
-			throw Error::StrategyError("Could not close " + 
-			    _theFilesDir + " (" + Error::errorStr() + 
-			    ")");
-		}
+	if (_atStart || (cursor == BE_RECSTORE_SEQ_START)) {
+		_atStart = false;
+		_cursorKey = _keys.cbegin();
 	}
+	if (_cursorKey == _keys.cend())
+		throw Error::ObjectDoesNotExist("No record at position");
+
+	return (*_cursorKey++);
+}
+
+void
+BiometricEvaluation::IO::FileRecordStore::Impl::Cursor::setCursorAtKey(
+    const std::string &key)
+{
+	if (!_store.validateKeyString(key))
+		throw Error::StrategyError("Invalid key format");
+
+	const auto it = _keys.find(key);
+	if (it == _keys.cend())
+		throw Error::ObjectDoesNotExist(key);
+
+	_cursorKey = it;
+	_atStart = false;
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::FileRecordStore::Impl::Cursor::read(
+    const std::string &key)
+    const
+{
+	/* Each read opens its own file */
+	return (_store.read(key));
+}
+
+uint64_t
+BiometricEvaluation::IO::FileRecordStore::Impl::Cursor::length(
+    const std::string &key)
+    const
+{
+	return (_store.length(key));
 }
 
 /******************************************************************************/
@@ -426,6 +433,63 @@ BiometricEvaluation::IO::FileRecordStore::Impl::writeNewRecordFile(
 		    Error::errorStr() + ")");
 }
 
+void
+BiometricEvaluation::IO::FileRecordStore::Impl::buildKeyIndex()
+{
+	this->_keyIndex = this->scanKeys();
+	this->_cursorKey = this->_keyIndex.cbegin();
+	this->_keyIndexBuilt = true;
+}
+
+std::set<std::string>
+BiometricEvaluation::IO::FileRecordStore::Impl::scanKeys()
+    const
+{
+	DIR *dir;
+	dir = opendir(_theFilesDir.c_str());
+	if (dir == nullptr)
+		throw Error::StrategyError("Cannot open store directory");
+
+	std::set<std::string> keys{};
+	struct dirent *entry;
+	struct stat sb;
+	std::string cname;
+	while ((entry = readdir(dir)) != nullptr) {
+#ifndef _WIN32
+		if (entry->d_ino == 0)
+			continue;
+#endif
+		if (entry->d_type == DT_DIR)	/* skip '.' and '..' */
+			continue;
+		if (entry->d_type == DT_UNKNOWN) {
+			cname = _theFilesDir + "/" + entry->d_name;
+			if (stat(cname.c_str(), &sb) != 0) {
+				const std::string errorStr{"Cannot stat store "
+				    "file (" + Error::errorStr() + ")"};
+				if (closedir(dir)) {
+					throw Error::StrategyError("Could not "
+					    "close " + this->_theFilesDir + " "
+					    "(" + Error::errorStr() + ") "
+					    "while exiting with error " +
+					    errorStr);
+				}
+
+				throw Error::StrategyError{errorStr};
+			}
+			if ((S_IFMT & sb.st_mode) == S_IFDIR)
+				continue;
+		}
+		keys.emplace(entry->d_name);
+	}
+
+	if (closedir(dir)) {
+		throw Error::StrategyError("Could not close " + 
+		    _theFilesDir + " (" + Error::errorStr() + ")");
+	}
+
+	return (keys);
+}
+
 std::string
 BiometricEvaluation::IO::FileRecordStore::Impl::canonicalName(
     const std::string &name) const
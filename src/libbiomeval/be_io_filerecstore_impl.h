@@ -10,6 +10,8 @@
 #ifndef __BE_FILERECSTORE_IMPL_H__
 #define __BE_FILERECSTORE_IMPL_H__
 
+#include <set>
+
 #include "be_io_recordstore_impl.h"
 #include <be_io_filerecstore.h>
 
@@ -104,6 +106,66 @@ namespace BiometricEvaluation {
 
 			void setCursorAtKey(const std::string &key);
 
+			/**
+			 * A RecordStore::Cursor over a copy of the key
+			 * index, reading record files directly.
+			 */
+			class Cursor : public RecordStore::Cursor
+			{
+			public:
+				/**
+				 * @param[in] store
+				 *	Store to read.
+				 * @param[in] keys
+				 *	Keys of the store's records.
+				 */
+				Cursor(
+				    const FileRecordStore::Impl &store,
+				    std::set<std::string> &&keys);
+
+				RecordStore::Record
+				sequence(
+				    int cursor = BE_RECSTORE_SEQ_NEXT)
+				    override;
+
+				std::string
+				sequenceKey(
+				    int cursor = BE_RECSTORE_SEQ_NEXT)
+				    override;
+
+				void
+				setCursorAtKey(
+				    const std::string &key)
+				    override;
+
+				Memory::uint8Array
+				read(
+				    const std::string &key)
+				    const
+				    override;
+
+				uint64_t
+				length(
+				    const std::string &key)
+				    const
+				    override;
+
+			private:
+				/** Store being read */
+				const FileRecordStore::Impl &_store;
+				/** Keys of the store's records */
+				const std::set<std::string> _keys;
+				/** Next key to be returned by sequence() */
+				std::set<std::string>::const_iterator
+				    _cursorKey;
+				/** Whether to start at the first key */
+				bool _atStart{true};
+			};
+
+			/** See RecordStore::makeReader() */
+			std::unique_ptr<RecordStore::Cursor> makeReader()
+			    const;
+
 			void move(const std::string &pathname);
 
 			/* Prevent copying of FileRecordStore objects */
@@ -120,9 +182,48 @@ namespace BiometricEvaluation {
 			    const void *data,
 			    const uint64_t size);
 
-			uint64_t _cursorPos;
 			std::string _theFilesDir;
 
+			/*
+			 * Sorted index of the record keys, built from the
+			 * file area the first time it is needed and kept
+			 * current by insert() and remove().
+			 */
+			std::set<std::string> _keyIndex;
+			bool _keyIndexBuilt;
+
+			/* Next key to be returned by sequence() */
+			std::set<std::string>::const_iterator _cursorKey;
+
+			/**
+			 * @brief
+			 * Build the key index from a single pass over the
+			 * file area.
+			 * @details
+			 * The directory entry type is used to skip
+			 * subdirectories, falling back to stat() only when
+			 * the file system does not report a type.
+			 *
+			 * @throw Error::StrategyError
+			 *	An error occurred when reading the file area.
+			 */
+			void
+			buildKeyIndex();
+
+			/**
+			 * @brief
+			 * Read the keys of all records from the file area.
+			 *
+			 * @return
+			 *	Sorted keys.
+			 *
+			 * @throw Error::StrategyError
+			 *	An error occurred when reading the file area.
+			 */
+			std::set<std::string>
+			scanKeys()
+			    const;
+
 			/**
 			 * Internal implementation of sequencing through a
 			 * store, returning the key, and optionally, the
@@ -8,7 +8,9 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
 #include <cstring>
+#include <limits>
 
 #include <zlib.h>
 
@@ -436,6 +438,11 @@ BiometricEvaluation::IO::GZip::decompress(
 			throw Error::StrategyError("Compressed data remains "
 			    "after decompressing chunk");
 		}
+		if ((remainingBytes == 0) && (rv != Z_STREAM_END)) {
+			inflateEnd(&strm);
+			throw Error::StrategyError("Compressed data is "
+			    "truncated");
+		}
 		
 	} while (rv != Z_STREAM_END);
 	inflateEnd(&strm);
@@ -453,6 +460,77 @@ BiometricEvaluation::IO::GZip::decompress(
 	return (this->decompress(compressedData, compressedData.size()));
 }
 
+void
+BiometricEvaluation::IO::GZip::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	z_stream &strm = this->getReusableDecompressionStream();
+
+	/* zlib counts available bytes in uInt, so feed large buffers */
+	const uint64_t maxAvail = std::numeric_limits<uInt>::max();
+	uint64_t remainingIn = compressedDataSize;
+	uint64_t remainingOut = uncompressedDataSize;
+	strm.next_in = const_cast<uint8_t *>(compressedData);
+
+	/* inflate() rejects a null output, as empty buffers may have */
+	uint8_t emptyOutput{};
+	strm.next_out = (uncompressedData != nullptr ? uncompressedData :
+	    &emptyOutput);
+	strm.avail_in = 0;
+	strm.avail_out = 0;
+
+	int32_t rv;
+	do {
+		if (strm.avail_in == 0) {
+			strm.avail_in = std::min(remainingIn, maxAvail);
+			remainingIn -= strm.avail_in;
+		}
+		if (strm.avail_out == 0) {
+			strm.avail_out = std::min(remainingOut, maxAvail);
+			remainingOut -= strm.avail_out;
+		}
+
+		/* Inflate directly into the caller's buffer */
+		rv = inflate(&strm, Z_NO_FLUSH);
+	} while (rv == Z_OK);
+
+	switch (rv) {
+	case Z_STREAM_END:
+		break;
+	case Z_BUF_ERROR:
+		if ((strm.avail_out == 0) && (remainingOut == 0))
+			throw Error::StrategyError("Decompressed data is larger "
+			    "than expected size");
+		throw Error::StrategyError("Compressed data is truncated");
+	default:
+		throw Error::StrategyError("Error during inflate (" +
+		    std::to_string(rv) + ")");
+	}
+
+	/* Sanity check */
+	if ((strm.avail_in != 0) || (remainingIn != 0))
+		throw Error::StrategyError("Compressed data remains "
+		    "after decompressing");
+	if ((strm.avail_out != 0) || (remainingOut != 0))
+		throw Error::StrategyError("Decompressed data is smaller "
+		    "than expected size");
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::GZip::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint64_t uncompressedDataSize)
+    const
+{
+	return (Compressor::decompress(compressedData, compressedDataSize,
+	    uncompressedDataSize));
+}
+
 BiometricEvaluation::Memory::uint8Array
 BiometricEvaluation::IO::GZip::decompress(
     const std::string &inputFile)
@@ -640,6 +718,12 @@ BiometricEvaluation::IO::GZip::decompress(
 			throw Error::StrategyError("Wrote invalid number of "
 			    "bytes after decompressing chunk");
 		}
+		if ((remainingBytes == 0) && (rv != Z_STREAM_END)) {
+			fclose(ofp);
+			inflateEnd(&strm);
+			throw Error::StrategyError("Compressed data is "
+			    "truncated");
+		}
 	} while (rv != Z_STREAM_END);
 	fclose(ofp);
 	inflateEnd(&strm);
@@ -679,6 +763,43 @@ BiometricEvaluation::IO::GZip::initDecompressionStream()
 	return (strm);
 }
 
+z_stream&
+BiometricEvaluation::IO::GZip::getReusableDecompressionStream()
+    const
+{
+	/* Per-thread inflate state, released when the thread exits */
+	struct ReusableStream
+	{
+		z_stream strm{};
+		bool initialized{false};
+
+		~ReusableStream()
+		{
+			if (this->initialized)
+				inflateEnd(&this->strm);
+		}
+	};
+	static thread_local ReusableStream reusable;
+
+	const int windowBits = static_cast<int>(
+	    this->getOptionAsInteger(WINDOW_BITS));
+	if (!reusable.initialized) {
+		reusable.strm.zalloc = Z_NULL;
+		reusable.strm.zfree = Z_NULL;
+		reusable.strm.opaque = Z_NULL;
+		reusable.strm.avail_in = 0;
+		reusable.strm.next_in = Z_NULL;
+		if (inflateInit2(&reusable.strm, windowBits) != Z_OK)
+			throw Error::StrategyError("Could not initialize "
+			    "stream");
+		reusable.initialized = true;
+	} else if (inflateReset2(&reusable.strm, windowBits) != Z_OK) {
+		throw Error::StrategyError("Could not reset stream");
+	}
+
+	return (reusable.strm);
+}
+
 int32_t
 BiometricEvaluation::IO::GZip::decompressChunk(
     uint64_t chunkSize,
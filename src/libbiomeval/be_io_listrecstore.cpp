@@ -61,6 +61,13 @@ BiometricEvaluation::IO::ListRecordStore::setCursorAtKey(
 	this->pimpl->setCursorAtKey(key);
 }
 
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::ListRecordStore::makeReader()
+    const
+{
+	return (this->pimpl->makeReader());
+}
+
 uint64_t
 BiometricEvaluation::IO::ListRecordStore::getSpaceUsed()
     const
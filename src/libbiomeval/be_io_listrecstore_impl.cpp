@@ -147,6 +147,96 @@ BiometricEvaluation::IO::ListRecordStore::Impl::setCursorAtKey(
 		    RecordStore::Impl::canonicalName(KEYLISTFILENAME));
 }
 
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::ListRecordStore::Impl::makeReader()
+    const
+{
+	return (std::unique_ptr<RecordStore::Cursor>(new Cursor(*this)));
+}
+
+BiometricEvaluation::IO::ListRecordStore::Impl::Cursor::Cursor(
+    const ListRecordStore::Impl &store) :
+    _keyListPath(store.canonicalName(KEYLISTFILENAME)),
+    _keyListFile(_keyListPath),
+    _source(store._sourceRecordStore->makeReader())
+{
+	if (!this->_keyListFile.is_open())
+		throw Error::StrategyError("Could not open key list file");
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::ListRecordStore::Impl::Cursor::sequence(
+    int cursor)
+{
+	BE::IO::RecordStore::Record record;
+	record.key = this->sequenceKey(cursor);
+	record.data = this->_source->read(record.key);
+	return (record);
+}
+
+std::string
+BiometricEvaluation::IO::ListRecordStore::Impl::Cursor::sequenceKey(
+    int cursor)
+{
+	if ((cursor != BE_RECSTORE_SEQ_START) &&
+	    (cursor != BE_RECSTORE_SEQ_NEXT))
+		throw Error::StrategyError("Invalid cursor position as "
+		    "argument");
+
+	if (cursor == BE_RECSTORE_SEQ_START) {
+		this->_pendingKey.clear();
+		this->_keyListFile.clear();
+		this->_keyListFile.seekg(0);
+		if (!this->_keyListFile)
+			throw Error::StrategyError("Could not rewind " +
+			    this->_keyListPath);
+	}
+	if (!this->_pendingKey.empty()) {
+		std::string key;
+		std::swap(key, this->_pendingKey);
+		return (key);
+	}
+
+	std::string line;
+	std::getline(this->_keyListFile, line);
+	if (this->_keyListFile.eof())
+		throw (Error::ObjectDoesNotExist("No record at position"));
+	return (Text::trimWhitespace(line));
+}
+
+void
+BiometricEvaluation::IO::ListRecordStore::Impl::Cursor::setCursorAtKey(
+    const std::string &key)
+{
+	/* Sequence until we find the key */
+	const std::string searchKey{Text::trimWhitespace(key)};
+	std::string sequencedKey;
+	try {
+		sequencedKey = this->sequenceKey(BE_RECSTORE_SEQ_START);
+		while (sequencedKey != searchKey)
+			sequencedKey = this->sequenceKey();
+	} catch (const Error::ObjectDoesNotExist&) {
+		throw Error::ObjectDoesNotExist(key);
+	}
+	this->_pendingKey = sequencedKey;
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::ListRecordStore::Impl::Cursor::read(
+    const std::string &key)
+    const
+{
+	return (this->_source->read(key));
+}
+
+uint64_t
+BiometricEvaluation::IO::ListRecordStore::Impl::Cursor::length(
+    const std::string &key)
+    const
+{
+	return (this->_source->length(key));
+}
+
 uint64_t
 BiometricEvaluation::IO::ListRecordStore::Impl::getSpaceUsed()
     const
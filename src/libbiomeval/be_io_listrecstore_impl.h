@@ -11,7 +11,9 @@
 #ifndef __BE_IO_LISTRECSTORE_IMPL_H__
 #define __BE_IO_LISTRECSTORE_IMPL_H__
 
+#include <fstream>
 #include <list>
+#include <memory>
 
 #include <be_io_listrecstore.h>
 #include "be_io_recordstore_impl.h"
@@ -53,6 +55,68 @@ namespace BiometricEvaluation
 			void
 			setCursorAtKey(const std::string &key);
 
+			/**
+			 * A RecordStore::Cursor with its own stream of the
+			 * key list, reading through a Cursor of the source
+			 * RecordStore.
+			 */
+			class Cursor : public RecordStore::Cursor
+			{
+			public:
+				/**
+				 * @param store
+				 *	Store to read.
+				 *
+				 * @throw Error::NotImplemented
+				 *	Source store does not support Cursors.
+				 * @throw Error::StrategyError
+				 *	Could not open the key list.
+				 */
+				Cursor(
+				    const ListRecordStore::Impl &store);
+
+				RecordStore::Record
+				sequence(
+				    int cursor = BE_RECSTORE_SEQ_NEXT)
+				    override;
+
+				std::string
+				sequenceKey(
+				    int cursor = BE_RECSTORE_SEQ_NEXT)
+				    override;
+
+				void
+				setCursorAtKey(
+				    const std::string &key)
+				    override;
+
+				Memory::uint8Array
+				read(
+				    const std::string &key)
+				    const
+				    override;
+
+				uint64_t
+				length(
+				    const std::string &key)
+				    const
+				    override;
+
+			private:
+				/** Path to the key list */
+				const std::string _keyListPath;
+				/** Key list */
+				std::ifstream _keyListFile;
+				/** Cursor over the source RecordStore */
+				std::unique_ptr<RecordStore::Cursor> _source;
+				/** Key found by setCursorAtKey(), if any */
+				std::string _pendingKey{};
+			};
+
+			std::unique_ptr<RecordStore::Cursor>
+			makeReader()
+			    const;
+
 			uint64_t
 			getSpaceUsed() const;
 
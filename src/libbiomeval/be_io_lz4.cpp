@@ -0,0 +1,189 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifdef BIOMEVAL_WITH_LZ4
+
+#include <algorithm>
+
+#include <lz4frame.h>
+
+#include <be_io_lz4.h>
+
+namespace BE = BiometricEvaluation;
+
+const std::string
+    BiometricEvaluation::IO::LZ4::COMPRESSION_LEVEL = "CompressionLevel";
+
+namespace
+{
+	/** Per-thread decompression context, reused for every frame */
+	struct LZ4Context
+	{
+		LZ4F_dctx *dctx{nullptr};
+
+		~LZ4Context()
+		{
+			if (this->dctx != nullptr)
+				LZ4F_freeDecompressionContext(this->dctx);
+		}
+	};
+	thread_local LZ4Context context;
+
+	/* Context is reset, ready for a new frame */
+	LZ4F_dctx*
+	decompressionContext()
+	{
+		if (context.dctx == nullptr) {
+			if (LZ4F_isError(LZ4F_createDecompressionContext(
+			    &context.dctx, LZ4F_VERSION)))
+				throw BE::Error::StrategyError("Could not "
+				    "create decompression context");
+		} else {
+			LZ4F_resetDecompressionContext(context.dctx);
+		}
+		return (context.dctx);
+	}
+
+	std::string
+	errorString(
+	    size_t rv)
+	{
+		return (std::string(LZ4F_getErrorName(rv)));
+	}
+}
+
+BiometricEvaluation::IO::LZ4::LZ4() :
+    BiometricEvaluation::IO::Compressor()
+{
+	this->setOption(COMPRESSION_LEVEL, 0);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::LZ4::compress(
+    const uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	LZ4F_preferences_t preferences{};
+	preferences.frameInfo.contentSize = uncompressedDataSize;
+	preferences.compressionLevel = static_cast<int>(
+	    this->getOptionAsInteger(COMPRESSION_LEVEL));
+
+	Memory::uint8Array compressedData(LZ4F_compressFrameBound(
+	    uncompressedDataSize, &preferences));
+	const size_t rv = LZ4F_compressFrame(compressedData,
+	    compressedData.size(), uncompressedData, uncompressedDataSize,
+	    &preferences);
+	if (LZ4F_isError(rv))
+		throw Error::StrategyError("Could not compress: " +
+		    errorString(rv));
+
+	/* Resize output buffer's size parameter to match the actual size */
+	compressedData.resize(rv);
+	return (compressedData);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::LZ4::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize)
+    const
+{
+	LZ4F_dctx *dctx = decompressionContext();
+	LZ4F_frameInfo_t frameInfo{};
+	size_t inAvail = compressedDataSize;
+	size_t hint = LZ4F_getFrameInfo(dctx, &frameInfo, compressedData,
+	    &inAvail);
+	if (LZ4F_isError(hint))
+		throw Error::StrategyError("Not an LZ4 frame: " +
+		    errorString(hint));
+	if (frameInfo.contentSize != 0)
+		return (Compressor::decompress(compressedData,
+		    compressedDataSize, frameInfo.contentSize));
+
+	/* Size not recorded: grow geometrically while decompressing */
+	Memory::uint8Array uncompressedData(std::max<uint64_t>(
+	    compressedDataSize * 2, 65536));
+	uint64_t inPos = inAvail, outPos = 0;
+	while (hint != 0) {
+		if (outPos == uncompressedData.size())
+			uncompressedData.resize(uncompressedData.size() * 2);
+
+		inAvail = compressedDataSize - inPos;
+		size_t outAvail = uncompressedData.size() - outPos;
+		hint = LZ4F_decompress(dctx, uncompressedData + outPos,
+		    &outAvail, compressedData + inPos, &inAvail, nullptr);
+		if (LZ4F_isError(hint))
+			throw Error::StrategyError("Could not decompress: " +
+			    errorString(hint));
+		inPos += inAvail;
+		outPos += outAvail;
+
+		if ((hint != 0) && (inPos == compressedDataSize) &&
+		    (outPos < uncompressedData.size()))
+			throw Error::StrategyError("Compressed data is "
+			    "truncated");
+	}
+	if (inPos != compressedDataSize)
+		throw Error::StrategyError("Compressed data remains after "
+		    "decompressing");
+
+	uncompressedData.resize(outPos);
+	return (uncompressedData);
+}
+
+void
+BiometricEvaluation::IO::LZ4::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	LZ4F_dctx *dctx = decompressionContext();
+
+	uint64_t inPos = 0, outPos = 0;
+	size_t hint;
+	do {
+		size_t inAvail = compressedDataSize - inPos;
+		size_t outAvail = uncompressedDataSize - outPos;
+		hint = LZ4F_decompress(dctx, uncompressedData + outPos,
+		    &outAvail, compressedData + inPos, &inAvail, nullptr);
+		if (LZ4F_isError(hint))
+			throw Error::StrategyError("Could not decompress: " +
+			    errorString(hint));
+		inPos += inAvail;
+		outPos += outAvail;
+
+		/* No progress possible */
+		if ((hint != 0) && (inAvail == 0) && (outAvail == 0)) {
+			if (outPos == uncompressedDataSize)
+				throw Error::StrategyError("Decompressed data "
+				    "is larger than expected size");
+			throw Error::StrategyError("Compressed data is "
+			    "truncated");
+		}
+	} while (hint != 0);
+
+	/* Sanity check */
+	if (inPos != compressedDataSize)
+		throw Error::StrategyError("Compressed data remains after "
+		    "decompressing");
+	if (outPos != uncompressedDataSize)
+		throw Error::StrategyError("Decompressed data is smaller "
+		    "than expected size");
+}
+
+BiometricEvaluation::IO::LZ4::~LZ4()
+{
+
+}
+
+#endif /* BIOMEVAL_WITH_LZ4 */
@@ -77,6 +77,38 @@ BiometricEvaluation::IO::RecordStore::replace(
 	this->insert(key, data, size);
 }
 
+void
+BiometricEvaluation::IO::RecordStore::beginBulk()
+{
+}
+
+void
+BiometricEvaluation::IO::RecordStore::commitBulk()
+{
+}
+
+void
+BiometricEvaluation::IO::RecordStore::insertBatch(
+    const std::vector<Record> &records)
+{
+	this->beginBulk();
+	try {
+		for (const auto &record : records)
+			this->insert(record.key, record.data);
+	} catch (...) {
+		this->commitBulk();
+		throw;
+	}
+	this->commitBulk();
+}
+
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::RecordStore::makeReader()
+    const
+{
+	throw Error::NotImplemented("Cursors");
+}
+
 bool
 BiometricEvaluation::IO::RecordStore::containsKey(
     const std::string &key) const
@@ -132,7 +164,21 @@ BiometricEvaluation::IO::RecordStore::mergeRecordStores(
     const std::function<bool()> &interrupt)
 {
 	return (IO::RecordStore::Impl::mergeRecordStores(
-	    mergePathname, description, kind, pathnames, interrupt));
+	    mergePathname, description, kind, pathnames,
+	    MergeOrder::Unordered, interrupt));
+}
+
+void
+BiometricEvaluation::IO::RecordStore::mergeRecordStores(
+    const std::string &mergePathname,
+    const std::string &description,
+    const RecordStore::Kind &kind,
+    const std::vector<std::string> &pathnames,
+    const MergeOrder order,
+    const std::function<bool()> &interrupt)
+{
+	return (IO::RecordStore::Impl::mergeRecordStores(
+	    mergePathname, description, kind, pathnames, order, interrupt));
 }
 
 BiometricEvaluation::IO::RecordStore::iterator
@@ -222,12 +268,21 @@ BiometricEvaluation::IO::RecordStoreIterator::operator==(
 void
 BiometricEvaluation::IO::RecordStoreIterator::setBegin()
 {
+	/* A new Cursor starts at the beginning */
 	try {
-		std::string key = this->_recordStore->sequenceKey(
-		     RecordStore::BE_RECSTORE_SEQ_START);
-		this->_recordStore->setCursorAtKey(key);
-	} catch (const Error::ObjectDoesNotExist&) {
-		this->setEnd();
+		this->_cursor = this->_recordStore->makeReader();
+	} catch (const Error::Exception&) {
+		this->_cursor.reset();
+	}
+
+	if (this->_cursor == nullptr) {
+		try {
+			std::string key = this->_recordStore->sequenceKey(
+			     RecordStore::BE_RECSTORE_SEQ_START);
+			this->_recordStore->setCursorAtKey(key);
+		} catch (const Error::ObjectDoesNotExist&) {
+			this->setEnd();
+		}
 	}
 
 	this->step(1);
@@ -244,7 +299,12 @@ BiometricEvaluation::IO::RecordStoreIterator::step(
 	/* Forward one step */
 	if (numSteps == 1) {
 		try {
-			this->_currentRecord = this->_recordStore->sequence();
+			if (this->_cursor != nullptr)
+				this->_currentRecord =
+				    this->_cursor->sequence();
+			else
+				this->_currentRecord =
+				    this->_recordStore->sequence();
 		} catch (const Error::ObjectDoesNotExist&) {
 			this->setEnd();
 		}
@@ -255,7 +315,10 @@ BiometricEvaluation::IO::RecordStoreIterator::step(
 	std::string key;
 	for (difference_type i = 0; i < numSteps; i++) {
 		try {
-			key = this->_recordStore->sequenceKey();
+			if (this->_cursor != nullptr)
+				key = this->_cursor->sequenceKey();
+			else
+				key = this->_recordStore->sequenceKey();
 		} catch (const Error::ObjectDoesNotExist&) {
 			this->setEnd();
 			return;
@@ -263,7 +326,10 @@ BiometricEvaluation::IO::RecordStoreIterator::step(
 	}
 
 	Memory::uint8Array data;
-	data = this->_recordStore->read(key);
+	if (this->_cursor != nullptr)
+		data = this->_cursor->read(key);
+	else
+		data = this->_recordStore->read(key);
 	this->_currentRecord = RecordStore::Record(key, data);
 }
 
@@ -13,9 +13,17 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <queue>
 #include <sstream>
+#include <thread>
 
 #include <be_error.h>
 #include <be_error_exception.h>
@@ -32,6 +40,7 @@
 #include <be_io_utility.h>
 #include <be_memory_autoarray.h>
 #include <be_sysdeps.h>
+#include <be_system.h>
 
 
 namespace BE = BiometricEvaluation;
@@ -84,7 +93,9 @@ BiometricEvaluation::IO::RecordStore::Impl::Impl(
     const BE::IO::RecordStore::Kind &kind) :
     _pathname(pathname),
     _cursor(RecordStore::BE_RECSTORE_SEQ_START),
-    _mode(IO::Mode::ReadWrite)
+    _mode(IO::Mode::ReadWrite),
+    _inBulk(false),
+    _bulkCountDelta(0)
 {
 	if (IO::Utility::fileExists(pathname))
 		throw Error::ObjectExists(pathname + " already exists");
@@ -113,7 +124,9 @@ BiometricEvaluation::IO::RecordStore::Impl::Impl(
     IO::Mode mode) :
     _pathname(pathname),
     _cursor(RecordStore::BE_RECSTORE_SEQ_START),
-    _mode(mode)
+    _mode(mode),
+    _inBulk(false),
+    _bulkCountDelta(0)
 {
 	if (!IO::Utility::fileExists(pathname))
 		throw Error::ObjectDoesNotExist("Could not find " + pathname);
@@ -130,9 +143,19 @@ BiometricEvaluation::IO::RecordStore::Impl::Impl(
 }
 
 /*
- * Destructor for the abstract class; required empty implementaton.
+ * Destructor for the abstract class. A record count deferred by an
+ * uncommitted bulk update is written before the control file is closed,
+ * on a best-effort basis, since a destructor must not throw.
  */
-BiometricEvaluation::IO::RecordStore::Impl::~Impl() { }
+BiometricEvaluation::IO::RecordStore::Impl::~Impl()
+{
+	if (_inBulk && (_props != nullptr)) {
+		try {
+			_props->setPropertyFromInteger(COUNTPROPERTY,
+			    this->getCount());
+		} catch (...) {}
+	}
+}
 
 /******************************************************************************/
 /* Common public methods implementations.                                     */
@@ -151,14 +174,51 @@ BiometricEvaluation::IO::RecordStore::Impl::insert(
     const void *const data,
     const uint64_t size)
 {
-	_props->setPropertyFromInteger(COUNTPROPERTY, this->getCount() + 1);
+	if (_inBulk)
+		_bulkCountDelta++;
+	else
+		_props->setPropertyFromInteger(COUNTPROPERTY,
+		    this->getCount() + 1);
 }
 
 void
 BiometricEvaluation::IO::RecordStore::Impl::remove(
     const std::string &key)
 {
-	_props->setPropertyFromInteger(COUNTPROPERTY, this->getCount() - 1);
+	if (_inBulk)
+		_bulkCountDelta--;
+	else
+		_props->setPropertyFromInteger(COUNTPROPERTY,
+		    this->getCount() - 1);
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::beginBulk()
+{
+	if (_mode == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+	if (_inBulk)
+		throw Error::StrategyError("Bulk update already in progress");
+
+	_inBulk = true;
+	_bulkCountDelta = 0;
+}
+
+void
+BiometricEvaluation::IO::RecordStore::Impl::commitBulk()
+{
+	if (!_inBulk)
+		throw Error::StrategyError("No bulk update in progress");
+
+	_props->setPropertyFromInteger(COUNTPROPERTY, this->getCount());
+	_bulkCountDelta = 0;
+	_inBulk = false;
+}
+
+bool
+BiometricEvaluation::IO::RecordStore::Impl::inBulk() const
+{
+	return (_inBulk);
 }
 
 int
@@ -190,6 +250,11 @@ BiometricEvaluation::IO::RecordStore::Impl::sync() const
 		return;
 
 	try {
+		if (_bulkCountDelta != 0) {
+			_props->setPropertyFromInteger(COUNTPROPERTY,
+			    this->getCount());
+			_bulkCountDelta = 0;
+		}
 		_props->sync();
 	} catch (const Error::Exception& e) {
 		throw Error::StrategyError(e.whatString());
@@ -199,7 +264,7 @@ BiometricEvaluation::IO::RecordStore::Impl::sync() const
 unsigned int
 BiometricEvaluation::IO::RecordStore::Impl::getCount() const
 {
-	return (_props->getPropertyAsInteger(COUNTPROPERTY));
+	return (_props->getPropertyAsInteger(COUNTPROPERTY) + _bulkCountDelta);
 }
 
 std::string
@@ -387,12 +452,519 @@ BiometricEvaluation::IO::RecordStore::Impl::removeRecordStore(
 	}
 }
 
+namespace
+{
+	/** Records handed from a reading thread to the merging thread */
+	using MergeBatch = std::vector<BE::IO::RecordStore::Record>;
+
+	/** Most records in a MergeBatch */
+	const size_t MERGEBATCHRECORDS = 1024;
+	/** Most bytes of record data in a MergeBatch */
+	const uint64_t MERGEBATCHBYTES = 4 * 1024 * 1024;
+	/** MergeBatches each reading thread may have waiting */
+	const size_t MERGEQUEUEDEPTH = 4;
+
+	/** Bounded queue of MergeBatches between threads */
+	class MergeQueue
+	{
+	public:
+		MergeQueue(
+		    size_t capacity,
+		    size_t producers) :
+		    _capacity(capacity),
+		    _producers(producers)
+		{
+
+		}
+
+		/*
+		 * Wait for room and enqueue batch.
+		 * Returns false if the queue was cancelled.
+		 */
+		bool
+		push(
+		    MergeBatch &&batch)
+		{
+			std::unique_lock<std::mutex> lock(this->_mutex);
+			this->_notFull.wait(lock, [&]() {
+			    return (this->_cancelled ||
+			    (this->_batches.size() < this->_capacity)); });
+			if (this->_cancelled)
+				return (false);
+			this->_batches.push_back(std::move(batch));
+			this->_notEmpty.notify_one();
+			return (true);
+		}
+
+		/*
+		 * Wait for and dequeue a batch. Returns false if the
+		 * queue was cancelled, or if it is empty and all
+		 * producers are done.
+		 */
+		bool
+		pop(
+		    MergeBatch &batch)
+		{
+			std::unique_lock<std::mutex> lock(this->_mutex);
+			this->_notEmpty.wait(lock, [&]() {
+			    return (this->_cancelled ||
+			    !this->_batches.empty() ||
+			    (this->_producers == 0)); });
+			if (this->_cancelled || this->_batches.empty())
+				return (false);
+			batch = std::move(this->_batches.front());
+			this->_batches.pop_front();
+			this->_notFull.notify_one();
+			return (true);
+		}
+
+		void
+		producerDone()
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			this->_producers--;
+			this->_notEmpty.notify_all();
+		}
+
+		void
+		cancel()
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			this->_cancelled = true;
+			this->_notFull.notify_all();
+			this->_notEmpty.notify_all();
+		}
+
+	private:
+		std::mutex _mutex{};
+		std::condition_variable _notFull{};
+		std::condition_variable _notEmpty{};
+		std::deque<MergeBatch> _batches{};
+		const size_t _capacity;
+		size_t _producers;
+		bool _cancelled{false};
+	};
+
+	/** First exception raised by any reading thread */
+	class MergeErrors
+	{
+	public:
+		void
+		set(
+		    std::exception_ptr error)
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			if (this->_error == nullptr)
+				this->_error = error;
+		}
+
+		void
+		rethrow()
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			if (this->_error != nullptr)
+				std::rethrow_exception(this->_error);
+		}
+
+	private:
+		std::mutex _mutex{};
+		std::exception_ptr _error{};
+	};
+
+	/*
+	 * The records of a RecordStore to merge, read a batch at a time,
+	 * in key order when sorted is true. The store is opened when the
+	 * first batch is read.
+	 */
+	class MergeSource
+	{
+	public:
+		MergeSource(
+		    const std::string &pathname,
+		    bool sorted) :
+		    _pathname(pathname),
+		    _sorted(sorted)
+		{
+
+		}
+
+		/*
+		 * Read the next batch of records. Returns false once
+		 * every record has been read.
+		 */
+		bool
+		next(
+		    MergeBatch &batch)
+		{
+			if (this->_done)
+				return (false);
+			if (this->_rs == nullptr)
+				this->open();
+
+			uint64_t batchBytes = 0;
+			while ((batch.size() < MERGEBATCHRECORDS) &&
+			    (batchBytes < MERGEBATCHBYTES)) {
+				BE::IO::RecordStore::Record record;
+				if (this->_streamed) {
+					try {
+						record = this->_rs->sequence(
+						    this->_cursor);
+					} catch (const BE::Error::
+					    ObjectDoesNotExist&) {
+						this->_done = true;
+						break;
+					}
+					this->_cursor = BE::IO::RecordStore::
+					    BE_RECSTORE_SEQ_NEXT;
+				} else {
+					if (this->_nextKey ==
+					    this->_keys.size()) {
+						this->_done = true;
+						break;
+					}
+					record.key =
+					    this->_keys[this->_nextKey++];
+					record.data = this->_rs->read(
+					    record.key);
+				}
+
+				batchBytes += record.data.size();
+				batch.push_back(std::move(record));
+			}
+			return (!batch.empty());
+		}
+
+	private:
+		void
+		open()
+		{
+			try {
+				this->_rs = BE::IO::RecordStore::
+				    openRecordStore(this->_pathname,
+				    BE::IO::Mode::ReadOnly);
+			} catch (const BE::Error::Exception &e) {
+				throw BE::Error::StrategyError(
+				    e.whatString());
+			}
+
+			/*
+			 * Stores that sequence keys in order are streamed,
+			 * others are read by key once their keys are sorted.
+			 */
+			if (this->_sorted) {
+				try {
+					for (;;)
+						this->_keys.push_back(
+						    this->_rs->sequenceKey());
+				} catch (const BE::Error::ObjectDoesNotExist&) {}
+				if (std::is_sorted(this->_keys.begin(),
+				    this->_keys.end()))
+					this->_keys.clear();
+				else
+					std::sort(this->_keys.begin(),
+					    this->_keys.end());
+			}
+			this->_streamed = this->_keys.empty();
+		}
+
+		const std::string _pathname;
+		const bool _sorted;
+		std::shared_ptr<BE::IO::RecordStore> _rs{};
+		std::vector<std::string> _keys{};
+		bool _streamed{true};
+		int _cursor{BE::IO::RecordStore::BE_RECSTORE_SEQ_START};
+		size_t _nextKey{0};
+		bool _done{false};
+	};
+
+	/* Number of threads to read sourceCount RecordStores */
+	uint32_t
+	mergeReaderCount(
+	    size_t sourceCount)
+	{
+		uint32_t readerCount = 1;
+		try {
+			readerCount = BE::System::getCPUCount();
+		} catch (const BE::Error::NotImplemented&) {}
+		return (std::max<uint32_t>(1, std::min<uint64_t>(readerCount,
+		    sourceCount)));
+	}
+
+	/*
+	 * Read every record of a RecordStore into batches on queue.
+	 * Any error is recorded in errors and cancels queue. Returns
+	 * false if reading was stopped early.
+	 */
+	bool
+	readMergeSource(
+	    const std::string &pathname,
+	    MergeQueue &queue,
+	    MergeErrors &errors)
+	{
+		try {
+			MergeSource source(pathname, false);
+			MergeBatch batch;
+			while (source.next(batch)) {
+				if (!queue.push(std::move(batch)))
+					return (false);
+				batch = MergeBatch();
+			}
+		} catch (...) {
+			errors.set(std::current_exception());
+			queue.cancel();
+			return (false);
+		}
+		return (true);
+	}
+
+	/*
+	 * Read RecordStores in key order for a k-way merge, with no more
+	 * threads than processors. Each source has its own queue, and a
+	 * batch is read for a source only when its queue has room for it,
+	 * so no reading thread waits on one source while the merge waits
+	 * on another.
+	 */
+	class SortedMergeReaders
+	{
+	public:
+		SortedMergeReaders(
+		    const std::vector<std::string> &pathnames,
+		    MergeErrors &errors) :
+		    _errors(errors),
+		    _requests(pathnames.size(), 0),
+		    _finished(pathnames.size(), false)
+		{
+			for (const auto &pathname : pathnames) {
+				this->_sources.emplace_back(new MergeSource(
+				    pathname, true));
+				this->_queues.emplace_back(new MergeQueue(
+				    MERGEQUEUEDEPTH, 1));
+			}
+			for (size_t i = 0; i < MERGEQUEUEDEPTH; i++)
+				for (size_t source = 0;
+				    source < pathnames.size(); source++)
+					this->request(source);
+
+			const uint32_t readerCount = mergeReaderCount(
+			    pathnames.size());
+			for (uint32_t i = 0; i < readerCount; i++)
+				this->_readers.emplace_back([this]() {
+					this->read();
+				});
+		}
+
+		~SortedMergeReaders()
+		{
+			this->stop();
+		}
+
+		size_t
+		size()
+		    const
+		{
+			return (this->_sources.size());
+		}
+
+		/*
+		 * Wait for the next batch of source. Returns false once
+		 * all of its records have been read, or on error.
+		 */
+		bool
+		pop(
+		    size_t source,
+		    MergeBatch &batch)
+		{
+			if (!this->_queues[source]->pop(batch))
+				return (false);
+			this->request(source);
+			return (true);
+		}
+
+		/* Stop reading and wait for the reading threads */
+		void
+		stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(this->_mutex);
+				this->_stopped = true;
+				this->_ready.notify_all();
+			}
+			for (auto &queue : this->_queues)
+				queue->cancel();
+			for (auto &reader : this->_readers)
+				reader.join();
+			this->_readers.clear();
+		}
+
+	private:
+		/*
+		 * Ask for another batch of source. Sources with requests
+		 * outstanding are on the ready list at most once, so only
+		 * one thread reads a source at a time.
+		 */
+		void
+		request(
+		    size_t source)
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex);
+			if (this->_finished[source])
+				return;
+			if (this->_requests[source]++ == 0) {
+				this->_readySources.push_back(source);
+				this->_ready.notify_one();
+			}
+		}
+
+		/* Read one batch at a time for each ready source */
+		void
+		read()
+		{
+			for (;;) {
+				size_t source;
+				{
+					std::unique_lock<std::mutex> lock(
+					    this->_mutex);
+					this->_ready.wait(lock, [&]() {
+					    return (this->_stopped ||
+					    !this->_readySources.empty()); });
+					if (this->_stopped)
+						return;
+					source = this->_readySources.front();
+					this->_readySources.pop_front();
+				}
+
+				const bool more = this->readBatch(source);
+
+				std::lock_guard<std::mutex> lock(this->_mutex);
+				if (!more) {
+					this->_finished[source] = true;
+					this->_requests[source] = 0;
+				} else if (--this->_requests[source] != 0) {
+					this->_readySources.push_back(source);
+					this->_ready.notify_one();
+				}
+			}
+		}
+
+		/*
+		 * Read a batch of source onto its queue, which has room.
+		 * Returns false once the source has no more records.
+		 */
+		bool
+		readBatch(
+		    size_t source)
+		{
+			MergeQueue &queue = *this->_queues[source];
+			try {
+				MergeBatch batch;
+				if (this->_sources[source]->next(batch) &&
+				    queue.push(std::move(batch)))
+					return (true);
+			} catch (...) {
+				this->_errors.set(std::current_exception());
+				queue.cancel();
+			}
+			/* Close the store once it has been read */
+			this->_sources[source].reset();
+			queue.producerDone();
+			return (false);
+		}
+
+		MergeErrors &_errors;
+		std::vector<std::unique_ptr<MergeSource>> _sources{};
+		std::vector<std::unique_ptr<MergeQueue>> _queues{};
+
+		/** Protects the members below */
+		std::mutex _mutex{};
+		std::condition_variable _ready{};
+		/** Sources with batches requested, in request order */
+		std::deque<size_t> _readySources{};
+		/** Batches requested of each source */
+		std::vector<size_t> _requests;
+		std::vector<bool> _finished;
+		bool _stopped{false};
+
+		std::vector<std::thread> _readers{};
+	};
+
+	/* Insert batches in the order they are read */
+	void
+	insertUnordered(
+	    BE::IO::RecordStore &rs,
+	    MergeQueue &queue,
+	    MergeErrors &errors,
+	    const std::function<bool()> &interrupt)
+	{
+		MergeBatch batch;
+		while (!interrupt() && queue.pop(batch))
+			for (const auto &record : batch)
+				rs.insert(record.key, record.data);
+		errors.rethrow();
+	}
+
+	/* Insert the records of every source in key order (k-way merge) */
+	void
+	insertSorted(
+	    BE::IO::RecordStore &rs,
+	    SortedMergeReaders &readers,
+	    MergeErrors &errors,
+	    const std::function<bool()> &interrupt)
+	{
+		/* Batch currently being merged from each source */
+		std::vector<MergeBatch> batches(readers.size());
+		std::vector<size_t> positions(readers.size(), 0);
+		const auto nextKey = [&](size_t source) -> const std::string& {
+			return (batches[source][positions[source]].key);
+		};
+		const auto later = [&](size_t lhs, size_t rhs) {
+			return (nextKey(lhs) > nextKey(rhs));
+		};
+		std::priority_queue<size_t, std::vector<size_t>,
+		    decltype(later)> sources(later);
+
+		/* Move to the next record of source, if there is one */
+		const auto advance = [&](size_t source) {
+			if (++positions[source] < batches[source].size())
+				return (true);
+			positions[source] = 0;
+			if (readers.pop(source, batches[source]))
+				return (true);
+			errors.rethrow();
+			return (false);
+		};
+
+		for (size_t i = 0; i < readers.size(); i++) {
+			if (readers.pop(i, batches[i]))
+				sources.push(i);
+			else
+				errors.rethrow();
+		}
+
+		uint64_t inserted = 0;
+		while (!sources.empty()) {
+			const size_t source = sources.top();
+			sources.pop();
+			const BE::IO::RecordStore::Record &record =
+			    batches[source][positions[source]];
+			rs.insert(record.key, record.data);
+			if (advance(source))
+				sources.push(source);
+
+			if (((++inserted % MERGEBATCHRECORDS) == 0) &&
+			    interrupt())
+				return;
+		}
+		errors.rethrow();
+	}
+}
+
 void
 BiometricEvaluation::IO::RecordStore::Impl::mergeRecordStores(
     const std::string &mergePathname,
     const std::string &description,
     const RecordStore::Kind &kind,
     const std::vector<std::string> &pathnames,
+    const RecordStore::MergeOrder order,
     const std::function<bool()> &interrupt)
 {
 	std::shared_ptr<RecordStore> merged_rs;
@@ -412,29 +984,74 @@ BiometricEvaluation::IO::RecordStore::Impl::mergeRecordStores(
 		case BiometricEvaluation::IO::RecordStore::Kind::Compressed:
 			throw Error::StrategyError("Invalid RecordStore type");
 	}
+	if (pathnames.empty())
+		return;
 
-	std::shared_ptr<RecordStore> rs;
-	RecordStore::Record record;
-	for (uint32_t i = 0; i < pathnames.size(); i++) {
-		try {
-			rs = openRecordStore(pathnames[i], Mode::ReadOnly);
-		} catch (const Error::Exception &e) {
-			throw Error::StrategyError(e.whatString());
-		}
-	
-		while (true) {
-			try {
-				if (interrupt()) {
-					break;
+	/*
+	 * Sources are read by no more threads than processors into
+	 * bounded queues of batches, which are drained into the merged
+	 * store by this thread. Unordered merges share one queue between
+	 * the reading threads. Sorted merges need the next record of
+	 * every source, so each source has a queue of its own, filled as
+	 * the merge empties it.
+	 */
+	MergeErrors errors;
+	std::unique_ptr<MergeQueue> queue;
+	std::unique_ptr<SortedMergeReaders> sortedReaders;
+	std::vector<std::thread> readers;
+	std::atomic<size_t> nextSource{0};
+	if (order == RecordStore::MergeOrder::Sorted) {
+		sortedReaders.reset(new SortedMergeReaders(pathnames,
+		    errors));
+	} else {
+		const uint32_t readerCount = mergeReaderCount(
+		    pathnames.size());
+		queue.reset(new MergeQueue(readerCount * MERGEQUEUEDEPTH,
+		    readerCount));
+		for (uint32_t i = 0; i < readerCount; i++) {
+			readers.emplace_back([&]() {
+				size_t source;
+				while ((source = nextSource++) <
+				    pathnames.size()) {
+					if (!readMergeSource(pathnames[source],
+					    *queue, errors))
+						break;
 				}
-				record = rs->sequence();
-				merged_rs->insert(record.key, record.data);
-			} catch (const Error::ObjectDoesNotExist&) {
-				break;
-			}
+				queue->producerDone();
+			});
 		}
 	}
+
+	/* Readers must be stopped before leaving, however we leave */
+	const auto stopReaders = [&]() {
+		if (sortedReaders != nullptr)
+			sortedReaders->stop();
+		if (queue != nullptr)
+			queue->cancel();
+		for (auto &reader : readers)
+			reader.join();
+		readers.clear();
+	};
+
+	try {
+		merged_rs->beginBulk();
+		if (order == RecordStore::MergeOrder::Sorted)
+			insertSorted(*merged_rs, *sortedReaders, errors,
+			    interrupt);
+		else
+			insertUnordered(*merged_rs, *queue, errors,
+			    interrupt);
+	} catch (...) {
+		stopReaders();
+		try {
+			merged_rs->commitBulk();
+		} catch (const Error::Exception&) {}
+		throw;
+	}
+	stopReaders();
+	merged_rs->commitBulk();
 }
+
 /******************************************************************************/
 /* Common protected method implementations.                                   */
 /******************************************************************************/
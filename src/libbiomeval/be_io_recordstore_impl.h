@@ -145,6 +145,33 @@ namespace BiometricEvaluation {
 			void remove(
 			    const std::string &key);
 
+			/**
+			 * @brief
+			 * Begin a bulk update, deferring updates of the
+			 * record count until commitBulk().
+			 *
+			 * @throw Error::StrategyError
+			 *	The RecordStore was opened read-only, or a
+			 *	bulk update is already in progress.
+			 */
+			void beginBulk();
+
+			/**
+			 * @brief
+			 * Complete a bulk update, writing the record
+			 * count once.
+			 *
+			 * @throw Error::StrategyError
+			 *	No bulk update is in progress.
+			 */
+			void commitBulk();
+
+			/**
+			 * @return
+			 *	Whether a bulk update is in progress.
+			 */
+			bool inBulk() const;
+
 			/**
 			 * @brief
 			 * Determine if a location appears to be a RecordStore.
@@ -250,12 +277,16 @@ namespace BiometricEvaluation {
 			 *	Vector of path names to RecordStores to open.
 			 *	These are the RecordStores that will be merged
 			 *	to create the new RecordStore.
+			 * @param[in] order
+			 *	Order in which records are inserted.
 			 * @param[in] interrupt
-			 *	A function to be called during long operations
-			 *	to determine whether to interrupt and return.
+			 *	A function to be called after each batch of
+			 *	records is inserted to determine whether to
+			 *	interrupt and return.
 			 *
 			 * @throw Error::ObjectExists
-			 *	A RecordStore at mergePathname already exists.
+			 *	A RecordStore at mergePathname already exists,
+			 *	or a key exists in more than one RecordStore.
 			 * @throw Error::StrategyError
 			 *	An error occurred when using the underlying
 			 *	storage system.
@@ -265,6 +296,8 @@ namespace BiometricEvaluation {
 			    const std::string &description,
 			    const IO::RecordStore::Kind &kind,
 			    const std::vector<std::string> &pathnames,
+			    const RecordStore::MergeOrder order =
+				RecordStore::MergeOrder::Unordered,
 			    const std::function<bool()> &interrupt = 
 				[]() {return (false);});
 
@@ -403,6 +436,15 @@ namespace BiometricEvaluation {
 			 * Mode in which the RecordStore was opened.
 			 */
 			BiometricEvaluation::IO::Mode _mode;
+
+			/* Whether a bulk update is in progress */
+			bool _inBulk;
+
+			/*
+			 * Change in the record count not yet written to the
+			 * control file during a bulk update.
+			 */
+			mutable int64_t _bulkCountDelta;
 			
 			/**
 			 * @brief
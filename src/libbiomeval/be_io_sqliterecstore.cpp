@@ -12,6 +12,13 @@
 
 namespace BE = BiometricEvaluation;
 
+const std::string BiometricEvaluation::IO::SQLiteRecordStore::
+    JOURNAL_MODE_PROPERTY{"SQLite_Journal_Mode"};
+const std::string BiometricEvaluation::IO::SQLiteRecordStore::
+    MMAP_SIZE_PROPERTY{"SQLite_MMap_Size"};
+const std::string BiometricEvaluation::IO::SQLiteRecordStore::
+    CACHE_SIZE_PROPERTY{"SQLite_Cache_Size"};
+
 BiometricEvaluation::IO::SQLiteRecordStore::SQLiteRecordStore(
     const std::string &pathname,
     const std::string &description)
@@ -37,6 +44,20 @@ BiometricEvaluation::IO::SQLiteRecordStore::~SQLiteRecordStore()
 {
 }
 
+void
+BiometricEvaluation::IO::SQLiteRecordStore::setPragmaProfile(
+    const PragmaProfile &profile)
+{
+	this->pimpl->setPragmaProfile(profile);
+}
+
+BiometricEvaluation::IO::SQLiteRecordStore::PragmaProfile
+BiometricEvaluation::IO::SQLiteRecordStore::getPragmaProfile()
+    const
+{
+	return (this->pimpl->getPragmaProfile());
+}
+
 void
 BiometricEvaluation::IO::SQLiteRecordStore::move(const std::string &pathname)
 { 
@@ -57,6 +78,18 @@ BiometricEvaluation::IO::SQLiteRecordStore::sync()
 	this->pimpl->sync();
 }
 
+void
+BiometricEvaluation::IO::SQLiteRecordStore::beginBulk()
+{
+	this->pimpl->beginBulk();
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::commitBulk()
+{
+	this->pimpl->commitBulk();
+}
+
 void
 BiometricEvaluation::IO::SQLiteRecordStore::insert( 
     const std::string &key,
@@ -118,6 +151,13 @@ BiometricEvaluation::IO::SQLiteRecordStore::setCursorAtKey(
 	this->pimpl->setCursorAtKey(key);
 }
 
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::SQLiteRecordStore::makeReader()
+    const
+{
+	return (this->pimpl->makeReader());
+}
+
 unsigned int
 BiometricEvaluation::IO::SQLiteRecordStore::getCount()
     const
@@ -8,7 +8,11 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <sstream>
 
 #include "be_io_sqliterecstore_impl.h"
@@ -85,6 +89,7 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::Impl(
 	if ((rv != SQLITE_OK) || (_db == nullptr))
 		sqliteError(rv);
 	
+	this->applyPragmaProfile();
 	this->createStructure();
 	_cursorRow = 0;
 }
@@ -122,15 +127,26 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::Impl(
 	if ((rv != SQLITE_OK) || (_db == nullptr))
 		sqliteError(rv);
 	
-	if (this->validateSchema() == false)
-		throw Error::StrategyError("sqlite3: Invalid schema");
+	/* The destructor won't close the database if construction fails */
+	try {
+		if (this->validateSchema() == false)
+			throw Error::StrategyError("sqlite3: Invalid schema");
+		this->applyPragmaProfile();
+	} catch (const Error::Exception&) {
+		try {
+			this->cleanup();
+		} catch (const Error::Exception&) {}
+		throw;
+	}
 		
 	_cursorRow = 0;
 }
 
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::~Impl()
 {
-	this->cleanup();
+	try {
+		this->cleanup();
+	} catch (const Error::Exception&) {}
 		
 	/* NOT THREAD SAFE! */
 //	sqlite3_shutdown();
@@ -178,6 +194,33 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::move(
 
 	if (this->validateSchema() == false)
 		throw Error::StrategyError("sqlite3: Invalid schema");
+	this->applyPragmaProfile();
+
+	/* Continue a bulk update committed by cleanup() */
+	if (this->inBulk())
+		this->execute("BEGIN TRANSACTION");
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::beginBulk()
+{
+	RecordStore::Impl::beginBulk();
+	try {
+		this->execute("BEGIN TRANSACTION");
+	} catch (const Error::Exception&) {
+		RecordStore::Impl::commitBulk();
+		throw;
+	}
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::commitBulk()
+{
+	if (!this->inBulk())
+		throw Error::StrategyError("No bulk update in progress");
+
+	this->execute("COMMIT");
+	RecordStore::Impl::commitBulk();
 }
 
 uint64_t
@@ -185,8 +228,15 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::getSpaceUsed()
     const
 {
 	this->sync();
-	return (RecordStore::Impl::getSpaceUsed() + 
-	    IO::Utility::getFileSize(this->_dbname));
+	uint64_t total = RecordStore::Impl::getSpaceUsed() +
+	    IO::Utility::getFileSize(this->_dbname);
+
+	/* Write-ahead log, when journal_mode is WAL */
+	const std::string walName = this->_dbname + "-wal";
+	if (IO::Utility::fileExists(walName))
+		total += IO::Utility::getFileSize(walName);
+
+	return (total);
 }
 
 void
@@ -200,39 +250,20 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::insert(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 	
-	/* Warn if key is already in database */
-	try {
-		this->length(key);
-		throw Error::ObjectExists(key);
-	} catch (const Error::ObjectDoesNotExist&) {}
-	
-	sqlite3_stmt *statement = nullptr;
+	/*
+	 * The key column is unique, so a duplicate key is reported by
+	 * SQLite when the first segment is inserted.
+	 */
 	std::string activeTable = PRIMARY_KV_TABLE;
 	uint64_t segnum = 0;
 	uint64_t remSize = size, bindSize = 0;
 	uint8_t *bindData = (uint8_t *)data;
 	while ((remSize > 0) ||
 	    ((remSize == 0) && (segnum < KEY_SEGMENT_START))) {
-		std::string sqlCommand = "INSERT INTO " + activeTable + " " + 
-		    "VALUES ('" + genKeySegName(key, segnum) +
-		    "', $value)";
-	
-		/* Prepare the statement */
-#ifdef	SQLITE_V2_SUPPORT
-		int32_t rv = sqlite3_prepare_v2(_db, sqlCommand.c_str(),
-		    sqlCommand.length(), &statement, nullptr);
-#else
-		int32_t rv = sqlite3_prepare(_db, sqlCommand.c_str(),
-		    sqlCommand.length(), &statement, nullptr);
-#endif
-		if (rv != SQLITE_OK) {
-			sqlite3_finalize(statement);
-			sqliteError(rv);
-		}
-		if (statement == nullptr)
-			throw Error::StrategyError("SQLite: Could not allocate "
-			    "statement");
-	
+		sqlite3_stmt *statement = this->getStatement("INSERT INTO " +
+		    activeTable + " VALUES (?, ?)");
+		const std::string segKey = genKeySegName(key, segnum);
+
 		/* Bind data to the statement, segmenting if necessary */
 		if (remSize < MAX_REC_SIZE) {
 			bindSize = remSize;
@@ -241,26 +272,30 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::insert(
 			bindSize = MAX_REC_SIZE;
 			remSize -= MAX_REC_SIZE;
 		}
-		rv = sqlite3_bind_blob(statement,
-		    sqlite3_bind_parameter_index(statement, "$value"),
-		    bindData, bindSize, SQLITE_STATIC);
+		int32_t rv = sqlite3_bind_text(statement, 1, segKey.c_str(),
+		    segKey.length(), SQLITE_STATIC);
+		if (rv == SQLITE_OK)
+			rv = sqlite3_bind_blob(statement, 2, bindData,
+			    bindSize, SQLITE_STATIC);
 		if (rv != SQLITE_OK) {
-			sqlite3_finalize(statement);
+			sqlite3_clear_bindings(statement);
 			sqliteError(rv);
 		}
-			
-		/* Execute the statement */
-		rv = sqlite3_step(statement);
-		if (rv != SQLITE_DONE) {
-			sqlite3_finalize(statement);
+
+		/*
+		 * Execute the statement, leaving it ready for reuse.
+		 * Resetting returns the error from a failed step.
+		 */
+		(void)sqlite3_step(statement);
+		rv = sqlite3_reset(statement);
+		sqlite3_clear_bindings(statement);
+		if (rv != SQLITE_OK) {
+			if ((segnum == 0) &&
+			    ((rv & 0xFF) == SQLITE_CONSTRAINT))
+				throw Error::ObjectExists(key);
 			sqliteError(rv);
 		}
-			
-		/* Free the statement */
-		rv = sqlite3_finalize(statement);
-		if (rv != SQLITE_OK)
-			sqliteError(rv);
-			
+
 		/* Increment data position and segment */
 		bindData += bindSize;
 		switch (segnum) {
@@ -287,43 +322,25 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::remove(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
-	sqlite3_stmt *statement;
 	std::string activeTable = PRIMARY_KV_TABLE;
 	int64_t segnum = 0;
 	bool moreSegments = true;
 	while (moreSegments) {
-		std::string sqlCommand = "DELETE FROM " + activeTable + " " + 
-		    "WHERE " + KEY_COL + " = '" + genKeySegName(key, segnum) + 
-		    "'";
-		
-		/* Prepare the statement */
-#ifdef	SQLITE_V2_SUPPORT
-		int32_t rv = sqlite3_prepare_v2(_db, sqlCommand.c_str(),
-		    sqlCommand.length(), &statement, nullptr);
-#else
-		int32_t rv = sqlite3_prepare(_db, sqlCommand.c_str(),
-		    sqlCommand.length(), &statement, nullptr);
-#endif
-		if (rv != SQLITE_OK) {
-			sqlite3_finalize(statement);
-			sqliteError(rv);
-		}
-		if (statement == nullptr)
-			throw Error::StrategyError("SQLite: Could not allocate "
-			    "statement");
-	
-		/* Execute the statement */
-		rv = sqlite3_step(statement);
-		if (rv != SQLITE_DONE) {
-			sqlite3_finalize(statement);
+		sqlite3_stmt *statement = this->getStatement("DELETE FROM " +
+		    activeTable + " WHERE " + KEY_COL + " = ?");
+		const std::string segKey = genKeySegName(key, segnum);
+		int32_t rv = sqlite3_bind_text(statement, 1, segKey.c_str(),
+		    segKey.length(), SQLITE_STATIC);
+		if (rv != SQLITE_OK)
 			sqliteError(rv);
-		}
-		
-		/* Free the statement */
-		rv = sqlite3_finalize(statement);
+
+		/* Execute the statement, leaving it ready for reuse */
+		(void)sqlite3_step(statement);
+		rv = sqlite3_reset(statement);
+		sqlite3_clear_bindings(statement);
 		if (rv != SQLITE_OK)
 			sqliteError(rv);
-		
+
 		/* Increment segment number */
 		switch (segnum) {
 		case 0:
@@ -357,8 +374,7 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::read(
     const
 {
 	BiometricEvaluation::Memory::uint8Array data;
-	data.resize(this->length(key));
-	this->readSegments(key, data);
+	this->readSegments(key, &data);
 	return(data);
 }
 
@@ -373,66 +389,76 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::length(
 uint64_t
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::readSegments(
     const std::string &key,
-    void * const data)
+    Memory::uint8Array *const data)
+    const
+{
+	return (this->readSegments(this->_db, this->_statements, key, data));
+}
+
+uint64_t
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::readSegments(
+    sqlite3 *db,
+    std::map<std::string, sqlite3_stmt *> &statements,
+    const std::string &key,
+    Memory::uint8Array *const data)
     const
 {	
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
-	sqlite3_stmt *statement;
+	/* Without a buffer, ask SQLite for lengths without loading values */
+	const std::string column = (data == nullptr ?
+	    "length(" + VALUE_COL + ")" : VALUE_COL);
+
 	uint64_t segnum = 0;
 	uint64_t totalBytes = 0, segBytes;
 	std::string activeTable = PRIMARY_KV_TABLE;
-	uint8_t *dataPtr = (uint8_t *)data;
 	bool moreSegments = true;
 	while (moreSegments) {
-		std::string sqlCommand = "SELECT " + VALUE_COL + " FROM " + 
-		    activeTable + " WHERE " + KEY_COL + " = '" + 
-		    genKeySegName(key, segnum) + "' LIMIT 1";
-		    
-		/* Prepare the statement */
-#ifdef	SQLITE_V2_SUPPORT
-		int32_t rv = sqlite3_prepare_v2(_db, sqlCommand.c_str(),
-		    sqlCommand.length(), &statement, nullptr);
-#else
-		int32_t rv = sqlite3_prepare(_db, sqlCommand.c_str(),
-		    sqlCommand.length(), &statement, nullptr);
-#endif
-		if (rv != SQLITE_OK) {
-			sqlite3_finalize(statement);
-			sqliteError(rv);
-		}
-		if (statement == nullptr)
-			throw Error::StrategyError("SQLite: Could not allocate "
-			    "statement");
-			
+		sqlite3_stmt *statement = getStatement(db, statements,
+		    "SELECT " +
+		    column + " FROM " + activeTable + " WHERE " + KEY_COL +
+		    " = ? LIMIT 1");
+		const std::string segKey = genKeySegName(key, segnum);
+		int32_t rv = sqlite3_bind_text(statement, 1, segKey.c_str(),
+		    segKey.length(), SQLITE_STATIC);
+		if (rv != SQLITE_OK)
+			sqliteError(db, rv);
+
 		/* Execute the statement */
+		segBytes = 0;
 		rv = sqlite3_step(statement);
-		switch (segnum) {
-		case 0:
-			if (rv != SQLITE_ROW) {
-				sqlite3_finalize(statement);
-				throw Error::ObjectDoesNotExist(key);
+		if (rv == SQLITE_ROW) {
+			if (data == nullptr) {
+				segBytes = sqlite3_column_int64(statement, 0);
+			} else {
+				/* Grow the buffer by the segment's size */
+				const void *blob = sqlite3_column_blob(
+				    statement, 0);
+				segBytes = sqlite3_column_bytes(statement, 0);
+				try {
+					data->resize(totalBytes + segBytes);
+				} catch (const Error::Exception&) {
+					sqlite3_reset(statement);
+					sqlite3_clear_bindings(statement);
+					throw;
+				}
+				if (segBytes != 0)
+					std::memcpy(&(*data)[totalBytes], blob,
+					    segBytes);
 			}
-			/* FALLTHROUGH */
-		default:
-			segBytes = sqlite3_column_bytes(statement, 0);
 			totalBytes += segBytes;
-			
-			if (data != nullptr) {
-				memcpy(dataPtr,
-				    sqlite3_column_blob(statement, 0),
-				    segBytes);
-				dataPtr += segBytes;
-				break;
-			}
 		}
 
-		/* Free the statement */
-		rv = sqlite3_finalize(statement);
+		/* Leave the statement ready for reuse */
+		const int32_t stepRV = rv;
+		rv = sqlite3_reset(statement);
+		sqlite3_clear_bindings(statement);
 		if (rv != SQLITE_OK)
-			sqliteError(rv);
-			
+			sqliteError(db, rv);
+		if ((segnum == 0) && (stepRV != SQLITE_ROW))
+			throw Error::ObjectDoesNotExist(key);
+
 		/* Increment segment number if there's more data */
 		if (segBytes == MAX_REC_SIZE) {
 			switch (segnum) {
@@ -514,22 +540,23 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::i_sequence(
 		if (rv != SQLITE_OK)
 			sqliteError(rv);
 	
-		std::stringstream sqlCommand;
-		sqlCommand << "SELECT *,ROWID FROM " <<
-		    PRIMARY_KV_TABLE << " " << "WHERE ROWID >= " << 
-		    _cursorRow << " ORDER BY ROWID";
-		_cursorRow = 0;
+		std::string sqlCommand = "SELECT *,ROWID FROM " +
+		    PRIMARY_KV_TABLE + " " + "WHERE ROWID >= ? ORDER BY ROWID";
 	
 		/* Prepare the statement */
 #ifdef	SQLITE_V2_SUPPORT
-		rv = sqlite3_prepare_v2(_db, sqlCommand.str().c_str(),
-		    sqlCommand.str().length(), &_sequencer, nullptr);
+		rv = sqlite3_prepare_v2(_db, sqlCommand.c_str(),
+		    sqlCommand.length(), &_sequencer, nullptr);
 #else
-		rv = sqlite3_prepare(_db, sqlCommand.str().c_str(),
-		    sqlCommand.str().length(), &_sequencer, nullptr);
+		rv = sqlite3_prepare(_db, sqlCommand.c_str(),
+		    sqlCommand.length(), &_sequencer, nullptr);
 #endif
 		if ((rv != SQLITE_OK) || (_sequencer == nullptr))
 			sqliteError(rv);
+		rv = sqlite3_bind_int64(_sequencer, 1, _cursorRow);
+		if (rv != SQLITE_OK)
+			sqliteError(rv);
+		_cursorRow = 0;
 	}
 	
 	/* Execute the statement */
@@ -590,49 +617,32 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::setCursorAtKey(
 	if (!validateKeyString(key))
 		throw Error::StrategyError("Invalid key format");
 
-	int32_t rv;
-	
-	sqlite3_stmt *statement;
-	std::string sqlCommand = "SELECT ROWID FROM " + PRIMARY_KV_TABLE + " " +
-	    "WHERE " + KEY_COL + " = '" + key + "'";
-	
-	/* Prepare the statement */
-#ifdef	SQLITE_V2_SUPPORT
-	rv = sqlite3_prepare_v2(_db, sqlCommand.c_str(), sqlCommand.length(),
-	    &statement, nullptr);
-#else
-	rv = sqlite3_prepare(_db, sqlCommand.c_str(), sqlCommand.length(),
-	    &statement, nullptr);
-#endif
-	if ((rv != SQLITE_OK) || (statement == nullptr))
+	sqlite3_stmt *statement = this->getStatement("SELECT ROWID FROM " +
+	    PRIMARY_KV_TABLE + " " + "WHERE " + KEY_COL + " = ?");
+	int32_t rv = sqlite3_bind_text(statement, 1, key.c_str(),
+	    key.length(), SQLITE_STATIC);
+	if (rv != SQLITE_OK)
 		sqliteError(rv);
 	
 	/* Execute the statement */
-	rv = sqlite3_step(statement);
+	const int32_t stepRV = sqlite3_step(statement);
+	if (stepRV == SQLITE_ROW)
+		_cursorRow = sqlite3_column_int64(statement, 0);
+	rv = sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+	if (rv != SQLITE_OK)
+		sqliteError(rv);
 	
 	/* End of entries */
-	switch (rv) {
-	case SQLITE_ROW: {
-		_cursorRow = (uint64_t)strtoll(
-		    (const char *)sqlite3_column_text(statement, 0), nullptr, 
-		    10);
-
-    		rv = sqlite3_finalize(statement);
-		if (rv != SQLITE_OK)
-			sqliteError(rv);
+	switch (stepRV) {
+	case SQLITE_ROW:
 		break;
-	} case SQLITE_DONE:
-		rv = sqlite3_finalize(statement);
-		if (rv != SQLITE_OK)
-			sqliteError(rv);
+	case SQLITE_DONE:
 		throw Error::ObjectDoesNotExist();
 		
 		/* Not reached */
 		break;
 	default:
-    		rv = sqlite3_finalize(statement);
-		if (rv != SQLITE_OK)
-			sqliteError(rv);
 		throw Error::StrategyError();
 		
 		/* Not reached */
@@ -643,11 +653,223 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::setCursorAtKey(
 	_sequenceEnd = false;
 }
 
+std::unique_ptr<BiometricEvaluation::IO::RecordStore::Cursor>
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::makeReader()
+    const
+{
+	return (std::unique_ptr<RecordStore::Cursor>(new Cursor(*this)));
+}
+
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::Cursor::Cursor(
+    const SQLiteRecordStore::Impl &store) :
+    _store(store),
+    _nextRow(std::numeric_limits<int64_t>::min())
+{
+	/* Uncommitted records are only visible on the store's connection */
+	if (store.inBulk()) {
+		this->_db = store._db;
+		return;
+	}
+
+#ifdef	SQLITE_V2_SUPPORT
+	int32_t rv = sqlite3_open_v2(store._dbname.c_str(), &this->_db,
+	    SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+#else
+	int32_t rv = sqlite3_open(store._dbname.c_str(), &this->_db);
+#endif
+	if ((rv != SQLITE_OK) || (this->_db == nullptr)) {
+		const std::string message = (this->_db == nullptr ?
+		    "out of memory" : sqlite3_errmsg(this->_db));
+		sqlite3_close(this->_db);
+		throw Error::StrategyError("sqlite3: " + message + " (" +
+		    std::to_string(rv) + ")");
+	}
+	this->_ownsDB = true;
+
+	/* Readers benefit from the same memory settings as the store */
+	const SQLiteRecordStore::PragmaProfile profile =
+	    store.getPragmaProfile();
+	std::string pragmas;
+	if (profile.mmapSize != 0)
+		pragmas += "PRAGMA mmap_size = " +
+		    std::to_string(profile.mmapSize) + ";";
+	if (profile.cacheSize != 0)
+		pragmas += "PRAGMA cache_size = " +
+		    std::to_string(profile.cacheSize) + ";";
+	if (!pragmas.empty()) {
+		rv = sqlite3_exec(this->_db, pragmas.c_str(), nullptr,
+		    nullptr, nullptr);
+		if (rv != SQLITE_OK) {
+			const std::string message = sqlite3_errmsg(this->_db);
+			sqlite3_close(this->_db);
+			throw Error::StrategyError("sqlite3: " + message +
+			    " (" + std::to_string(rv) + ")");
+		}
+	}
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::Cursor::i_sequence(
+    bool returnData,
+    int cursor)
+{
+	if ((cursor != BE_RECSTORE_SEQ_START) &&
+	    (cursor != BE_RECSTORE_SEQ_NEXT))
+		throw Error::StrategyError("Invalid cursor position as "
+		    "argument");
+
+	if (cursor == BE_RECSTORE_SEQ_START) {
+		this->_nextRow = std::numeric_limits<int64_t>::min();
+		this->_sequenceEnd = false;
+	}
+	if (this->_sequenceEnd)
+		throw Error::ObjectDoesNotExist();
+
+	/* Seek to the next row, leaving no statement open between calls */
+	const std::string column = (returnData ? VALUE_COL : "NULL");
+	sqlite3_stmt *statement = getStatement(this->_db, this->_statements,
+	    "SELECT " + KEY_COL + "," + column + ",ROWID FROM " +
+	    PRIMARY_KV_TABLE + " WHERE ROWID >= ? ORDER BY ROWID LIMIT 1");
+	int32_t rv = sqlite3_bind_int64(statement, 1, this->_nextRow);
+	if (rv != SQLITE_OK)
+		sqliteError(this->_db, rv);
+
+	RecordStore::Record record;
+	const int32_t stepRV = sqlite3_step(statement);
+	bool segmented = false;
+	if (stepRV == SQLITE_ROW) {
+		record.key.assign(reinterpret_cast<const char *>(
+		    sqlite3_column_text(statement, 0)));
+		if (returnData) {
+			const uint64_t bytes = sqlite3_column_bytes(
+			    statement, 1);
+			segmented = (bytes == MAX_REC_SIZE);
+			if (!segmented) {
+				record.data.resize(bytes);
+				if (bytes != 0)
+					record.data.copy(static_cast<const
+					    uint8_t *>(sqlite3_column_blob(
+					    statement, 1)), bytes);
+			}
+		}
+		this->_nextRow = sqlite3_column_int64(statement, 2) + 1;
+	}
+	rv = sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+	if (rv != SQLITE_OK)
+		sqliteError(this->_db, rv);
+
+	switch (stepRV) {
+	case SQLITE_ROW:
+		break;
+	case SQLITE_DONE:
+		this->_sequenceEnd = true;
+		throw Error::ObjectDoesNotExist();
+	default:
+		sqliteError(this->_db, stepRV);
+	}
+
+	/* Remaining segments are in the subordinate table */
+	if (segmented)
+		this->_store.readSegments(this->_db, this->_statements,
+		    record.key, &record.data);
+	return (record);
+}
+
+BiometricEvaluation::IO::RecordStore::Record
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::Cursor::sequence(
+    int cursor)
+{
+	return (this->i_sequence(true, cursor));
+}
+
+std::string
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::Cursor::sequenceKey(
+    int cursor)
+{
+	return (this->i_sequence(false, cursor).key);
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::Cursor::setCursorAtKey(
+    const std::string &key)
+{
+	if (!this->_store.validateKeyString(key))
+		throw Error::StrategyError("Invalid key format");
+
+	sqlite3_stmt *statement = getStatement(this->_db, this->_statements,
+	    "SELECT ROWID FROM " + PRIMARY_KV_TABLE + " WHERE " + KEY_COL +
+	    " = ?");
+	int32_t rv = sqlite3_bind_text(statement, 1, key.c_str(),
+	    key.length(), SQLITE_STATIC);
+	if (rv != SQLITE_OK)
+		sqliteError(this->_db, rv);
+
+	const int32_t stepRV = sqlite3_step(statement);
+	if (stepRV == SQLITE_ROW)
+		this->_nextRow = sqlite3_column_int64(statement, 0);
+	rv = sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+	if (rv != SQLITE_OK)
+		sqliteError(this->_db, rv);
+
+	switch (stepRV) {
+	case SQLITE_ROW:
+		break;
+	case SQLITE_DONE:
+		throw Error::ObjectDoesNotExist(key);
+	default:
+		sqliteError(this->_db, stepRV);
+	}
+	this->_sequenceEnd = false;
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::Cursor::read(
+    const std::string &key)
+    const
+{
+	Memory::uint8Array data;
+	this->_store.readSegments(this->_db, this->_statements, key, &data);
+	return (data);
+}
+
+uint64_t
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::Cursor::length(
+    const std::string &key)
+    const
+{
+	return (this->_store.readSegments(this->_db, this->_statements, key,
+	    nullptr));
+}
+
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::Cursor::~Cursor()
+{
+	for (const auto &cached : this->_statements)
+		sqlite3_finalize(cached.second);
+	if (this->_ownsDB)
+		sqlite3_close(this->_db);
+}
+
 void
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::cleanup()
 {
 	int32_t rv;
 
+	/* Finalize cached statements */
+	bool finalized = true;
+	for (const auto &cached : _statements)
+		if (sqlite3_finalize(cached.second) != SQLITE_OK)
+			finalized = false;
+	_statements.clear();
+	if (!finalized)
+		throw Error::StrategyError("SQLite: Could not finalize "
+		    "cached statement");
+
+	/* Closing the database would roll back an open bulk update */
+	if (this->inBulk())
+		this->execute("COMMIT");
+
 	/* Finalize sequencer */
 	rv = sqlite3_finalize(_sequencer);
 	if (rv != SQLITE_OK)
@@ -663,13 +885,168 @@ BiometricEvaluation::IO::SQLiteRecordStore::Impl::cleanup()
 		    "free all statements?)");
 }
 
+sqlite3_stmt *
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::getStatement(
+    const std::string &sqlCommand)
+    const
+{
+	return (getStatement(this->_db, this->_statements, sqlCommand));
+}
+
+sqlite3_stmt *
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::getStatement(
+    sqlite3 *db,
+    std::map<std::string, sqlite3_stmt *> &statements,
+    const std::string &sqlCommand)
+{
+	const auto cached = statements.find(sqlCommand);
+	if (cached != statements.end())
+		return (cached->second);
+
+	sqlite3_stmt *statement = nullptr;
+#ifdef	SQLITE_V2_SUPPORT
+	int32_t rv = sqlite3_prepare_v2(db, sqlCommand.c_str(),
+	    sqlCommand.length(), &statement, nullptr);
+#else
+	int32_t rv = sqlite3_prepare(db, sqlCommand.c_str(),
+	    sqlCommand.length(), &statement, nullptr);
+#endif
+	if (rv != SQLITE_OK) {
+		sqlite3_finalize(statement);
+		sqliteError(db, rv);
+	}
+	if (statement == nullptr)
+		throw Error::StrategyError("SQLite: Could not allocate "
+		    "statement");
+
+	statements[sqlCommand] = statement;
+	return (statement);
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::applyPragmaProfile()
+{
+	const SQLiteRecordStore::PragmaProfile profile =
+	    this->getPragmaProfile();
+
+	/* Changing the journal mode requires write access */
+	if (!profile.journalMode.empty() &&
+	    (this->getMode() == Mode::ReadWrite))
+		this->execute("PRAGMA journal_mode = " + profile.journalMode);
+	if (profile.mmapSize != 0)
+		this->execute("PRAGMA mmap_size = " +
+		    std::to_string(profile.mmapSize));
+	if (profile.cacheSize != 0)
+		this->execute("PRAGMA cache_size = " +
+		    std::to_string(profile.cacheSize));
+}
+
+std::string
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::validateJournalMode(
+    const std::string &journalMode)
+{
+	std::string upper = journalMode;
+	std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+	if (!upper.empty() && (upper != "DELETE") && (upper != "TRUNCATE") &&
+	    (upper != "PERSIST") && (upper != "MEMORY") && (upper != "WAL") &&
+	    (upper != "OFF"))
+		throw Error::StrategyError("Invalid journal mode: " +
+		    journalMode);
+	return (upper);
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::setPragmaProfile(
+    const SQLiteRecordStore::PragmaProfile &profile)
+{
+	if (this->getMode() == Mode::ReadOnly)
+		throw Error::StrategyError(RSREADONLYERROR);
+
+	const std::string journalMode = validateJournalMode(
+	    profile.journalMode);
+
+	std::shared_ptr<IO::Properties> props = this->getProperties();
+	for (const auto &key : {SQLiteRecordStore::JOURNAL_MODE_PROPERTY,
+	    SQLiteRecordStore::MMAP_SIZE_PROPERTY,
+	    SQLiteRecordStore::CACHE_SIZE_PROPERTY}) {
+		try {
+			props->removeProperty(key);
+		} catch (const Error::ObjectDoesNotExist&) {}
+	}
+	if (!journalMode.empty())
+		props->setProperty(SQLiteRecordStore::JOURNAL_MODE_PROPERTY,
+		    journalMode);
+	if (profile.mmapSize != 0)
+		props->setPropertyFromInteger(
+		    SQLiteRecordStore::MMAP_SIZE_PROPERTY, profile.mmapSize);
+	if (profile.cacheSize != 0)
+		props->setPropertyFromInteger(
+		    SQLiteRecordStore::CACHE_SIZE_PROPERTY, profile.cacheSize);
+	this->setProperties(props);
+
+	this->applyPragmaProfile();
+}
+
+BiometricEvaluation::IO::SQLiteRecordStore::PragmaProfile
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::getPragmaProfile()
+    const
+{
+	SQLiteRecordStore::PragmaProfile profile;
+	std::shared_ptr<IO::Properties> props = this->getProperties();
+	try {
+		try {
+			/* Edited properties must not reach the SQL */
+			profile.journalMode = validateJournalMode(
+			    props->getProperty(SQLiteRecordStore::
+			    JOURNAL_MODE_PROPERTY));
+		} catch (const Error::ObjectDoesNotExist&) {}
+		try {
+			profile.mmapSize = props->getPropertyAsInteger(
+			    SQLiteRecordStore::MMAP_SIZE_PROPERTY);
+		} catch (const Error::ObjectDoesNotExist&) {}
+		try {
+			profile.cacheSize = props->getPropertyAsInteger(
+			    SQLiteRecordStore::CACHE_SIZE_PROPERTY);
+		} catch (const Error::ObjectDoesNotExist&) {}
+	} catch (const Error::ConversionError &e) {
+		throw Error::StrategyError("Invalid SQLite property: " +
+		    e.whatString());
+	}
+
+	return (profile);
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::execute(
+    const std::string &sqlCommand)
+{
+	char *errorMessage = nullptr;
+	int32_t rv = sqlite3_exec(_db, sqlCommand.c_str(), nullptr, nullptr,
+	    &errorMessage);
+	if (rv != SQLITE_OK) {
+		const std::string message = (errorMessage == nullptr ?
+		    "unknown error" : errorMessage);
+		sqlite3_free(errorMessage);
+		throw Error::StrategyError("sqlite3: " + message + " (" +
+		    std::to_string(rv) + ")");
+	}
+}
+
 void
 BiometricEvaluation::IO::SQLiteRecordStore::Impl::sqliteError(
     int32_t errorNumber)
     const
 {	
+	sqliteError(this->_db, errorNumber);
+}
+
+void
+BiometricEvaluation::IO::SQLiteRecordStore::Impl::sqliteError(
+    sqlite3 *db,
+    int32_t errorNumber)
+{
 	std::stringstream msg;
-	msg << "sqlite3: " << sqlite3_errmsg(_db) << " (" << errorNumber << ')';
+	msg << "sqlite3: " << sqlite3_errmsg(db) << " (" << errorNumber << ')';
 	throw Error::StrategyError(msg.str());
 }
 
@@ -11,6 +11,10 @@
 #ifndef __BE_IO_SQLITERECORDSTORE_IMPL_H__
 #define __BE_IO_SQLITERECORDSTORE_IMPL_H__
 
+#include <map>
+#include <memory>
+#include <string>
+
 #include <sqlite3.h>
 
 #include "be_io_recordstore_impl.h"
@@ -50,6 +54,39 @@ namespace BiometricEvaluation
 
 			void 
 			remove(const std::string &key);
+
+			/**
+			 * @brief
+			 * Begin a bulk update, wrapping subsequent
+			 * changes in a single SQLite transaction.
+			 *
+			 * @throw Error::StrategyError
+			 *	Read-only store, bulk update in progress,
+			 *	or error beginning the transaction.
+			 */
+			void
+			beginBulk();
+
+			/**
+			 * @brief
+			 * Commit the transaction started by beginBulk().
+			 *
+			 * @throw Error::StrategyError
+			 *	No bulk update in progress, or error
+			 *	committing the transaction.
+			 */
+			void
+			commitBulk();
+
+			/** See SQLiteRecordStore::setPragmaProfile() */
+			void
+			setPragmaProfile(
+			    const SQLiteRecordStore::PragmaProfile &profile);
+
+			/** See SQLiteRecordStore::getPragmaProfile() */
+			SQLiteRecordStore::PragmaProfile
+			getPragmaProfile()
+			    const;
 	
 			Memory::uint8Array
 			read(const std::string &key) const;
@@ -69,6 +106,86 @@ namespace BiometricEvaluation
 			void
 			setCursorAtKey(const std::string &key);
 
+			/**
+			 * @brief
+			 * A RecordStore::Cursor with its own SQLite
+			 * connection and statements.
+			 * @details
+			 * Records are sequenced by ROWID, selecting one row
+			 * per step, so no statement is left open between
+			 * calls.  During a bulk update, the store's
+			 * connection is shared so that uncommitted records
+			 * are visible.
+			 */
+			class Cursor : public RecordStore::Cursor
+			{
+			public:
+				/**
+				 * @param store
+				 *	Store to read.
+				 *
+				 * @throw Error::StrategyError
+				 *	Could not open the database.
+				 */
+				Cursor(
+				    const SQLiteRecordStore::Impl &store);
+
+				RecordStore::Record
+				sequence(
+				    int cursor = BE_RECSTORE_SEQ_NEXT)
+				    override;
+
+				std::string
+				sequenceKey(
+				    int cursor = BE_RECSTORE_SEQ_NEXT)
+				    override;
+
+				void
+				setCursorAtKey(
+				    const std::string &key)
+				    override;
+
+				Memory::uint8Array
+				read(
+				    const std::string &key)
+				    const
+				    override;
+
+				uint64_t
+				length(
+				    const std::string &key)
+				    const
+				    override;
+
+				~Cursor();
+
+			private:
+				/** Store being read */
+				const SQLiteRecordStore::Impl &_store;
+				/** Database handle */
+				sqlite3 *_db{nullptr};
+				/** Whether _db was opened by this Cursor */
+				bool _ownsDB{false};
+				/** Prepared statements, keyed by their SQL */
+				mutable std::map<std::string, sqlite3_stmt *>
+				    _statements{};
+				/** Lowest ROWID that may be returned next */
+				int64_t _nextRow;
+				/** If sequencing has reached the end */
+				bool _sequenceEnd{false};
+
+				/** See SQLiteRecordStore::Impl::i_sequence() */
+				RecordStore::Record
+				i_sequence(
+				    bool returnData,
+				    int cursor);
+			};
+
+			/** See RecordStore::makeReader() */
+			std::unique_ptr<RecordStore::Cursor>
+			makeReader()
+			    const;
+
 			~Impl();
 
 			Impl(const SQLiteRecordStore&) = delete;
@@ -87,6 +204,25 @@ namespace BiometricEvaluation
 			 */
 			void
 			sqliteError(int32_t errorNumber) const;
+
+			/**
+			 * @brief
+			 * Convert an SQLite error on a connection into a
+			 * StrategyError.
+			 *
+			 * @param db
+			 *	Connection on which the error occurred.
+			 * @param errorNumber
+			 *	SQLite return code.
+			 *
+			 * @throw Error::StrategyError
+			 *	Always thrown with the textual description of
+			 *	the last error condition on db.
+			 */
+			static void
+			sqliteError(
+			    sqlite3 *db,
+			    int32_t errorNumber);
 			
 			/**
 			 * @brief
@@ -156,7 +292,9 @@ namespace BiometricEvaluation
 			 *	Key of the row to select.
 			 * @param data
 			 *	If not nullptr, deep copy the record for key
-			 *	into data.
+			 *	into data, which is resized as each segment
+			 *	is read. Otherwise only the segment lengths
+			 *	are retrieved.
 			 * 
 			 * @throw Error::ObjectDoesNotExist
 			 *	Key does not exist in RecordStore.
@@ -169,7 +307,37 @@ namespace BiometricEvaluation
 			uint64_t
 			readSegments(
 			    const std::string &key,
-			    void * const data) const;
+			    Memory::uint8Array *const data) const;
+
+			/**
+			 * @brief
+			 * Select a row from the RecordStore using a given
+			 * connection.
+			 *
+			 * @param db
+			 *	Connection to the store's database.
+			 * @param statements
+			 *	Prepared statements for db.
+			 * @param key
+			 *	Key of the row to select.
+			 * @param data
+			 *	If not nullptr, deep copy the record for key
+			 *	into data.
+			 *
+			 * @throw Error::ObjectDoesNotExist
+			 *	Key does not exist in RecordStore.
+			 * @throw Error::StrategyError
+			 *	Error executing SQL commands.
+			 *
+			 * @return
+			 *	Size of key's record.
+			 */
+			uint64_t
+			readSegments(
+			    sqlite3 *db,
+			    std::map<std::string, sqlite3_stmt *> &statements,
+			    const std::string &key,
+			    Memory::uint8Array *const data) const;
 
 			/**
 			 * @brief
@@ -184,6 +352,97 @@ namespace BiometricEvaluation
 			void
 			cleanup();
 
+			/**
+			 * @brief
+			 * Obtain a prepared statement.
+			 * @details
+			 * Statements are prepared on first use and kept
+			 * until cleanup(). Callers bind the statement's
+			 * parameters, then reset it and clear its bindings
+			 * when done.
+			 *
+			 * @param sqlCommand
+			 *	SQL, with ? for each parameter.
+			 *
+			 * @return
+			 *	Prepared statement.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error compiling SQL.
+			 */
+			sqlite3_stmt *
+			getStatement(
+			    const std::string &sqlCommand)
+			    const;
+
+			/**
+			 * @brief
+			 * Obtain a prepared statement for a connection.
+			 *
+			 * @param db
+			 *	Connection to prepare the statement on.
+			 * @param statements
+			 *	Statements already prepared on db, to which
+			 *	a newly prepared statement is added.
+			 * @param sqlCommand
+			 *	SQL, with ? for each parameter.
+			 *
+			 * @return
+			 *	Prepared statement.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error compiling SQL.
+			 */
+			static sqlite3_stmt *
+			getStatement(
+			    sqlite3 *db,
+			    std::map<std::string, sqlite3_stmt *> &statements,
+			    const std::string &sqlCommand);
+
+			/**
+			 * @brief
+			 * Apply the PragmaProfile saved in the store's
+			 * properties to the database connection.
+			 *
+			 * @throw Error::StrategyError
+			 *	Invalid profile, or error executing SQL.
+			 */
+			void
+			applyPragmaProfile();
+
+			/**
+			 * @brief
+			 * Check a journal mode, which can't be bound to a
+			 * PRAGMA statement, against those known to SQLite.
+			 *
+			 * @param[in] journalMode
+			 *	Journal mode, in any case, or empty for
+			 *	SQLite's default.
+			 *
+			 * @return
+			 *	journalMode in upper case.
+			 *
+			 * @throw Error::StrategyError
+			 *	journalMode is not known to SQLite.
+			 */
+			static std::string
+			validateJournalMode(
+			    const std::string &journalMode);
+
+			/**
+			 * @brief
+			 * Execute SQL that returns no rows.
+			 *
+			 * @param sqlCommand
+			 *	SQL to execute.
+			 *
+			 * @throw Error::StrategyError
+			 *	Error executing SQL.
+			 */
+			void
+			execute(
+			    const std::string &sqlCommand);
+
 		private:
 			/** SQLite database handle */
 			sqlite3 *_db;
@@ -195,6 +454,9 @@ namespace BiometricEvaluation
 			bool _sequenceEnd;
 			/** Row for key in setCursorForKey() */
 			uint64_t _cursorRow;
+			/** Prepared statements, keyed by their SQL */
+			mutable std::map<std::string, sqlite3_stmt *>
+			    _statements;
 			
 			/** Name given to the primate SQLite table */
 			static const std::string PRIMARY_KV_TABLE;
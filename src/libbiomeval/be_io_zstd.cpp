@@ -0,0 +1,342 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#ifdef BIOMEVAL_WITH_ZSTD
+
+#include <cstring>
+#include <map>
+
+#include <zdict.h>
+#include <zstd.h>
+
+#include <be_io_zstd.h>
+
+namespace BE = BiometricEvaluation;
+
+const std::string
+    BiometricEvaluation::IO::Zstd::COMPRESSION_LEVEL = "CompressionLevel";
+
+/** Digested forms of a dictionary, shared by all threads */
+struct BiometricEvaluation::IO::Zstd::Dictionary
+{
+	Memory::uint8Array data{};
+	unsigned int id{0};
+	ZSTD_DDict *ddict{nullptr};
+
+	/** Compression dictionaries, by compression level */
+	std::map<int, ZSTD_CDict*> cdicts{};
+	std::mutex cdictsMutex{};
+
+	/**
+	 * @brief
+	 * Obtain the compression dictionary for a level, digesting the
+	 * dictionary on first use of the level.
+	 */
+	const ZSTD_CDict*
+	getCDict(
+	    int level)
+	{
+		std::lock_guard<std::mutex> lock(this->cdictsMutex);
+		const auto it = this->cdicts.find(level);
+		if (it != this->cdicts.end())
+			return (it->second);
+
+		ZSTD_CDict *cdict = ZSTD_createCDict(this->data,
+		    this->data.size(), level);
+		if (cdict == nullptr)
+			throw Error::StrategyError("Could not digest "
+			    "dictionary");
+		this->cdicts[level] = cdict;
+		return (cdict);
+	}
+
+	~Dictionary()
+	{
+		for (const auto &cdict : this->cdicts)
+			ZSTD_freeCDict(cdict.second);
+		ZSTD_freeDDict(this->ddict);
+	}
+};
+
+namespace
+{
+	/** Per-thread contexts, reused for every frame */
+	struct ZstdContexts
+	{
+		ZSTD_CCtx *cctx{nullptr};
+		ZSTD_DCtx *dctx{nullptr};
+
+		~ZstdContexts()
+		{
+			ZSTD_freeCCtx(this->cctx);
+			ZSTD_freeDCtx(this->dctx);
+		}
+	};
+	thread_local ZstdContexts contexts;
+
+	ZSTD_CCtx*
+	compressionContext()
+	{
+		if (contexts.cctx == nullptr) {
+			contexts.cctx = ZSTD_createCCtx();
+			if (contexts.cctx == nullptr)
+				throw BE::Error::StrategyError("Could not "
+				    "create compression context");
+		}
+		return (contexts.cctx);
+	}
+
+	/* Context is reset, including any referenced dictionary */
+	ZSTD_DCtx*
+	decompressionContext()
+	{
+		if (contexts.dctx == nullptr) {
+			contexts.dctx = ZSTD_createDCtx();
+			if (contexts.dctx == nullptr)
+				throw BE::Error::StrategyError("Could not "
+				    "create decompression context");
+		} else {
+			ZSTD_DCtx_reset(contexts.dctx,
+			    ZSTD_reset_session_and_parameters);
+		}
+		return (contexts.dctx);
+	}
+
+	std::string
+	errorString(
+	    size_t rv)
+	{
+		return (std::string(ZSTD_getErrorName(rv)));
+	}
+}
+
+BiometricEvaluation::IO::Zstd::Zstd() :
+    BiometricEvaluation::IO::Compressor()
+{
+	this->setOption(COMPRESSION_LEVEL, ZSTD_CLEVEL_DEFAULT);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::compress(
+    const uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	const int level = static_cast<int>(this->getOptionAsInteger(
+	    COMPRESSION_LEVEL));
+	const std::shared_ptr<Dictionary> dictionary =
+	    this->currentDictionary();
+
+	Memory::uint8Array compressedData(ZSTD_compressBound(
+	    uncompressedDataSize));
+	size_t rv;
+	if (dictionary != nullptr)
+		rv = ZSTD_compress_usingCDict(compressionContext(),
+		    compressedData, compressedData.size(), uncompressedData,
+		    uncompressedDataSize, dictionary->getCDict(level));
+	else
+		rv = ZSTD_compressCCtx(compressionContext(), compressedData,
+		    compressedData.size(), uncompressedData,
+		    uncompressedDataSize, level);
+	if (ZSTD_isError(rv))
+		throw Error::StrategyError("Could not compress: " +
+		    errorString(rv));
+
+	/* Resize output buffer's size parameter to match the actual size */
+	compressedData.resize(rv);
+	return (compressedData);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize)
+    const
+{
+	const unsigned long long size = ZSTD_getFrameContentSize(
+	    compressedData, compressedDataSize);
+	if (size == ZSTD_CONTENTSIZE_ERROR)
+		throw Error::StrategyError("Not a Zstandard frame");
+	if (size == ZSTD_CONTENTSIZE_UNKNOWN)
+		return (this->decompressStream(compressedData,
+		    compressedDataSize));
+
+	return (Compressor::decompress(compressedData, compressedDataSize,
+	    static_cast<uint64_t>(size)));
+}
+
+void
+BiometricEvaluation::IO::Zstd::decompress(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize,
+    uint8_t *const uncompressedData,
+    uint64_t uncompressedDataSize)
+    const
+{
+	ZSTD_DCtx *dctx = decompressionContext();
+
+	size_t rv;
+	const unsigned int dictID = ZSTD_getDictID_fromFrame(compressedData,
+	    compressedDataSize);
+	if (dictID != 0) {
+		const std::shared_ptr<Dictionary> dictionary =
+		    this->frameDictionary(dictID);
+		rv = ZSTD_decompress_usingDDict(dctx, uncompressedData,
+		    uncompressedDataSize, compressedData, compressedDataSize,
+		    dictionary->ddict);
+	} else {
+		rv = ZSTD_decompressDCtx(dctx, uncompressedData,
+		    uncompressedDataSize, compressedData, compressedDataSize);
+	}
+	if (ZSTD_isError(rv))
+		throw Error::StrategyError("Could not decompress: " +
+		    errorString(rv));
+	if (rv != uncompressedDataSize)
+		throw Error::StrategyError("Decompressed data is smaller "
+		    "than expected size");
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::decompressStream(
+    const uint8_t *const compressedData,
+    uint64_t compressedDataSize)
+    const
+{
+	ZSTD_DCtx *dctx = decompressionContext();
+	const unsigned int dictID = ZSTD_getDictID_fromFrame(compressedData,
+	    compressedDataSize);
+	if (dictID != 0) {
+		const std::shared_ptr<Dictionary> dictionary =
+		    this->frameDictionary(dictID);
+		ZSTD_DCtx_refDDict(dctx, dictionary->ddict);
+	}
+
+	const size_t chunk = ZSTD_DStreamOutSize();
+	Memory::uint8Array uncompressedData(chunk);
+	ZSTD_inBuffer in{compressedData, compressedDataSize, 0};
+	ZSTD_outBuffer out{uncompressedData, uncompressedData.size(), 0};
+	size_t rv;
+	do {
+		/* Grow geometrically so each byte is copied O(1) times */
+		if (out.pos == out.size) {
+			uncompressedData.resize(uncompressedData.size() * 2);
+			out.dst = uncompressedData;
+			out.size = uncompressedData.size();
+		}
+
+		rv = ZSTD_decompressStream(dctx, &out, &in);
+		if (ZSTD_isError(rv))
+			throw Error::StrategyError("Could not decompress: " +
+			    errorString(rv));
+		if ((rv != 0) && (in.pos == in.size) && (out.pos < out.size))
+			throw Error::StrategyError("Compressed data is "
+			    "truncated");
+	} while (rv != 0);
+
+	uncompressedData.resize(out.pos);
+	return (uncompressedData);
+}
+
+bool
+BiometricEvaluation::IO::Zstd::supportsDictionaries()
+    const
+{
+	return (true);
+}
+
+void
+BiometricEvaluation::IO::Zstd::setDictionary(
+    const Memory::uint8Array &dictionary)
+{
+	std::shared_ptr<Dictionary> digested = std::make_shared<Dictionary>();
+	digested->data = dictionary;
+	digested->id = ZSTD_getDictID_fromDict(dictionary, dictionary.size());
+	if (digested->id == 0)
+		throw Error::StrategyError("Not a Zstandard dictionary");
+	digested->ddict = ZSTD_createDDict(dictionary, dictionary.size());
+	if (digested->ddict == nullptr)
+		throw Error::StrategyError("Could not digest dictionary");
+
+	std::lock_guard<std::mutex> lock(this->_dictionaryMutex);
+	this->_dictionary = digested;
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::getDictionary()
+    const
+{
+	const std::shared_ptr<Dictionary> dictionary =
+	    this->currentDictionary();
+	if (dictionary == nullptr)
+		return (Memory::uint8Array());
+	return (dictionary->data);
+}
+
+std::shared_ptr<BiometricEvaluation::IO::Zstd::Dictionary>
+BiometricEvaluation::IO::Zstd::currentDictionary()
+    const
+{
+	std::lock_guard<std::mutex> lock(this->_dictionaryMutex);
+	return (this->_dictionary);
+}
+
+std::shared_ptr<BiometricEvaluation::IO::Zstd::Dictionary>
+BiometricEvaluation::IO::Zstd::frameDictionary(
+    unsigned int dictID)
+    const
+{
+	const std::shared_ptr<Dictionary> dictionary =
+	    this->currentDictionary();
+	if ((dictionary == nullptr) || (dictionary->id != dictID))
+		throw Error::StrategyError("Data was compressed with "
+		    "dictionary " + std::to_string(dictID) + ", which is not "
+		    "in use");
+	return (dictionary);
+}
+
+BiometricEvaluation::Memory::uint8Array
+BiometricEvaluation::IO::Zstd::trainDictionary(
+    const std::vector<Memory::uint8Array> &samples,
+    uint64_t maxDictionarySize)
+    const
+{
+	/* Samples are presented to the trainer concatenated */
+	uint64_t totalSize = 0;
+	std::vector<size_t> sampleSizes;
+	sampleSizes.reserve(samples.size());
+	for (const auto &sample : samples) {
+		sampleSizes.push_back(sample.size());
+		totalSize += sample.size();
+	}
+	Memory::uint8Array concatenated(totalSize);
+	uint64_t offset = 0;
+	for (const auto &sample : samples) {
+		std::memcpy(concatenated + offset, sample, sample.size());
+		offset += sample.size();
+	}
+
+	Memory::uint8Array dictionary(maxDictionarySize);
+	const size_t rv = ZDICT_trainFromBuffer(dictionary, dictionary.size(),
+	    concatenated, sampleSizes.data(),
+	    static_cast<unsigned int>(sampleSizes.size()));
+	if (ZDICT_isError(rv))
+		throw Error::StrategyError("Could not train dictionary: " +
+		    std::string(ZDICT_getErrorName(rv)));
+
+	dictionary.resize(rv);
+	return (dictionary);
+}
+
+BiometricEvaluation::IO::Zstd::~Zstd()
+{
+
+}
+
+#endif /* BIOMEVAL_WITH_ZSTD */
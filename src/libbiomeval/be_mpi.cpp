@@ -50,7 +50,8 @@ const std::map<BiometricEvaluation::MPI::MessageTag, std::string>
 BE_MPI_MessageTag_EnumToStringMap  = {
 	{BiometricEvaluation::MPI::MessageTag::Control, "Control"},
 	{BiometricEvaluation::MPI::MessageTag::Data, "Data"},
-	{BiometricEvaluation::MPI::MessageTag::OOB, "Out-of-band"}
+	{BiometricEvaluation::MPI::MessageTag::OOB, "Out-of-band"},
+	{BiometricEvaluation::MPI::MessageTag::Report, "Report"}
 };
 BE_FRAMEWORK_ENUMERATION_DEFINITIONS(
     BiometricEvaluation::MPI::MessageTag,
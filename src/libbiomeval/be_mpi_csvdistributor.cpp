@@ -107,15 +107,15 @@ BiometricEvaluation::MPI::CSVDistributor::createWorkPackage(
 
 	/*
 	 * Distribute a work package based on the chunk size given
-	 * in the resources object. If a failure occurs reading a key,
-	 * continue onto the next key. It is possible to send an empty
-	 * work package due to sequential failures.
+	 * in the resources object, possibly adapted to processing
+	 * times. If a failure occurs reading a key, continue onto the
+	 * next key. It is possible to send an empty work package due
+	 * to sequential failures.
 	 */
-	uint64_t lineCount;
-	if (this->_resources->getNumRemainingLines() >
-	    this->_resources->getChunkSize())
-		lineCount = this->_resources->getChunkSize();
-	else
+	uint64_t lineCount = this->getWorkPackageSize(
+	    this->_resources->getChunkSize(),
+	    this->_resources->getNumRemainingLines());
+	if (lineCount > this->_resources->getNumRemainingLines())
 		lineCount = this->_resources->getNumRemainingLines();
 
 	/*
@@ -145,11 +145,19 @@ BiometricEvaluation::MPI::CSVDistributor::createWorkPackage(
 	/*
 	 * NOTE: At this point it is possible to have no keys in the package.
 	 */
-	this->_distributedLineCount += realLineCount;
 	workPackage.setNumElements(realLineCount);
+	workPackage.setNumInputElements(realLineCount);
 	workPackage.setData(packageData);
 }
 
+void
+BiometricEvaluation::MPI::CSVDistributor::workPackageSent(
+    const MPI::WorkPackage &workPackage)
+{
+	/* Lines queued ahead of requests are not yet distributed */
+	this->_distributedLineCount += workPackage.getNumInputElements();
+}
+
 void
 BiometricEvaluation::MPI::CSVDistributor::checkpointSave(
     const std::string &reason)
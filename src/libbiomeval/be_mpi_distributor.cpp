@@ -8,6 +8,12 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
 #include <set>
 #include <string>
 #include <sstream>
@@ -37,6 +43,171 @@ BiometricEvaluation::MPI::Distributor::CHECKPOINTREASON = "Reason";
 const std::string
 BiometricEvaluation::MPI::Distributor::CHECKPOINTPID = "PID";
 
+/*
+ * Bounded queue of WorkPackages, filled by one producer thread and
+ * emptied by the thread sending WorkPackages. Counts kept for the log
+ * are only read once the producer has finished.
+ */
+class BiometricEvaluation::MPI::Distributor::WorkPackageQueue
+{
+public:
+	WorkPackageQueue(
+	    uint32_t capacity) :
+	    _capacity(capacity)
+	{
+	}
+
+	/*
+	 * Add a WorkPackage, waiting while the queue is full. Returns
+	 * whether the producer should continue. Once stopped, the
+	 * WorkPackage is queued anyway, since its elements have already
+	 * been taken from the input.
+	 */
+	bool
+	push(
+	    std::unique_ptr<BE::MPI::WorkPackage> &&workPackage)
+	{
+		const auto begin = std::chrono::steady_clock::now();
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		this->_notFull.wait(lock, [&]() {
+		    return (this->_stopped ||
+		    (this->_packages.size() < this->_capacity)); });
+		this->fullTime += std::chrono::steady_clock::now() - begin;
+
+		this->_packages.push_back(std::move(workPackage));
+		this->_notEmpty.notify_one();
+		return (!this->_stopped);
+	}
+
+	/* No more WorkPackages will be added, possibly due to error */
+	void
+	finish(
+	    std::exception_ptr error)
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_finished = true;
+		this->_error = error;
+		this->_notEmpty.notify_all();
+	}
+
+	/* Ask the producer to finish */
+	void
+	stop()
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_stopped = true;
+		this->_notFull.notify_all();
+	}
+
+	/*
+	 * Remove the next WorkPackage, waiting while the queue is empty.
+	 * Returns false once the producer has finished and the queue
+	 * is empty, rethrowing any error from the producer.
+	 */
+	bool
+	pop(
+	    std::unique_ptr<BE::MPI::WorkPackage> &workPackage,
+	    size_t &depth,
+	    std::chrono::microseconds &waited)
+	{
+		const auto begin = std::chrono::steady_clock::now();
+		std::unique_lock<std::mutex> lock(this->_mutex);
+		depth = this->_packages.size();
+		this->_notEmpty.wait(lock, [&]() {
+		    return (this->_finished || !this->_packages.empty()); });
+		waited = std::chrono::duration_cast<std::chrono::microseconds>(
+		    std::chrono::steady_clock::now() - begin);
+		if (this->_packages.empty()) {
+			if (this->_error != nullptr)
+				std::rethrow_exception(this->_error);
+			return (false);
+		}
+
+		workPackage = std::move(this->_packages.front());
+		this->_packages.pop_front();
+		this->_notFull.notify_one();
+
+		this->requests++;
+		this->depthTotal += depth;
+		if (depth == 0)
+			this->waits++;
+		this->waitTime += waited;
+		this->maxWaitTime = std::max(this->maxWaitTime, waited);
+		return (true);
+	}
+
+	size_t
+	size()
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		return (this->_packages.size());
+	}
+
+	uint64_t
+	getNumElements()
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		uint64_t numElements{0};
+		for (const auto &workPackage : this->_packages)
+			numElements += workPackage->getNumElements();
+		return (numElements);
+	}
+
+	/* Packages created, and time spent creating them */
+	uint64_t created{0};
+	std::chrono::steady_clock::duration createTime{};
+	/* Time the producer waited for room in the queue */
+	std::chrono::steady_clock::duration fullTime{};
+
+	/* Packages requested, and the queue depth when requested */
+	uint64_t requests{0};
+	uint64_t depthTotal{0};
+	/* Requests that waited for a package, and time waited */
+	uint64_t waits{0};
+	std::chrono::microseconds waitTime{};
+	std::chrono::microseconds maxWaitTime{};
+
+private:
+	std::mutex _mutex{};
+	std::condition_variable _notFull{};
+	std::condition_variable _notEmpty{};
+	std::deque<std::unique_ptr<BE::MPI::WorkPackage>> _packages{};
+	const size_t _capacity;
+	bool _stopped{false};
+	bool _finished{false};
+	std::exception_ptr _error{};
+};
+
+/*
+ * The messages carrying a WorkPackage to a task, which must remain
+ * in place until the sends complete.
+ */
+class BiometricEvaluation::MPI::Distributor::WorkPackageSend
+{
+public:
+	BE::MPI::taskcmd_t taskCommand{};
+	BE::Memory::uint8Array data{};
+	uint64_t numElements{};
+	::MPI::Request requests[3]{};
+
+	/* Whether all sends have completed, releasing the data if so */
+	bool
+	test()
+	{
+		if (!::MPI::Request::Testall(3, this->requests))
+			return (false);
+		this->data.resize(0, true);
+		return (true);
+	}
+
+	void
+	wait()
+	{
+		::MPI::Request::Waitall(3, this->requests);
+		this->data.resize(0, true);
+	}
+};
+
 /******************************************************************************/
 /* Class method definitions.                                                  */
 /******************************************************************************/
@@ -99,11 +270,33 @@ BiometricEvaluation::MPI::Distributor::getCheckpointData() const
 	return (this->_checkpointData);
 }
 
+uint64_t
+BiometricEvaluation::MPI::Distributor::getWorkPackageSize(
+    const uint64_t chunkSize,
+    const uint64_t remaining) const
+{
+	if (this->_resources->getTargetChunkTime() == 0)
+		return (chunkSize);
+
+	uint64_t size = this->_adaptedChunkSize;
+	if (size == 0)
+		size = chunkSize;
+
+	/* Guided self-scheduling: an even share of what remains */
+	const uint64_t share = (remaining + this->_numWorkers - 1) /
+	    this->_numWorkers;
+	return (std::max<uint64_t>(1, std::min(size, share)));
+}
+
 /******************************************************************************/
 /* Object method definitions.                                                 */
 /******************************************************************************/
 BiometricEvaluation::MPI::Distributor::~Distributor()
 {
+	if (this->_workPackageProducer.joinable()) {
+		this->_workPackageQueue->stop();
+		this->_workPackageProducer.join();
+	}
 }
 
 void
@@ -155,32 +348,248 @@ BiometricEvaluation::MPI::Distributor::sendWorkPackage(
     BE::MPI::WorkPackage &workPackage, int MPITask)
 {
 	/*
-	 * Send three pieces of information:
+	 * The previous work package sent to the task has been received,
+	 * since the task is asking for another.
+	 */
+	auto &send = this->_workPackageSends[MPITask];
+	if (send == nullptr)
+		send.reset(new WorkPackageSend());
+	else
+		send->wait();
+
+	/*
+	 * Send three pieces of information, after the command
+	 * telling the task to continue:
 	 * The raw data and length, in the first message;
 	 * The number of elements in the second message.
 	 */
-	BE::Memory::uint8Array data(0);
-	workPackage.getData(data);
-	int size = static_cast<int>(data.size());
-	::MPI::COMM_WORLD.Send(
-	    (void *)data, size, MPI_CHAR, MPITask,
+	send->taskCommand = to_int_type(MPI::TaskCommand::Continue);
+	send->requests[0] = ::MPI::COMM_WORLD.Isend(
+	    (void *)&send->taskCommand, 1, MPI_INT32_T, MPITask,
+	    to_int_type(BE::MPI::MessageTag::Control));
+
+	workPackage.getData(send->data);
+	int size = static_cast<int>(send->data.size());
+	send->requests[1] = ::MPI::COMM_WORLD.Isend(
+	    (void *)send->data, size, MPI_CHAR, MPITask,
 	    to_int_type(BE::MPI::MessageTag::Data));
 
-	uint64_t numElements = workPackage.getNumElements();
-	::MPI::COMM_WORLD.Send(
-	    (void *)&numElements, 1, MPI_UINT64_T,
+	send->numElements = workPackage.getNumElements();
+	send->requests[2] = ::MPI::COMM_WORLD.Isend(
+	    (void *)&send->numElements, 1, MPI_UINT64_T,
 	    MPITask, to_int_type(BE::MPI::MessageTag::Data));
 
-	BE::IO::Logsheet *log = this->_logsheet.get();
+	this->workPackageSent(workPackage);
+
+	std::ostringstream sstr;
+	sstr << "Sent package of size " << size << " (" <<
+	    send->numElements << " elements) to Task-" << MPITask;
+	this->writeLog(sstr.str());
+}
+
+void
+BiometricEvaluation::MPI::Distributor::workPackageSent(
+    const MPI::WorkPackage & /* workPackage */)
+{
+}
+
+void
+BiometricEvaluation::MPI::Distributor::completeWorkPackageSends(
+    bool wait)
+{
+	for (auto it = this->_workPackageSends.begin();
+	    it != this->_workPackageSends.end(); ) {
+		if (wait) {
+			it->second->wait();
+		} else if (!it->second->test()) {
+			++it;
+			continue;
+		}
+		it = this->_workPackageSends.erase(it);
+	}
+}
+
+void
+BiometricEvaluation::MPI::Distributor::writeLog(
+    const std::string &message)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->_pendingLogMutex);
+		this->_pendingLog.push_back(message);
+	}
+
+	/*
+	 * While the producer holds the Logsheet, messages wait for it to
+	 * finish the work package, rather than delaying distribution.
+	 */
+	std::unique_lock<std::mutex> lock(this->_logMutex, std::try_to_lock);
+	if (lock.owns_lock())
+		this->flushLog();
+}
+
+void
+BiometricEvaluation::MPI::Distributor::flushLog()
+{
+	std::vector<std::string> messages;
+	{
+		std::lock_guard<std::mutex> lock(this->_pendingLogMutex);
+		messages.swap(this->_pendingLog);
+	}
+	for (const auto &message : messages)
+		MPI::logMessage(*this->_logsheet, message);
+}
+
+void
+BiometricEvaluation::MPI::Distributor::startWorkPackageQueue()
+{
+	const uint32_t depth = this->_resources->getWorkPackageQueueDepth();
+	if (depth == 0)
+		return;
+
+	this->_workPackageQueue.reset(new WorkPackageQueue(depth));
+	this->_workPackageProducer = std::thread([this]() {
+		WorkPackageQueue &queue = *this->_workPackageQueue;
+		std::exception_ptr error{};
+		try {
+			while (!(BE::MPI::Exit || BE::MPI::QuickExit ||
+			    BE::MPI::TermExit)) {
+				auto workPackage = BE::Memory::make_unique<
+				    MPI::WorkPackage>();
+				const auto begin =
+				    std::chrono::steady_clock::now();
+				{
+					std::lock_guard<std::mutex> lock(
+					    this->_logMutex);
+					this->createWorkPackage(*workPackage);
+					this->flushLog();
+				}
+				queue.createTime +=
+				    std::chrono::steady_clock::now() - begin;
+				if (workPackage->getNumElements() == 0)
+					break;
+				queue.created++;
+				if (!queue.push(std::move(workPackage)))
+					break;
+			}
+		} catch (...) {
+			error = std::current_exception();
+		}
+		queue.finish(error);
+	});
+
+	std::ostringstream sstr;
+	sstr << "Creating work packages ahead of requests, queue depth " <<
+	    depth;
+	this->writeLog(sstr.str());
+}
+
+void
+BiometricEvaluation::MPI::Distributor::stopWorkPackageQueue()
+{
+	if (!this->_workPackageProducer.joinable())
+		return;
+	this->_workPackageQueue->stop();
+	this->_workPackageProducer.join();
+
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+	const WorkPackageQueue &queue = *this->_workPackageQueue;
+	std::ostringstream sstr;
+	sstr << "Work package queue: Created " << queue.created <<
+	    " packages in " << Milliseconds(queue.createTime).count() <<
+	    " ms, waiting " << Milliseconds(queue.fullTime).count() <<
+	    " ms for room in the queue";
+	this->writeLog(sstr.str());
+	sstr.str("");
+	sstr << "Work package queue: " << queue.requests << " requests, " <<
+	    "mean queue depth " << (queue.requests == 0 ? 0.0 :
+	    static_cast<double>(queue.depthTotal) / queue.requests) <<
+	    "; " << queue.waits << " waited " <<
+	    Milliseconds(queue.waitTime).count() << " ms (maximum " <<
+	    Milliseconds(queue.maxWaitTime).count() << " ms)";
+	this->writeLog(sstr.str());
+}
+
+void
+BiometricEvaluation::MPI::Distributor::receiveReport(
+    int MPITask)
+{
+	uint64_t report[2];
+	::MPI::COMM_WORLD.Recv((void *)report, 2, MPI_UINT64_T, MPITask,
+	    to_int_type(MPI::MessageTag::Report));
+	const uint64_t numElements = report[0];
+	const uint64_t microseconds = report[1];
+	if (numElements == 0)
+		return;
+	this->_reportedElements += numElements;
+	this->_reportedTime += microseconds;
+
+	std::ostringstream sstr;
+	sstr << "Task-" << MPITask << " processed " << numElements <<
+	    " elements in " << (microseconds / 1000.0) << " ms (" <<
+	    (microseconds == 0 ? 0.0 : (numElements * 1000000.0 /
+	    microseconds)) << " elements/s per worker)";
+
+	/*
+	 * Adapt the size of work packages to a moving average of the
+	 * time taken to process an element.
+	 */
+	const uint32_t targetTime = this->_resources->getTargetChunkTime();
+	if (targetTime != 0) {
+		static const double Weight{0.25};
+		const double elementTime = static_cast<double>(microseconds) /
+		    numElements;
+		if (this->_elementTime == 0)
+			this->_elementTime = elementTime;
+		else
+			this->_elementTime = ((1 - Weight) *
+			    this->_elementTime) + (Weight * elementTime);
+
+		uint64_t size = 1;
+		if (this->_elementTime > 0)
+			size = std::max<uint64_t>(1, static_cast<uint64_t>(
+			    (targetTime * 1000.0) / this->_elementTime));
+		else
+			size = std::numeric_limits<uint32_t>::max();
+		const uint32_t maximum = this->_resources->getMaximumChunkSize();
+		if (maximum != 0)
+			size = std::min<uint64_t>(size, maximum);
+		this->_adaptedChunkSize = size;
+		sstr << "; chunk size " << size;
+	}
+	this->writeLog(sstr.str());
+}
+
+bool
+BiometricEvaluation::MPI::Distributor::nextWorkPackage(
+    std::unique_ptr<MPI::WorkPackage> &workPackage)
+{
+	if (BE::MPI::QuickExit || BE::MPI::TermExit)
+		return (false);
+
+	if (this->_workPackageQueue == nullptr) {
+		if (BE::MPI::Exit)
+			return (false);
+		workPackage = BE::Memory::make_unique<MPI::WorkPackage>();
+		this->createWorkPackage(*workPackage);
+		return (workPackage->getNumElements() != 0);
+	}
+
+	/* On Exit, the packages already created are still distributed */
+	size_t depth;
+	std::chrono::microseconds waited;
+	if (!this->_workPackageQueue->pop(workPackage, depth, waited))
+		return (false);
 	std::ostringstream sstr;
-	sstr << "Sent package of size " << size << " to Task-" << MPITask;
-	MPI::logMessage(*log, sstr.str());
+	sstr << "Work package queue depth " << depth << ", waited " <<
+	    waited.count() << " us";
+	this->writeLog(sstr.str());
+	return (true);
 }
 
 void
 BiometricEvaluation::MPI::Distributor::distributeWork()
 {
-	MPI::WorkPackage workPackage;
+	std::unique_ptr<MPI::WorkPackage> workPackage;
 	int numTasks = this->_activeMpiTasks.size();
 	auto taskStatus = BE::Memory::make_unique<MPI::taskstat_t[]>(numTasks);
 	auto indices = BE::Memory::make_unique<int[]>(numTasks);
@@ -189,6 +598,10 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 	int numRequests;
 	BE::IO::Logsheet *log = this->_logsheet.get();
 
+	this->_numWorkers = std::max<uint64_t>(1, numTasks *
+	    this->_resources->getWorkersPerNode());
+	this->startWorkPackageQueue();
+
 	/*
  	 * Perform a non-blocking receive from all child tasks.
  	 * This loop creates the initial set of receive requests,
@@ -214,13 +627,20 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 		/*
 		 * Check for exit signal conditions. The action
 		 * taken for each condition will be done outside
-		 * of this distribution loop.
+		 * of this distribution loop. On Exit, work packages
+		 * that have been created are distributed first.
 		 */
-		if (BiometricEvaluation::MPI::Exit ||
-		    BiometricEvaluation::MPI::QuickExit ||
+		if (BiometricEvaluation::MPI::QuickExit ||
 		    BiometricEvaluation::MPI::TermExit) {
 			break;
 		}
+		if (BiometricEvaluation::MPI::Exit) {
+			if (this->_workPackageQueue == nullptr)
+				break;
+			this->stopWorkPackageQueue();
+			if (this->_workPackageQueue->size() == 0)
+				break;
+		}
 
 		/*
 		 * Implement a fair message processing scheme, where all 
@@ -239,27 +659,25 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 	 		* then take it out of the list of
 	 		* active tasks.
 			*/
-			*log << "Received ";
 			const auto ts = to_enum<MPI::TaskStatus>(
 			    taskStatus[indices[r]]);
 			if ((ts == MPI::TaskStatus::Exit) ||
 			    (ts == MPI::TaskStatus::Failed)) {
-				*log << "Exit/Failure from Task-" << task;
-				MPI::logEntry(*log);
+				this->writeLog("Received Exit/Failure from "
+				    "Task-" + std::to_string(task));
 				this->_activeMpiTasks.erase(task);
 				continue;
 			} else if (ts == MPI::TaskStatus::
 			    RequestJobTermination) {
-				*log << "Job termination request from Task-" <<
-				    task;
-				MPI::logEntry(*log);
+				this->writeLog("Received Job termination "
+				    "request from Task-" +
+				    std::to_string(task));
 				BE::MPI::TermExit = true;
 				continue;
 			}
-			*log << "OK from Task-" << task;
-			MPI::logEntry(*log);
-
-			this->createWorkPackage(workPackage);
+			this->writeLog("Received OK from Task-" +
+			    std::to_string(task));
+			this->receiveReport(task);
 
 			/*
 			 * If we are out of work, or in a shutdown
@@ -267,10 +685,7 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 			 * reply. We need to do this so the
 			 * communication send/recv pairs stay in sync.
 			 */
-			if ((workPackage.getNumElements() == 0) ||
-			   (BiometricEvaluation::MPI::Exit ||
-			    BiometricEvaluation::MPI::QuickExit ||
-			    BiometricEvaluation::MPI::TermExit)) {
+			if (!this->nextWorkPackage(workPackage)) {
 				taskCmd = to_int_type(MPI::TaskCommand::Ignore);
 				::MPI::COMM_WORLD.Send(
 				    (void *)&taskCmd, 1, MPI_INT32_T, task,
@@ -282,11 +697,7 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 			 * Tell the task to continue with the
 			 * data coming in the next messages.
 			 */
-			taskCmd = to_int_type(MPI::TaskCommand::Continue);
-			::MPI::COMM_WORLD.Send((void *)&taskCmd, 1, MPI_INT32_T,
-			    task, to_int_type(MPI::MessageTag::Control));
-
-			sendWorkPackage(workPackage, task);
+			sendWorkPackage(*workPackage, task);
 
 			/*
 			 * Repost the non-blocking receive
@@ -298,6 +709,32 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 		}
 		if (this->_activeMpiTasks.empty())
 			break;
+
+		/*
+		 * While no requests are waiting, release the data of
+		 * work packages that have been received, and let the
+		 * work package producer run.
+		 */
+		if (numRequests <= 0) {
+			this->completeWorkPackageSends(false);
+			std::this_thread::yield();
+		}
+	}
+
+	/*
+	 * Work packages may remain queued when no task is left to take
+	 * them. Those elements are not distributed, and since checkpoint
+	 * state is only updated as packages are sent, a restore
+	 * distributes them again.
+	 */
+	this->stopWorkPackageQueue();
+	if ((this->_workPackageQueue != nullptr) &&
+	    (this->_workPackageQueue->size() != 0)) {
+		*log << "Work package queue: " <<
+		    this->_workPackageQueue->size() << " packages with " <<
+		    this->_workPackageQueue->getNumElements() <<
+		    " elements were not distributed";
+		MPI::logEntry(*log);
 	}
 
 	/*
@@ -357,6 +794,8 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 				MPI::logEntry(*log);
 				this->_activeMpiTasks.erase(task);
 			} else {
+				if (ts == MPI::TaskStatus::OK)
+					this->receiveReport(task);
 				::MPI::COMM_WORLD.Send(
 				    (void *)&taskCmd, 1,
 				    MPI_INT32_T, task,
@@ -366,6 +805,8 @@ BiometricEvaluation::MPI::Distributor::distributeWork()
 		numRequests = ::MPI::Request::Testsome(
 		    numTasks, requests.get(), indices.get(), MPIstatus.get());
 	}
+
+	this->completeWorkPackageSends(true);
 }
 
 void
@@ -411,6 +852,8 @@ BiometricEvaluation::MPI::Distributor::shutdown()
 
 		/* Tell the task to exit */
 		int task = MPIstatus.Get_source();
+		if (taskStatus == to_int_type(MPI::TaskStatus::OK))
+			this->receiveReport(task);
 		::MPI::COMM_WORLD.Send(
 		    (void *)&taskCmd, 1, MPI_INT32_T, task,
 		    to_int_type(MPI::MessageTag::Control));
@@ -420,6 +863,12 @@ BiometricEvaluation::MPI::Distributor::shutdown()
 		*log << "Sent exit command to Task-" << task;
 		MPI::logEntry(*log);
 	}
+	*log << "Tasks processed " << this->_reportedElements <<
+	    " elements in " << (this->_reportedTime / 1000000.0) <<
+	    " s of worker time (" << (this->_reportedTime == 0 ? 0.0 :
+	    (this->_reportedElements * 1000000.0 / this->_reportedTime)) <<
+	    " elements/s per worker)";
+	MPI::logEntry(*log);
 
 	/* Wait for other tasks to start the shut down */
 	::MPI::COMM_WORLD.Barrier();
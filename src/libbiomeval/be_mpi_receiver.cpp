@@ -7,12 +7,18 @@
  * its use by other parties, and makes no guarantees, expressed or implied,
  * about its quality, reliability, or any other characteristic.
  */
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <set>
 #include <sstream>
+#include <vector>
 #include <mpi.h>
 #include <signal.h>
-#include <time.h>
 
+#include <be_error.h>
 #include <be_memory_autoarrayutility.h>
 #include <be_mpi.h>
 #include <be_mpi_exception.h>
@@ -22,6 +28,12 @@
 namespace BE = BiometricEvaluation;
 using namespace BE::Framework::Enumeration;
 
+/*
+ * Longest time to wait for a worker to ask for work before checking for
+ * out-of-band messages from Task-0.
+ */
+static const std::chrono::milliseconds OOBCheckInterval{100};
+
 /*
  * Local helper functions.
  */
@@ -47,25 +59,156 @@ static void commandToMessage(
 }
 
 /*
- * Convert a message to a task status.
+ * Convert a message to a task status, and the number of elements
+ * processed, the time taken, in microseconds, and the latency of the
+ * last request for a work package, in microseconds, that follow it.
  */
 static BiometricEvaluation::MPI::TaskStatus
-messageToStatus(const BE::Memory::uint8Array &message)
+messageToStatus(
+    const BE::Memory::uint8Array &message,
+    uint64_t &numElements,
+    uint64_t &microseconds,
+    uint64_t &latency)
 {
-	return (to_enum<BE::MPI::TaskStatus>(std::stoi(to_string(message))));
+	std::istringstream sstr(to_string(message));
+	BE::MPI::taskstat_t taskStatus;
+	sstr >> taskStatus;
+	numElements = microseconds = latency = 0;
+	if (!(sstr >> numElements >> microseconds >> latency))
+		numElements = microseconds = latency = 0;
+	return (to_enum<BE::MPI::TaskStatus>(taskStatus));
 }
 
 /*
- * Convert a task status to a message.
+ * Convert a task status to a message, followed by the number of
+ * elements processed since the last message, the time taken, and
+ * the latency of the last request for a work package.
  */
 static void statusToMessage(
     const BiometricEvaluation::MPI::TaskStatus taskStatus,
-    BE::Memory::uint8Array &message)
+    BE::Memory::uint8Array &message,
+    uint64_t numElements = 0,
+    uint64_t microseconds = 0,
+    uint64_t latency = 0)
 {
 	BE::Memory::AutoArrayUtility::setString(message,
-	    std::to_string(to_int_type(taskStatus)));
+	    std::to_string(to_int_type(taskStatus)) + ' ' +
+	    std::to_string(numElements) + ' ' + std::to_string(microseconds) +
+	    ' ' + std::to_string(latency));
 }
 
+/*
+ * Work package buffers in memory shared with the worker processes. The
+ * memory is mapped before the workers are forked, so every worker sees
+ * the buffers at the same address. Only the Receiver acquires and
+ * releases buffers: a buffer handed to a worker is released when that
+ * worker next sends a status message, as it has then finished with the
+ * work package, so the pipe messages order all use of the buffers.
+ */
+class BiometricEvaluation::MPI::Receiver::PackageBuffers
+{
+public:
+	/** Buffer number meaning the work package is not in a buffer */
+	static const uint64_t None = UINT64_MAX;
+
+	PackageBuffers(
+	    const uint64_t count,
+	    const uint64_t size) :
+	    _size(size),
+	    _used(count, false),
+	    _lengths(count, 0),
+	    _owners(count, nullptr)
+	{
+		void *mapping = ::mmap(nullptr, count * size,
+		    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+		if (mapping == MAP_FAILED)
+			throw BE::Error::StrategyError("Could not map work "
+			    "package buffers: " + BE::Error::errorStr());
+		this->_buffers = static_cast<uint8_t *>(mapping);
+	}
+
+	~PackageBuffers()
+	{
+		::munmap(this->_buffers, this->_used.size() * this->_size);
+	}
+
+	/*
+	 * Obtain a free buffer for a work package of length octets, or
+	 * None if the package is too large or no buffer is free.
+	 */
+	uint64_t
+	acquire(
+	    const uint64_t length)
+	{
+		if (length > this->_size)
+			return (None);
+		for (uint64_t i = 0; i < this->_used.size(); i++) {
+			if (!this->_used[i]) {
+				this->_used[i] = true;
+				this->_lengths[i] = length;
+				return (i);
+			}
+		}
+		return (None);
+	}
+
+	/* Record that a worker is using a buffer */
+	void
+	assign(
+	    const uint64_t buffer,
+	    const void *owner)
+	{
+		if (buffer != None)
+			this->_owners[buffer] = owner;
+	}
+
+	/* Release a buffer, unless a worker is using it */
+	void
+	release(
+	    const uint64_t buffer)
+	{
+		if ((buffer != None) && (this->_owners[buffer] == nullptr))
+			this->_used[buffer] = false;
+	}
+
+	/* Release the buffer a worker was using, if any */
+	void
+	releaseOwner(
+	    const void *owner)
+	{
+		for (uint64_t i = 0; i < this->_owners.size(); i++) {
+			if (this->_owners[i] == owner) {
+				this->_owners[i] = nullptr;
+				this->_used[i] = false;
+			}
+		}
+	}
+
+	uint8_t *
+	get(
+	    const uint64_t buffer)
+	    const
+	{
+		return (this->_buffers + (buffer * this->_size));
+	}
+
+	/* Length of the work package in a buffer */
+	uint64_t
+	getLength(
+	    const uint64_t buffer)
+	    const
+	{
+		return (this->_lengths[buffer]);
+	}
+
+private:
+	uint8_t *_buffers{nullptr};
+	const uint64_t _size;
+	std::vector<bool> _used;
+	std::vector<uint64_t> _lengths;
+	std::vector<const void *> _owners;
+};
+
 /******************************************************************************/
 /* Class method definitions.                                                  */
 /******************************************************************************/
@@ -74,10 +217,12 @@ static void statusToMessage(
  */
 BiometricEvaluation::MPI::Receiver::PackageWorker::PackageWorker(
     const std::shared_ptr<MPI::WorkPackageProcessor> &workPackageProcessor,
-    const std::shared_ptr<MPI::Resources> &resources)
+    const std::shared_ptr<MPI::Resources> &resources,
+    const std::shared_ptr<PackageBuffers> &packageBuffers)
 {
 	this->_workPackageProcessor = workPackageProcessor;
 	this->_resources = resources;
+	this->_packageBuffers = packageBuffers;
 }
 
 int32_t
@@ -107,6 +252,15 @@ BiometricEvaluation::MPI::Receiver::PackageWorker::workerMain()
 	BE::Memory::uint8Array message;
 	MPI::TaskStatus taskStatus = MPI::TaskStatus::OK;
 	MPI::TaskCommand taskCommand;
+	uint64_t processedElements{0};
+	std::chrono::microseconds processingTime{};
+
+	/*
+	 * Latency of the last request for a work package: the time from
+	 * asking the Receiver for work to being told to continue.
+	 */
+	std::chrono::steady_clock::time_point requested;
+	std::chrono::microseconds latency{};
 
 	/*
 	 * The child process needs its own copy of the package
@@ -161,12 +315,17 @@ BiometricEvaluation::MPI::Receiver::PackageWorker::workerMain()
 		 * Send a status message to report status, asking for more
 		 * work unless we are in a bad state; then exit.
 		 */
-		statusToMessage(taskStatus, message);
+		statusToMessage(taskStatus, message, processedElements,
+		    processingTime.count(), latency.count());
+		processedElements = 0;
+		processingTime = std::chrono::microseconds::zero();
+		latency = std::chrono::microseconds::zero();
 		try {
 			this->sendMessageToManager(message);
 			if (taskStatus != MPI::TaskStatus::OK) {
 				break;
 			}
+			requested = std::chrono::steady_clock::now();
 		} catch (const Error::Exception &e) {
 			MPI::logMessage(*log, "Worker send message failure: "
 			    + e.whatString());
@@ -198,17 +357,30 @@ BiometricEvaluation::MPI::Receiver::PackageWorker::workerMain()
 		if (taskCommand == MPI::TaskCommand::Ignore) {
 			continue;
 		}
+		latency = std::chrono::duration_cast<std::chrono::microseconds>(
+		    std::chrono::steady_clock::now() - requested);
+
 		/*
 		 * Receieve the work package and hand it off to the
-		 * package processor.
+		 * package processor. The data is either in a shared
+		 * buffer, or follows through the pipe.
 		 */
 		try {
 			this->waitForMessage();
 			this->receiveMessageFromManager(message);
-			uint64_t wpCount;
-			std::memcpy(&wpCount, &message[0], sizeof(wpCount));
-			this->waitForMessage();
-			this->receiveMessageFromManager(message);
+			uint64_t header[3];
+			std::memcpy(header, &message[0], sizeof(header));
+			const uint64_t wpCount = header[0];
+			const uint64_t buffer = header[1];
+			const uint64_t length = header[2];
+			if (buffer != PackageBuffers::None) {
+				message.resize(length);
+				std::memcpy(&message[0],
+				    this->_packageBuffers->get(buffer), length);
+			} else {
+				this->waitForMessage();
+				this->receiveMessageFromManager(message);
+			}
 			workPackage = MPI::WorkPackage(message);
 			workPackage.setNumElements(wpCount);
 		} catch (const Error::Exception &e) {
@@ -218,8 +390,13 @@ BiometricEvaluation::MPI::Receiver::PackageWorker::workerMain()
 			continue; /* Attempt to send one final status */
 		}
 		try {
+			const auto begin = std::chrono::steady_clock::now();
 			this->_workPackageProcessor->processWorkPackage(
 			    workPackage);
+			processingTime = std::chrono::duration_cast<
+			    std::chrono::microseconds>(
+			    std::chrono::steady_clock::now() - begin);
+			processedElements = workPackage.getNumElements();
 		} catch (const MPI::TerminateJob &e) {
 			MPI::logMessage(*log,
 			    "Package processor wants complete job termination: "
@@ -262,7 +439,8 @@ BiometricEvaluation::MPI::Receiver::~Receiver()
 
 void
 BiometricEvaluation::MPI::Receiver::sendWorkPackage(
-    MPI::WorkPackage &workPackage)
+    MPI::WorkPackage &workPackage,
+    const uint64_t buffer)
 {
 	/*
 	 * While there is some worker available, send the work package
@@ -320,24 +498,30 @@ BiometricEvaluation::MPI::Receiver::sendWorkPackage(
 		}
 
 		/*
- 		 * If no worker is ready, pause for a bit, then go back
- 		 * to the top of the loop and start over.
+ 		 * Sleep until a worker asks for work, waking immediately
+ 		 * when one does. If none has after a while, go back to the
+ 		 * top of the loop to check for messages from Task-0, which
+ 		 * cannot be waited for together with the workers' pipes.
  		 */
-		bool msgAvail =
-		    this->_processManager.getNextMessage(worker, message, 0);
-		if (!msgAvail) {
-			struct timespec ts;
-			ts.tv_sec = 0;
-			ts.tv_nsec = 100000000L;	/* 100 milliseconds */
-			nanosleep(&ts, NULL);
+		bool msgAvail = this->_processManager.getNextMessage(worker,
+		    message, OOBCheckInterval);
+		if (!msgAvail)
 			continue;
-		}
 
 		/*
 		 * Once a worker is ready, we're dedicated to sending off
 		 * the work package, so no checks for Exit conditions here.
+		 * Any message means the worker is done with its last work
+		 * package, and so with the buffer holding it.
 		 */
-		taskStatus = messageToStatus(message);
+		if (this->_packageBuffers)
+			this->_packageBuffers->releaseOwner(worker.get());
+		uint64_t numElements, microseconds, latency;
+		taskStatus = messageToStatus(message, numElements,
+		    microseconds, latency);
+		this->_reportedElements += numElements;
+		this->_reportedTime += microseconds;
+		this->recordLatency(latency);
 
 		/*
 		 * When a worker gets into trouble, have it stop processing.
@@ -364,16 +548,25 @@ BiometricEvaluation::MPI::Receiver::sendWorkPackage(
 	worker->sendMessageToWorker(message);
 			
 	/*
-	 * A work package is sent in two parts: 
-	 * The number of elements, and the raw data.
+	 * A work package is sent in two parts: The number of elements,
+	 * the shared buffer holding the data, and the length of the data,
+	 * then the raw data when it is not in a shared buffer.
 	 */
-	uint64_t wpCount = workPackage.getNumElements();
-	message.resize(sizeof(wpCount));
-	std::memcpy(&message[0], &wpCount, sizeof(wpCount));
-	worker->sendMessageToWorker(message);
 	workPackage.getData(wpData);
-	worker->sendMessageToWorker(wpData);
-	*log << "Sent work package of size " << wpData.size() << " to worker";
+	const uint64_t length = (buffer == PackageBuffers::None ?
+	    wpData.size() : this->_packageBuffers->getLength(buffer));
+	const uint64_t header[3]{workPackage.getNumElements(), buffer, length};
+	message.resize(sizeof(header));
+	std::memcpy(&message[0], header, sizeof(header));
+	worker->sendMessageToWorker(message);
+	if (buffer == PackageBuffers::None) {
+		worker->sendMessageToWorker(wpData);
+		*log << "Sent work package of size " << length << " to worker";
+	} else {
+		this->_packageBuffers->assign(buffer, worker.get());
+		*log << "Sent work package of size " << length <<
+		    " to worker in shared buffer " << buffer;
+	}
 	MPI::logEntry(*log);
 }
 
@@ -426,11 +619,27 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 		}
 
 		MPI::logMessage(*log, "Asking for work package");
+
+		/*
+		 * Report the elements processed by workers since the
+		 * last request, and the time they took. Task-0 receives
+		 * the report only after the request, so the report must
+		 * not block the request.
+		 */
+		const uint64_t report[2]{this->_reportedElements,
+		    this->_reportedTime};
+		::MPI::Request reportRequest = ::MPI::COMM_WORLD.Isend(
+		    (void *)report, 2, MPI_UINT64_T, 0,
+		    to_int_type(MPI::MessageTag::Report));
+		this->_reportedElements = 0;
+		this->_reportedTime = 0;
+
 		taskStatus = to_int_type(MPI::TaskStatus::OK);
 		::MPI::COMM_WORLD.Sendrecv(
 		    (void *)&taskStatus, 1, MPI_INT32_T, 0,
 		    to_int_type(MPI::MessageTag::Control), &taskCommand, 1,
 		    MPI_INT32_T, 0, to_int_type(MPI::MessageTag::Control));
+		reportRequest.Wait();
 
 		const BE::MPI::TaskCommand  taskCommandE =
 		    to_enum<TaskCommand>(taskCommand);
@@ -453,25 +662,42 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 		 * Receive three pieces of information:
 		 * The raw data and length in the first message;
 		 * The number of elements in the second message.
+		 * The data is received directly into a shared buffer
+		 * when one is free and large enough.
 		 */
 		::MPI::COMM_WORLD.Probe(0, to_int_type(MPI::MessageTag::Data),
 		    MPIstatus);
 		uint64_t length = MPIstatus.Get_count(MPI_CHAR);
-		workPackageRaw.resize(length);
+		const uint64_t buffer = (this->_packageBuffers ?
+		    this->_packageBuffers->acquire(length) :
+		    PackageBuffers::None);
+		uint8_t *data;
+		if (buffer != PackageBuffers::None) {
+			workPackageRaw.resize(0);
+			data = this->_packageBuffers->get(buffer);
+		} else {
+			workPackageRaw.resize(length);
+			data = &workPackageRaw[0];
+		}
 		::MPI::COMM_WORLD.Recv(
-		    (void *)&workPackageRaw[0], length, MPI_CHAR, 0,
+		    (void *)data, length, MPI_CHAR, 0,
 		    to_int_type(MPI::MessageTag::Data));
-		workPackageRaw.resize(length);
 
 		uint64_t numElements;
 		::MPI::COMM_WORLD.Recv(
 		    (void *)&numElements, 1, MPI_UINT64_T, 0,
 		    to_int_type(MPI::MessageTag::Data));
+
+		/* The buffer is released here unless a worker has it */
 		try {
 			MPI::WorkPackage workPackage(workPackageRaw);
 			workPackage.setNumElements(numElements);
-			this->sendWorkPackage(workPackage);
+			this->sendWorkPackage(workPackage, buffer);
+			if (this->_packageBuffers)
+				this->_packageBuffers->release(buffer);
 		} catch (const MPI::TerminateJob &e) {
+			if (this->_packageBuffers)
+				this->_packageBuffers->release(buffer);
 			MPI::logMessage(*log,
 			    "Package processor requested job termination " +
 			    e.whatString());
@@ -482,6 +708,8 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 			     to_int_type(MPI::MessageTag::Control));
 			status = MPI::TaskStatus::RequestJobTermination;
 		} catch (const Error::Exception &e) {
+			if (this->_packageBuffers)
+				this->_packageBuffers->release(buffer);
 			MPI::logMessage(*log,
 			    "Failure to process work package: "
 			    + e.whatString());
@@ -496,15 +724,44 @@ BiometricEvaluation::MPI::Receiver::requestWorkPackages()
 	return (status);
 }
 
+void
+BiometricEvaluation::MPI::Receiver::recordLatency(
+    const uint64_t latency)
+{
+	if (latency == 0)
+		return;
+	this->_requests++;
+	this->_totalLatency += latency;
+	this->_maxLatency = std::max(this->_maxLatency, latency);
+}
+
 void
 BiometricEvaluation::MPI::Receiver::startWorkers()
 {
 	std::shared_ptr<Process::WorkerController> wc;
 	BE::IO::Logsheet *log = this->_logsheet.get();
+
+	/*
+	 * Map the shared buffers before forking: one for each worker,
+	 * and one for the work package being received. If that fails,
+	 * work packages go through the pipes.
+	 */
+	const uint64_t bufferSize = this->_resources->getSharedPackageSize();
+	if (bufferSize != 0) {
+		try {
+			this->_packageBuffers.reset(new PackageBuffers(
+			    this->_resources->getWorkersPerNode() + 1,
+			    bufferSize));
+		} catch (const Error::Exception &e) {
+			MPI::logMessage(*log, "Sending work packages through "
+			    "pipes: " + e.whatString());
+		}
+	}
+
 	for (int w = 0; w < this->_resources->getWorkersPerNode(); w++) {
 		std::shared_ptr<PackageWorker> pw(new PackageWorker(
 		    this->_workPackageProcessor,
-		    this->_resources));
+		    this->_resources, this->_packageBuffers));
 		wc = this->_processManager.addWorker(pw);
 		try {
 			this->_processManager.startWorker(wc, false, true);
@@ -642,6 +899,10 @@ BiometricEvaluation::MPI::Receiver::shutdown(
 			}
 			if (!msgAvail)
 				break;
+			uint64_t numElements, microseconds, latency;
+			(void)messageToStatus(inMessage, numElements,
+			    microseconds, latency);
+			this->recordLatency(latency);
 			try {
 				this->_processManager.stopWorker(worker);
 			} catch (const Error::Exception &e) {
@@ -650,6 +911,14 @@ BiometricEvaluation::MPI::Receiver::shutdown(
 			}
 		}
 	}
+	if (this->_requests != 0) {
+		*log << "Work package request latency: " << this->_requests <<
+		    " requests, mean " << (this->_totalLatency /
+		    this->_requests) << " us, max " << this->_maxLatency <<
+		    " us";
+		MPI::logEntry(*log);
+	}
+
 	/*
 	 * Call shutdown function in the work package processor. If that
 	 * fails, continue with the shutdown.
@@ -7,6 +7,8 @@
  * its use by other parties, and makes no guarantees, expressed or implied,
  * about its quality, reliability, or any other characteristic.
  */
+#include <cstring>
+
 #include <be_mpi_recordprocessor.h>
 #include <be_mpi_runtime.h>
 
@@ -45,6 +47,10 @@ BiometricEvaluation::MPI::RecordProcessor::processWorkPackage(
 	 Memory::uint8Array packageData(0);
 	 workPackage.getData(packageData);
 	 uint64_t numElements = workPackage.getNumElements();
+	if (this->_resources->distributeKeyRanges()) {
+		this->processKeyRange(packageData, numElements);
+		return;
+	}
 
 	/*
 	 * Call the implementation's record processor function
@@ -101,3 +107,91 @@ BiometricEvaluation::MPI::RecordProcessor::processWorkPackage(
 	}
 }
 
+
+void
+BiometricEvaluation::MPI::RecordProcessor::processKeyRange(
+    const Memory::uint8Array &packageData,
+    const uint64_t numElements)
+{
+	if (numElements == 0)
+		return;
+	if (!this->_resources->haveRecordStore())
+		throw Error::StrategyError("Key ranges were distributed, but "
+		    "the input record store is not accessible");
+	std::shared_ptr<IO::RecordStore> recordStore =
+	    this->_resources->getRecordStore();
+
+	/*
+	 * Read the first and last key lengths, whether values are to
+	 * be read, and the keys (see MPI::RecordStoreDistributor).
+	 */
+	uint32_t firstKeyLength, lastKeyLength;
+	uint8_t includeValues;
+	uint64_t index = 0;
+	std::memcpy(&firstKeyLength, &packageData[index], sizeof(uint32_t));
+	index += sizeof(uint32_t);
+	std::memcpy(&lastKeyLength, &packageData[index], sizeof(uint32_t));
+	index += sizeof(uint32_t);
+	std::memcpy(&includeValues, &packageData[index], sizeof(uint8_t));
+	index += sizeof(uint8_t);
+	const std::string firstKey((const char *)&packageData[index],
+	    firstKeyLength);
+	index += firstKeyLength;
+	const std::string lastKey((const char *)&packageData[index],
+	    lastKeyLength);
+
+	/*
+	 * Sequence with a Cursor when the record store has them, so
+	 * the record store's own cursor is left for the implementation.
+	 */
+	if (!this->_checkedCursor) {
+		try {
+			this->_cursor = recordStore->makeReader();
+		} catch (const Error::NotImplemented&) {
+			this->_cursor.reset();
+		}
+		this->_checkedCursor = true;
+	}
+	if (this->_cursor)
+		this->_cursor->setCursorAtKey(firstKey);
+	else
+		recordStore->setCursorAtKey(firstKey);
+
+	/*
+	 * Process the records from the first key through the last key,
+	 * stopping early only when a quick or immediate exit condition
+	 * exists.
+	 */
+	IO::RecordStore::Record record;
+	for (uint64_t count = 0; count < numElements; count++) {
+		if (MPI::QuickExit || MPI::TermExit) {
+			IO::Logsheet *log = this->getLogsheet().get();
+			log->writeDebug("Early exit: End record processing");
+			break;
+		}
+		try {
+			if (includeValues != 0)
+				record = (this->_cursor ?
+				    this->_cursor->sequence() :
+				    recordStore->sequence());
+			else
+				record.key = (this->_cursor ?
+				    this->_cursor->sequenceKey() :
+				    recordStore->sequenceKey());
+		} catch (const Error::ObjectDoesNotExist&) {
+			/* Fewer records than when the range was created */
+			break;
+		}
+
+		/*
+		 * An exception from the implementation is a request for
+		 * termination, and is left for the framework.
+		 */
+		if (includeValues != 0)
+			this->processRecord(record.key, record.data);
+		else
+			this->processRecord(record.key);
+		if (record.key == lastKey)
+			break;
+	}
+}
@@ -8,6 +8,9 @@
  * about its quality, reliability, or any other characteristic.
  */
 
+#include <algorithm>
+#include <cstring>
+
 #include <be_mpi_recordstoredistributor.h>
 
 namespace BE = BiometricEvaluation;
@@ -62,7 +65,8 @@ BiometricEvaluation::MPI::RecordStoreDistributor::~RecordStoreDistributor()
  * Add a string key to the given buffer, preceded by the length of the
  * key. The key is written as characters, without the nul terminator.
  * The index out parameter is updated to the location of where the
- * next write can take place.
+ * next write can take place. The buffer grows geometrically, so its
+ * size can exceed index; the caller trims it once all records are added.
  */
 static void
 fillBufferWithKeyAndValue(
@@ -76,14 +80,13 @@ fillBufferWithKeyAndValue(
 	uint64_t neededSpace = index		/* buffer space in use */
 	    + sizeof(uint32_t) + keyLength	/* space for key and length */
 	    + sizeof(uint64_t) + valueSize;	/* for value and size */
-	buf.resize(neededSpace);
+	if (neededSpace > buf.size())
+		buf.resize(std::max<uint64_t>(neededSpace, buf.size() * 2));
 
 	/* Write the key length, value size, key, value if non-zero size */
-	uint32_t *pInt32 = (uint32_t *)&buf[index];
-	*pInt32 = (uint32_t)keyLength;
+	std::memcpy(&buf[index], &keyLength, sizeof(uint32_t));
 	index += sizeof(uint32_t);
-	uint64_t *pInt64 = (uint64_t *)&buf[index];
-	*pInt64 = (uint64_t)valueSize;
+	std::memcpy(&buf[index], &valueSize, sizeof(uint64_t));
 	index += sizeof(uint64_t);
 	std::memcpy((char *)&buf[index], key.data(), keyLength);
 	index += keyLength;
@@ -93,6 +96,36 @@ fillBufferWithKeyAndValue(
 	}
 }
 
+/*
+ * Describe a range of keys: the lengths of the first and last keys,
+ * whether values are to be read, and the two keys as characters.
+ * The format is read by MPI::RecordProcessor.
+ */
+static void
+fillBufferWithKeyRange(
+    BE::Memory::uint8Array &buf,
+    const std::string &firstKey,
+    const std::string &lastKey,
+    const bool includeValues)
+{
+	const uint32_t firstKeyLength = firstKey.length();
+	const uint32_t lastKeyLength = lastKey.length();
+	const uint8_t values = (includeValues ? 1 : 0);
+	buf.resize((sizeof(uint32_t) * 2) + sizeof(uint8_t) +
+	    firstKeyLength + lastKeyLength);
+
+	BE::Memory::uint8Array::size_type index = 0;
+	std::memcpy(&buf[index], &firstKeyLength, sizeof(uint32_t));
+	index += sizeof(uint32_t);
+	std::memcpy(&buf[index], &lastKeyLength, sizeof(uint32_t));
+	index += sizeof(uint32_t);
+	std::memcpy(&buf[index], &values, sizeof(uint8_t));
+	index += sizeof(uint8_t);
+	std::memcpy(&buf[index], firstKey.data(), firstKeyLength);
+	index += firstKeyLength;
+	std::memcpy(&buf[index], lastKey.data(), lastKeyLength);
+}
+
 void
 BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
     MPI::WorkPackage &workPackage)
@@ -114,28 +147,61 @@ BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
 
 	/*
 	 * Distribute a work package based on the chunk size given
-	 * in the resources object. If a failure occurs reading a key,
-	 * continue onto the next key. It is possible to send an empty
-	 * work package due to sequential failures.
+	 * in the resources object, possibly adapted to processing
+	 * times. If a failure occurs reading a key, continue onto the
+	 * next key. It is possible to send an empty work package due
+	 * to sequential failures.
 	 */
-	uint64_t keyCount;
-	if (this->_recordsRemaining > this->_resources->getChunkSize()) {
-		keyCount = this->_resources->getChunkSize();
-	} else {
+	uint64_t keyCount = this->getWorkPackageSize(
+	    this->_resources->getChunkSize(), this->_recordsRemaining);
+	if (keyCount > this->_recordsRemaining)
 		keyCount = this->_recordsRemaining;
-	}
 	
 	this->_recordsRemaining -= keyCount;
 
+	std::shared_ptr<IO::RecordStore> recordStore =
+	    this->_resources->getRecordStore();
+	uint64_t realKeyCount = 0;
+	std::string lastKey{};
+
+	/*
+	 * When distributing key ranges, only keys are sequenced here.
+	 * The receiving task reads the records from the first key through
+	 * the last key from its own record store, so neither the values
+	 * nor the keys in between pass through this task.
+	 */
+	if (this->_resources->distributeKeyRanges()) {
+		std::string firstKey, key;
+		for (uint64_t n = 0; n < keyCount; n++) {
+			try {
+				key = recordStore->sequenceKey();
+			} catch (const Error::Exception &e) {
+				log->writeDebug("Caught " + e.whatString());
+				continue;
+			}
+			if (realKeyCount == 0)
+				firstKey = key;
+			lastKey = key;
+			realKeyCount++;
+		}
+		if (realKeyCount != 0)
+			fillBufferWithKeyRange(packageData, firstKey,
+			    lastKey, this->_includeValues);
+		else
+			packageData.resize(0);
+		workPackage.setNumElements(realKeyCount);
+		workPackage.setNumInputElements(keyCount);
+		workPackage.setLastKey(lastKey);
+		workPackage.setData(packageData);
+		return;
+	}
+
 	/*
 	 * The value array must be 0-sized to start, and will stay that way
 	 * if values are not to be sent.
 	 */
 	BE::IO::RecordStore::Record record;
 	BE::Memory::uint8Array::size_type index = 0;
-	uint64_t realKeyCount = 0;
-	std::shared_ptr<IO::RecordStore> recordStore =
-	    this->_resources->getRecordStore();
 
 	/*
 	 * Pull keys, and possibly values, from the RecordStore and
@@ -148,9 +214,9 @@ BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
 			else
 				record.key = recordStore->sequenceKey();
 			/*
-			 * Save the last key sent for checkpointing purposes.
+			 * Save the last key for checkpointing purposes.
 			 */
-			this->_lastDistributedKey = record.key;
+			lastKey = record.key;
 
 			fillBufferWithKeyAndValue(packageData, record.key,
 			    record.data, index);
@@ -163,10 +229,26 @@ BiometricEvaluation::MPI::RecordStoreDistributor::createWorkPackage(
 	/*
 	 * NOTE: At this point it is possible to have no keys in the package.
 	 */
+	packageData.resize(index);
 	workPackage.setNumElements(realKeyCount);
+	workPackage.setNumInputElements(keyCount);
+	workPackage.setLastKey(lastKey);
 	workPackage.setData(packageData);
 }
 
+void
+BiometricEvaluation::MPI::RecordStoreDistributor::workPackageSent(
+    const MPI::WorkPackage &workPackage)
+{
+	/*
+	 * Checkpoint only what has been sent, since work packages
+	 * may have been created ahead of requests.
+	 */
+	if (!workPackage.getLastKey().empty())
+		this->_lastDistributedKey = workPackage.getLastKey();
+	this->_distributedKeyCount += workPackage.getNumInputElements();
+}
+
 void
 BiometricEvaluation::MPI::RecordStoreDistributor::checkpointSave(
     const std::string &reason)
@@ -178,12 +260,9 @@ BiometricEvaluation::MPI::RecordStoreDistributor::checkpointSave(
 		chkData->setProperty(
 		    BE::MPI::RecordStoreDistributor::CHECKPOINTLASTKEY,
 		     this->_lastDistributedKey);
-		auto keyCount = 
-		    this->_resources->getRecordStore()->getCount() -
-		    this->_recordsRemaining;
 		chkData->setPropertyFromInteger(
 		    BE::MPI::RecordStoreDistributor::CHECKPOINTNUMKEYS,
-		    keyCount);
+		    this->_distributedKeyCount);
 		chkData->sync();
 		this->getLogsheet()->writeDebug("Checkpoint saved: " + reason);
 	} catch (const Error::Exception &e) {
@@ -207,8 +286,10 @@ BiometricEvaluation::MPI::RecordStoreDistributor::checkpointRestore()
 		recordStore->setCursorAtKey(lastKey);
 		(void)recordStore->sequence();
 
-		this->_recordsRemaining -= chkData->getPropertyAsInteger(
+		this->_distributedKeyCount = chkData->getPropertyAsInteger(
 		    BE::MPI::RecordStoreDistributor::CHECKPOINTNUMKEYS);
+		this->_recordsRemaining -= this->_distributedKeyCount;
+		this->_lastDistributedKey = lastKey;
 		this->getLogsheet()->writeDebug(
 		    "Checkpoint restore: " + chkData->getProperty(
 			BE::MPI::Distributor::CHECKPOINTREASON));
@@ -22,6 +22,9 @@ BiometricEvaluation::MPI::RecordStoreResources::INPUTRSPROPERTY =
 const std::string
 BiometricEvaluation::MPI::RecordStoreResources::CHUNKSIZEPROPERTY =
     "Chunk Size";
+const std::string
+BiometricEvaluation::MPI::RecordStoreResources::KEYRANGESPROPERTY =
+    "Distribute Key Ranges";
 
 /******************************************************************************/
 /* Class method definitions.                                                  */
@@ -49,6 +52,11 @@ BiometricEvaluation::MPI::RecordStoreResources::RecordStoreResources(
 		throw Error::ObjectDoesNotExist("Could not read properties: " +
 		    e.whatString());
 	}
+	try {
+		this->_distributeKeyRanges = props->getPropertyAsBoolean(
+		    MPI::RecordStoreResources::KEYRANGESPROPERTY);
+	} catch (const Error::ObjectDoesNotExist &) {
+	}
 	try {
 		this->_recordStore = IO::RecordStore::openRecordStore(
 		    RSName, IO::Mode::ReadOnly);
@@ -69,6 +77,12 @@ BiometricEvaluation::MPI::RecordStoreResources::getChunkSize() const
 	return (this->_chunkSize);
 }
 
+bool
+BiometricEvaluation::MPI::RecordStoreResources::distributeKeyRanges() const
+{
+	return (this->_distributeKeyRanges);
+}
+
 bool
 BiometricEvaluation::MPI::RecordStoreResources::haveRecordStore() const
 {
@@ -96,6 +110,7 @@ BiometricEvaluation::MPI::RecordStoreResources::getOptionalProperties()
 {
 	std::vector<std::string> props;
 	props = MPI::Resources::getOptionalProperties();
+	props.push_back(MPI::RecordStoreResources::KEYRANGESPROPERTY);
 	return (props);
 }
 
@@ -12,6 +12,8 @@
 #include <unistd.h>
 
 #include <mpi.h>
+
+#include <algorithm>
 #include <sstream>
 
 #include <be_mpi.h>
@@ -40,6 +42,18 @@ const std::string
 BiometricEvaluation::MPI::Resources::LOGSHEETURLPROPERTY("Logsheet URL");
 const std::string
 BiometricEvaluation::MPI::Resources::CHECKPOINTPATHPROPERTY("Checkpoint Path");
+const std::string
+BiometricEvaluation::MPI::Resources::WORKPACKAGEQUEUEDEPTHPROPERTY(
+    "Work Package Queue Depth");
+const std::string
+BiometricEvaluation::MPI::Resources::TARGETCHUNKTIMEPROPERTY(
+    "Target Chunk Time");
+const std::string
+BiometricEvaluation::MPI::Resources::MAXCHUNKSIZEPROPERTY(
+    "Maximum Chunk Size");
+const std::string
+BiometricEvaluation::MPI::Resources::SHAREDPACKAGESIZEPROPERTY(
+    "Shared Package Buffer Size");
 
 /******************************************************************************/
 /* Class method definitions.                                                  */
@@ -106,6 +120,51 @@ BiometricEvaluation::MPI::Resources::Resources(
 			this->_checkpointPath = "";
 		}
 	}
+	try {
+		const auto depth = props->getPropertyAsInteger(
+		    MPI::Resources::WORKPACKAGEQUEUEDEPTHPROPERTY);
+		if (depth < 0)
+			throw Error::ParameterError(
+			    MPI::Resources::WORKPACKAGEQUEUEDEPTHPROPERTY +
+			    " is negative");
+		this->_workPackageQueueDepth = depth;
+	} catch (const Error::ObjectDoesNotExist &) {
+		this->_workPackageQueueDepth = std::max(2,
+		    this->_numTasks - 1);
+	}
+	try {
+		const auto time = props->getPropertyAsInteger(
+		    MPI::Resources::TARGETCHUNKTIMEPROPERTY);
+		if (time <= 0)
+			throw Error::ParameterError(
+			    MPI::Resources::TARGETCHUNKTIMEPROPERTY +
+			    " is not positive");
+		this->_targetChunkTime = time;
+	} catch (const Error::ObjectDoesNotExist &) {
+		this->_targetChunkTime = 0;
+	}
+	try {
+		const auto size = props->getPropertyAsInteger(
+		    MPI::Resources::MAXCHUNKSIZEPROPERTY);
+		if (size <= 0)
+			throw Error::ParameterError(
+			    MPI::Resources::MAXCHUNKSIZEPROPERTY +
+			    " is not positive");
+		this->_maximumChunkSize = size;
+	} catch (const Error::ObjectDoesNotExist &) {
+		this->_maximumChunkSize = 0;
+	}
+	try {
+		const auto size = props->getPropertyAsInteger(
+		    MPI::Resources::SHAREDPACKAGESIZEPROPERTY);
+		if (size < 0)
+			throw Error::ParameterError(
+			    MPI::Resources::SHAREDPACKAGESIZEPROPERTY +
+			    " is negative");
+		this->_sharedPackageSize = size;
+	} catch (const Error::ObjectDoesNotExist &) {
+		this->_sharedPackageSize = 4 * 1024 * 1024;
+	}
 }
 
 std::vector<std::string>
@@ -122,6 +181,10 @@ BiometricEvaluation::MPI::Resources::getOptionalProperties()
 	std::vector<std::string> props;
 	props.push_back(MPI::Resources::LOGSHEETURLPROPERTY);
 	props.push_back(MPI::Resources::CHECKPOINTPATHPROPERTY);
+	props.push_back(MPI::Resources::WORKPACKAGEQUEUEDEPTHPROPERTY);
+	props.push_back(MPI::Resources::TARGETCHUNKTIMEPROPERTY);
+	props.push_back(MPI::Resources::MAXCHUNKSIZEPROPERTY);
+	props.push_back(MPI::Resources::SHAREDPACKAGESIZEPROPERTY);
 	return (props);
 }
 
@@ -150,6 +213,30 @@ BiometricEvaluation::MPI::Resources::getPropertiesFileName() const
 	return (_propertiesFileName);
 }
 
+uint32_t
+BiometricEvaluation::MPI::Resources::getWorkPackageQueueDepth() const
+{
+	return (this->_workPackageQueueDepth);
+}
+
+uint32_t
+BiometricEvaluation::MPI::Resources::getTargetChunkTime() const
+{
+	return (this->_targetChunkTime);
+}
+
+uint32_t
+BiometricEvaluation::MPI::Resources::getMaximumChunkSize() const
+{
+	return (this->_maximumChunkSize);
+}
+
+uint64_t
+BiometricEvaluation::MPI::Resources::getSharedPackageSize() const
+{
+	return (this->_sharedPackageSize);
+}
+
 int
 BiometricEvaluation::MPI::Resources::getRank() const
 {
@@ -39,7 +39,12 @@ BiometricEvaluation::MPI::Runtime::Runtime(
     _argc{argc}, _argv{argv}
 {
 	BiometricEvaluation::MPI::checkpointEnable = checkpointEnable;
-	::MPI::Init(this->_argc, this->_argv);
+	/*
+	 * The Distributor creates work packages in another thread, but
+	 * only the main thread of any task makes MPI calls.
+	 */
+	(void)::MPI::Init_thread(this->_argc, this->_argv,
+	    MPI_THREAD_FUNNELED);
 }
 
 BiometricEvaluation::MPI::Runtime::~Runtime()
@@ -64,3 +64,28 @@ BiometricEvaluation::MPI::WorkPackage::setNumElements(
 	this->_numElements = numElements;;
 }
 
+std::string
+BiometricEvaluation::MPI::WorkPackage::getLastKey() const
+{
+	return (this->_lastKey);
+}
+
+void
+BiometricEvaluation::MPI::WorkPackage::setLastKey(
+    const std::string &lastKey)
+{
+	this->_lastKey = lastKey;
+}
+
+uint64_t
+BiometricEvaluation::MPI::WorkPackage::getNumInputElements() const
+{
+	return (this->_numInputElements);
+}
+
+void
+BiometricEvaluation::MPI::WorkPackage::setNumInputElements(
+    const uint64_t numInputElements)
+{
+	this->_numInputElements = numInputElements;
+}
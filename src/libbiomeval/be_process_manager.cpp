@@ -11,6 +11,7 @@
 #include <sys/select.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cerrno>
 
 #include <be_error.h>
@@ -86,6 +87,20 @@ BiometricEvaluation::Process::Manager::waitForMessage(
     int *nextFD,
     int numSeconds)
     const
+{
+	if (numSeconds < 0)
+		return (this->waitForMessage(sender, nextFD,
+		    std::chrono::microseconds(-1)));
+	return (this->waitForMessage(sender, nextFD,
+	    std::chrono::seconds(numSeconds)));
+}
+
+bool
+BiometricEvaluation::Process::Manager::waitForMessage(
+    std::shared_ptr<WorkerController> &sender,
+    int *nextFD,
+    const std::chrono::microseconds &timeoutDuration)
+    const
 {
 	bool result = false;
 	fd_set set;
@@ -96,9 +111,9 @@ BiometricEvaluation::Process::Manager::waitForMessage(
 	std::map<std::shared_ptr<WorkerController>, int> fds;
 	
 	struct timeval timeout, *timeoutptr = nullptr;
-	if (numSeconds >= 0) {
-		timeout.tv_sec = numSeconds;
-		timeout.tv_usec = 0;
+	if (timeoutDuration.count() >= 0) {
+		timeout.tv_sec = timeoutDuration.count() / 1000000;
+		timeout.tv_usec = timeoutDuration.count() % 1000000;
 		timeoutptr = &timeout;
 	}
 	
@@ -177,7 +192,21 @@ bool
 BiometricEvaluation::Process::Manager::getNextMessage(
     std::shared_ptr<WorkerController> &sender,
     Memory::uint8Array &message,
-    int timeout)
+    int numSeconds)
+    const
+{
+	if (numSeconds < 0)
+		return (this->getNextMessage(sender, message,
+		    std::chrono::microseconds(-1)));
+	return (this->getNextMessage(sender, message,
+	    std::chrono::seconds(numSeconds)));
+}
+
+bool
+BiometricEvaluation::Process::Manager::getNextMessage(
+    std::shared_ptr<WorkerController> &sender,
+    Memory::uint8Array &message,
+    const std::chrono::microseconds &timeout)
     const
 {
 	int fd = 0;
@@ -0,0 +1,43 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file Copyright.txt or https://cmake.org/licensing for details.
+#
+# Created by NIST for the Biometric Evaluation Framework.
+#
+#.rst:
+# FindLZ4
+# --------
+#
+# Find LZ4, the LZ4 compression library.
+#
+# Find the LZ4 library and headers.
+#
+# ::
+#
+#   LZ4_INCLUDE_DIR, where to find lz4frame.h, etc.
+#   LZ4_LIBRARIES, the libraries needed to use LZ4.
+#   LZ4_FOUND, If false, do not try to use LZ4.
+#
+# also defined, but not for general use are
+#
+# ::
+#
+#   LZ4_LIBRARY, where to find the LZ4 library.
+
+find_path(LZ4_INCLUDE_DIR lz4frame.h
+  /usr/include/
+  /usr/local/include/
+)
+
+set(LZ4_NAMES lz4 liblz4)
+find_library(LZ4_LIBRARY NAMES ${LZ4_NAMES})
+
+# handle the QUIETLY and REQUIRED arguments and set LZ4_FOUND to TRUE if
+# all listed variables are TRUE
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LZ4 DEFAULT_MSG LZ4_LIBRARY LZ4_INCLUDE_DIR)
+
+if(LZ4_FOUND)
+  set(LZ4_LIBRARIES ${LZ4_LIBRARY})
+endif()
+
+mark_as_advanced(LZ4_LIBRARY LZ4_INCLUDE_DIR )
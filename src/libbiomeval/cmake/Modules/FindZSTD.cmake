@@ -0,0 +1,43 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file Copyright.txt or https://cmake.org/licensing for details.
+#
+# Created by NIST for the Biometric Evaluation Framework.
+#
+#.rst:
+# FindZSTD
+# --------
+#
+# Find Zstandard, the Zstandard compression library.
+#
+# Find the Zstandard library and headers.
+#
+# ::
+#
+#   ZSTD_INCLUDE_DIR, where to find zstd.h, etc.
+#   ZSTD_LIBRARIES, the libraries needed to use Zstandard.
+#   ZSTD_FOUND, If false, do not try to use Zstandard.
+#
+# also defined, but not for general use are
+#
+# ::
+#
+#   ZSTD_LIBRARY, where to find the Zstandard library.
+
+find_path(ZSTD_INCLUDE_DIR zstd.h
+  /usr/include/
+  /usr/local/include/
+)
+
+set(ZSTD_NAMES zstd libzstd zstd_static)
+find_library(ZSTD_LIBRARY NAMES ${ZSTD_NAMES})
+
+# handle the QUIETLY and REQUIRED arguments and set ZSTD_FOUND to TRUE if
+# all listed variables are TRUE
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(ZSTD DEFAULT_MSG ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
+
+if(ZSTD_FOUND)
+  set(ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+endif()
+
+mark_as_advanced(ZSTD_LIBRARY ZSTD_INCLUDE_DIR )
@@ -0,0 +1,361 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <be_error_exception.h>
+#include <be_image_jpeg.h>
+#include <be_image_png.h>
+#include <be_image_raw.h>
+#include <be_image_resample.h>
+#include <be_image_tiff.h>
+#include <be_process_statistics.h>
+
+namespace BE = BiometricEvaluation;
+
+static BE::Image::Raw
+makeRaw(
+    const BE::Image::Size &size,
+    uint32_t colorDepth,
+    uint16_t bitDepth)
+{
+	BE::Memory::uint8Array pixels(static_cast<uint64_t>(size.xSize) *
+	    size.ySize * (colorDepth / 8));
+	for (uint64_t i = 0; i < pixels.size(); i++)
+		pixels[i] = static_cast<uint8_t>((i * 13) ^ (i / 97));
+	return (BE::Image::Raw(pixels, size, colorDepth, bitDepth,
+	    BE::Image::Resolution(500, 500, BE::Image::Resolution::Units::PPI),
+	    colorDepth == 32));
+}
+
+/* Concatenate every band of a BandReader */
+static BE::Memory::uint8Array
+readAll(
+    BE::Image::Image::BandReader &reader,
+    uint8_t grayscaleDepth = 0)
+{
+	const BE::Image::ROI region = reader.getRegion();
+	BE::Memory::uint8Array all;
+	BE::Memory::uint8Array band;
+	uint64_t offset{0};
+	uint32_t rows;
+	while ((rows = (grayscaleDepth == 0 ? reader.read(band) :
+	    reader.readGrayscale(band, grayscaleDepth))) != 0) {
+		EXPECT_LE(rows, reader.getMaximumBandRows());
+		const uint64_t size = (grayscaleDepth == 0 ?
+		    reader.getRowSize() * rows : static_cast<uint64_t>(
+		    region.size.xSize) * rows * (grayscaleDepth == 16 ? 2 : 1));
+		all.resize(offset + size);
+		std::memcpy(all + offset, band, size);
+		offset += size;
+	}
+	EXPECT_EQ(region.vertOffset + region.size.ySize, reader.getNextRow());
+	return (all);
+}
+
+TEST(ImageBandReader, Rows)
+{
+	const BE::Image::Size size(203, 150);
+	const auto rgb = makeRaw(size, 24, 8);
+	const std::vector<std::shared_ptr<BE::Image::Image>> images{
+	    std::make_shared<BE::Image::Raw>(rgb),
+	    std::make_shared<BE::Image::PNG>(BE::Image::PNG::encode(rgb)),
+	    std::make_shared<BE::Image::PNG>(BE::Image::PNG::encode(
+	        makeRaw(size, 16, 16))),
+	    std::make_shared<BE::Image::PNG>(BE::Image::PNG::encode(
+	        makeRaw(size, 32, 8))),
+	    std::make_shared<BE::Image::JPEG>(BE::Image::JPEG::encode(rgb))};
+
+	for (const auto &image : images) {
+		SCOPED_TRACE(BE::Framework::Enumeration::to_string(
+		    image->getCompressionAlgorithm()) +
+		    ", " + std::to_string(image->getColorDepth()) + "-bit");
+		for (const auto &roi : {BE::Image::ROI(),
+		    BE::Image::ROI(BE::Image::Size(50, 100), 17, 33, {}),
+		    BE::Image::ROI(BE::Image::Size(203, 1), 0, 149, {})}) {
+			const auto reader = image->makeBandReader(roi);
+			EXPECT_EQ(image->getReducedDimensions(0, roi),
+			    reader->getRegion().size);
+			EXPECT_EQ(image->getRawData(0, roi), readAll(*reader));
+
+			/* Nothing left */
+			BE::Memory::uint8Array band;
+			EXPECT_EQ(0, reader->read(band));
+		}
+	}
+
+	EXPECT_THROW(images[1]->makeBandReader(BE::Image::ROI(
+	    BE::Image::Size(10, 10), 200, 0, {})), BE::Error::ParameterError);
+}
+
+TEST(ImageBandReader, Grayscale)
+{
+	const BE::Image::Size size(97, 131);
+	for (const auto &raw : {makeRaw(size, 24, 8), makeRaw(size, 48, 16),
+	    makeRaw(size, 8, 8)}) {
+		const BE::Image::PNG png(BE::Image::PNG::encode(raw));
+		for (const uint8_t depth : {1, 8, 16}) {
+			SCOPED_TRACE(std::to_string(raw.getColorDepth()) +
+			    " to " + std::to_string(depth));
+			const auto reader = png.makeBandReader();
+			EXPECT_EQ(png.getRawGrayscaleData(depth),
+			    readAll(*reader, depth));
+		}
+
+		const auto reader = png.makeBandReader();
+		BE::Memory::uint8Array band;
+		EXPECT_THROW(reader->readGrayscale(band, 4),
+		    BE::Error::ParameterError);
+	}
+}
+
+/*
+ * Uncompressed little-endian TIFF of 8-bit samples, in strips of
+ * rowsPerStrip rows, or in square tiles of tileSize when not 0.
+ */
+static BE::Memory::uint8Array
+makeTIFF(
+    const BE::Image::Raw &raw,
+    uint32_t rowsPerStrip,
+    uint32_t tileSize = 0)
+{
+	const BE::Image::Size size = raw.getDimensions();
+	const uint32_t samples = raw.getColorDepth() / 8;
+	const BE::Memory::uint8Array pixels = raw.getRawData();
+
+	/* Strips or tiles, each padded to a whole tile */
+	std::vector<std::vector<uint8_t>> chunks;
+	if (tileSize == 0) {
+		for (uint32_t top = 0; top < size.ySize; top += rowsPerStrip) {
+			const uint32_t rows = std::min(rowsPerStrip,
+			    size.ySize - top);
+			const uint8_t *start = pixels + (static_cast<uint64_t>(
+			    top) * size.xSize * samples);
+			chunks.emplace_back(start, start + (static_cast<
+			    uint64_t>(rows) * size.xSize * samples));
+		}
+	} else {
+		for (uint32_t top = 0; top < size.ySize; top += tileSize) {
+			for (uint32_t left = 0; left < size.xSize;
+			    left += tileSize) {
+				std::vector<uint8_t> tile(tileSize * tileSize *
+				    samples);
+				for (uint32_t y = top; y < std::min(top +
+				    tileSize, size.ySize); y++) {
+					const uint32_t width = std::min(
+					    tileSize, size.xSize - left);
+					std::memcpy(&tile[(y - top) * tileSize *
+					    samples], pixels + ((static_cast<
+					    uint64_t>(y) * size.xSize + left) *
+					    samples), width * samples);
+				}
+				chunks.push_back(std::move(tile));
+			}
+		}
+	}
+
+	std::vector<uint8_t> file{'I', 'I', 42, 0, 8, 0, 0, 0};
+	const auto put = [](std::vector<uint8_t> &bytes, uint64_t offset,
+	    uint32_t value, uint8_t width) {
+		for (uint8_t i = 0; i < width; i++)
+			bytes[offset + i] = static_cast<uint8_t>(value >>
+			    (8 * i));
+	};
+
+	/* Tag, type (3 is SHORT, 4 is LONG), and values */
+	std::vector<std::tuple<uint16_t, uint16_t, std::vector<uint32_t>>>
+	    entries{
+	    {256, 4, {size.xSize}},
+	    {257, 4, {size.ySize}},
+	    {258, 3, std::vector<uint32_t>(samples, 8)},
+	    {259, 3, {1}},
+	    {262, 3, {samples == 1 ? 1u : 2u}},
+	    {277, 3, {samples}},
+	    {284, 3, {1}}};
+	std::vector<uint32_t> offsets, counts;
+	uint32_t offset{0};
+	for (const auto &chunk : chunks) {
+		counts.push_back(static_cast<uint32_t>(chunk.size()));
+		offsets.push_back(offset);
+		offset += static_cast<uint32_t>(chunk.size());
+	}
+	if (tileSize == 0) {
+		entries.push_back({273, 4, offsets});
+		entries.push_back({278, 4, {rowsPerStrip}});
+		entries.push_back({279, 4, counts});
+	} else {
+		entries.push_back({322, 4, {tileSize}});
+		entries.push_back({323, 4, {tileSize}});
+		entries.push_back({324, 4, offsets});
+		entries.push_back({325, 4, counts});
+	}
+	std::sort(entries.begin(), entries.end(), [](const auto &a,
+	    const auto &b) { return (std::get<0>(a) < std::get<0>(b)); });
+
+	/* IFD, then values that don't fit in an entry, then pixels */
+	const uint32_t ifdSize = 2 + (12 * entries.size()) + 4;
+	file.resize(8 + ifdSize);
+	put(file, 8, entries.size(), 2);
+	uint64_t entryOffset{10};
+	uint32_t dataOffset{0};
+	for (const auto &[tag, type, values] : entries) {
+		const uint8_t width = (type == 3 ? 2 : 4);
+		put(file, entryOffset, tag, 2);
+		put(file, entryOffset + 2, type, 2);
+		put(file, entryOffset + 4, values.size(), 4);
+		uint64_t valueOffset = entryOffset + 8;
+		if ((values.size() * width) > 4) {
+			put(file, entryOffset + 8, file.size(), 4);
+			valueOffset = file.size();
+			file.resize(file.size() + (values.size() * width));
+		}
+		/* Chunk offsets are relative to the pixels until known */
+		if ((tag == 273) || (tag == 324))
+			dataOffset = valueOffset;
+		for (const uint32_t value : values) {
+			put(file, valueOffset, value, width);
+			valueOffset += width;
+		}
+		entryOffset += 12;
+	}
+	const uint32_t pixelsOffset = static_cast<uint32_t>(file.size());
+	for (uint64_t i = 0; i < offsets.size(); i++)
+		put(file, dataOffset + (i * 4), offsets[i] + pixelsOffset, 4);
+	for (const auto &chunk : chunks)
+		file.insert(file.end(), chunk.begin(), chunk.end());
+
+	BE::Memory::uint8Array tiff(file.size());
+	std::memcpy(tiff, file.data(), file.size());
+	return (tiff);
+}
+
+TEST(ImageBandReader, TIFF)
+{
+	const BE::Image::Size size(203, 150);
+	for (const auto &raw : {makeRaw(size, 24, 8), makeRaw(size, 8, 8)}) {
+		/* Strips, one strip of the whole image, and tiles */
+		for (const auto &[rowsPerStrip, tileSize, bandRows] :
+		    {std::make_tuple(7u, 0u, 7u),
+		    std::make_tuple(size.ySize, 0u, 64u),
+		    std::make_tuple(0u, 32u, 32u)}) {
+			SCOPED_TRACE(std::to_string(raw.getColorDepth()) +
+			    "-bit, " + std::to_string(rowsPerStrip) +
+			    " rows per strip, tiles of " +
+			    std::to_string(tileSize));
+			const BE::Image::TIFF tiff(makeTIFF(raw, rowsPerStrip,
+			    tileSize));
+			EXPECT_EQ(raw.getRawData(), tiff.getRawData());
+
+			for (const auto &roi : {BE::Image::ROI(),
+			    BE::Image::ROI(BE::Image::Size(50, 100), 17, 33,
+			    {}),
+			    BE::Image::ROI(BE::Image::Size(203, 1), 0, 149,
+			    {})}) {
+				/* libtiff may split a large strip into smaller */
+				const auto reader = tiff.makeBandReader(roi);
+				EXPECT_LE(reader->getMaximumBandRows(),
+				    std::min(bandRows,
+				    reader->getRegion().size.ySize));
+				EXPECT_EQ(raw.getRawData(0, roi),
+				    readAll(*reader));
+			}
+		}
+	}
+}
+
+/*
+ * Growth of the resident size, in kilobytes, while running a function,
+ * sampled from another thread.
+ */
+static uint64_t
+peakResidentGrowth(
+    const std::function<void()> &function)
+{
+	BE::Process::Statistics statistics;
+	const uint64_t baseline = std::get<0>(statistics.getMemorySizes());
+
+	std::atomic<bool> done{false};
+	uint64_t peak{baseline};
+	std::thread sampler([&]() {
+		BE::Process::Statistics samplerStatistics;
+		while (!done) {
+			peak = std::max(peak, std::get<0>(
+			    samplerStatistics.getMemorySizes()));
+			std::this_thread::sleep_for(
+			    std::chrono::milliseconds(1));
+		}
+	});
+	try {
+		function();
+	} catch (...) {
+		done = true;
+		sampler.join();
+		throw;
+	}
+	done = true;
+	sampler.join();
+
+	peak = std::max(peak, std::get<0>(statistics.getMemorySizes()));
+	return (peak - baseline);
+}
+
+TEST(ImageBandReader, BoundedMemory)
+{
+	try {
+		BE::Process::Statistics().getMemorySizes();
+	} catch (const BE::Error::NotImplemented&) {
+		GTEST_SKIP() << "Memory sizes are not available";
+	}
+
+	/* Compressible image of 24 MB */
+	const BE::Image::Size size(6000, 4000);
+	const uint64_t rawKB = (static_cast<uint64_t>(size.xSize) *
+	    size.ySize) / 1024;
+	std::shared_ptr<BE::Image::PNG> png;
+	{
+		BE::Memory::uint8Array pixels(static_cast<uint64_t>(
+		    size.xSize) * size.ySize);
+		for (uint64_t i = 0; i < pixels.size(); i++)
+			pixels[i] = static_cast<uint8_t>((i % size.xSize) ^
+			    (i / size.xSize));
+		png = std::make_shared<BE::Image::PNG>(BE::Image::PNG::encode(
+		    BE::Image::Raw(pixels, size, 8, 8, BE::Image::Resolution(
+		    1000, 1000, BE::Image::Resolution::Units::PPI), false), 1));
+	}
+
+	/* Grayscale conversion by bands holds a band, not the image */
+	EXPECT_LT(peakResidentGrowth([&]() {
+		const auto reader = png->makeBandReader();
+		BE::Memory::uint8Array band;
+		uint32_t rows, total{0};
+		while ((rows = reader->readGrayscale(band, 8)) != 0)
+			total += rows;
+		EXPECT_EQ(size.ySize, total);
+	}), rawKB / 8);
+
+	/* Resampling by bands holds rows, and the quarter-size output */
+	EXPECT_LT(peakResidentGrowth([&]() {
+		const BE::Image::Raw normalized =
+		    BE::Image::normalizeResolution(*png);
+		EXPECT_EQ(BE::Image::Size(3000, 2000),
+		    normalized.getDimensions());
+	}), rawKB / 2);
+}
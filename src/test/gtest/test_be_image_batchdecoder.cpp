@@ -0,0 +1,219 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <be_image_batchdecoder.h>
+#include <be_image_jpeg.h>
+#include <be_image_netpbm.h>
+#include <be_image_png.h>
+#include <be_image_raw.h>
+#include <be_io_recordstore.h>
+
+namespace BE = BiometricEvaluation;
+
+static const uint32_t ImageCount{60};
+
+/* Encoded test images and the pixels they decode to */
+class ImageBatchDecoder : public ::testing::Test
+{
+protected:
+	ImageBatchDecoder()
+	{
+		for (uint32_t i = 0; i < ImageCount; i++) {
+			const BE::Image::Size size(17 + i, 9 + (i % 5));
+			BE::Memory::uint8Array pixels(size.xSize * size.ySize);
+			for (uint64_t p = 0; p < pixels.size(); p++)
+				pixels[p] = static_cast<uint8_t>((p * 7) + i);
+			const BE::Image::Raw raw(pixels, size, 8, 8,
+			    BE::Image::Resolution(500, 500,
+			    BE::Image::Resolution::Units::PPI), false);
+
+			switch (i % 3) {
+			case 0:
+				this->_encoded.push_back(
+				    BE::Image::PNG::encode(raw));
+				break;
+			case 1:
+				this->_encoded.push_back(
+				    BE::Image::NetPBM::encode(raw));
+				break;
+			case 2:
+				this->_encoded.push_back(
+				    BE::Image::JPEG::encode(raw));
+				break;
+			}
+			this->_expected.push_back(BE::Image::Image::openImage(
+			    this->_encoded.back())->getRawData());
+		}
+	}
+
+	std::vector<BE::Memory::uint8Array> _encoded{};
+	std::vector<BE::Memory::uint8Array> _expected{};
+};
+
+TEST_F(ImageBatchDecoder, SubmissionOrder)
+{
+	BE::Image::BatchDecoder::Options options;
+	options.threads = 4;
+	options.queueDepth = 8;
+	BE::Image::BatchDecoder decoder(options);
+	EXPECT_EQ(4, decoder.getThreadCount());
+
+	/* Bounded queue requires retrieving while submitting */
+	std::thread producer([&]() {
+		for (uint32_t i = 0; i < ImageCount; i++)
+			EXPECT_EQ(i, decoder.submit(this->_encoded[i],
+			    std::to_string(i)));
+		decoder.finish();
+	});
+
+	uint32_t count{0};
+	BE::Image::BatchDecoder::Result result;
+	while (decoder.next(result)) {
+		ASSERT_EQ(count, result.sequence);
+		EXPECT_EQ(std::to_string(count), result.identifier);
+		EXPECT_FALSE(result.error);
+		ASSERT_NE(nullptr, result.image);
+		EXPECT_EQ(this->_expected[count], result.rawData);
+		count++;
+	}
+	producer.join();
+	EXPECT_EQ(ImageCount, count);
+	EXPECT_THROW(decoder.submit(this->_encoded[0]),
+	    BE::Error::ObjectExists);
+
+	const auto statistics = decoder.getStatistics();
+	for (const auto algorithm : {BE::Image::CompressionAlgorithm::PNG,
+	    BE::Image::CompressionAlgorithm::NetPBM,
+	    BE::Image::CompressionAlgorithm::JPEGB}) {
+		ASSERT_EQ(1, statistics.count(algorithm));
+		EXPECT_EQ(ImageCount / 3, statistics.at(algorithm).images);
+		EXPECT_EQ(0, statistics.at(algorithm).failures);
+		EXPECT_GT(statistics.at(algorithm).encodedBytes, 0);
+		EXPECT_GT(statistics.at(algorithm).decodedBytes, 0);
+	}
+}
+
+TEST_F(ImageBatchDecoder, CompletionCallback)
+{
+	BE::Image::BatchDecoder::Options options;
+	options.threads = 3;
+	options.order = BE::Image::BatchDecoder::Order::Completion;
+	options.grayscaleDepth = 8;
+
+	std::mutex mutex;
+	std::set<uint64_t> sequences;
+	BE::Image::BatchDecoder decoder([&](
+	    BE::Image::BatchDecoder::Result &result) {
+		std::lock_guard<std::mutex> lock(mutex);
+		EXPECT_FALSE(result.error);
+		EXPECT_EQ(this->_expected[result.sequence], result.rawData);
+		sequences.insert(result.sequence);
+	}, options);
+
+	for (uint32_t i = 0; i < ImageCount; i++)
+		decoder.submit(std::make_shared<const BE::Memory::uint8Array>(
+		    this->_encoded[i]));
+	decoder.wait();
+	EXPECT_EQ(ImageCount, sequences.size());
+
+	BE::Image::BatchDecoder::Result result;
+	EXPECT_THROW(decoder.next(result), BE::Error::StrategyError);
+}
+
+TEST_F(ImageBatchDecoder, Errors)
+{
+	BE::Image::BatchDecoder::Options options;
+	options.threads = 2;
+	BE::Image::BatchDecoder decoder(options);
+
+	const BE::Memory::uint8Array garbage{'n', 'o', 't', ' ', 'a', 'n',
+	    ' ', 'i', 'm', 'a', 'g', 'e'};
+	decoder.submit(garbage, "garbage");
+	decoder.submit(this->_encoded[0], "valid");
+	decoder.finish();
+
+	BE::Image::BatchDecoder::Result result;
+	ASSERT_TRUE(decoder.next(result));
+	EXPECT_EQ("garbage", result.identifier);
+	EXPECT_TRUE(result.error);
+	EXPECT_EQ(nullptr, result.image);
+	EXPECT_THROW(std::rethrow_exception(result.error),
+	    BE::Error::Exception);
+
+	ASSERT_TRUE(decoder.next(result));
+	EXPECT_EQ("valid", result.identifier);
+	EXPECT_FALSE(result.error);
+	EXPECT_FALSE(decoder.next(result));
+
+	EXPECT_EQ(1, decoder.getStatistics().at(
+	    BE::Image::CompressionAlgorithm::None).failures);
+
+	options.grayscaleDepth = 12;
+	EXPECT_THROW(BE::Image::BatchDecoder{options},
+	    BE::Error::ParameterError);
+	EXPECT_THROW(BE::Image::BatchDecoder{
+	    BE::Image::BatchDecoder::Callback()}, BE::Error::ParameterError);
+}
+
+TEST_F(ImageBatchDecoder, RecordStore)
+{
+	static const std::string rsName{"test_batchdecoder_rs"};
+	std::shared_ptr<BE::IO::RecordStore> rs;
+	ASSERT_NO_THROW(rs = BE::IO::RecordStore::createRecordStore(rsName,
+	    "BatchDecoder", BE::IO::RecordStore::Kind::SQLite));
+	for (uint32_t i = 0; i < ImageCount; i++)
+		rs->insert(std::to_string(i), this->_encoded[i]);
+	rs->sync();
+
+	{
+		BE::Image::BatchDecoder::Options options;
+		options.threads = 4;
+		BE::Image::BatchDecoder decoder(options);
+		std::thread producer([&]() {
+			for (uint32_t i = 0; i < ImageCount; i++)
+				decoder.submit(rs, std::to_string(i));
+			decoder.submit(rs, "missing");
+			decoder.finish();
+		});
+
+		uint32_t count{0};
+		BE::Image::BatchDecoder::Result result;
+		while (decoder.next(result)) {
+			if (count == ImageCount) {
+				EXPECT_EQ("missing", result.identifier);
+				EXPECT_THROW(std::rethrow_exception(
+				    result.error),
+				    BE::Error::ObjectDoesNotExist);
+			} else {
+				EXPECT_EQ(std::to_string(count),
+				    result.identifier);
+				EXPECT_FALSE(result.error);
+				EXPECT_EQ(this->_expected[count],
+				    result.rawData);
+			}
+			count++;
+		}
+		producer.join();
+		EXPECT_EQ(ImageCount + 1, count);
+	}
+
+	rs.reset();
+	EXPECT_NO_THROW(BE::IO::RecordStore::removeRecordStore(rsName));
+}
@@ -9,11 +9,16 @@
  */
 
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <be_image_image.h>
 #include <be_image_bmp.h>
@@ -399,3 +404,567 @@ TEST_F(ImageRecordStore, rawDataConversion)
 	EXPECT_GT(imagesChecked, 0);
 }
 
+#if defined WSQTEST
+TEST_F(ImageRecordStore, concurrentRawDataConversion)
+{
+	/* Read the corpus up front; only the decoding is concurrent */
+	std::vector<std::string> keys;
+	std::vector<BE::Memory::uint8Array> images, rawImages;
+	for (const auto &entry : *(this->_imageRS)) {
+		if (extensions[getFileExtension(entry.key)] != imageType)
+			continue;
+		keys.push_back(entry.key);
+		images.push_back(entry.data);
+		ASSERT_NO_THROW(rawImages.push_back(this->_imageRS->read(
+		    entry.key + RawSuffix)));
+	}
+	ASSERT_GT(keys.size(), 0);
+
+	static const unsigned int numThreads = 8;
+	std::vector<uint8_t> matched(numThreads * keys.size(), 0);
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < numThreads; t++) {
+		threads.emplace_back([&, t]() {
+			for (size_t k = 0; k < keys.size(); k++) {
+				try {
+					const auto generated = BE::Image::WSQ(
+					    images[k], keys[k]).getRawData();
+					matched[(t * keys.size()) + k] =
+					    (generated.size() ==
+					    rawImages[k].size()) &&
+					    (std::memcmp(generated,
+					    rawImages[k],
+					    rawImages[k].size()) == 0);
+				} catch (const BE::Error::Exception&) {
+					/* Left unmatched */
+				}
+			}
+		});
+	}
+	for (auto &thread : threads)
+		thread.join();
+
+	for (unsigned int t = 0; t < numThreads; t++)
+		for (size_t k = 0; k < keys.size(); k++)
+			EXPECT_TRUE(matched[(t * keys.size()) + k]) <<
+			    keys[k] << " (thread " << t << ")";
+}
+#endif
+
+#if !defined FACTORYTEST && !defined RAWTEST
+TEST_F(ImageRecordStore, decodeCache)
+{
+	using DecodeCache = BE::Image::DecodeCache;
+
+	BE::Memory::uint8Array data;
+	for (const auto &entry : *(this->_imageRS)) {
+		if (extensions[getFileExtension(entry.key)] == imageType) {
+			data = entry.data;
+			break;
+		}
+	}
+	ASSERT_GT(data.size(), 0);
+
+	DecodeCache::setCapacity(0);
+	DecodeCache::resetStatistics();
+
+	/* Decode once per object */
+	std::shared_ptr<BE::Image::Image> image;
+	ASSERT_NO_THROW(image = BE::Image::Image::openImage(data));
+	EXPECT_FALSE(image->getRetainDecodedData());
+	image->setRetainDecodedData(true);
+	BE::Memory::uint8Array raw, cached;
+	ASSERT_NO_THROW(raw = image->getRawData());
+	ASSERT_NO_THROW(cached = image->getRawData());
+	ASSERT_EQ(raw.size(), cached.size());
+	EXPECT_EQ(0, std::memcmp(raw, cached, raw.size()));
+	ASSERT_NO_THROW(cached = image->getRawGrayscaleData(8));
+	ASSERT_NO_THROW(cached = image->getRawGrayscaleData(8));
+	auto statistics = DecodeCache::getStatistics();
+	EXPECT_EQ(2, statistics.misses);
+	EXPECT_GE(statistics.retainedHits, 2);
+	EXPECT_EQ(0, statistics.entries);
+	image->releaseDecodedData();
+
+	/* Decode once per process */
+	DecodeCache::setCapacity(raw.size() * 4);
+	DecodeCache::resetStatistics();
+	ASSERT_NO_THROW(image = BE::Image::Image::openImage(data));
+	ASSERT_NO_THROW(cached = image->getRawData());
+	ASSERT_NO_THROW(image = BE::Image::Image::openImage(data));
+	ASSERT_NO_THROW(cached = image->getRawData());
+	ASSERT_EQ(raw.size(), cached.size());
+	EXPECT_EQ(0, std::memcmp(raw, cached, raw.size()));
+	statistics = DecodeCache::getStatistics();
+	EXPECT_EQ(1, statistics.misses);
+	EXPECT_EQ(1, statistics.hits);
+	EXPECT_EQ(1, statistics.entries);
+	/* Encoded data keys the entry, and is held with it */
+	EXPECT_EQ(raw.size() + data.size(), statistics.bytes);
+
+	/* Bounded by capacity */
+	DecodeCache::setCapacity(raw.size() - 1);
+	statistics = DecodeCache::getStatistics();
+	EXPECT_EQ(0, statistics.entries);
+	EXPECT_EQ(1, statistics.evictions);
+	ASSERT_NO_THROW(cached = image->getRawData());
+	EXPECT_EQ(0, DecodeCache::getStatistics().entries);
+
+	DecodeCache::setCapacity(0);
+	DecodeCache::resetStatistics();
+}
+
+#if defined WSQTEST
+TEST(DecodeCache, borrowedData)
+{
+	using DecodeCache = BE::Image::DecodeCache;
+
+	BE::Memory::uint8Array data;
+	ASSERT_NO_THROW(data = BE::IO::Utility::readFile(
+	    RSParentDir + "/img.wsq"));
+
+	DecodeCache::clear();
+	DecodeCache::setCapacity(UINT32_MAX);
+	DecodeCache::resetStatistics();
+
+	/* Borrowed data is freed while its pixels are cached */
+	auto buffer = std::make_unique<uint8_t[]>(data.size());
+	std::memcpy(buffer.get(), data, data.size());
+	std::shared_ptr<BE::Image::Image> image;
+	ASSERT_NO_THROW(image = BE::Image::Image::openImage(
+	    BE::Image::Image::borrowData(buffer.get()), data.size()));
+	BE::Memory::uint8Array raw;
+	ASSERT_NO_THROW(raw = image->getRawData());
+	image.reset();
+	buffer.reset();
+
+	/* Same content, borrowed from another buffer, is a hit */
+	buffer = std::make_unique<uint8_t[]>(data.size());
+	std::memcpy(buffer.get(), data, data.size());
+	ASSERT_NO_THROW(image = BE::Image::Image::openImage(
+	    BE::Image::Image::borrowData(buffer.get()), data.size()));
+	BE::Memory::uint8Array cached;
+	ASSERT_NO_THROW(cached = image->getRawData());
+	EXPECT_EQ(raw, cached);
+
+	const auto statistics = DecodeCache::getStatistics();
+	EXPECT_EQ(1, statistics.misses);
+	EXPECT_EQ(1, statistics.hits);
+	/* The entry holds its own copy of the borrowed data */
+	EXPECT_EQ(raw.size() + data.size(), statistics.bytes);
+
+	DecodeCache::setCapacity(0);
+	DecodeCache::resetStatistics();
+}
+#endif
+
+TEST_F(ImageRecordStore, reducedDecode)
+{
+	BE::Memory::uint8Array data;
+	for (const auto &entry : *(this->_imageRS)) {
+		if (extensions[getFileExtension(entry.key)] == imageType) {
+			data = entry.data;
+			break;
+		}
+	}
+	ASSERT_GT(data.size(), 0);
+
+	std::shared_ptr<BE::Image::Image> image;
+	ASSERT_NO_THROW(image = BE::Image::Image::openImage(data));
+	const BE::Image::Size dimensions = image->getDimensions();
+	BE::Memory::uint8Array full;
+	ASSERT_NO_THROW(full = image->getRawData());
+	const uint64_t bytesPerPixel = full.size() /
+	    (static_cast<uint64_t>(dimensions.xSize) * dimensions.ySize);
+
+	/* Full resolution of the entire image */
+	BE::Memory::uint8Array reduced;
+	ASSERT_NO_THROW(reduced = image->getRawData(0, BE::Image::ROI()));
+	ASSERT_EQ(full.size(), reduced.size());
+	EXPECT_EQ(0, std::memcmp(full, reduced, full.size()));
+
+	/* Full resolution of a region is an exact crop */
+	const BE::Image::ROI roi(BE::Image::Size(dimensions.xSize / 2,
+	    dimensions.ySize / 3), dimensions.xSize / 4, dimensions.ySize / 5,
+	    {});
+	ASSERT_NO_THROW(reduced = image->getRawData(0, roi));
+	ASSERT_EQ(static_cast<uint64_t>(roi.size.xSize) * roi.size.ySize *
+	    bytesPerPixel, reduced.size());
+	for (uint32_t row = 0; row < roi.size.ySize; row++)
+		ASSERT_EQ(0, std::memcmp(reduced + (row * roi.size.xSize *
+		    bytesPerPixel), full + ((((roi.vertOffset + row) *
+		    dimensions.xSize) + roi.horzOffset) * bytesPerPixel),
+		    roi.size.xSize * bytesPerPixel));
+
+	/* Reduced dimensions round up */
+	for (uint8_t reduction = 1; reduction <= 5; reduction++) {
+		const BE::Image::Size expected(
+		    (dimensions.xSize + (1 << reduction) - 1) >> reduction,
+		    (dimensions.ySize + (1 << reduction) - 1) >> reduction);
+		EXPECT_EQ(expected, image->getReducedDimensions(reduction,
+		    BE::Image::ROI()));
+		ASSERT_NO_THROW(reduced = image->getRawData(reduction,
+		    BE::Image::ROI()));
+		EXPECT_EQ(static_cast<uint64_t>(expected.xSize) *
+		    expected.ySize * bytesPerPixel, reduced.size());
+
+		const BE::Image::Size region = image->getReducedDimensions(
+		    reduction, roi);
+		ASSERT_NO_THROW(reduced = image->getRawData(reduction, roi));
+		EXPECT_EQ(static_cast<uint64_t>(region.xSize) * region.ySize *
+		    bytesPerPixel, reduced.size());
+	}
+
+	/* Region outside of the image */
+	EXPECT_THROW(image->getRawData(1, BE::Image::ROI(BE::Image::Size(
+	    dimensions.xSize, 1), 1, 0, {})), BE::Error::ParameterError);
+}
+
+TEST_F(ImageRecordStore, probe)
+{
+	uint32_t imagesChecked{0};
+	for (const auto &entry : *(this->_imageRS)) {
+		if (extensions[getFileExtension(entry.key)] != imageType)
+			continue;
+		imagesChecked++;
+
+		std::shared_ptr<BE::Image::Image> image;
+		ASSERT_NO_THROW(image = BE::Image::Image::openImage(
+		    entry.data));
+		BE::Image::Image::Attributes attributes;
+		ASSERT_NO_THROW(attributes = BE::Image::Image::probe(
+		    entry.data));
+
+		EXPECT_EQ(image->getCompressionAlgorithm(),
+		    attributes.compressionAlgorithm) << entry.key;
+		EXPECT_EQ(image->getDimensions(), attributes.dimensions) <<
+		    entry.key;
+		EXPECT_EQ(image->getColorDepth(), attributes.colorDepth) <<
+		    entry.key;
+		EXPECT_EQ(image->getBitDepth(), attributes.bitDepth) <<
+		    entry.key;
+		EXPECT_EQ(image->getResolution(), attributes.resolution) <<
+		    entry.key;
+		EXPECT_EQ(image->hasAlphaChannel(),
+		    attributes.hasAlphaChannel) << entry.key;
+	}
+	EXPECT_GT(imagesChecked, 0);
+
+	/* Headers only */
+	const uint8_t empty[1]{};
+	EXPECT_THROW(BE::Image::Image::probe(empty, 0),
+	    BE::Error::StrategyError);
+	EXPECT_THROW(BE::Image::Image::probe(nullptr, 0),
+	    BE::Error::StrategyError);
+}
+
+TEST_F(ImageRecordStore, sharedData)
+{
+	std::shared_ptr<BE::Memory::uint8Array> data;
+	for (const auto &entry : *(this->_imageRS)) {
+		if (extensions[getFileExtension(entry.key)] == imageType) {
+			data = std::make_shared<BE::Memory::uint8Array>(
+			    entry.data);
+			break;
+		}
+	}
+	ASSERT_NE(nullptr, data);
+
+	std::shared_ptr<BE::Image::Image> copied, shared, borrowed;
+	ASSERT_NO_THROW(copied = BE::Image::Image::openImage(*data));
+	ASSERT_NO_THROW(shared = BE::Image::Image::openImage(
+	    std::shared_ptr<const BE::Memory::uint8Array>(data)));
+	ASSERT_NO_THROW(borrowed = BE::Image::Image::openImage(
+	    BE::Image::Image::borrowData(*data), data->size()));
+
+	ASSERT_EQ(data->size(), shared->getData().size());
+	ASSERT_EQ(data->size(), borrowed->getData().size());
+	EXPECT_EQ(0, std::memcmp(copied->getData(), *data, data->size()));
+	EXPECT_EQ(0, std::memcmp(shared->getData(), *data, data->size()));
+	EXPECT_EQ(0, std::memcmp(borrowed->getData(), *data, data->size()));
+
+	const auto raw = copied->getRawData();
+	EXPECT_EQ(raw, shared->getRawData());
+	EXPECT_EQ(raw, borrowed->getRawData());
+
+	/* Shared data outlives the caller's reference */
+	const uint64_t size = data->size();
+	data.reset();
+	EXPECT_EQ(size, shared->getData().size());
+	EXPECT_EQ(raw, shared->getRawData());
+}
+
+TEST_F(ImageRecordStore, reusedBuffer)
+{
+	uint32_t imagesChecked{0};
+	BE::Memory::uint8Array reused;
+	for (const auto &entry : *(this->_imageRS)) {
+		if (extensions[getFileExtension(entry.key)] != imageType)
+			continue;
+
+		std::shared_ptr<BE::Image::Image> image;
+		ASSERT_NO_THROW(image = BE::Image::Image::openImage(
+		    entry.data, entry.key));
+		BE::Memory::uint8Array expected;
+		ASSERT_NO_THROW(expected = image->getRawData()) << entry.key;
+
+		/* Larger buffer from a previous image is reused */
+		ASSERT_NO_THROW(image->getRawData(reused)) << entry.key;
+		EXPECT_EQ(expected, reused) << entry.key;
+
+		/* Retained data is copied */
+		image->setRetainDecodedData(true);
+		BE::Memory::uint8Array retained(1);
+		ASSERT_NO_THROW(image->getRawData(retained)) << entry.key;
+		EXPECT_EQ(expected, retained) << entry.key;
+
+		imagesChecked++;
+	}
+	EXPECT_GT(imagesChecked, 0);
+}
+
+#if defined JPEGBTEST || defined JPEG2000TEST || defined NETPBMTEST || \
+    defined PNGTEST || defined WSQTEST
+TEST_F(ImageRecordStore, encode)
+{
+	uint32_t imagesEncoded{0};
+	for (const auto &entry : *(this->_imageRS)) {
+		if (extensions[getFileExtension(entry.key)] != imageType)
+			continue;
+
+		std::shared_ptr<BE::Image::Image> image;
+		ASSERT_NO_THROW(image = BE::Image::Image::openImage(
+		    entry.data));
+		const BE::Image::Raw raw(image->getRawData(),
+		    image->getDimensions(), image->getColorDepth(),
+		    image->getBitDepth(), image->getResolution(),
+		    image->hasAlphaChannel());
+
+		BE::Memory::uint8Array encoded;
+		try {
+#if defined JPEGBTEST
+			encoded = BE::Image::JPEG::encode(raw, 90);
+#elif defined JPEG2000TEST
+			encoded = BE::Image::JPEG2000::encode(raw);
+#elif defined NETPBMTEST
+			encoded = BE::Image::NetPBM::encode(raw);
+#elif defined PNGTEST
+			encoded = BE::Image::PNG::encode(raw);
+#elif defined WSQTEST
+			encoded = BE::Image::WSQ::encode(raw, 2.25);
+#endif
+		} catch (const BE::Error::NotImplemented&) {
+			/* e.g., 1-bit pixmaps */
+			continue;
+		}
+		imagesEncoded++;
+
+		std::shared_ptr<BE::Image::Image> decoded;
+		ASSERT_NO_THROW(decoded = BE::Image::Image::openImage(
+		    encoded)) << entry.key;
+		EXPECT_EQ(imageType, decoded->getCompressionAlgorithm()) <<
+		    entry.key;
+		ASSERT_EQ(image->getDimensions(), decoded->getDimensions()) <<
+		    entry.key;
+
+#if defined JPEG2000TEST || defined NETPBMTEST || defined PNGTEST
+		/* Lossless */
+		EXPECT_EQ(image->getColorDepth(), decoded->getColorDepth()) <<
+		    entry.key;
+		EXPECT_EQ(image->hasAlphaChannel(),
+		    decoded->hasAlphaChannel()) << entry.key;
+		EXPECT_EQ(raw.getRawData(), decoded->getRawData()) << entry.key;
+#else
+		/* Lossy, so compare the average difference in luma */
+		const auto expected = image->getRawGrayscaleData(8);
+		const auto actual = decoded->getRawGrayscaleData(8);
+		ASSERT_EQ(expected.size(), actual.size()) << entry.key;
+		uint64_t difference{0};
+		for (uint64_t i = 0; i < expected.size(); i++)
+			difference += std::abs(static_cast<int>(expected[i]) -
+			    static_cast<int>(actual[i]));
+		EXPECT_LT(difference / expected.size(), 8) << entry.key;
+#endif
+	}
+	EXPECT_GT(imagesEncoded, 0);
+
+	const BE::Image::Raw empty(BE::Memory::uint8Array(),
+	    BE::Image::Size(0, 0), 8, 8, BE::Image::Resolution(), false);
+#if defined JPEGBTEST
+	EXPECT_THROW(BE::Image::JPEG::encode(empty),
+	    BE::Error::ParameterError);
+#elif defined JPEG2000TEST
+	EXPECT_THROW(BE::Image::JPEG2000::encode(empty),
+	    BE::Error::ParameterError);
+#elif defined NETPBMTEST
+	EXPECT_THROW(BE::Image::NetPBM::encode(empty),
+	    BE::Error::ParameterError);
+#elif defined PNGTEST
+	EXPECT_THROW(BE::Image::PNG::encode(empty),
+	    BE::Error::ParameterError);
+#elif defined WSQTEST
+	EXPECT_THROW(BE::Image::WSQ::encode(empty),
+	    BE::Error::ParameterError);
+#endif
+}
+#endif
+
+#if defined JPEG2000TEST
+/*
+ * Synthetic image with samples varied enough to detect lossy or reordered
+ * samples, and a resolution the JP2 capture resolution box stores exactly.
+ */
+static BE::Image::Raw
+makeRaw(
+    const BE::Image::Size &size,
+    const uint32_t colorDepth,
+    const uint16_t bitDepth,
+    const bool hasAlphaChannel)
+{
+	BE::Memory::uint8Array pixels(static_cast<uint64_t>(size.xSize) *
+	    size.ySize * (colorDepth / 8));
+	for (uint64_t i = 0; i < pixels.size(); i++)
+		pixels[i] = static_cast<uint8_t>((i * 13) ^ (i / 97));
+	return (BE::Image::Raw(pixels, size, colorDepth, bitDepth,
+	    BE::Image::Resolution(200, 200,
+	    BE::Image::Resolution::Units::PPCM), hasAlphaChannel));
+}
+
+TEST(JPEG2000, encodeSynthetic)
+{
+	/* Color depth, bit depth, and alpha of each supported layout */
+	const std::vector<std::tuple<uint32_t, uint16_t, bool>> layouts{
+	    {8, 8, false}, {16, 8, true}, {16, 16, false}, {24, 8, false},
+	    {32, 8, true}, {48, 16, false}};
+	for (const auto &[colorDepth, bitDepth, hasAlphaChannel] : layouts) {
+		SCOPED_TRACE(std::to_string(colorDepth) + "/" +
+		    std::to_string(bitDepth));
+		const auto raw = makeRaw(BE::Image::Size(203, 150), colorDepth,
+		    bitDepth, hasAlphaChannel);
+
+		BE::Memory::uint8Array encoded;
+		ASSERT_NO_THROW(encoded = BE::Image::JPEG2000::encode(raw));
+		std::shared_ptr<BE::Image::Image> decoded;
+		ASSERT_NO_THROW(decoded = BE::Image::Image::openImage(encoded));
+		EXPECT_EQ(BE::Image::CompressionAlgorithm::JP2,
+		    decoded->getCompressionAlgorithm());
+		EXPECT_EQ(raw.getDimensions(), decoded->getDimensions());
+		EXPECT_EQ(colorDepth, decoded->getColorDepth());
+		EXPECT_EQ(bitDepth, decoded->getBitDepth());
+		EXPECT_EQ(hasAlphaChannel, decoded->hasAlphaChannel());
+		EXPECT_EQ(raw.getResolution(), decoded->getResolution());
+		EXPECT_EQ(raw.getRawData(), decoded->getRawData());
+
+		BE::Memory::uint8Array lossy;
+		ASSERT_NO_THROW(lossy = BE::Image::JPEG2000::encode(raw, 15));
+		EXPECT_LT(lossy.size(), encoded.size());
+		ASSERT_NO_THROW(decoded = BE::Image::Image::openImage(lossy));
+		EXPECT_EQ(raw.getDimensions(), decoded->getDimensions());
+	}
+
+	EXPECT_THROW(BE::Image::JPEG2000::encode(makeRaw(
+	    BE::Image::Size(8, 8), 8, 8, false), -1),
+	    BE::Error::ParameterError);
+}
+
+TEST_F(ImageRecordStore, decodeThreads)
+{
+	using BE::Image::JPEG2000;
+	const uint32_t original = JPEG2000::getDefaultDecodeThreadCount();
+	EXPECT_EQ(1, original);
+
+	/* Exercise the first decode using the constructor's header */
+	EXPECT_FALSE(JPEG2000::getDefaultRetainHeader());
+	JPEG2000::setDefaultRetainHeader(true);
+
+	uint32_t imagesChecked{0};
+	for (const auto &entry : *(this->_imageRS)) {
+		if (extensions[getFileExtension(entry.key)] != imageType)
+			continue;
+
+		JPEG2000::setDefaultDecodeThreadCount(1);
+		JPEG2000 single(entry.data, entry.key);
+		EXPECT_EQ(1, single.getDecodeThreadCount());
+		BE::Memory::uint8Array expected;
+		ASSERT_NO_THROW(expected = single.getRawData()) << entry.key;
+
+		/* Decoding again must read the header again */
+		EXPECT_EQ(expected, single.getRawData()) << entry.key;
+
+		JPEG2000::setDefaultDecodeThreadCount(0);
+		JPEG2000 all(entry.data, entry.key);
+		EXPECT_EQ(0, all.getDecodeThreadCount());
+		EXPECT_EQ(expected, all.getRawData()) << entry.key;
+
+		/* Change after the constructor read the header */
+		JPEG2000 changed(entry.data, entry.key);
+		changed.setDecodeThreadCount(4);
+		EXPECT_EQ(4, changed.getDecodeThreadCount());
+		EXPECT_EQ(expected, changed.getRawData()) << entry.key;
+
+		imagesChecked++;
+	}
+	EXPECT_GT(imagesChecked, 0);
+
+	JPEG2000::setDefaultDecodeThreadCount(original);
+	JPEG2000::setDefaultRetainHeader(false);
+}
+
+TEST(JPEG2000, decodeThreads)
+{
+	using BE::Image::JPEG2000;
+	const uint32_t original = JPEG2000::getDefaultDecodeThreadCount();
+
+	std::vector<std::pair<std::string, BE::Memory::uint8Array>> images;
+	BE::Memory::uint8Array data;
+	ASSERT_NO_THROW(data = BE::IO::Utility::readFile(
+	    RSParentDir + "/img.jp2"));
+	images.emplace_back("img.jp2", data);
+	ASSERT_NO_THROW(data = JPEG2000::encode(makeRaw(
+	    BE::Image::Size(203, 150), 32, 8, true)));
+	images.emplace_back("synthetic", data);
+
+	const BE::Image::ROI roi(BE::Image::Size(50, 40), 17, 33, {});
+	for (const bool retainHeader : {false, true}) {
+		JPEG2000::setDefaultRetainHeader(retainHeader);
+		for (const auto &[key, data] : images) {
+			SCOPED_TRACE(key + (retainHeader ? ", retained" : ""));
+
+			JPEG2000::setDefaultDecodeThreadCount(1);
+			const JPEG2000 single(data, key);
+			EXPECT_EQ(1, single.getDecodeThreadCount());
+			BE::Memory::uint8Array expected;
+			ASSERT_NO_THROW(expected = single.getRawData());
+			EXPECT_EQ(expected, single.getRawData());
+
+			/* Regions and reductions reuse the header, too */
+			const BE::Image::Raw raw(expected,
+			    single.getDimensions(), single.getColorDepth(),
+			    single.getBitDepth(), single.getResolution(),
+			    single.hasAlphaChannel());
+			EXPECT_EQ(raw.getRawData(0, roi),
+			    single.getRawData(0, roi));
+			EXPECT_EQ(single.getReducedDimensions(1, {}).xSize *
+			    single.getReducedDimensions(1, {}).ySize *
+			    (single.getColorDepth() / 8),
+			    single.getRawData(1, {}).size());
+
+			JPEG2000::setDefaultDecodeThreadCount(0);
+			const JPEG2000 all(data, key);
+			EXPECT_EQ(0, all.getDecodeThreadCount());
+			EXPECT_EQ(expected, all.getRawData());
+
+			JPEG2000 changed(data, key);
+			changed.setDecodeThreadCount(4);
+			EXPECT_EQ(4, changed.getDecodeThreadCount());
+			EXPECT_EQ(expected, changed.getRawData());
+			EXPECT_EQ(raw.getRawData(0, roi),
+			    changed.getRawData(0, roi));
+		}
+	}
+
+	JPEG2000::setDefaultDecodeThreadCount(original);
+	JPEG2000::setDefaultRetainHeader(false);
+}
+#endif
+#endif
@@ -0,0 +1,339 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <be_image.h>
+#include <be_image_image.h>
+#include <be_image_pixelkernels.h>
+#include <be_memory_indexedbuffer.h>
+#include <be_memory_mutableindexedbuffer.h>
+
+namespace BE = BiometricEvaluation;
+namespace PixelKernels = BE::Image::PixelKernels;
+
+/* Pixel counts exercising vector bodies and scalar remainders */
+static const std::vector<uint64_t> PixelCounts{0, 1, 3, 5, 7, 9, 15, 16,
+    17, 31, 33, 64, 1000, 4099};
+
+static std::vector<PixelKernels::InstructionSet>
+supportedInstructionSets()
+{
+	std::vector<PixelKernels::InstructionSet> sets;
+	for (const auto set : {PixelKernels::InstructionSet::Scalar,
+	    PixelKernels::InstructionSet::SSE4_1,
+	    PixelKernels::InstructionSet::AVX2})
+		if (PixelKernels::isSupported(set))
+			sets.push_back(set);
+	return (sets);
+}
+
+static BE::Memory::uint8Array
+randomData(
+    uint64_t size,
+    unsigned int seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<int> distribution(0, UINT8_MAX);
+	BE::Memory::uint8Array data(size);
+	for (uint64_t i = 0; i < size; i++)
+		data[i] = static_cast<uint8_t>(distribution(generator));
+
+	/* Extremes of each component */
+	if (size >= 8) {
+		std::memset(data, 0x00, 4);
+		std::memset(data + 4, 0xFF, 4);
+	}
+	return (data);
+}
+
+/*
+ * Conversion to grayscale as previously implemented pixel-by-pixel in
+ * Image::getRawGrayscaleData().
+ */
+static BE::Memory::uint8Array
+referenceColorToGray(
+    const BE::Memory::uint8Array &rawColor,
+    uint8_t colorDepth,
+    uint8_t depth)
+{
+	using BE::Image::Image;
+	static const float redFactor = 0.299;
+	static const float greenFactor = 0.587;
+	static const float blueFactor = 0.114;
+
+	const uint8_t bpcIn = colorDepth / 8;
+	BE::Memory::IndexedBuffer inBuffer{rawColor};
+	const uint8_t componentBytes = ((colorDepth == 24) ||
+	    (colorDepth == 32) ? 1 : 2);
+	const uint8_t components = colorDepth / (8 * componentBytes);
+	BE::Memory::uint8Array rawGray((depth / 8) * (rawColor.size() /
+	    (components * componentBytes)));
+	BE::Memory::MutableIndexedBuffer outBuffer(rawGray);
+
+	uint16_t rValue, bValue, gValue;
+	for (uint32_t i = 0; i < rawColor.size(); i += bpcIn) {
+		switch (colorDepth) {
+		case 32:
+		case 24:
+			if (depth == 16) {
+				rValue = static_cast<uint16_t>(
+				    Image::valueInColorspace(
+				    inBuffer.scanU8Val(), UINT8_MAX, 16));
+				gValue = static_cast<uint16_t>(
+				    Image::valueInColorspace(
+				    inBuffer.scanU8Val(), UINT8_MAX, 16));
+				bValue = static_cast<uint16_t>(
+				    Image::valueInColorspace(
+				    inBuffer.scanU8Val(), UINT8_MAX, 16));
+				outBuffer.pushU16Val((rValue * redFactor) +
+				    (gValue * greenFactor) +
+				    (bValue * blueFactor));
+			} else {
+				outBuffer.pushU8Val(static_cast<uint8_t>(
+				    (inBuffer.scanU8Val() * redFactor) +
+				    (inBuffer.scanU8Val() * greenFactor) +
+				    (inBuffer.scanU8Val() * blueFactor)));
+			}
+			if (colorDepth == 32)
+				inBuffer.scanU8Val();
+			break;
+		case 64:
+		case 48:
+			rValue = inBuffer.scanU16Val();
+			gValue = inBuffer.scanU16Val();
+			bValue = inBuffer.scanU16Val();
+			if (depth == 16) {
+				outBuffer.pushU16Val((rValue * redFactor) +
+				    (gValue * greenFactor) +
+				    (bValue * blueFactor));
+			} else {
+				rValue = static_cast<uint8_t>(
+				    Image::valueInColorspace(rValue,
+				    UINT16_MAX, 8));
+				gValue = static_cast<uint8_t>(
+				    Image::valueInColorspace(gValue,
+				    UINT16_MAX, 8));
+				bValue = static_cast<uint8_t>(
+				    Image::valueInColorspace(bValue,
+				    UINT16_MAX, 8));
+				outBuffer.pushU8Val((rValue * redFactor) +
+				    (gValue * greenFactor) +
+				    (bValue * blueFactor));
+			}
+			if (colorDepth == 64)
+				inBuffer.scanU16Val();
+			break;
+		}
+	}
+	return (rawGray);
+}
+
+TEST(PixelKernels, InstructionSet)
+{
+	EXPECT_TRUE(PixelKernels::isSupported(
+	    PixelKernels::InstructionSet::Scalar));
+	const auto original = PixelKernels::getInstructionSet();
+	EXPECT_TRUE(PixelKernels::isSupported(original));
+
+	for (const auto set : supportedInstructionSets()) {
+		ASSERT_NO_THROW(PixelKernels::setInstructionSet(set));
+		EXPECT_EQ(set, PixelKernels::getInstructionSet());
+	}
+	for (const auto set : {PixelKernels::InstructionSet::SSE4_1,
+	    PixelKernels::InstructionSet::AVX2}) {
+		if (!PixelKernels::isSupported(set)) {
+			EXPECT_THROW(PixelKernels::setInstructionSet(set),
+			    BE::Error::NotImplemented);
+		}
+	}
+
+	PixelKernels::setInstructionSet(original);
+}
+
+TEST(PixelKernels, colorToGray)
+{
+	const auto original = PixelKernels::getInstructionSet();
+	for (const auto set : supportedInstructionSets()) {
+		PixelKernels::setInstructionSet(set);
+		for (const uint8_t inDepth : {8, 16})
+		for (const uint8_t components : {3, 4})
+		for (const uint8_t outDepth : {8, 16})
+		for (const uint64_t count : PixelCounts) {
+			SCOPED_TRACE(BE::Framework::Enumeration::to_string(
+			    set) + ": " + std::to_string(count) + " pixels of " +
+			    std::to_string(components) + "x" +
+			    std::to_string(inDepth) + " bits to " +
+			    std::to_string(outDepth) + " bits");
+
+			const auto in = randomData(count * components *
+			    (inDepth / 8), count);
+			const auto expected = referenceColorToGray(in,
+			    components * inDepth, outDepth);
+			BE::Memory::uint8Array out(count * (outDepth / 8));
+			ASSERT_NO_THROW(PixelKernels::colorToGray(in, out,
+			    count, inDepth, components, outDepth));
+			ASSERT_EQ(expected.size(), out.size());
+			EXPECT_EQ(0, std::memcmp(expected, out, out.size()));
+		}
+	}
+	PixelKernels::setInstructionSet(original);
+
+	uint8_t pixel[8]{};
+	EXPECT_THROW(PixelKernels::colorToGray(pixel, pixel, 1, 8, 2, 8),
+	    BE::Error::ParameterError);
+	EXPECT_THROW(PixelKernels::colorToGray(pixel, pixel, 1, 12, 3, 8),
+	    BE::Error::ParameterError);
+	EXPECT_THROW(PixelKernels::colorToGray(pixel, pixel, 1, 8, 3, 1),
+	    BE::Error::ParameterError);
+}
+
+TEST(PixelKernels, rescale)
+{
+	/* Every 16-bit value */
+	BE::Memory::uint8Array all16(2 * 65536);
+	for (uint32_t v = 0; v < 65536; v++) {
+		const uint16_t value = static_cast<uint16_t>(v);
+		std::memcpy(all16 + (2 * v), &value, sizeof(value));
+	}
+	BE::Memory::uint8Array all8(256);
+	for (uint32_t v = 0; v < 256; v++)
+		all8[v] = static_cast<uint8_t>(v);
+
+	const auto original = PixelKernels::getInstructionSet();
+	for (const auto set : supportedInstructionSets()) {
+		SCOPED_TRACE(BE::Framework::Enumeration::to_string(set));
+		PixelKernels::setInstructionSet(set);
+
+		BE::Memory::uint8Array out8(65536);
+		PixelKernels::rescale(all16, out8, 65536, 16, 8);
+		for (uint32_t v = 0; v < 65536; v++)
+			ASSERT_EQ(BE::Image::Image::valueInColorspace(v,
+			    UINT16_MAX, 8), out8[v]) << v;
+
+		BE::Memory::uint8Array out16(2 * 256);
+		PixelKernels::rescale(all8, out16, 256, 8, 16);
+		for (uint32_t v = 0; v < 256; v++) {
+			uint16_t value;
+			std::memcpy(&value, out16 + (2 * v), sizeof(value));
+			ASSERT_EQ(BE::Image::Image::valueInColorspace(v,
+			    UINT8_MAX, 16), value) << v;
+		}
+
+		/* Remainders */
+		for (const uint64_t count : PixelCounts) {
+			if (count > 256)
+				continue;
+			BE::Memory::uint8Array part(count);
+			PixelKernels::rescale(all16 + (2 * 300), part, count,
+			    16, 8);
+			EXPECT_EQ(0, std::memcmp(part, out8 + 300, count));
+		}
+	}
+	PixelKernels::setInstructionSet(original);
+}
+
+TEST(PixelKernels, removeLastComponent)
+{
+	const auto original = PixelKernels::getInstructionSet();
+	for (const auto set : supportedInstructionSets()) {
+		PixelKernels::setInstructionSet(set);
+		for (const uint8_t bytes : {1, 2})
+		for (const uint8_t components : {2, 4})
+		for (const uint64_t count : PixelCounts) {
+			SCOPED_TRACE(BE::Framework::Enumeration::to_string(
+			    set) + ": " + std::to_string(count) + " pixels of " +
+			    std::to_string(components) + "x" +
+			    std::to_string(bytes) + " bytes");
+
+			const auto in = randomData(count * components * bytes,
+			    count);
+			std::vector<bool> remove(components, false);
+			remove.back() = true;
+			const auto expected = BE::Image::removeComponents(in,
+			    bytes * 8, remove);
+
+			/* Guard against writing past the end */
+			BE::Memory::uint8Array out(count * (components - 1) *
+			    bytes + 1);
+			out[out.size() - 1] = 0xA5;
+			ASSERT_NO_THROW(PixelKernels::removeLastComponent(in,
+			    out, count, bytes, components));
+			EXPECT_EQ(0xA5, out[out.size() - 1]);
+			ASSERT_EQ(expected.size(), out.size() - 1);
+
+			/* Byte-for-byte copy of the remaining components */
+			for (uint64_t px = 0; px < count; px++)
+				ASSERT_EQ(0, std::memcmp(out + (px *
+				    (components - 1) * bytes), in + (px *
+				    components * bytes), (components - 1) *
+				    bytes)) << px;
+			EXPECT_EQ(0, std::memcmp(expected, out,
+			    expected.size()));
+		}
+	}
+	PixelKernels::setInstructionSet(original);
+}
+
+TEST(PixelKernels, weightedSum)
+{
+	const auto original = PixelKernels::getInstructionSet();
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> distribution(0, UINT16_MAX);
+	for (const uint32_t weightCount : {1, 2, 7}) {
+		std::vector<float> weights(weightCount);
+		for (uint32_t k = 0; k < weightCount; k++)
+			weights[k] = (k + 1.0f) / (weightCount * 2.0f);
+
+		for (const uint64_t count : PixelCounts) {
+			/* Rows of count values, one longer than needed */
+			const uint64_t stride = count + 1;
+			std::vector<float> in(stride * weightCount);
+			for (float &value : in)
+				value = distribution(generator);
+
+			PixelKernels::setInstructionSet(
+			    PixelKernels::InstructionSet::Scalar);
+			std::vector<float> expected(count);
+			PixelKernels::weightedSum(in.data(), stride,
+			    weights.data(), weightCount, expected.data(),
+			    count);
+			for (uint64_t i = 0; i < count; i++) {
+				float sum{0};
+				for (uint32_t k = 0; k < weightCount; k++)
+					sum += weights[k] * in[(k * stride) + i];
+				ASSERT_FLOAT_EQ(sum, expected[i]) << i;
+			}
+
+			for (const auto set : supportedInstructionSets()) {
+				SCOPED_TRACE(BE::Framework::Enumeration::
+				    to_string(set) + ": " + std::to_string(
+				    count) + " values, " + std::to_string(
+				    weightCount) + " weights");
+				PixelKernels::setInstructionSet(set);
+
+				/* Guard against writing past the end */
+				std::vector<float> out(count + 1, -1.0f);
+				PixelKernels::weightedSum(in.data(), stride,
+				    weights.data(), weightCount, out.data(),
+				    count);
+				EXPECT_EQ(-1.0f, out[count]);
+				EXPECT_EQ(0, std::memcmp(expected.data(),
+				    out.data(), count * sizeof(float)));
+			}
+		}
+	}
+	PixelKernels::setInstructionSet(original);
+}
@@ -0,0 +1,195 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <be_error_exception.h>
+#include <be_image_pixelkernels.h>
+#include <be_image_raw.h>
+#include <be_image_resample.h>
+
+namespace BE = BiometricEvaluation;
+using BE::Image::ResampleFilter;
+
+static const std::vector<ResampleFilter> Filters{ResampleFilter::Area,
+    ResampleFilter::Bilinear, ResampleFilter::Lanczos3};
+
+static BE::Image::Raw
+makeRaw(
+    const BE::Image::Size &size,
+    uint8_t components,
+    const BE::Image::Resolution &resolution = BE::Image::Resolution(1000,
+        1000, BE::Image::Resolution::Units::PPI))
+{
+	BE::Memory::uint8Array pixels(static_cast<uint64_t>(size.xSize) *
+	    size.ySize * components);
+	for (uint64_t i = 0; i < pixels.size(); i++)
+		pixels[i] = static_cast<uint8_t>((i * 37) ^ (i / 11));
+	return (BE::Image::Raw(pixels, size, components * 8, 8, resolution,
+	    false));
+}
+
+TEST(ImageResample, Identity)
+{
+	for (const uint8_t components : {1, 3}) {
+		const auto raw = makeRaw(BE::Image::Size(37, 23), components);
+		for (const auto filter : Filters) {
+			SCOPED_TRACE(BE::Framework::Enumeration::to_string(
+			    filter));
+			const auto resampled = BE::Image::resample(raw,
+			    raw.getDimensions(), filter);
+			EXPECT_EQ(raw.getDimensions(),
+			    resampled.getDimensions());
+			EXPECT_EQ(raw.getColorDepth(),
+			    resampled.getColorDepth());
+			EXPECT_EQ(raw.getRawData(), resampled.getRawData());
+		}
+	}
+}
+
+TEST(ImageResample, AreaAverage)
+{
+	const auto raw = makeRaw(BE::Image::Size(40, 30), 1);
+	const auto pixels = raw.getRawData();
+	const auto resampled = BE::Image::resample(raw,
+	    BE::Image::Size(20, 15), ResampleFilter::Area);
+	const auto out = resampled.getRawData();
+	ASSERT_EQ(20u * 15u, out.size());
+
+	for (uint32_t y = 0; y < 15; y++) {
+		for (uint32_t x = 0; x < 20; x++) {
+			const uint32_t sum = pixels[(2 * y * 40) + (2 * x)] +
+			    pixels[(2 * y * 40) + (2 * x) + 1] +
+			    pixels[(((2 * y) + 1) * 40) + (2 * x)] +
+			    pixels[(((2 * y) + 1) * 40) + (2 * x) + 1];
+			/* Within rounding of the exact average */
+			EXPECT_NEAR(sum / 4.0, out[(y * 20) + x], 0.51) <<
+			    x << "," << y;
+		}
+	}
+}
+
+TEST(ImageResample, Constant)
+{
+	const BE::Image::Size size(31, 17);
+	const BE::Memory::uint8Array pixels(size.xSize * size.ySize * 2);
+	for (uint64_t i = 0; i < pixels.size(); i += 2) {
+		const uint16_t value{51234};
+		std::memcpy(const_cast<uint8_t *>(&pixels[i]), &value,
+		    sizeof(value));
+	}
+	const BE::Image::Raw raw(pixels, size, 16, 16,
+	    BE::Image::Resolution(500, 500, BE::Image::Resolution::Units::PPI),
+	    false);
+
+	for (const auto filter : Filters) {
+		for (const auto &resampledSize : {BE::Image::Size(9, 5),
+		    BE::Image::Size(70, 40), BE::Image::Size(13, 60)}) {
+			const auto out = BE::Image::resample(raw,
+			    resampledSize, filter).getRawData();
+			ASSERT_EQ(resampledSize.xSize * resampledSize.ySize *
+			    2, out.size());
+			for (uint64_t i = 0; i < out.size(); i += 2) {
+				uint16_t value;
+				std::memcpy(&value, &out[i], sizeof(value));
+				ASSERT_EQ(51234, value) << i;
+			}
+		}
+	}
+}
+
+TEST(ImageResample, ROI)
+{
+	const auto raw = makeRaw(BE::Image::Size(64, 48), 3);
+	const BE::Image::ROI roi(BE::Image::Size(20, 12), 10, 6, {});
+	const BE::Image::Raw cropped(raw.getRawData(0, roi), roi.size, 24, 8,
+	    raw.getResolution(), false);
+
+	/* Area filters read no pixels outside the region */
+	const auto expected = BE::Image::resample(cropped,
+	    BE::Image::Size(7, 5), ResampleFilter::Area);
+	const auto actual = BE::Image::resample(raw, BE::Image::Size(7, 5),
+	    ResampleFilter::Area, roi);
+	EXPECT_EQ(expected.getRawData(), actual.getRawData());
+	EXPECT_DOUBLE_EQ(expected.getResolution().xRes,
+	    actual.getResolution().xRes);
+	EXPECT_DOUBLE_EQ(expected.getResolution().yRes,
+	    actual.getResolution().yRes);
+
+	EXPECT_THROW(BE::Image::resample(raw, BE::Image::Size(7, 5),
+	    ResampleFilter::Area, BE::Image::ROI(BE::Image::Size(20, 12), 50,
+	    6, {})), BE::Error::ParameterError);
+}
+
+TEST(ImageResample, InstructionSets)
+{
+	const auto raw = makeRaw(BE::Image::Size(101, 67), 3);
+	const auto original = BE::Image::PixelKernels::getInstructionSet();
+
+	for (const auto filter : Filters) {
+		BE::Image::PixelKernels::setInstructionSet(
+		    BE::Image::PixelKernels::InstructionSet::Scalar);
+		const auto expected = BE::Image::resample(raw,
+		    BE::Image::Size(43, 88), filter).getRawData();
+
+		for (const auto set : {
+		    BE::Image::PixelKernels::InstructionSet::SSE4_1,
+		    BE::Image::PixelKernels::InstructionSet::AVX2}) {
+			if (!BE::Image::PixelKernels::isSupported(set))
+				continue;
+			BE::Image::PixelKernels::setInstructionSet(set);
+			EXPECT_EQ(expected, BE::Image::resample(raw,
+			    BE::Image::Size(43, 88), filter).getRawData());
+		}
+	}
+	BE::Image::PixelKernels::setInstructionSet(original);
+}
+
+TEST(ImageResample, Resolution)
+{
+	const auto raw = makeRaw(BE::Image::Size(80, 60), 1);
+	const auto resampled = BE::Image::resample(raw, BE::Image::Size(40,
+	    120), ResampleFilter::Bilinear);
+	EXPECT_DOUBLE_EQ(500, resampled.getResolution().xRes);
+	EXPECT_DOUBLE_EQ(2000, resampled.getResolution().yRes);
+
+	const auto normalized = BE::Image::normalizeResolution(raw);
+	EXPECT_EQ(BE::Image::Size(40, 30), normalized.getDimensions());
+	EXPECT_DOUBLE_EQ(500, normalized.getResolution().xRes);
+	EXPECT_DOUBLE_EQ(500, normalized.getResolution().yRes);
+	EXPECT_EQ(BE::Image::Resolution::Units::PPI,
+	    normalized.getResolution().units);
+
+	/* Conversion of units */
+	const auto metric = BE::Image::normalizeResolution(raw,
+	    BE::Image::Resolution(19.685, 19.685,
+	    BE::Image::Resolution::Units::PPMM), ResampleFilter::Lanczos3,
+	    BE::Image::ROI(BE::Image::Size(40, 20), 0, 0, {}));
+	EXPECT_EQ(BE::Image::Size(20, 10), metric.getDimensions());
+}
+
+TEST(ImageResample, Errors)
+{
+	const auto raw = makeRaw(BE::Image::Size(8, 8), 1);
+	EXPECT_THROW(BE::Image::resample(raw, BE::Image::Size(0, 4)),
+	    BE::Error::ParameterError);
+	EXPECT_THROW(BE::Image::normalizeResolution(raw,
+	    BE::Image::Resolution(0, 500, BE::Image::Resolution::Units::PPI)),
+	    BE::Error::ParameterError);
+
+	const auto noUnits = makeRaw(BE::Image::Size(8, 8), 1,
+	    BE::Image::Resolution(1, 1, BE::Image::Resolution::Units::NA));
+	EXPECT_THROW(BE::Image::normalizeResolution(noUnits),
+	    BE::Error::StrategyError);
+}
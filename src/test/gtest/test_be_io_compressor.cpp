@@ -0,0 +1,239 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_io_compressor.h>
+#include <be_io_utility.h>
+#include <be_memory_autoarray.h>
+
+#include <gtest/gtest.h>
+
+namespace BE = BiometricEvaluation;
+
+class Compressor : public ::testing::TestWithParam<BE::IO::Compressor::Kind>
+{
+protected:
+	void
+	SetUp()
+	    override
+	{
+		try {
+			_compressor = BE::IO::Compressor::createCompressor(
+			    GetParam());
+		} catch (const BE::Error::NotImplemented&) {
+			GTEST_SKIP() << "Compressor not built";
+		}
+
+		/* Several chunks of compressible, non-repeating data */
+		_data.resize(100003);
+		for (uint64_t i = 0; i < _data.size(); i++)
+			_data[i] = static_cast<uint8_t>((i * i) % 251);
+		_compressed = _compressor->compress(_data);
+	}
+
+	std::shared_ptr<BE::IO::Compressor> _compressor;
+	BE::Memory::uint8Array _data;
+	BE::Memory::uint8Array _compressed;
+};
+
+TEST_P(Compressor, RoundTrip)
+{
+	EXPECT_LT(_compressed.size(), _data.size());
+
+	BE::Memory::uint8Array out = _compressor->decompress(_compressed);
+	ASSERT_EQ(out.size(), _data.size());
+	EXPECT_EQ(0, std::memcmp(out, _data, _data.size()));
+
+	/* Empty buffers */
+	BE::Memory::uint8Array empty;
+	BE::Memory::uint8Array compressedEmpty;
+	ASSERT_NO_THROW(compressedEmpty = _compressor->compress(empty));
+	ASSERT_NO_THROW(out = _compressor->decompress(compressedEmpty));
+	EXPECT_EQ(0, out.size());
+}
+
+TEST_P(Compressor, KnownSize)
+{
+	BE::Memory::uint8Array out;
+	ASSERT_NO_THROW(out = _compressor->decompress(_compressed,
+	    _compressed.size(), _data.size()));
+	ASSERT_EQ(out.size(), _data.size());
+	EXPECT_EQ(0, std::memcmp(out, _data, _data.size()));
+
+	/* Reused stream must be reset between calls */
+	ASSERT_NO_THROW(out = _compressor->decompress(_compressed,
+	    _compressed.size(), _data.size()));
+	EXPECT_EQ(0, std::memcmp(out, _data, _data.size()));
+
+	/* Empty buffers, which have no data pointer */
+	const BE::Memory::uint8Array compressedEmpty = _compressor->compress(
+	    BE::Memory::uint8Array());
+	ASSERT_NO_THROW(out = _compressor->decompress(compressedEmpty,
+	    compressedEmpty.size(), 0));
+	EXPECT_EQ(0, out.size());
+	EXPECT_THROW(_compressor->decompress(_compressed, _compressed.size(),
+	    0), BE::Error::StrategyError);
+}
+
+TEST_P(Compressor, CallerBuffer)
+{
+	BE::Memory::uint8Array out(_data.size() + 1);
+	out[_data.size()] = 0xAA;
+	ASSERT_NO_THROW(_compressor->decompress(_compressed,
+	    _compressed.size(), out, _data.size()));
+	EXPECT_EQ(0, std::memcmp(out, _data, _data.size()));
+	EXPECT_EQ(0xAA, out[_data.size()]);
+}
+
+TEST_P(Compressor, WrongSize)
+{
+	EXPECT_THROW(_compressor->decompress(_compressed, _compressed.size(),
+	    _data.size() - 1), BE::Error::StrategyError);
+	EXPECT_THROW(_compressor->decompress(_compressed, _compressed.size(),
+	    _data.size() + 1), BE::Error::StrategyError);
+
+	/* A failed decompression must not affect the next one */
+	BE::Memory::uint8Array out;
+	ASSERT_NO_THROW(out = _compressor->decompress(_compressed,
+	    _compressed.size(), _data.size()));
+	EXPECT_EQ(0, std::memcmp(out, _data, _data.size()));
+}
+
+TEST_P(Compressor, Truncated)
+{
+	EXPECT_THROW(_compressor->decompress(_compressed,
+	    _compressed.size() / 2, _data.size()), BE::Error::StrategyError);
+	EXPECT_THROW(_compressor->decompress(_compressed,
+	    _compressed.size() / 2), BE::Error::StrategyError);
+}
+
+TEST_P(Compressor, Files)
+{
+	const std::string input = "compressor_test_input";
+	const std::string compressed = "compressor_test_compressed";
+	const std::string output = "compressor_test_output";
+	for (const auto &path : {input, compressed, output})
+		std::remove(path.c_str());
+	BE::IO::Utility::writeFile(_data, input);
+
+	ASSERT_NO_THROW(_compressor->compress(input, compressed));
+	EXPECT_THROW(_compressor->compress(input, compressed),
+	    BE::Error::ObjectExists);
+	ASSERT_NO_THROW(_compressor->decompress(compressed, output));
+	BE::Memory::uint8Array out = BE::IO::Utility::readFile(output);
+	ASSERT_EQ(out.size(), _data.size());
+	EXPECT_EQ(0, std::memcmp(out, _data, _data.size()));
+
+	ASSERT_NO_THROW(out = _compressor->decompress(compressed));
+	ASSERT_EQ(out.size(), _data.size());
+	EXPECT_EQ(0, std::memcmp(out, _data, _data.size()));
+
+	EXPECT_THROW(_compressor->compress(input + "_missing"),
+	    BE::Error::ObjectDoesNotExist);
+
+	for (const auto &path : {input, compressed, output})
+		std::remove(path.c_str());
+}
+
+TEST_P(Compressor, Threads)
+{
+	static const int NUMTHREADS = 4;
+	std::vector<int> failures(NUMTHREADS, 0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < NUMTHREADS; t++) {
+		threads.emplace_back([&, t]() {
+			BE::Memory::uint8Array out(_data.size());
+			for (int i = 0; i < 50; i++) {
+				try {
+					_compressor->decompress(_compressed,
+					    _compressed.size(), out,
+					    out.size());
+					if (std::memcmp(out, _data,
+					    _data.size()) != 0)
+						failures[t]++;
+				} catch (const BE::Error::Exception&) {
+					failures[t]++;
+				}
+			}
+		});
+	}
+	for (auto &thread : threads)
+		thread.join();
+	for (int t = 0; t < NUMTHREADS; t++)
+		EXPECT_EQ(0, failures[t]);
+}
+
+TEST_P(Compressor, Dictionary)
+{
+	/* Many small records sharing most of their content */
+	std::vector<BE::Memory::uint8Array> samples;
+	for (int i = 0; i < 1000; i++) {
+		const std::string record = "<record><id>" +
+		    std::to_string(i) + "</id><finger>" +
+		    std::to_string(i % 10) + "</finger><quality>" +
+		    std::to_string((i * 7) % 100) + "</quality></record>";
+		BE::Memory::uint8Array sample(record.size());
+		sample.copy(reinterpret_cast<const uint8_t *>(record.data()),
+		    record.size());
+		samples.push_back(sample);
+	}
+
+	if (!_compressor->supportsDictionaries()) {
+		EXPECT_THROW(_compressor->trainDictionary(samples),
+		    BE::Error::NotImplemented);
+		EXPECT_EQ(0, _compressor->getDictionary().size());
+		return;
+	}
+
+	/* Compressed without a dictionary, read back with one */
+	const BE::Memory::uint8Array plain = _compressor->compress(
+	    samples[0]);
+
+	BE::Memory::uint8Array dictionary;
+	ASSERT_NO_THROW(dictionary = _compressor->trainDictionary(samples,
+	    4096));
+	EXPECT_GT(dictionary.size(), 0);
+	EXPECT_LE(dictionary.size(), 4096);
+	ASSERT_NO_THROW(_compressor->setDictionary(dictionary));
+	EXPECT_EQ(dictionary.size(), _compressor->getDictionary().size());
+
+	const BE::Memory::uint8Array withDictionary = _compressor->compress(
+	    samples[0]);
+	EXPECT_LT(withDictionary.size(), plain.size());
+
+	BE::Memory::uint8Array out;
+	ASSERT_NO_THROW(out = _compressor->decompress(withDictionary));
+	ASSERT_EQ(out.size(), samples[0].size());
+	EXPECT_EQ(0, std::memcmp(out, samples[0], out.size()));
+	ASSERT_NO_THROW(out = _compressor->decompress(plain));
+	ASSERT_EQ(out.size(), samples[0].size());
+	EXPECT_EQ(0, std::memcmp(out, samples[0], out.size()));
+
+	/* Another instance needs the dictionary */
+	auto other = BE::IO::Compressor::createCompressor(GetParam());
+	EXPECT_THROW(other->decompress(withDictionary),
+	    BE::Error::StrategyError);
+	EXPECT_THROW(_compressor->setDictionary(samples[0]),
+	    BE::Error::StrategyError);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Kinds,
+    Compressor,
+    ::testing::Values(
+    BE::IO::Compressor::Kind::GZIP,
+    BE::IO::Compressor::Kind::ZSTD,
+    BE::IO::Compressor::Kind::LZ4));
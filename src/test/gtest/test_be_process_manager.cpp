@@ -10,6 +10,8 @@
 
 #include <unistd.h>
 
+#include <chrono>
+
 #ifdef FORK
 #include <csignal>
 #endif
@@ -306,6 +308,48 @@ TEST(ProcessManager, Communications)
 	EXPECT_EQ(manager->getNumActiveWorkers(), 0);
 }
 
+TEST(ProcessManager, SubsecondTimeout)
+{
+	std::unique_ptr<BE::Process::Manager> manager;
+#if defined FORK
+	manager.reset(new BE::Process::ForkManager());
+#elif defined THREAD
+	manager.reset(new BE::Process::POSIXThreadManager());
+#else
+	ASSERT_TRUE(false);
+#endif
+
+	for (auto i = 0; i < numWorkers; i++)
+		manager->addWorker(std::shared_ptr<TalkWorker>(
+		    new TalkWorker()));
+	manager->startWorkers(false, true);
+
+	/* Workers wait for a message, so they have nothing to send */
+	BE::Memory::uint8Array message;
+	std::shared_ptr<BE::Process::WorkerController> sender;
+	const auto begin = std::chrono::steady_clock::now();
+	EXPECT_FALSE(manager->getNextMessage(sender, message,
+	    std::chrono::milliseconds(50)));
+	const auto elapsed = std::chrono::steady_clock::now() - begin;
+	EXPECT_GE(elapsed, std::chrono::milliseconds(50));
+	EXPECT_LT(elapsed, std::chrono::seconds(1));
+
+	BE::Memory::AutoArrayUtility::setString(message, "To TalkWorker");
+	manager->broadcastMessage(message);
+	uint8_t receivedMessages = 0;
+	while (manager->getNextMessage(sender, message,
+	    std::chrono::milliseconds(500))) {
+		receivedMessages++;
+		EXPECT_EQ("To Manager", to_string(message));
+	}
+	EXPECT_EQ(receivedMessages, numWorkers);
+
+	BE::Memory::AutoArrayUtility::setString(message, "QUIT");
+	manager->broadcastMessage(message);
+	manager->waitForWorkerExit();
+	EXPECT_EQ(manager->getNumActiveWorkers(), 0);
+}
+
 TEST(ProcessManager, Individual)
 {
 	std::unique_ptr<BE::Process::Manager> manager;
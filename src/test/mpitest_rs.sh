@@ -39,6 +39,9 @@ Workers Per Node = 1
 Logsheet URL = file://mpi.log
 Record Logsheet URL = file://record.log
 Checkpoint Path = $CHKPATH
+Work Package Queue Depth = 4
+#Target Chunk Time = 1000
+#Distribute Key Ranges = true
 #Logsheet URL = syslog://linc01b:2514
 #Record Logsheet URL = syslog://linc01b:2514
 EOF
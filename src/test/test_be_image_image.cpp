@@ -16,10 +16,13 @@
 #include <memory>
 
 #include <be_image_image.h>
+#include <be_image_raw.h>
+#include <be_image_resample.h>
 #include <be_io_properties.h>
 #include <be_io_recordstore.h>
 #include <be_io_utility.h>
 #include <be_memory_autoarray.h>
+#include <be_sysdeps.h>
 
 #include <be_framework_enumeration.h>
 using namespace BiometricEvaluation::Framework::Enumeration;
@@ -281,6 +284,223 @@ compareProperties(
 		cout << "\t>> All Properties Validated" << endl;
 }
 
+#define TIMEINTERVAL(__s, __f)                                          \
+	(__f.tv_sec - __s.tv_sec)*1000000+(__f.tv_usec - __s.tv_usec)
+
+/**
+ * @brief
+ * Time decoding at reduced resolutions and of a region against a
+ * full-resolution decode.
+ *
+ * @param key
+ *	Name of the image.
+ * @param image
+ *	Image to decode.
+ */
+static void
+benchmarkReduction(
+    const std::string &key,
+    const shared_ptr<Image::Image> &image)
+{
+	struct timeval starttm, endtm;
+	const Image::Size dimensions = image->getDimensions();
+	const Image::ROI center(Image::Size(std::max(dimensions.xSize / 2, 1u),
+	    std::max(dimensions.ySize / 2, 1u)), dimensions.xSize / 4,
+	    dimensions.ySize / 4, {});
+
+	/* Pixels decoded above would otherwise be reused */
+	image->releaseDecodedData();
+	try {
+		gettimeofday(&starttm, nullptr);
+		image->getRawData();
+		gettimeofday(&endtm, nullptr);
+		cout << "\tFull decode: " << TIMEINTERVAL(starttm, endtm) <<
+		    " usec" << endl;
+
+		for (uint8_t reduction = 1; reduction <= 3; reduction++) {
+			for (const auto &roi : {Image::ROI(), center}) {
+				gettimeofday(&starttm, nullptr);
+				const Memory::uint8Array buf = image->getRawData(
+				    reduction, roi);
+				gettimeofday(&endtm, nullptr);
+				cout << "\tDecode 1/" << (1 << reduction) <<
+				    (roi.size.xSize == 0 ? "" : " (center)") <<
+				    ": " << image->getReducedDimensions(
+				    reduction, roi) << ", " << buf.size() <<
+				    " bytes, " << TIMEINTERVAL(starttm, endtm) <<
+				    " usec" << endl;
+			}
+		}
+	} catch (const Error::Exception &e) {
+		cerr << "Error reduced getRawData for " << key << ": " <<
+		    e.whatString() << endl;
+	}
+}
+
+/**
+ * @brief
+ * Time resampling to half size against decoding and then interpolating
+ * pixel by pixel.
+ *
+ * @param key
+ *	Name of the image.
+ * @param image
+ *	Image to resample.
+ */
+static void
+benchmarkResample(
+    const std::string &key,
+    const shared_ptr<Image::Image> &image)
+{
+	struct timeval starttm, endtm;
+	const Image::Size dimensions = image->getDimensions();
+	const Image::Size half(std::max(dimensions.xSize / 2, 1u),
+	    std::max(dimensions.ySize / 2, 1u));
+	const Image::ROI center(half, dimensions.xSize / 4,
+	    dimensions.ySize / 4, {});
+
+	image->releaseDecodedData();
+	try {
+		/* Bilinear interpolation of every component, as 8-bit */
+		gettimeofday(&starttm, nullptr);
+		const Memory::uint8Array raw = image->getRawData();
+		const uint64_t components = raw.size() / (
+		    static_cast<uint64_t>(dimensions.xSize) *
+		    dimensions.ySize);
+		Memory::uint8Array naive(static_cast<uint64_t>(half.xSize) *
+		    half.ySize * components);
+		const double xScale = static_cast<double>(dimensions.xSize) /
+		    half.xSize;
+		const double yScale = static_cast<double>(dimensions.ySize) /
+		    half.ySize;
+		for (uint32_t y = 0; y < half.ySize; y++) {
+			const double sy = std::max(((y + 0.5) * yScale) - 0.5,
+			    0.0);
+			const uint32_t y0 = std::min<uint32_t>(sy,
+			    dimensions.ySize - 1);
+			const uint32_t y1 = std::min(y0 + 1,
+			    dimensions.ySize - 1);
+			for (uint32_t x = 0; x < half.xSize; x++) {
+				const double sx = std::max(((x + 0.5) *
+				    xScale) - 0.5, 0.0);
+				const uint32_t x0 = std::min<uint32_t>(sx,
+				    dimensions.xSize - 1);
+				const uint32_t x1 = std::min(x0 + 1,
+				    dimensions.xSize - 1);
+				for (uint64_t c = 0; c < components; c++) {
+					const auto at = [&](uint32_t px,
+					    uint32_t py) {
+						return (raw[(((static_cast<
+						    uint64_t>(py) *
+						    dimensions.xSize) + px) *
+						    components) + c]);
+					};
+					const double top = at(x0, y0) + ((sx -
+					    x0) * (at(x1, y0) - at(x0, y0)));
+					const double bottom = at(x0, y1) +
+					    ((sx - x0) * (at(x1, y1) -
+					    at(x0, y1)));
+					naive[(((static_cast<uint64_t>(y) *
+					    half.xSize) + x) * components) +
+					    c] = static_cast<uint8_t>(top +
+					    ((sy - y0) * (bottom - top)) + 0.5);
+				}
+			}
+		}
+		gettimeofday(&endtm, nullptr);
+		cout << "\tDecode, then interpolate to " << half << ": " <<
+		    TIMEINTERVAL(starttm, endtm) << " usec" << endl;
+
+		for (const auto filter : {Image::ResampleFilter::Area,
+		    Image::ResampleFilter::Bilinear,
+		    Image::ResampleFilter::Lanczos3}) {
+			for (const auto &roi : {Image::ROI(), center}) {
+				image->releaseDecodedData();
+				gettimeofday(&starttm, nullptr);
+				const Image::Raw resampled = Image::resample(
+				    *image, (roi.size.xSize == 0 ? half :
+				    Image::Size(std::max(half.xSize / 2, 1u),
+				    std::max(half.ySize / 2, 1u))), filter,
+				    roi);
+				gettimeofday(&endtm, nullptr);
+				cout << "\tResample (" <<
+				    Framework::Enumeration::to_string(filter) <<
+				    (roi.size.xSize == 0 ? "" : ", center") <<
+				    ") to " << resampled.getDimensions() <<
+				    ": " << TIMEINTERVAL(starttm, endtm) <<
+				    " usec" << endl;
+			}
+		}
+
+		if (image->getResolution().units !=
+		    Image::Resolution::Units::NA) {
+			image->releaseDecodedData();
+			gettimeofday(&starttm, nullptr);
+			const Image::Raw normalized =
+			    Image::normalizeResolution(*image);
+			gettimeofday(&endtm, nullptr);
+			cout << "\tNormalize to 500 PPI: " <<
+			    normalized.getDimensions() << ", " <<
+			    TIMEINTERVAL(starttm, endtm) << " usec" << endl;
+		}
+	} catch (const Error::Exception &e) {
+		cerr << "Error resampling " << key << ": " <<
+		    e.whatString() << endl;
+	}
+}
+
+#if defined JPEGBTEST || defined JPEG2000TEST || defined NETPBMTEST || \
+    defined PNGTEST || defined WSQTEST
+/**
+ * @brief
+ * Time encoding the raw pixels of an image back into its format.
+ *
+ * @param key
+ *	Name of the image.
+ * @param image
+ *	Image to re-encode.
+ */
+static void
+benchmarkEncode(
+    const std::string &key,
+    const shared_ptr<Image::Image> &image)
+{
+	struct timeval starttm, endtm;
+	try {
+		const Image::Raw raw(image->getRawData(),
+		    image->getDimensions(), image->getColorDepth(),
+		    image->getBitDepth(), image->getResolution(),
+		    image->hasAlphaChannel());
+
+		gettimeofday(&starttm, nullptr);
+#if defined JPEGBTEST
+		const Memory::uint8Array encoded = Image::JPEG::encode(raw);
+#elif defined JPEG2000TEST
+		const Memory::uint8Array encoded = Image::JPEG2000::encode(
+		    raw);
+#elif defined NETPBMTEST
+		const Memory::uint8Array encoded = Image::NetPBM::encode(raw);
+#elif defined PNGTEST
+		const Memory::uint8Array encoded = Image::PNG::encode(raw);
+#elif defined WSQTEST
+		const Memory::uint8Array encoded = Image::WSQ::encode(raw);
+#endif
+		gettimeofday(&endtm, nullptr);
+
+		const auto usec = TIMEINTERVAL(starttm, endtm);
+		cout << "\tEncode: " << encoded.size() << " bytes, " << usec <<
+		    " usec";
+		if (usec > 0)
+			cout << " (" << (raw.getRawData().size() / usec) <<
+			    " MB/s)";
+		cout << endl;
+	} catch (const Error::Exception &e) {
+		cerr << "Error encoding " << key << ": " << e.whatString() <<
+		    endl;
+	}
+}
+#endif
+
 int
 main(
     int argc,
@@ -501,6 +721,13 @@ main(
 			   "for " << record.key << endl;
 			cerr << e.whatString() << endl;
 		}
+
+		benchmarkReduction(record.key, image);
+		benchmarkResample(record.key, image);
+#if defined JPEGBTEST || defined JPEG2000TEST || defined NETPBMTEST || \
+    defined PNGTEST || defined WSQTEST
+		benchmarkEncode(record.key, image);
+#endif
 		
 		/* 
 		 * Compare all properties of the Image as parsed to those 
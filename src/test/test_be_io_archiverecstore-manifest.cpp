@@ -0,0 +1,198 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <be_io_archiverecstore.h>
+#include <be_io_utility.h>
+#include <be_sysdeps.h>
+
+using namespace BiometricEvaluation;
+using namespace std;
+
+#define TIMEINTERVAL(__s, __f)                                          \
+	(__f.tv_sec - __s.tv_sec)*1000000+(__f.tv_usec - __s.tv_usec)
+
+static const int DEFAULTRECCOUNT = 500009;	/* A prime number of records */
+static const int RECSIZE = 13;			/* of prime number size each */
+static const int KEYNAMESIZE = 32;
+static const string RSNAME("ars_manifest_test");
+
+static string
+keyName(
+    int i)
+{
+	char buf[KEYNAMESIZE];
+	snprintf(buf, KEYNAMESIZE, "key%u", i);
+	return (buf);
+}
+
+/* Time opening the store and verify its contents */
+static int
+openAndCheck(
+    const string &label,
+    int recCount,
+    const string &removedKey)
+{
+	struct timeval starttm, endtm;
+	gettimeofday(&starttm, nullptr);
+	unique_ptr<IO::ArchiveRecordStore> rs;
+	try {
+		rs.reset(new IO::ArchiveRecordStore(RSNAME,
+		    IO::Mode::ReadOnly));
+	} catch (const Error::Exception &e) {
+		cout << "Could not open " << label << ": " << e.whatString() <<
+		    endl;
+		return (-1);
+	}
+	gettimeofday(&endtm, nullptr);
+	cout << "Open with " << label << " lapsed time: " <<
+	    TIMEINTERVAL(starttm, endtm) << endl;
+
+	/* Spot check reads, including the first and last records */
+	for (int i = 0; i < recCount; i += (recCount / 97) + 1) {
+		const string key = keyName(i);
+		if (key == removedKey)
+			continue;
+		try {
+			Memory::uint8Array data = rs->read(key);
+			if ((data.size() != RECSIZE) ||
+			    (strncmp((char *)&data[0], key.c_str(),
+			    RECSIZE) != 0)) {
+				cout << "Wrong data for " << key << endl;
+				return (-1);
+			}
+		} catch (const Error::Exception &e) {
+			cout << "Could not read " << key << ": " <<
+			    e.whatString() << endl;
+			return (-1);
+		}
+	}
+	if (!removedKey.empty()) {
+		try {
+			(void)rs->read(removedKey);
+			cout << "Read removed key " << removedKey << endl;
+			return (-1);
+		} catch (const Error::ObjectDoesNotExist&) {}
+	}
+
+	/* Every record is visited exactly once */
+	int sequenced = 0;
+	try {
+		for (;;) {
+			(void)rs->sequenceKey();
+			sequenced++;
+		}
+	} catch (const Error::ObjectDoesNotExist&) {}
+	const int expected = recCount - (removedKey.empty() ? 0 : 1);
+	if (sequenced != expected) {
+		cout << "Sequenced " << sequenced << " records, expected " <<
+		    expected << endl;
+		return (-1);
+	}
+	return (0);
+}
+
+/*
+ * Compare the time taken to open an ArchiveRecordStore using the text
+ * manifest against the binary manifest, and check that both describe the
+ * same records, including those changed after conversion.
+ */
+int
+main(
+    int argc,
+    char *argv[])
+{
+	int recCount = DEFAULTRECCOUNT;
+	if (argc > 1)
+		recCount = atoi(argv[1]);
+	if (recCount < 2) {
+		cout << "Usage: " << argv[0] << " [record count]" << endl;
+		return (EXIT_FAILURE);
+	}
+
+	if (IO::Utility::fileExists(RSNAME)) {
+		cout << RSNAME << " already exists; exiting." << endl;
+		return (EXIT_FAILURE);
+	}
+
+	cout << "Creating " << recCount << " records of size " << RECSIZE <<
+	    "." << endl;
+	try {
+		IO::ArchiveRecordStore rs(RSNAME, "Manifest Test");
+		char data[RECSIZE];
+		for (int i = 0; i < recCount; i++) {
+			const string key = keyName(i);
+			strncpy(data, key.c_str(), RECSIZE);
+			rs.insert(key, data, RECSIZE);
+		}
+	} catch (const Error::Exception &e) {
+		cout << "Could not create store: " << e.whatString() << endl;
+		return (EXIT_FAILURE);
+	}
+
+	int status = EXIT_SUCCESS;
+	if (openAndCheck("text manifest", recCount, "") != 0)
+		status = EXIT_FAILURE;
+
+	struct timeval starttm, endtm;
+	gettimeofday(&starttm, nullptr);
+	try {
+		IO::ArchiveRecordStore::convertManifest(RSNAME);
+	} catch (const Error::Exception &e) {
+		cout << "Could not convert manifest: " << e.whatString() <<
+		    endl;
+		status = EXIT_FAILURE;
+	}
+	gettimeofday(&endtm, nullptr);
+	cout << "Convert lapsed time: " << TIMEINTERVAL(starttm, endtm) <<
+	    endl;
+
+	if ((status == EXIT_SUCCESS) &&
+	    (openAndCheck("binary manifest", recCount, "") != 0))
+		status = EXIT_FAILURE;
+
+	/* Changes after conversion are appended to the text manifest */
+	const string removedKey = keyName(recCount / 2);
+	if (status == EXIT_SUCCESS) {
+		try {
+			IO::ArchiveRecordStore rs(RSNAME, IO::Mode::ReadWrite);
+			rs.remove(removedKey);
+			const string key = keyName(recCount);
+			char data[RECSIZE];
+			strncpy(data, key.c_str(), RECSIZE);
+			rs.insert(key, data, RECSIZE);
+		} catch (const Error::Exception &e) {
+			cout << "Could not modify store: " << e.whatString() <<
+			    endl;
+			status = EXIT_FAILURE;
+		}
+	}
+	if ((status == EXIT_SUCCESS) &&
+	    (openAndCheck("binary manifest and log", recCount + 1,
+	    removedKey) != 0))
+		status = EXIT_FAILURE;
+
+	try {
+		IO::RecordStore::removeRecordStore(RSNAME);
+	} catch (const Error::Exception &e) {
+		cout << "Could not remove store: " << e.whatString() << endl;
+		status = EXIT_FAILURE;
+	}
+
+	if (status == EXIT_SUCCESS)
+		cout << "Passed." << endl;
+	return (status);
+}
@@ -218,6 +218,33 @@ int main (int argc, char* argv[]) {
 		return (EXIT_FAILURE);
 	}
 
+	/* Compare mapped views against copied reads */
+	try {
+		IO::ArchiveRecordStore::RecordView view;
+		{
+			IO::ArchiveRecordStore roRS(archivefn,
+			    IO::Mode::ReadOnly);
+			for (const auto &key : {"0", "1", "99"}) {
+				Memory::uint8Array buf = roRS.read(key);
+				view = roRS.readView(key);
+				if ((view.size != buf.size()) ||
+				    (memcmp(view.data, buf, buf.size()) != 0)) {
+					cout << "Failed test of reading "
+					    "view for key " << key << endl;
+					return (EXIT_FAILURE);
+				}
+			}
+		}
+		/* The view must outlive the RecordStore */
+		Memory::uint8Array copy(view.size);
+		memcpy(copy, view.data, view.size);
+		cout << "Passed test of reading views" << endl;
+	} catch (const Error::Exception &e) {
+		cout << "Failed test of reading views: " << e.whatString() <<
+		    endl;
+		return (EXIT_FAILURE);
+	}
+
 	/* Remove the RecordStore */
 	cout << "Removing record store...";
 	try {
@@ -0,0 +1,328 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_io_compressedrecstore.h>
+#include <be_io_compressor.h>
+#include <be_io_utility.h>
+#include <be_sysdeps.h>
+
+using namespace BiometricEvaluation;
+using namespace std;
+
+#define TIMEINTERVAL(__s, __f)                                          \
+	(__f.tv_sec - __s.tv_sec)*1000000+(__f.tv_usec - __s.tv_usec)
+
+static const string RSNAME("compressor_test");
+static const vector<string> DEFAULTSTORES{
+    "test_data/AN2KRecordStore",
+    "test_data/ImageRS",
+    "test_data/ImagePropertiesRS"};
+
+/* Megabytes per second, from bytes and microseconds */
+static double
+throughput(
+    uint64_t bytes,
+    uint64_t usec)
+{
+	if (usec == 0)
+		usec = 1;
+	return ((static_cast<double>(bytes) / (1024 * 1024)) /
+	    (static_cast<double>(usec) / 1000000));
+}
+
+static vector<IO::RecordStore::Record>
+readStore(
+    const string &pathname)
+{
+	vector<IO::RecordStore::Record> records;
+	shared_ptr<IO::RecordStore> rs = IO::RecordStore::openRecordStore(
+	    pathname, IO::Mode::ReadOnly);
+	try {
+		for (;;)
+			records.push_back(rs->sequence());
+	} catch (const Error::ObjectDoesNotExist&) {}
+	return (records);
+}
+
+/* Compress and decompress every record, reporting ratio and speed */
+static int
+benchmark(
+    const string &label,
+    const shared_ptr<IO::Compressor> &compressor,
+    const vector<IO::RecordStore::Record> &records)
+{
+	struct timeval starttm, endtm;
+	uint64_t originalSize = 0, compressedSize = 0;
+	vector<Memory::uint8Array> compressed;
+	compressed.reserve(records.size());
+
+	gettimeofday(&starttm, nullptr);
+	for (const auto &record : records) {
+		compressed.push_back(compressor->compress(record.data));
+		originalSize += record.data.size();
+		compressedSize += compressed.back().size();
+	}
+	gettimeofday(&endtm, nullptr);
+	const uint64_t compressTime = TIMEINTERVAL(starttm, endtm);
+
+	gettimeofday(&starttm, nullptr);
+	for (size_t i = 0; i < records.size(); i++) {
+		const Memory::uint8Array data = compressor->decompress(
+		    compressed[i], compressed[i].size(),
+		    records[i].data.size());
+		if ((data.size() != records[i].data.size()) ||
+		    (memcmp(data, records[i].data, data.size()) != 0)) {
+			cout << label << ": round trip of " << records[i].key <<
+			    " failed" << endl;
+			return (-1);
+		}
+	}
+	gettimeofday(&endtm, nullptr);
+	const uint64_t decompressTime = TIMEINTERVAL(starttm, endtm);
+
+	cout << "  " << left << setw(18) << label << right << fixed <<
+	    setprecision(2) << " ratio " << setw(6) <<
+	    (static_cast<double>(originalSize) / max<uint64_t>(
+	    compressedSize, 1)) << "  compress " << setw(9) <<
+	    throughput(originalSize, compressTime) << " MB/s  decompress " <<
+	    setw(9) << throughput(originalSize, decompressTime) << " MB/s" <<
+	    endl;
+	return (0);
+}
+
+static int
+benchmarkStore(
+    const string &pathname)
+{
+	vector<IO::RecordStore::Record> records;
+	try {
+		records = readStore(pathname);
+	} catch (const Error::Exception &e) {
+		cout << "Could not read " << pathname << ": " <<
+		    e.whatString() << endl;
+		return (-1);
+	}
+	uint64_t totalSize = 0;
+	for (const auto &record : records)
+		totalSize += record.data.size();
+	cout << pathname << ": " << records.size() << " records, " <<
+	    totalSize << " bytes" << endl;
+
+	for (const auto kind : {IO::Compressor::Kind::GZIP,
+	    IO::Compressor::Kind::ZSTD, IO::Compressor::Kind::LZ4}) {
+		const string label = Framework::Enumeration::to_string(kind);
+		shared_ptr<IO::Compressor> compressor;
+		try {
+			compressor = IO::Compressor::createCompressor(kind);
+		} catch (const Error::NotImplemented&) {
+			cout << "  " << label << ": not built" << endl;
+			continue;
+		}
+
+		try {
+			if (benchmark(label, compressor, records) != 0)
+				return (-1);
+		} catch (const Error::Exception &e) {
+			cout << "  " << label << ": " << e.whatString() <<
+			    endl;
+			return (-1);
+		}
+
+		if (!compressor->supportsDictionaries())
+			continue;
+		vector<Memory::uint8Array> samples;
+		for (const auto &record : records)
+			samples.push_back(record.data);
+		try {
+			compressor->setDictionary(
+			    compressor->trainDictionary(samples));
+		} catch (const Error::StrategyError &e) {
+			/* Too few or too dissimilar records to train */
+			cout << "  " << label << " + dictionary: " <<
+			    e.whatString() << endl;
+			continue;
+		}
+		try {
+			if (benchmark(label + " + dictionary", compressor,
+			    records) != 0)
+				return (-1);
+		} catch (const Error::Exception &e) {
+			cout << "  " << label << " + dictionary: " <<
+			    e.whatString() << endl;
+			return (-1);
+		}
+	}
+	return (0);
+}
+
+/*
+ * Store records in a CompressedRecordStore that trains a dictionary from
+ * the first of them, and check that all records read back after reopening.
+ */
+static int
+testDictionaryTraining()
+{
+	static const int RECCOUNT = 2000;
+	static const int SAMPLECOUNT = 500;
+
+	cout << "CompressedRecordStore dictionary training:" << endl;
+	vector<IO::RecordStore::Record> records;
+	for (int i = 0; i < RECCOUNT; i++) {
+		const string text = "<record><id>" + to_string(i) +
+		    "</id><position>" + to_string(i % 10) + "</position>"
+		    "<quality>" + to_string((i * 7) % 100) + "</quality>"
+		    "</record>";
+		Memory::uint8Array data(text.size());
+		data.copy(reinterpret_cast<const uint8_t *>(text.data()),
+		    text.size());
+		records.emplace_back("key" + to_string(i), data);
+	}
+
+	try {
+		IO::CompressedRecordStore rs(RSNAME, "Dictionary Test",
+		    IO::RecordStore::Kind::File, IO::Compressor::Kind::ZSTD);
+		rs.trainDictionary(SAMPLECOUNT);
+		for (int i = 0; i < RECCOUNT; i++) {
+			rs.insert(records[i].key, records[i].data);
+			if ((i == SAMPLECOUNT - 2) && rs.hasDictionary()) {
+				cout << "  Dictionary trained too early" <<
+				    endl;
+				return (-1);
+			}
+		}
+		if (!rs.hasDictionary()) {
+			cout << "  No dictionary after " << SAMPLECOUNT <<
+			    " records" << endl;
+			return (-1);
+		}
+	} catch (const Error::NotImplemented &e) {
+		cout << "  " << e.whatString() << "; skipping." << endl;
+		return (0);
+	} catch (const Error::Exception &e) {
+		cout << "  Could not populate store: " << e.whatString() <<
+		    endl;
+		return (-1);
+	}
+
+	try {
+		IO::CompressedRecordStore rs(RSNAME, IO::Mode::ReadOnly);
+		if (!rs.hasDictionary()) {
+			cout << "  Dictionary not restored" << endl;
+			return (-1);
+		}
+		for (const auto &record : records) {
+			const Memory::uint8Array data = rs.read(record.key);
+			if ((data.size() != record.data.size()) ||
+			    (memcmp(data, record.data, data.size()) != 0)) {
+				cout << "  Wrong data for " << record.key <<
+				    endl;
+				return (-1);
+			}
+		}
+		cout << "  " << RECCOUNT << " records read back with "
+		    "dictionary." << endl;
+	} catch (const Error::Exception &e) {
+		cout << "  Could not read store: " << e.whatString() << endl;
+		return (-1);
+	}
+	return (0);
+}
+
+/*
+ * Store a zero-length record with each Compressor, and read it back after
+ * reopening the store.
+ */
+static int
+testZeroLength()
+{
+	cout << "Zero-length records:" << endl;
+	for (const auto kind : {IO::Compressor::Kind::GZIP,
+	    IO::Compressor::Kind::ZSTD, IO::Compressor::Kind::LZ4}) {
+		const string label = Framework::Enumeration::to_string(kind);
+		try {
+			{
+				IO::CompressedRecordStore rs(RSNAME,
+				    "Zero-length Test",
+				    IO::RecordStore::Kind::SQLite, kind);
+				rs.insert("zero", nullptr, 0);
+			}
+			IO::CompressedRecordStore rs(RSNAME,
+			    IO::Mode::ReadOnly);
+			if ((rs.length("zero") != 0) ||
+			    (rs.read("zero").size() != 0)) {
+				cout << "  " << label << ": not empty" << endl;
+				return (-1);
+			}
+			cout << "  " << label << ": OK" << endl;
+		} catch (const Error::NotImplemented&) {
+			cout << "  " << label << ": not built" << endl;
+		} catch (const Error::Exception &e) {
+			cout << "  " << label << ": " << e.whatString() <<
+			    endl;
+			return (-1);
+		}
+		if (IO::Utility::fileExists(RSNAME))
+			IO::RecordStore::removeRecordStore(RSNAME);
+	}
+	return (0);
+}
+
+/*
+ * Compare the compression ratio and speed of each Compressor over the
+ * records of existing RecordStores, with and without a trained dictionary.
+ */
+int
+main(
+    int argc,
+    char *argv[])
+{
+	vector<string> stores(argv + 1, argv + argc);
+	if (stores.empty())
+		stores = DEFAULTSTORES;
+
+	if (IO::Utility::fileExists(RSNAME)) {
+		cout << RSNAME << " already exists; exiting." << endl;
+		return (EXIT_FAILURE);
+	}
+
+	int status = EXIT_SUCCESS;
+	for (const auto &store : stores)
+		if (benchmarkStore(store) != 0)
+			status = EXIT_FAILURE;
+
+	if (testDictionaryTraining() != 0)
+		status = EXIT_FAILURE;
+	if (IO::Utility::fileExists(RSNAME))
+		IO::RecordStore::removeRecordStore(RSNAME);
+	if (testZeroLength() != 0)
+		status = EXIT_FAILURE;
+	if (IO::Utility::fileExists(RSNAME)) {
+		try {
+			IO::RecordStore::removeRecordStore(RSNAME);
+		} catch (const Error::Exception &e) {
+			cout << "Could not remove store: " << e.whatString() <<
+			    endl;
+			status = EXIT_FAILURE;
+		}
+	}
+
+	if (status == EXIT_SUCCESS)
+		cout << "Passed." << endl;
+	return (status);
+}
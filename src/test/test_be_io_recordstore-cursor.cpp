@@ -0,0 +1,340 @@
+/*
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <be_error_exception.h>
+#include <be_io_recordstore.h>
+#include <be_io_utility.h>
+#include <be_sysdeps.h>
+
+#ifdef FILERECORDSTORETEST
+#define TESTKIND IO::RecordStore::Kind::File
+#endif
+#ifdef DBRECORDSTORETEST
+#define TESTKIND IO::RecordStore::Kind::BerkeleyDB
+#endif
+#ifdef ARCHIVERECORDSTORETEST
+#define TESTKIND IO::RecordStore::Kind::Archive
+#endif
+#ifdef SQLITERECORDSTORETEST
+#define TESTKIND IO::RecordStore::Kind::SQLite
+#endif
+#ifdef COMPRESSEDRECORDSTORETEST
+#include <be_io_compressedrecstore.h>
+#endif
+
+using namespace BiometricEvaluation;
+using namespace std;
+
+#define TIMEINTERVAL(__s, __f)                                          \
+	(__f.tv_sec - __s.tv_sec)*1000000+(__f.tv_usec - __s.tv_usec)
+
+static const string RSNAME("cursor_test");
+static const int RECCOUNT = 10007;	/* A prime number of records */
+static const int RECSIZE = 1153;	/* of about a prime number size */
+static const int NUMTHREADS = 8;
+static const int RANDOMREADS = 5000;	/* Per random-reading thread */
+
+static string
+makeKey(
+    unsigned int index)
+{
+	char key[32];
+	snprintf(key, sizeof(key), "key%06u", index);
+	return (key);
+}
+
+/* Record contents are derived from the record's index */
+static Memory::uint8Array
+makeData(
+    unsigned int index)
+{
+	Memory::uint8Array data(RECSIZE + (index % 97));
+	for (uint64_t i = 0; i < data.size(); i++)
+		data[i] = static_cast<uint8_t>((index + i) & 0xFF);
+	return (data);
+}
+
+static bool
+checkRecord(
+    const IO::RecordStore::Record &record)
+{
+	unsigned int index;
+	if (sscanf(record.key.c_str(), "key%u", &index) != 1)
+		return (false);
+	const Memory::uint8Array expected = makeData(index);
+	if (record.data.size() != expected.size())
+		return (false);
+	for (uint64_t i = 0; i < expected.size(); i++)
+		if (record.data[i] != expected[i])
+			return (false);
+	return (true);
+}
+
+static shared_ptr<IO::RecordStore>
+createStore()
+{
+#ifdef COMPRESSEDRECORDSTORETEST
+	return (make_shared<IO::CompressedRecordStore>(RSNAME,
+	    "Cursor Test", IO::RecordStore::Kind::Archive,
+	    IO::Compressor::Kind::GZIP));
+#else
+	return (IO::RecordStore::createRecordStore(RSNAME, "Cursor Test",
+	    TESTKIND));
+#endif
+}
+
+/*
+ * Check that Cursors do not disturb each other, the RecordStore's own
+ * sequence, or iterators.
+ */
+static int
+testIndependence(
+    const shared_ptr<IO::RecordStore> &rs,
+    const vector<string> &keys)
+{
+	cout << "Independence of Cursors... ";
+	try {
+		auto first = rs->makeReader();
+		auto second = rs->makeReader();
+		if (first->sequenceKey() != keys[0]) {
+			cout << "FAILED (first key of first Cursor)" << endl;
+			return (-1);
+		}
+		second->sequenceKey();
+		second->sequenceKey();
+		if (rs->sequenceKey(IO::RecordStore::BE_RECSTORE_SEQ_START) !=
+		    keys[0]) {
+			cout << "FAILED (RecordStore sequence)" << endl;
+			return (-1);
+		}
+		if (first->sequenceKey() != keys[1]) {
+			cout << "FAILED (second key of first Cursor)" << endl;
+			return (-1);
+		}
+		if (second->sequence().key != keys[2]) {
+			cout << "FAILED (third key of second Cursor)" << endl;
+			return (-1);
+		}
+		if (rs->sequenceKey() != keys[1]) {
+			cout << "FAILED (RecordStore sequence moved)" << endl;
+			return (-1);
+		}
+
+		first->setCursorAtKey(keys[keys.size() - 1]);
+		if (first->sequence().key != keys[keys.size() - 1]) {
+			cout << "FAILED (setCursorAtKey)" << endl;
+			return (-1);
+		}
+		try {
+			first->sequenceKey();
+			cout << "FAILED (sequenced past end)" << endl;
+			return (-1);
+		} catch (const Error::ObjectDoesNotExist&) {}
+		if (first->sequenceKey(IO::RecordStore::BE_RECSTORE_SEQ_START)
+		    != keys[0]) {
+			cout << "FAILED (restart)" << endl;
+			return (-1);
+		}
+		try {
+			first->setCursorAtKey("notakey");
+			cout << "FAILED (setCursorAtKey to missing key)" <<
+			    endl;
+			return (-1);
+		} catch (const Error::ObjectDoesNotExist&) {}
+
+		/* Iterators from separate begin() calls */
+		auto it1 = rs->begin();
+		auto it2 = rs->begin();
+		++it2;
+		if ((it1->key != keys[0]) || (it2->key != keys[1]) ||
+		    ((++it1)->key != keys[1])) {
+			cout << "FAILED (iterators)" << endl;
+			return (-1);
+		}
+	} catch (const Error::Exception &e) {
+		cout << "FAILED (" << e.whatString() << ")" << endl;
+		return (-1);
+	}
+	cout << "passed." << endl;
+	return (0);
+}
+
+/*
+ * Scan disjoint ranges of the key sequence in some threads while reading
+ * random records in others, each through its own Cursor.
+ */
+static int
+testConcurrency(
+    const shared_ptr<IO::RecordStore> &rs,
+    const vector<string> &keys,
+    int numThreads)
+{
+	atomic<int> failures{0};
+	atomic<uint64_t> recordsRead{0};
+	const int scanners = max(numThreads / 2, 1);
+	const size_t rangeSize = (keys.size() + scanners - 1) / scanners;
+
+	struct timeval starttm, endtm;
+	gettimeofday(&starttm, nullptr);
+	vector<thread> threads;
+	for (int t = 0; t < scanners; t++) {
+		threads.emplace_back([&, t]() {
+			const size_t begin = t * rangeSize;
+			const size_t end = min(begin + rangeSize, keys.size());
+			if (begin >= end)
+				return;
+			try {
+				auto cursor = rs->makeReader();
+				cursor->setCursorAtKey(keys[begin]);
+				for (size_t i = begin; i < end; i++) {
+					const auto record = cursor->sequence();
+					if ((record.key != keys[i]) ||
+					    !checkRecord(record))
+						failures++;
+				}
+				recordsRead += end - begin;
+			} catch (const Error::Exception &e) {
+				cout << "Scan " << t << ": " <<
+				    e.whatString() << endl;
+				failures++;
+			}
+		});
+	}
+	for (int t = scanners; t < numThreads; t++) {
+		threads.emplace_back([&, t]() {
+			mt19937 generator(t);
+			uniform_int_distribution<size_t> distribution(0,
+			    keys.size() - 1);
+			try {
+				auto cursor = rs->makeReader();
+				for (int i = 0; i < RANDOMREADS; i++) {
+					const string &key = keys[distribution(
+					    generator)];
+					IO::RecordStore::Record record(key,
+					    cursor->read(key));
+					if (!checkRecord(record) ||
+					    (cursor->length(key) !=
+					    record.data.size()))
+						failures++;
+				}
+				recordsRead += RANDOMREADS;
+			} catch (const Error::Exception &e) {
+				cout << "Random read " << t << ": " <<
+				    e.whatString() << endl;
+				failures++;
+			}
+		});
+	}
+	for (auto &thread : threads)
+		thread.join();
+	gettimeofday(&endtm, nullptr);
+
+	cout << "  " << numThreads << " thread(s): " << recordsRead <<
+	    " records in " << TIMEINTERVAL(starttm, endtm) << " usec, " <<
+	    failures << " failure(s)" << endl;
+	return (failures == 0 ? 0 : -1);
+}
+
+static int
+testStore(
+    const shared_ptr<IO::RecordStore> &rs)
+{
+	/* Expected order of keys */
+	vector<string> keys;
+	try {
+		auto cursor = rs->makeReader();
+		for (;;)
+			keys.push_back(cursor->sequenceKey());
+	} catch (const Error::ObjectDoesNotExist&) {
+	} catch (const Error::Exception &e) {
+		cout << "Could not sequence keys: " << e.whatString() << endl;
+		return (-1);
+	}
+	if (keys.size() != RECCOUNT) {
+		cout << "Sequenced " << keys.size() << " keys; expected " <<
+		    RECCOUNT << endl;
+		return (-1);
+	}
+
+	if (testIndependence(rs, keys) != 0)
+		return (-1);
+
+	cout << "Concurrent scans and random reads:" << endl;
+	int status = 0;
+	for (int numThreads : {1, NUMTHREADS})
+		if (testConcurrency(rs, keys, numThreads) != 0)
+			status = -1;
+	return (status);
+}
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+	if (IO::Utility::fileExists(RSNAME)) {
+		cout << RSNAME << " already exists; exiting." << endl;
+		return (EXIT_FAILURE);
+	}
+
+	int status = EXIT_SUCCESS;
+	try {
+		shared_ptr<IO::RecordStore> rs = createStore();
+		try {
+			rs->makeReader();
+		} catch (const Error::NotImplemented&) {
+			cout << "Cursors not supported; skipping." << endl;
+			IO::RecordStore::removeRecordStore(RSNAME);
+			return (EXIT_SUCCESS);
+		}
+
+		cout << "Inserting " << RECCOUNT << " records." << endl;
+		for (unsigned int i = 0; i < RECCOUNT; i++)
+			rs->insert(makeKey((i * 7919) % RECCOUNT),
+			    makeData((i * 7919) % RECCOUNT));
+
+		cout << "Read/write store:" << endl;
+		if (testStore(rs) != 0)
+			status = EXIT_FAILURE;
+		rs.reset();
+
+		cout << "Read-only store:" << endl;
+		rs = IO::RecordStore::openRecordStore(RSNAME,
+		    IO::Mode::ReadOnly);
+		if (testStore(rs) != 0)
+			status = EXIT_FAILURE;
+		rs.reset();
+	} catch (const Error::Exception &e) {
+		cout << "Caught " << e.whatString() << endl;
+		status = EXIT_FAILURE;
+	}
+
+	try {
+		if (IO::Utility::fileExists(RSNAME))
+			IO::RecordStore::removeRecordStore(RSNAME);
+	} catch (const Error::Exception &e) {
+		cout << "Could not remove store: " << e.whatString() << endl;
+		status = EXIT_FAILURE;
+	}
+
+	if (status == EXIT_SUCCESS)
+		cout << "Passed." << endl;
+	return (status);
+}
@@ -15,6 +15,7 @@
 #include <sstream>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <be_io_utility.h>
 #include <be_memory_autoarrayutility.h>
@@ -39,6 +40,7 @@
 #endif
 
 #ifdef SQLITERECORDSTORETEST
+#include <be_io_propertiesfile.h>
 #include <be_io_sqliterecstore.h>
 #define TESTDEFINED
 #define MERGETESTDEFINED
@@ -244,8 +246,40 @@ testMerge()
 		else
 			cout << "FAILED." << endl;
 
+		/* Interleave keys; the last store no longer sequences sorted */
+		cout << "Merge RecordStores in key order... ";
+		data.copy((uint8_t *)"05", 2);
+		merge_rs[2]->insert("05", data);
+		merge_rs[2]->sync();
+		data.copy((uint8_t *)"45", 2);
+		merge_rs[0]->insert("45", data);
+		merge_rs[0]->sync();
+		const string sorted_rs_fn = "test_merged_sorted";
+		IO::RecordStore::mergeRecordStores(sorted_rs_fn,
+		    "A sorted merge of 3 RS", merged_type, path,
+		    IO::RecordStore::MergeOrder::Sorted);
+		auto sorted_rs = IO::RecordStore::openRecordStore(sorted_rs_fn);
+		bool sortedOK = (sorted_rs->getCount() == ((num_rs * 3) + 2));
+		string prevKey;
+		try {
+			for (;;) {
+				const string key = sorted_rs->sequenceKey();
+				if (key < prevKey)
+					sortedOK = false;
+				prevKey = key;
+			}
+		} catch (const Error::ObjectDoesNotExist&) {}
+		if (sorted_rs->read("05")[0] != '0')
+			sortedOK = false;
+		sorted_rs.reset();
+		IO::RecordStore::removeRecordStore(sorted_rs_fn);
+		if (sortedOK)
+			cout << "success." << endl;
+		else
+			cout << "FAILED." << endl;
+
 		if (merged_rs != nullptr) {
-			delete merged_rs; 
+			delete merged_rs;
 			IO::RecordStore::removeRecordStore(merged_rs_fn);
 		}
 		if (merge_rs[0] != nullptr) {
@@ -266,6 +300,147 @@ testMerge()
 }
 #endif
 
+/*
+ * Test bulk updates of a RecordStore, leaving the store as it was found.
+ */
+static int
+testBulk(IO::RecordStore *rs)
+{
+	static const int BULKCOUNT = 100;
+	const unsigned int startCount = rs->getCount();
+
+	cout << "Insert and remove records in a bulk update... ";
+	try {
+		rs->beginBulk();
+		for (int i = 0; i < BULKCOUNT; i++) {
+			const string key = "bulk" + to_string(i);
+			rs->insert(key, key.c_str(), key.size() + 1);
+		}
+		rs->remove("bulk0");
+		/* Records are readable before the bulk update completes */
+		Memory::uint8Array data = rs->read("bulk1");
+		if (string((char *)&data[0]) != "bulk1" ||
+		    rs->getCount() != startCount + BULKCOUNT - 1) {
+			cout << "FAILED" << endl;
+			return (-1);
+		}
+		rs->commitBulk();
+	} catch (const Error::Exception &e) {
+		cout << "FAILED; caught " << e.what() << endl;
+		return (-1);
+	}
+	if (rs->getCount() != startCount + BULKCOUNT - 1) {
+		cout << "FAILED; count is " << rs->getCount() << endl;
+		return (-1);
+	}
+	cout << "success" << endl;
+
+	cout << "Commit without a bulk update, catching exception... ";
+	try {
+		rs->commitBulk();
+		cout << "FAILED" << endl;
+		return (-1);
+	} catch (const Error::StrategyError &e) {
+		cout << "success" << endl;
+	}
+
+	cout << "Insert a batch of records, one a duplicate... ";
+	vector<IO::RecordStore::Record> batch;
+	for (int i = BULKCOUNT; i < 2 * BULKCOUNT; i++) {
+		const string key = "bulk" + to_string(i);
+		Memory::uint8Array data(key.size() + 1);
+		data.copy((uint8_t *)key.c_str(), key.size() + 1);
+		batch.emplace_back(key, data);
+	}
+	batch.emplace_back("bulk1", Memory::uint8Array(1));
+	try {
+		rs->insertBatch(batch);
+		cout << "FAILED" << endl;
+		return (-1);
+	} catch (const Error::ObjectExists &e) {
+		/* Records preceding the duplicate remain */
+		if (rs->getCount() != startCount + (2 * BULKCOUNT) - 1) {
+			cout << "FAILED; count is " << rs->getCount() << endl;
+			return (-1);
+		}
+	} catch (const Error::Exception &e) {
+		cout << "FAILED; caught " << e.what() << endl;
+		return (-1);
+	}
+	cout << "success" << endl;
+
+	cout << "Sequence and remove the bulk records... ";
+	int found = 0;
+	try {
+		for (auto it = rs->begin(); it != rs->end(); it++) {
+			if (it->key.compare(0, 4, "bulk") != 0)
+				continue;
+			if (string((char *)&it->data[0]) != it->key) {
+				cout << "FAILED; wrong data for " << it->key <<
+				    endl;
+				return (-1);
+			}
+			found++;
+		}
+		for (int i = 1; i < 2 * BULKCOUNT; i++)
+			rs->remove("bulk" + to_string(i));
+	} catch (const Error::Exception &e) {
+		cout << "FAILED; caught " << e.what() << endl;
+		return (-1);
+	}
+	if ((found != (2 * BULKCOUNT) - 1) || (rs->getCount() != startCount)) {
+		cout << "FAILED; found " << found << " records" << endl;
+		return (-1);
+	}
+	cout << "success" << endl;
+
+	return (0);
+}
+
+/*
+ * Test that a record removed ahead of an iterator is skipped, without
+ * ending the iteration early, leaving the store as it was found.
+ */
+static int
+testRemoveWhileIterating(IO::RecordStore *rs)
+{
+	static const int ITERCOUNT = 10;
+	const unsigned int startCount = rs->getCount();
+
+	cout << "Remove a record ahead of an iterator... ";
+	int found = 0;
+	bool removedFound = false;
+	try {
+		for (int i = 0; i < ITERCOUNT; i++) {
+			const string key = "iter" + to_string(i);
+			rs->insert(key, key.c_str(), key.size() + 1);
+		}
+		for (auto it = rs->begin(); it != rs->end(); it++) {
+			if (it->key.compare(0, 4, "iter") != 0)
+				continue;
+			found++;
+			if (it->key == "iter5")
+				removedFound = true;
+			if (it->key == "iter2")
+				rs->remove("iter5");
+		}
+		for (int i = 0; i < ITERCOUNT; i++)
+			if (i != 5)
+				rs->remove("iter" + to_string(i));
+	} catch (const Error::Exception &e) {
+		cout << "FAILED; caught " << e.what() << endl;
+		return (-1);
+	}
+	if ((found != ITERCOUNT - 1) || removedFound ||
+	    (rs->getCount() != startCount)) {
+		cout << "FAILED; found " << found << " records" << endl;
+		return (-1);
+	}
+	cout << "success" << endl;
+
+	return (0);
+}
+
 /*
  * Test the read and write operations of a RecordStore. This function will
  * test any implementation of the abstract RecordStore by using the abstract
@@ -514,18 +689,22 @@ runTests(IO::RecordStore *rs)
 		cout << "success." << endl;
 	} catch (const Error::Exception &e) {
 		cout << "Caught: " << e.what() << endl;
+		return (-1);
 	}
 	cout << "Read zero-length record... ";
 	try {
 		rdata = rs->read(theKey);
 		rlen = rdata.size();
 		cout << "length is " << rlen << "; ";
-		if (rlen == 0)
+		if (rlen == 0) {
 			cout << "success." << endl;
-		else
+		} else {
 			cout << "failure." << endl;
+			return (-1);
+		}
 	} catch (const Error::Exception &e) {
 		cout << "Caught: " << e.what() << endl;
+		return (-1);
 	}
 	cout << "Removing zero-length record...";
 	try {
@@ -586,6 +765,12 @@ runTests(IO::RecordStore *rs)
 		cout << "success." << endl;
 	}
 
+	cout << endl;
+	if (testBulk(rs) != 0)
+		return (-1);
+	if (testRemoveWhileIterating(rs) != 0)
+		return (-1);
+
 	cout << "\nInsert with an invalid key..." << endl;
 	try {
 		string badKey("test/with/path/chars");
@@ -769,6 +954,67 @@ main(int argc, char* argv[]) {
 		cout << "A strategy error occurred: " << e.what() << endl;
 		return (EXIT_FAILURE);
 	}
+
+	/* Remaining tests run with the profile applied */
+	cout << "Set and reload a PragmaProfile... ";
+	try {
+		IO::SQLiteRecordStore::PragmaProfile profile;
+		profile.journalMode = "wal";
+		profile.mmapSize = 64 * 1024 * 1024;
+		profile.cacheSize = -8192;
+		rs->setPragmaProfile(profile);
+
+		IO::SQLiteRecordStore rors(rsPath, IO::Mode::ReadOnly);
+		const IO::SQLiteRecordStore::PragmaProfile loaded =
+		    rors.getPragmaProfile();
+		if ((loaded.journalMode != "WAL") ||
+		    (loaded.mmapSize != profile.mmapSize) ||
+		    (loaded.cacheSize != profile.cacheSize)) {
+			cout << "FAILED" << endl;
+			return (EXIT_FAILURE);
+		}
+	} catch (const Error::Exception &e) {
+		cout << "FAILED; caught " << e.what() << endl;
+		return (EXIT_FAILURE);
+	}
+	cout << "success" << endl;
+	cout << "Set an invalid PragmaProfile, catching exception... ";
+	try {
+		IO::SQLiteRecordStore::PragmaProfile profile;
+		profile.journalMode = "WAL; DROP TABLE RecordStore";
+		rs->setPragmaProfile(profile);
+		cout << "FAILED" << endl;
+		return (EXIT_FAILURE);
+	} catch (const Error::StrategyError &e) {
+		cout << "success" << endl;
+	}
+	cout << "Open with an invalid saved journal mode, catching "
+	    "exception... ";
+	try {
+		IO::PropertiesFile control(rsPath + "/.rscontrol.prop",
+		    IO::Mode::ReadWrite);
+		control.setProperty(
+		    IO::SQLiteRecordStore::JOURNAL_MODE_PROPERTY,
+		    "WAL; DROP TABLE RecordStore");
+		control.sync();
+		bool rejected = false;
+		try {
+			IO::SQLiteRecordStore rors(rsPath, IO::Mode::ReadOnly);
+		} catch (const Error::StrategyError &e) {
+			rejected = true;
+		}
+		control.setProperty(
+		    IO::SQLiteRecordStore::JOURNAL_MODE_PROPERTY, "WAL");
+		control.sync();
+		if (!rejected) {
+			cout << "FAILED" << endl;
+			return (EXIT_FAILURE);
+		}
+	} catch (const Error::Exception &e) {
+		cout << "FAILED; caught " << e.what() << endl;
+		return (EXIT_FAILURE);
+	}
+	cout << "success" << endl;
 #endif
 
 #ifdef COMPRESSEDRECORDSTORETEST
@@ -7,6 +7,7 @@
  * its use by other parties, and makes no guarantees, expressed or implied,
  * about its quality, reliability, or any other characteristic.
  */
+#include <chrono>
 #include <memory>
 #include <sstream>
 #include <stdlib.h>
@@ -26,6 +27,12 @@ using namespace std;
 using namespace BiometricEvaluation;
 
 static const std::string DefaultPropertiesFileName("test_be_rs_mpi.props");
+
+/*
+ * When benchmarking, records are processed without delay or logging,
+ * so the time taken is that of moving work packages to the workers.
+ */
+static bool Benchmark{false};
 const std::string
 TestRecordProcessor::RECORDLOGSHEETURLPROPERTY("Record Logsheet URL");
 
@@ -179,6 +186,10 @@ TestRecordProcessor::processRecord(const std::string &key)
 {
 	BE::IO::Logsheet *log = this->getLogsheet().get();
 
+	if (Benchmark) {
+		(void)this->getResources()->getRecordStore()->read(key);
+		return;
+	}
 	if (this->getResources()->haveRecordStore() == false) {
 		BE::MPI::logMessage(*log, "processRecord(" + key + ")"
 		    + " called but have no record store; returning.");
@@ -218,6 +229,8 @@ TestRecordProcessor::processRecord(
     const std::string &key,
     const BiometricEvaluation::Memory::uint8Array &value)
 {
+	if (Benchmark)
+		return;
 	BE::IO::Logsheet *log = this->getLogsheet().get();
 	*log << "processRecord(" << key << ", [value]) called: ";
 	char *buf = this->_sharedMemory.get();
@@ -274,14 +287,15 @@ main(int argc, char* argv[])
 	 * are take care of.
 	 */
 	/*
-	 * Process optional checkpoint and include-values flags.
+	 * Process optional checkpoint, include-values, and benchmark flags.
 	 */
 	bool checkpoint{false}, includeValues{false};
 	char ch;
-	while ((ch = getopt(argc, argv, "cv")) != -1) {
+	while ((ch = getopt(argc, argv, "cvb")) != -1) {
 		switch (ch) {
 			case 'c': checkpoint = true; break;
 			case 'v': includeValues = true; break;
+			case 'b': Benchmark = true; break;
 		}
 	}
 	MPI::Runtime runtime(argc, argv, checkpoint);
@@ -343,7 +357,29 @@ main(int argc, char* argv[])
 		runtime.abort(EXIT_FAILURE);
 	}
 	try {
+		const auto begin = std::chrono::steady_clock::now();
 		runtime.start(*distributor, *receiver);
+		const std::chrono::duration<double> elapsed =
+		    std::chrono::steady_clock::now() - begin;
+		if (Benchmark) {
+			/* Report throughput over the whole input */
+			MPI::RecordStoreResources resources(propFile);
+			if (resources.getRank() == 0) {
+				auto rs = resources.getRecordStore();
+				uint64_t size{0};
+				for (auto it = rs->begin(); it != rs->end();
+				    it++)
+					size += it->data.size();
+				std::ostringstream status;
+				status << "Benchmark: " << rs->getCount() <<
+				    " records, " << size << " octets in " <<
+				    elapsed.count() << " s (" << std::fixed <<
+				    (rs->getCount() / elapsed.count()) <<
+				    " records/s, " << ((size / 1048576.0) /
+				    elapsed.count()) << " MiB/s)";
+				MPI::printStatus(status.str());
+			}
+		}
 		runtime.shutdown();
 	} catch (const Error::Exception &e) {
 		MPI::printStatus("start/shutdown, caught: " + e.whatString());